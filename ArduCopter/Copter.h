@@ -961,6 +961,7 @@ private:
 
     // Parameters.cpp
     void load_parameters(void) override;
+    void set_parameter_defaults(void);
     void convert_pid_parameters(void);
 #if HAL_PROXIMITY_ENABLED
     void convert_prx_parameters();
@@ -983,6 +984,7 @@ private:
 
     // sensors.cpp
     void read_barometer(void);
+    void probe_rangefinder(void);
     void init_rangefinder(void);
     void read_rangefinder(void);
     bool rangefinder_alt_ok() const;
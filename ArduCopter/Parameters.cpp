@@ -1318,7 +1318,16 @@ ParametersG2::ParametersG2(void) :
 
 void Copter::load_parameters(void)
 {
-    AP_Vehicle::load_parameters(g.format_version, Parameters::k_format_version);
+    AP_Vehicle::load_parameters(g.format_version, Parameters::k_format_version,
+                                Parameters::k_conversion_version);
+
+    // setup AP_Param frame type flags
+    AP_Param::set_frame_type_flags(AP_PARAM_FRAME_COPTER);
+
+    if (AP_Param::conversions_done()) {
+        // this firmware has already converted the parameters
+        return;
+    }
 
 #if MODE_RTL_ENABLED
     // PARAMETER_CONVERSION - Added: Sep-2021
@@ -1360,25 +1369,14 @@ void Copter::load_parameters(void)
     };
 
     AP_Param::convert_toplevel_objects(toplevel_conversions, ARRAY_SIZE(toplevel_conversions));
-
-
-    // setup AP_Param frame type flags
-    AP_Param::set_frame_type_flags(AP_PARAM_FRAME_COPTER);
 }
 
-// handle conversion of PID gains
-void Copter::convert_pid_parameters(void)
+/*
+  set defaults that differ from those of the libraries. Defaults are
+  not stored, so unlike the conversions this runs on every boot
+ */
+void Copter::set_parameter_defaults(void)
 {
-    const AP_Param::ConversionInfo angle_and_filt_conversion_info[] = {
-        // PARAMETER_CONVERSION - Added: Aug-2021
-        { Parameters::k_param_pi_vel_xy, 3, AP_PARAM_FLOAT, "PSC_VELXY_FLTE" },
-    };
-
-    // convert angle controller gain and filter without scaling
-    for (const auto &info : angle_and_filt_conversion_info) {
-        AP_Param::convert_old_parameter(&info, 1.0f);
-    }
-
     // TradHeli default parameters
 #if FRAME_CONFIG == HELI_FRAME
     static const struct AP_Param::defaults_table_struct heli_defaults_table[] = {
@@ -1401,6 +1399,30 @@ void Copter::convert_pid_parameters(void)
     AP_Param::set_defaults_from_table(heli_defaults_table, ARRAY_SIZE(heli_defaults_table));
 #endif  // FRAME_CONFIG == HELI_FRAME
 
+#if AP_INERTIALSENSOR_HARMONICNOTCH_ENABLED
+#if HAL_INS_NUM_HARMONIC_NOTCH_FILTERS > 1
+    if (!ins.harmonic_notches[1].params.enabled()) {
+        // the second notch replaced the fixed notch for 4.2.x
+        AP_Param::set_default_by_name("INS_HNTC2_MODE", 0);
+        AP_Param::set_default_by_name("INS_HNTC2_HMNCS", 1);
+    }
+#endif
+#endif  // AP_INERTIALSENSOR_HARMONICNOTCH_ENABLED
+}
+
+// handle conversion of PID gains
+void Copter::convert_pid_parameters(void)
+{
+    const AP_Param::ConversionInfo angle_and_filt_conversion_info[] = {
+        // PARAMETER_CONVERSION - Added: Aug-2021
+        { Parameters::k_param_pi_vel_xy, 3, AP_PARAM_FLOAT, "PSC_VELXY_FLTE" },
+    };
+
+    // convert angle controller gain and filter without scaling
+    for (const auto &info : angle_and_filt_conversion_info) {
+        AP_Param::convert_old_parameter(&info, 1.0f);
+    }
+
 #if AP_INERTIALSENSOR_HARMONICNOTCH_ENABLED
 #if HAL_INS_NUM_HARMONIC_NOTCH_FILTERS > 1
     if (!ins.harmonic_notches[1].params.enabled()) {
@@ -1413,8 +1435,6 @@ void Copter::convert_pid_parameters(void)
             { Parameters::k_param_ins, 421, AP_PARAM_FLOAT, "INS_HNTC2_BW" },
         };
         AP_Param::convert_old_parameters(&notchfilt_conversion_info[0], ARRAY_SIZE(notchfilt_conversion_info));
-        AP_Param::set_default_by_name("INS_HNTC2_MODE", 0);
-        AP_Param::set_default_by_name("INS_HNTC2_HMNCS", 1);
     }
 #endif
 #endif  // AP_INERTIALSENSOR_HARMONICNOTCH_ENABLED
@@ -27,6 +27,13 @@ public:
     //
     static const uint16_t        k_format_version = 120;
 
+    // Parameter conversions run once for each firmware, see
+    // AP_Param::conversions_done(). Increment this when adding a
+    // PARAMETER_CONVERSION so that it runs on boards already booted
+    // with a build of the same git hash, such as development builds.
+    //
+    static const uint16_t        k_conversion_version = 1;
+
     // Parameter identities.
     //
     // The enumeration defined here is used to ensure that every parameter
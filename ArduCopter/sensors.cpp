@@ -9,10 +9,15 @@ void Copter::read_barometer(void)
 }
 
 #if AP_RANGEFINDER_ENABLED
-void Copter::init_rangefinder(void)
+// detect rangefinders, run in the background during startup
+void Copter::probe_rangefinder(void)
 {
    rangefinder.set_log_rfnd_bit(MASK_LOG_CTUN);
    rangefinder.init(ROTATION_PITCH_270);
+}
+
+void Copter::init_rangefinder(void)
+{
    rangefinder_state.alt_cm_filt.set_cutoff_frequency(g2.rangefinder_filt);
    rangefinder_state.enabled = rangefinder.has_orientation(ROTATION_PITCH_270);
 
@@ -27,13 +27,36 @@ void Copter::init_ardupilot()
     // initialise battery monitor
     battery.init();
 
+    /*
+      the compass and rangefinders are probed in the background while
+      the barometer is probed. They must be finished before the GCS is
+      set up, as from then on MAVLink is serviced from the delay
+      callback and can reach the compass
+     */
+    AP::compass().set_log_bit(MASK_LOG_COMPASS);
+#if HAL_MAG_PROBE_USES_INS
+    // probing these compasses detects the IMUs, so stays on the main thread
+    boot_phase("compass");
+    AP::compass().init();
+#else
+    boot_run_async("compass", FUNCTOR_BIND(&AP::compass(), &Compass::init, void));
+#endif
+#if AP_RANGEFINDER_ENABLED
+    boot_run_async("rangefinder", FUNCTOR_BIND_MEMBER(&Copter::probe_rangefinder, void));
+#endif
+
 #if AP_RSSI_ENABLED
     // Init RSSI
     rssi.init();
 #endif
 
+    boot_phase("baro");
     barometer.init();
 
+    boot_phase("probe-wait");
+    boot_wait_async();
+    boot_phase("copter");
+
     // setup telem slots with serial ports
     gcs().setup_uarts();
 
@@ -90,9 +113,6 @@ void Copter::init_ardupilot()
     gps.set_log_gps_bit(MASK_LOG_GPS);
     gps.init();
 
-    AP::compass().set_log_bit(MASK_LOG_COMPASS);
-    AP::compass().init();
-
 #if AP_AIRSPEED_ENABLED
     airspeed.set_log_bit(MASK_LOG_IMU);
 #endif
@@ -134,9 +154,12 @@ void Copter::init_ardupilot()
 
     // read Baro pressure at ground
     //-----------------------------
+    boot_phase("baro-cal");
     barometer.set_log_baro_bit(MASK_LOG_IMU);
     barometer.calibrate();
 
+    boot_phase("copter-late");
+
 #if AP_RANGEFINDER_ENABLED
     // initialise rangefinder
     init_rangefinder();
@@ -175,7 +198,9 @@ void Copter::init_ardupilot()
     logger.setVehicle_Startup_Writer(FUNCTOR_BIND(&copter, &Copter::Log_Write_Vehicle_Startup_Messages, void));
 #endif
 
+    boot_phase("ins");
     startup_INS_ground();
+    boot_phase("copter-final");
 
 #if AC_CUSTOMCONTROL_MULTI_ENABLED
     custom_control.init();
@@ -503,15 +528,23 @@ void Copter::allocate_motors(void)
         g.rc_speed.set_default(16000);
     }
     
-    // upgrade parameters. This must be done after allocating the objects
-    convert_pid_parameters();
-#if FRAME_CONFIG == HELI_FRAME
-    motors->heli_motors_param_conversions();
-#endif
+    // defaults are not stored, so these are set on every boot
+    set_parameter_defaults();
+
+    // upgrade parameters. This must be done after allocating the
+    // objects, and only once for each firmware
+    if (!AP_Param::conversions_done()) {
+        convert_pid_parameters();
 
 #if HAL_PROXIMITY_ENABLED
-    // convert PRX to PRX1_ parameters
-    convert_prx_parameters();
+        // convert PRX to PRX1_ parameters
+        convert_prx_parameters();
+#endif
+    }
+#if FRAME_CONFIG == HELI_FRAME
+    // this also sets the yaw trim of a direct drive tail set up since
+    // the last boot, so is not skipped with the conversions above
+    motors->heli_motors_param_conversions();
 #endif
 
     // param count could have changed
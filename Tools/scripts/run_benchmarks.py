@@ -0,0 +1,102 @@
+#!/usr/bin/env python3
+
+"""
+Runs the google-benchmark programs built by "./waf benchmarks" and
+collects their results into a single JSON file, so that results can be
+compared between builds or releases, e.g. with the compare.py tool in
+modules/gbenchmark/tools:
+
+  ./waf configure --board sitl --enable-benchmarks
+  ./waf benchmarks
+  Tools/scripts/run_benchmarks.py --out master.json
+  ...
+  modules/gbenchmark/tools/compare.py benchmarks master.json branch.json
+
+ AP_FLAKE8_CLEAN
+"""
+import argparse
+import json
+import os
+import subprocess
+import sys
+import tempfile
+
+tools_dir = os.path.dirname(os.path.realpath(__file__))
+root_dir = os.path.realpath(os.path.join(tools_dir, '../..'))
+
+
+def find_benchmarks(board, pattern):
+    '''return the paths of the benchmark programs built for board'''
+    bench_dir = os.path.join(root_dir, 'build', board, 'benchmarks')
+    if not os.path.isdir(bench_dir):
+        print("No benchmarks in %s, build them with ./waf benchmarks" % bench_dir)
+        sys.exit(1)
+    ret = []
+    for name in sorted(os.listdir(bench_dir)):
+        path = os.path.join(bench_dir, name)
+        if not name.startswith('benchmark_') or not os.access(path, os.X_OK):
+            continue
+        if pattern is not None and pattern not in name:
+            continue
+        ret.append(path)
+    return ret
+
+
+def run_benchmark(path, args):
+    '''run one benchmark program, returning its JSON results'''
+    with tempfile.NamedTemporaryFile(suffix='.json') as f:
+        cmd = [path,
+               '--benchmark_out=%s' % f.name,
+               '--benchmark_out_format=json']
+        if args.filter is not None:
+            cmd.append('--benchmark_filter=%s' % args.filter)
+        if args.repetitions > 1:
+            cmd.append('--benchmark_repetitions=%u' % args.repetitions)
+        if args.min_time is not None:
+            cmd.append('--benchmark_min_time=%s' % args.min_time)
+        subprocess.run(cmd, check=True)
+        return json.load(f)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('--board', default='sitl',
+                        help='board the benchmarks were built for')
+    parser.add_argument('--program', default=None,
+                        help='only run benchmark programs with names containing this')
+    parser.add_argument('--filter', default=None,
+                        help='regular expression passed to --benchmark_filter')
+    parser.add_argument('--repetitions', type=int, default=1,
+                        help='number of times to repeat each benchmark')
+    parser.add_argument('--min-time', default=None,
+                        help='minimum time in seconds to run each benchmark for')
+    parser.add_argument('--out', default='benchmarks.json',
+                        help='file to write the combined results to')
+    args = parser.parse_args()
+
+    combined = None
+    for path in find_benchmarks(args.board, args.program):
+        program = os.path.basename(path)
+        print("Running %s" % program)
+        results = run_benchmark(path, args)
+        for b in results.get('benchmarks', []):
+            b['program'] = program
+        if combined is None:
+            # the context (host, CPU and library details) is the same
+            # for every program
+            combined = results
+        else:
+            combined['benchmarks'].extend(results.get('benchmarks', []))
+
+    if combined is None:
+        print("No benchmarks run")
+        sys.exit(1)
+
+    with open(args.out, 'w') as f:
+        json.dump(combined, f, indent=2)
+    print("Wrote %u results to %s" % (len(combined['benchmarks']), args.out))
+
+
+if __name__ == '__main__':
+    main()
@@ -321,30 +321,29 @@ bool AC_PolyFence_loader::format()
     return write_eos_to_storage(offset);
 }
 
-bool AC_PolyFence_loader::scale_latlon_from_origin(const Location &origin, const Vector2l &point, Vector2f &pos_cm)
+bool AC_PolyFence_loader::scale_latlon_from_origin(const LocationReference &origin, const Vector2l &point, Vector2f &pos_cm)
 {
-    Location tmp_loc;
-    tmp_loc.lat = point.x;
-    tmp_loc.lng = point.y;
-    pos_cm = origin.get_distance_NE(tmp_loc) * 100.0f;
+    pos_cm = origin.get_distance_NE(point.x, point.y) * 100.0f;
     return true;
 }
 
-bool AC_PolyFence_loader::read_polygon_from_storage(const Location &origin, uint16_t &read_offset, const uint8_t vertex_count, Vector2f *&next_storage_point, Vector2l *&next_storage_point_lla)
+bool AC_PolyFence_loader::read_polygon_from_storage(const LocationReference &origin, uint16_t &read_offset, const uint8_t vertex_count, Vector2f *&next_storage_point, Vector2l *&next_storage_point_lla)
 {
     for (uint8_t i=0; i<vertex_count; i++) {
         // read from storage to lat/lon
-        if (!read_latlon_from_storage(read_offset, *next_storage_point_lla)) {
+        if (!read_latlon_from_storage(read_offset, next_storage_point_lla[i])) {
             return false;
         }
-        // convert lat/lon to position in cm from origin
-        if (!scale_latlon_from_origin(origin, *next_storage_point_lla, *next_storage_point)) {
-            return false;
-        }
-        
-        next_storage_point_lla++;
-        next_storage_point++;
     }
+
+    // convert lat/lon to position in cm from origin
+    origin.get_distance_NE(next_storage_point_lla, next_storage_point, vertex_count);
+    for (uint8_t i=0; i<vertex_count; i++) {
+        next_storage_point[i] *= 100.0f;
+    }
+
+    next_storage_point_lla += vertex_count;
+    next_storage_point += vertex_count;
     return true;
 }
 
@@ -613,11 +612,13 @@ bool AC_PolyFence_loader::load_from_eeprom()
         return _load_time_ms != 0;
     }
 
-    Location ekf_origin{};
-    if (!AP::ahrs().get_origin(ekf_origin)) {
+    Location ekf_origin_loc{};
+    if (!AP::ahrs().get_origin(ekf_origin_loc)) {
 //        Debug("fence load requires origin");
         return false;
     }
+    // all fence points are converted relative to the origin
+    const LocationReference ekf_origin{ekf_origin_loc};
 
     // find indexes of each fence:
     if (!get_loaded_fence_semaphore().take_nonblocking()) {
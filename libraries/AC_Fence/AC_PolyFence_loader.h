@@ -37,6 +37,7 @@ public:
 
 #include <AP_Common/AP_Common.h>
 #include <AP_Common/Location.h>
+#include <AP_Common/LocationReference.h>
 #include <GCS_MAVLink/GCS_MAVLink.h>
 
 class AC_PolyFence_loader
@@ -341,7 +342,7 @@ private:
     // scale_latlon_from_origin - given a latitude/longitude
     // transforms the point to an offset-from-origin and deposits
     // the result into pos_cm.
-    bool scale_latlon_from_origin(const Location &origin,
+    bool scale_latlon_from_origin(const LocationReference &origin,
                                   const Vector2l &point,
                                   Vector2f &pos_cm) WARN_IF_UNUSED;
    
@@ -349,7 +350,7 @@ private:
     // latitude/longitude points from offset in permanent storage,
     // transforms them into an offset-from-origin and deposits the
     // results into next_storage_point.
-    bool read_polygon_from_storage(const Location &origin,
+    bool read_polygon_from_storage(const LocationReference &origin,
                                    uint16_t &read_offset,
                                    const uint8_t vertex_count,
                                    Vector2f *&next_storage_point,
@@ -151,6 +151,17 @@ public:
         return -1;
     }
 
+    // return first bit set in both this and other, or -1 if none
+    int16_t first_set_in(const Bitmask &other) const {
+        for (uint16_t i=0; i<NUMWORDS; i++) {
+            const uint32_t both = bits[i] & other.bits[i];
+            if (both != 0) {
+                return i*32 + __builtin_ffs(both) - 1;
+            }
+        }
+        return -1;
+    }
+
     // return number of bits available
     uint16_t size() const {
         return NUMBITS;
@@ -0,0 +1,95 @@
+/*
+ * LocationReference.cpp
+ */
+
+#include "LocationReference.h"
+
+#ifndef HAL_BOOTLOADER_BUILD
+
+// conversion from 1e-7 degrees to radians
+#define LATLON_TO_RAD (1.0e-7 * DEG_TO_RAD)
+
+// largest latitude difference for the Taylor series, about 127km
+#define TAYLOR_MAX_RAD 0.02
+
+void LocationReference::set(int32_t lat, int32_t lng)
+{
+    ref_lat = lat;
+    ref_lng = lng;
+    const ftype lat_rad = lat * LATLON_TO_RAD;
+    ref_cos_lat = cosF(lat_rad);
+    ref_sin_lat = sinF(lat_rad);
+
+    /*
+      the largest term left out of the series is sin(lat)*h^3/6 for a
+      latitude difference of h radians. Limit h so that is below 2e-7
+      of the scale, which is the case for the whole of TAYLOR_MAX_RAD
+      unless the reference is close to a pole
+     */
+    float max_h = TAYLOR_MAX_RAD;
+    const float abs_sin = fabsf(float(ref_sin_lat));
+    const float cos_lat = ref_cos_lat;
+    if (abs_sin * max_h * max_h * max_h > 1.2e-6f * cos_lat) {
+        max_h = cbrtf(1.2e-6f * cos_lat / abs_sin);
+    }
+    taylor_max_diff = max_h / LATLON_TO_RAD;
+}
+
+ftype LocationReference::longitude_scale(int32_t lat) const
+{
+    const int32_t lat_diff = lat - ref_lat;
+    if (abs(lat_diff) > taylor_max_diff) {
+        return Location::longitude_scale(lat);
+    }
+    const ftype h = lat_diff * LATLON_TO_RAD;
+    const ftype scale = ref_cos_lat * (1 - 0.5 * h * h) - ref_sin_lat * h;
+    return MAX(scale, ftype(0.01));
+}
+
+Vector2f LocationReference::get_distance_NE(int32_t lat, int32_t lng) const
+{
+    return Vector2f((lat - ref_lat) * float(LATLON_TO_M),
+                    Location::diff_longitude(lng, ref_lng) * float(LATLON_TO_M) * longitude_scale((lat+ref_lat)/2));
+}
+
+void LocationReference::get_distance_NE(const Location *locs, Vector2f *ne, uint16_t count) const
+{
+    for (uint16_t i=0; i<count; i++) {
+        ne[i] = get_distance_NE(locs[i].lat, locs[i].lng);
+    }
+}
+
+void LocationReference::get_distance_NE(const Vector2l *latlng, Vector2f *ne, uint16_t count) const
+{
+    for (uint16_t i=0; i<count; i++) {
+        ne[i] = get_distance_NE(latlng[i].x, latlng[i].y);
+    }
+}
+
+ftype LocationReference::get_distance(const Location &loc) const
+{
+    const ftype dlat = (ftype)(loc.lat - ref_lat);
+    const ftype dlng = ((ftype)Location::diff_longitude(loc.lng, ref_lng)) * longitude_scale((ref_lat+loc.lat)/2);
+    return norm(dlat, dlng) * LATLON_TO_M;
+}
+
+ftype LocationReference::get_bearing(const Location &loc) const
+{
+    const float north = loc.lat - ref_lat;
+    const float east = Location::diff_longitude(loc.lng, ref_lng) * longitude_scale((ref_lat+loc.lat)/2);
+    ftype bearing = fast_atan2f(east, north);
+    if (bearing < 0) {
+        bearing += 2*M_PI;
+    }
+    return bearing;
+}
+
+void LocationReference::offset(Location &loc, ftype ofs_north, ftype ofs_east) const
+{
+    const int32_t dlat = ofs_north * float(LATLON_TO_M_INV);
+    const int64_t dlng = (ofs_east * float(LATLON_TO_M_INV)) / longitude_scale(loc.lat+dlat/2);
+    loc.lat = Location::limit_lattitude(loc.lat + dlat);
+    loc.lng = Location::wrap_longitude(dlng + loc.lng);
+}
+
+#endif // HAL_BOOTLOADER_BUILD
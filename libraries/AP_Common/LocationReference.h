@@ -0,0 +1,68 @@
+#pragma once
+
+#include "Location.h"
+
+/*
+  a reference point for converting nearby Locations to and from
+  North/East offsets in meters.
+
+  Location works out the longitude scale with a cosine for every
+  call. LocationReference takes the cosine and sine of its own latitude
+  once, in set(), and finds the scale at nearby latitudes with a
+  second order Taylor series about the reference. The series is used
+  while its relative error is below 2e-7, so the results match
+  Location to float precision. That is up to about 60km North or South
+  of the reference at mid latitudes, and less close to the poles.
+  Further away it falls back to Location::longitude_scale()
+
+  Use it where many Locations are compared against the same point in
+  one update, for example the vertices of a fence or a list of ADSB
+  vehicles against the vehicle position
+ */
+class LocationReference {
+public:
+    LocationReference() {}
+    LocationReference(const Location &loc) { set(loc); }
+
+    // set the reference point
+    void set(const Location &loc) { set(loc.lat, loc.lng); }
+    void set(int32_t lat, int32_t lng);
+
+    int32_t lat() const { return ref_lat; }
+    int32_t lng() const { return ref_lng; }
+
+    // scale for the longitude at latitude lat, as Location::longitude_scale()
+    ftype longitude_scale(int32_t lat) const;
+
+    // distance in meters North/East from the reference to a point, as
+    // Location::get_distance_NE()
+    Vector2f get_distance_NE(int32_t lat, int32_t lng) const;
+    Vector2f get_distance_NE(const Location &loc) const { return get_distance_NE(loc.lat, loc.lng); }
+
+    // convert count points to distances in meters North/East from the
+    // reference. The points can be Locations or lat/lng pairs in 1e-7
+    // degrees
+    void get_distance_NE(const Location *locs, Vector2f *ne, uint16_t count) const;
+    void get_distance_NE(const Vector2l *latlng, Vector2f *ne, uint16_t count) const;
+
+    // horizontal distance in meters from the reference to loc, as
+    // Location::get_distance()
+    ftype get_distance(const Location &loc) const;
+
+    // bearing in radians from the reference to loc, 0 to 2*Pi, as
+    // Location::get_bearing(). Uses fast_atan2f() so is within 3e-6
+    // radians of atan2() of the same north and east offsets
+    ftype get_bearing(const Location &loc) const;
+
+    // move loc ofs_north and ofs_east meters, as Location::offset(). loc
+    // should be near the reference for the offset to be fast
+    void offset(Location &loc, ftype ofs_north, ftype ofs_east) const;
+
+private:
+    int32_t ref_lat = 0;
+    int32_t ref_lng = 0;
+    ftype ref_cos_lat = 1;
+    ftype ref_sin_lat = 0;
+    // largest latitude difference in 1e-7 degrees for the Taylor series
+    int32_t taylor_max_diff = 0;
+};
@@ -144,5 +144,27 @@ TEST(Bitmask, Assignment63) { bitmask_assignment<63>(); }
 TEST(Bitmask, Assignment64) { bitmask_assignment<64>(); }
 TEST(Bitmask, Assignment65) { bitmask_assignment<65>(); }
 
+template<int N>
+void bitmask_first_set_in(void)
+{
+    Bitmask<N> x, y;
+    EXPECT_EQ(-1, x.first_set_in(y));
+    x.set(1);
+    x.set(N-1);
+    EXPECT_EQ(-1, x.first_set_in(y));
+    y.set(0);
+    y.set(N-1);
+    EXPECT_EQ(N-1, x.first_set_in(y));
+    EXPECT_EQ(N-1, y.first_set_in(x));
+    y.set(1);
+    EXPECT_EQ(1, x.first_set_in(y));
+    x.clear(1);
+    EXPECT_EQ(N-1, x.first_set_in(y));
+}
+
+TEST(Bitmask, FirstSetIn31) { bitmask_first_set_in<31>(); }
+TEST(Bitmask, FirstSetIn33) { bitmask_first_set_in<33>(); }
+TEST(Bitmask, FirstSetIn65) { bitmask_first_set_in<65>(); }
+
 AP_GTEST_PANIC()
 AP_GTEST_MAIN()
@@ -0,0 +1,112 @@
+#include <AP_gtest.h>
+#include <AP_Common/LocationReference.h>
+#include <AP_Math/AP_Math.h>
+#include <GCS_MAVLink/GCS_Dummy.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+const struct AP_Param::GroupInfo        GCS_MAVLINK_Parameters::var_info[] = {
+    AP_GROUPEND
+};
+GCS_Dummy _gcs;
+
+static const double ref_lats[] { -80, -45, -10, 0, 35.36, 60, 85 };
+static const double ref_lngs[] { -179.99, 0, 149.165 };
+static const float offsets[] { -300000, -50000, -1000, -10, 0, 10, 1000, 50000, 300000 };
+
+/*
+  exact North/East offset in meters of loc from ref on the WGS84
+  ellipsoid, using the double precision ECEF conversion
+ */
+static Vector2d exact_NE(const Location &ref, const Location &loc)
+{
+    Vector3d ecef_ref, ecef_loc;
+    const double lat = radians(ref.lat * 1.0e-7);
+    const double lng = radians(ref.lng * 1.0e-7);
+    wgsllh2ecef(Vector3d(lat, lng, 0), ecef_ref);
+    wgsllh2ecef(Vector3d(radians(loc.lat * 1.0e-7), radians(loc.lng * 1.0e-7), 0), ecef_loc);
+    const Vector3d d = ecef_loc - ecef_ref;
+    return Vector2d(-sin(lat)*cos(lng)*d.x - sin(lat)*sin(lng)*d.y + cos(lat)*d.z,
+                    -sin(lng)*d.x + cos(lng)*d.y);
+}
+
+TEST(LocationReferenceTest, DistanceNE)
+{
+    for (const double ref_lat : ref_lats) {
+        for (const double ref_lng : ref_lngs) {
+            Location ref;
+            ref.lat = ref_lat * 1.0e7;
+            ref.lng = ref_lng * 1.0e7;
+            const LocationReference reference{ref};
+            for (const float north : offsets) {
+                for (const float east : offsets) {
+                    Location loc = ref;
+                    loc.offset(north, east);
+
+                    // same as Location to float precision
+                    const Vector2f ne = reference.get_distance_NE(loc);
+                    const Vector2f loc_ne = ref.get_distance_NE(loc);
+                    const float tolerance = 0.001 + 1.0e-6 * loc_ne.length();
+                    EXPECT_NEAR(ne.x, loc_ne.x, tolerance);
+                    EXPECT_NEAR(ne.y, loc_ne.y, tolerance);
+                    EXPECT_NEAR(reference.get_distance(loc), ref.get_distance(loc), tolerance);
+
+                    // and no further from the exact ellipsoid offset
+                    // than Location is
+                    const Vector2d exact = exact_NE(ref, loc);
+                    const double err = (Vector2d(ne.x, ne.y) - exact).length();
+                    const double loc_err = (Vector2d(loc_ne.x, loc_ne.y) - exact).length();
+                    EXPECT_LE(err, loc_err + tolerance);
+
+                    if (ne.length() > 1) {
+                        EXPECT_NEAR(reference.get_bearing(loc), wrap_2PI(atan2(ne.y, ne.x)), 1.0e-5);
+                    }
+
+                    // offset from a point near the reference
+                    Location moved = ref;
+                    reference.offset(moved, north, east);
+                    EXPECT_NEAR(moved.get_distance(loc), 0, tolerance);
+                }
+            }
+        }
+    }
+}
+
+TEST(LocationReferenceTest, Batch)
+{
+    Location ref;
+    ref.lat = -353632610;
+    ref.lng = 1491652300;
+    const LocationReference reference{ref};
+
+    Location locs[8];
+    Vector2l latlng[8];
+    for (uint8_t i=0; i<ARRAY_SIZE(locs); i++) {
+        locs[i] = ref;
+        locs[i].offset(100.0f * i, -250.0f * i);
+        latlng[i] = Vector2l(locs[i].lat, locs[i].lng);
+    }
+    Vector2f ne[8], ne_latlng[8];
+    reference.get_distance_NE(locs, ne, ARRAY_SIZE(locs));
+    reference.get_distance_NE(latlng, ne_latlng, ARRAY_SIZE(latlng));
+    for (uint8_t i=0; i<ARRAY_SIZE(locs); i++) {
+        EXPECT_TRUE(ne[i] == reference.get_distance_NE(locs[i]));
+        EXPECT_TRUE(ne_latlng[i] == ne[i]);
+        EXPECT_NEAR(ne[i].x, 100.0f * i, 0.01);
+        EXPECT_NEAR(ne[i].y, -250.0f * i, 0.01);
+    }
+}
+
+TEST(LocationReferenceTest, FastAtan2)
+{
+    for (uint16_t i=0; i<3600; i++) {
+        const float angle = radians(i * 0.1f - 179.95f);
+        const float r = 0.5f + (i % 7);
+        const float y = r * sinf(angle);
+        const float x = r * cosf(angle);
+        EXPECT_NEAR(fast_atan2f(y, x), atan2(double(y), double(x)), 3.0e-6);
+    }
+    EXPECT_EQ(fast_atan2f(0, 0), 0);
+}
+
+AP_GTEST_MAIN()
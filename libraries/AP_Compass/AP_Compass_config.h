@@ -22,9 +22,24 @@
 #define AP_COMPASS_CALIBRATION_FIXED_YAW_ENABLED AP_COMPASS_ENABLED && AP_GPS_ENABLED && AP_AHRS_ENABLED
 #endif
 
+// set by boards whose compass probe list reaches a compass through an
+// IMU's auxiliary bus. Those probes detect the IMUs, so they must run
+// on the main thread
+#ifndef HAL_MAG_PROBE_USES_INS
+#define HAL_MAG_PROBE_USES_INS 0
+#endif
+
 #define COMPASS_MAX_SCALE_FACTOR 1.5
 #define COMPASS_MIN_SCALE_FACTOR (1.0/COMPASS_MAX_SCALE_FACTOR)
 
+// number of sphere or ellipsoid fit iterations run per calibrator
+// update. Boards with CPU to spare can raise this, and
+// COMPASS_CAL_NUM_SAMPLES, to finish calibration sooner or fit more
+// samples
+#ifndef COMPASS_CAL_FIT_STEPS_PER_UPDATE
+#define COMPASS_CAL_FIT_STEPS_PER_UPDATE 1
+#endif
+
 // Backend support
 #ifndef AP_COMPASS_BACKEND_DEFAULT_ENABLED
 #define AP_COMPASS_BACKEND_DEFAULT_ENABLED AP_COMPASS_ENABLED
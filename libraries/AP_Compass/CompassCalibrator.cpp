@@ -197,11 +197,17 @@ void CompassCalibrator::update()
         update_cal_report();
     }
 
-    // collect the minimum number of samples
-    if (!_fitting()) {
-        return;
+    for (uint8_t i = 0; i < COMPASS_CAL_FIT_STEPS_PER_UPDATE; i++) {
+        // collect the minimum number of samples
+        if (!_fitting()) {
+            return;
+        }
+        run_fit_step();
     }
+}
 
+void CompassCalibrator::run_fit_step()
+{
     if (_status == Status::RUNNING_STEP_ONE) {
         if (_fit_step >= 10) {
             if (is_equal(_fitness, _initial_fitness) || isnan(_fitness)) {  // if true, means that fitness is diverging instead of converging
@@ -569,27 +575,21 @@ bool CompassCalibrator::accept_sample(const CompassSample& sample, uint16_t skip
     return accept_sample(sample.get(), skip_index);
 }
 
-float CompassCalibrator::calc_residual(const Vector3f& sample, const param_t& params) const
-{
-    Matrix3f softiron(
-        params.diag.x    , params.offdiag.x , params.offdiag.y,
-        params.offdiag.x , params.diag.y    , params.offdiag.z,
-        params.offdiag.y , params.offdiag.z , params.diag.z
-    );
-    return params.radius - (softiron*(sample+params.offset)).length();
-}
-
 // calc the fitness given a set of parameters (offsets, diagonals, off diagonals)
 float CompassCalibrator::calc_mean_squared_residuals(const param_t& params) const
 {
     if (_sample_buffer == nullptr || _samples_collected == 0) {
         return 1.0e30f;
     }
+    const Matrix3f softiron(
+        params.diag.x    , params.offdiag.x , params.offdiag.y,
+        params.offdiag.x , params.diag.y    , params.offdiag.z,
+        params.offdiag.y , params.offdiag.z , params.diag.z
+    );
     float sum = 0.0f;
     for (uint16_t i=0; i < _samples_collected; i++) {
-        Vector3f sample = _sample_buffer[i].get();
-        float resid = calc_residual(sample, params);
-        sum += sq(resid);
+        const Vector3f sample = _sample_buffer[i].get();
+        sum += sq(params.radius - (softiron*(sample+params.offset)).length());
     }
     sum /= _samples_collected;
     return sum;
@@ -606,28 +606,96 @@ void CompassCalibrator::calc_initial_offset()
     _params.offset /= _samples_collected;
 }
 
-void CompassCalibrator::calc_sphere_jacob(const Vector3f& sample, const param_t& params, float* ret) const
+/*
+  accumulate the normal equations, JTJ and JTFI, of the sphere fit
+  (num_params == COMPASS_CAL_NUM_SPHERE_PARAMS) or the ellipsoid fit
+  (num_params == COMPASS_CAL_NUM_ELLIPSOID_PARAMS) over all samples.
+
+  Samples are processed COMPASS_CAL_FIT_BLOCK_SIZE at a time, with each
+  per-sample term and each column of the jacobian held in its own
+  array so that every loop over a block can be vectorised. The
+  residual is calculated once per sample and only the upper triangle
+  of the symmetric JTJ is summed
+ */
+void CompassCalibrator::calc_normal_equations(const param_t& params, uint8_t num_params, float* JTJ, float* JTFI) const
 {
     const Vector3f &offset = params.offset;
     const Vector3f &diag = params.diag;
     const Vector3f &offdiag = params.offdiag;
-    Matrix3f softiron(
-        diag.x    , offdiag.x , offdiag.y,
-        offdiag.x , diag.y    , offdiag.z,
-        offdiag.y , offdiag.z , diag.z
-    );
+    const bool ellipsoid = (num_params == COMPASS_CAL_NUM_ELLIPSOID_PARAMS);
+    // the sphere fit has the radius before the offsets
+    const uint8_t ofs_idx = ellipsoid ? 0 : 1;
+
+    float x[COMPASS_CAL_FIT_BLOCK_SIZE];
+    float y[COMPASS_CAL_FIT_BLOCK_SIZE];
+    float z[COMPASS_CAL_FIT_BLOCK_SIZE];
+    float resid[COMPASS_CAL_FIT_BLOCK_SIZE];
+    float jacob[COMPASS_CAL_NUM_ELLIPSOID_PARAMS][COMPASS_CAL_FIT_BLOCK_SIZE];
+
+    memset(JTJ, 0, sizeof(float)*num_params*num_params);
+    memset(JTFI, 0, sizeof(float)*num_params);
+
+    for (uint16_t start = 0; start < _samples_collected; start += COMPASS_CAL_FIT_BLOCK_SIZE) {
+        const uint8_t n = MIN(COMPASS_CAL_FIT_BLOCK_SIZE, _samples_collected - start);
+
+        for (uint8_t k = 0; k < n; k++) {
+            const Vector3f sample = _sample_buffer[start+k].get();
+            x[k] = sample.x + offset.x;
+            y[k] = sample.y + offset.y;
+            z[k] = sample.z + offset.z;
+        }
+
+        for (uint8_t k = 0; k < n; k++) {
+            // softiron * (sample + offset)
+            const float A = (diag.x    * x[k]) + (offdiag.x * y[k]) + (offdiag.y * z[k]);
+            const float B = (offdiag.x * x[k]) + (diag.y    * y[k]) + (offdiag.z * z[k]);
+            const float C = (offdiag.y * x[k]) + (offdiag.z * y[k]) + (diag.z    * z[k]);
+            const float length = sqrtf(A*A + B*B + C*C);
+            const float inv_length = 1.0f / length;
 
-    float A =  (diag.x    * (sample.x + offset.x)) + (offdiag.x * (sample.y + offset.y)) + (offdiag.y * (sample.z + offset.z));
-    float B =  (offdiag.x * (sample.x + offset.x)) + (diag.y    * (sample.y + offset.y)) + (offdiag.z * (sample.z + offset.z));
-    float C =  (offdiag.y * (sample.x + offset.x)) + (offdiag.z * (sample.y + offset.y)) + (diag.z    * (sample.z + offset.z));
-    float length = (softiron*(sample+offset)).length();
-
-    // 0: partial derivative (radius wrt fitness fn) fn operated on sample
-    ret[0] = 1.0f;
-    // 1-3: partial derivative (offsets wrt fitness fn) fn operated on sample
-    ret[1] = -1.0f * (((diag.x    * A) + (offdiag.x * B) + (offdiag.y * C))/length);
-    ret[2] = -1.0f * (((offdiag.x * A) + (diag.y    * B) + (offdiag.z * C))/length);
-    ret[3] = -1.0f * (((offdiag.y * A) + (offdiag.z * B) + (diag.z    * C))/length);
+            resid[k] = params.radius - length;
+
+            // partial derivatives of the residual wrt the radius and offsets
+            if (!ellipsoid) {
+                jacob[0][k] = 1.0f;
+            }
+            jacob[ofs_idx+0][k] = -1.0f * ((diag.x    * A) + (offdiag.x * B) + (offdiag.y * C)) * inv_length;
+            jacob[ofs_idx+1][k] = -1.0f * ((offdiag.x * A) + (diag.y    * B) + (offdiag.z * C)) * inv_length;
+            jacob[ofs_idx+2][k] = -1.0f * ((offdiag.y * A) + (offdiag.z * B) + (diag.z    * C)) * inv_length;
+            if (ellipsoid) {
+                // diagonals
+                jacob[3][k] = -1.0f * (x[k] * A) * inv_length;
+                jacob[4][k] = -1.0f * (y[k] * B) * inv_length;
+                jacob[5][k] = -1.0f * (z[k] * C) * inv_length;
+                // off-diagonals
+                jacob[6][k] = -1.0f * ((y[k] * A) + (x[k] * B)) * inv_length;
+                jacob[7][k] = -1.0f * ((z[k] * A) + (x[k] * C)) * inv_length;
+                jacob[8][k] = -1.0f * ((z[k] * B) + (y[k] * C)) * inv_length;
+            }
+        }
+
+        for (uint8_t i = 0; i < num_params; i++) {
+            for (uint8_t j = i; j < num_params; j++) {
+                float sum = 0.0f;
+                for (uint8_t k = 0; k < n; k++) {
+                    sum += jacob[i][k] * jacob[j][k];
+                }
+                JTJ[i*num_params+j] += sum;
+            }
+            float sum = 0.0f;
+            for (uint8_t k = 0; k < n; k++) {
+                sum += jacob[i][k] * resid[k];
+            }
+            JTFI[i] += sum;
+        }
+    }
+
+    // fill in the lower triangle
+    for (uint8_t i = 1; i < num_params; i++) {
+        for (uint8_t j = 0; j < i; j++) {
+            JTJ[i*num_params+j] = JTJ[j*num_params+i];
+        }
+    }
 }
 
 // run sphere fit to calculate diagonals and offdiagonals
@@ -645,28 +713,13 @@ void CompassCalibrator::run_sphere_fit()
     param_t fit1_params, fit2_params;
     fit1_params = fit2_params = _params;
 
-    float JTJ[COMPASS_CAL_NUM_SPHERE_PARAMS*COMPASS_CAL_NUM_SPHERE_PARAMS] = { };
-    float JTJ2[COMPASS_CAL_NUM_SPHERE_PARAMS*COMPASS_CAL_NUM_SPHERE_PARAMS] = { };
-    float JTFI[COMPASS_CAL_NUM_SPHERE_PARAMS] = { };
+    float JTJ[COMPASS_CAL_NUM_SPHERE_PARAMS*COMPASS_CAL_NUM_SPHERE_PARAMS];
+    float JTJ2[COMPASS_CAL_NUM_SPHERE_PARAMS*COMPASS_CAL_NUM_SPHERE_PARAMS];
+    float JTFI[COMPASS_CAL_NUM_SPHERE_PARAMS];
 
     // Gauss Newton Part common for all kind of extensions including LM
-    for (uint16_t k = 0; k<_samples_collected; k++) {
-        Vector3f sample = _sample_buffer[k].get();
-
-        float sphere_jacob[COMPASS_CAL_NUM_SPHERE_PARAMS];
-
-        calc_sphere_jacob(sample, fit1_params, sphere_jacob);
-
-        for (uint8_t i = 0;i < COMPASS_CAL_NUM_SPHERE_PARAMS; i++) {
-            // compute JTJ
-            for (uint8_t j = 0; j < COMPASS_CAL_NUM_SPHERE_PARAMS; j++) {
-                JTJ[i*COMPASS_CAL_NUM_SPHERE_PARAMS+j] += sphere_jacob[i] * sphere_jacob[j];
-                JTJ2[i*COMPASS_CAL_NUM_SPHERE_PARAMS+j] += sphere_jacob[i] * sphere_jacob[j];   //a backup JTJ for LM
-            }
-            // compute JTFI
-            JTFI[i] += sphere_jacob[i] * calc_residual(sample, fit1_params);
-        }
-    }
+    calc_normal_equations(fit1_params, COMPASS_CAL_NUM_SPHERE_PARAMS, JTJ, JTFI);
+    memcpy(JTJ2, JTJ, sizeof(JTJ2));    // a backup JTJ for LM
 
     //------------------------Levenberg-Marquardt-part-starts-here---------------------------------//
     // refer: http://en.wikipedia.org/wiki/Levenberg%E2%80%93Marquardt_algorithm#Choice_of_damping_parameter
@@ -717,36 +770,6 @@ void CompassCalibrator::run_sphere_fit()
     }
 }
 
-void CompassCalibrator::calc_ellipsoid_jacob(const Vector3f& sample, const param_t& params, float* ret) const
-{
-    const Vector3f &offset = params.offset;
-    const Vector3f &diag = params.diag;
-    const Vector3f &offdiag = params.offdiag;
-    Matrix3f softiron(
-        diag.x    , offdiag.x , offdiag.y,
-        offdiag.x , diag.y    , offdiag.z,
-        offdiag.y , offdiag.z , diag.z
-    );
-
-    float A =  (diag.x    * (sample.x + offset.x)) + (offdiag.x * (sample.y + offset.y)) + (offdiag.y * (sample.z + offset.z));
-    float B =  (offdiag.x * (sample.x + offset.x)) + (diag.y    * (sample.y + offset.y)) + (offdiag.z * (sample.z + offset.z));
-    float C =  (offdiag.y * (sample.x + offset.x)) + (offdiag.z * (sample.y + offset.y)) + (diag.z    * (sample.z + offset.z));
-    float length = (softiron*(sample+offset)).length();
-
-    // 0-2: partial derivative (offset wrt fitness fn) fn operated on sample
-    ret[0] = -1.0f * (((diag.x    * A) + (offdiag.x * B) + (offdiag.y * C))/length);
-    ret[1] = -1.0f * (((offdiag.x * A) + (diag.y    * B) + (offdiag.z * C))/length);
-    ret[2] = -1.0f * (((offdiag.y * A) + (offdiag.z * B) + (diag.z    * C))/length);
-    // 3-5: partial derivative (diag offset wrt fitness fn) fn operated on sample
-    ret[3] = -1.0f * ((sample.x + offset.x) * A)/length;
-    ret[4] = -1.0f * ((sample.y + offset.y) * B)/length;
-    ret[5] = -1.0f * ((sample.z + offset.z) * C)/length;
-    // 6-8: partial derivative (off-diag offset wrt fitness fn) fn operated on sample
-    ret[6] = -1.0f * (((sample.y + offset.y) * A) + ((sample.x + offset.x) * B))/length;
-    ret[7] = -1.0f * (((sample.z + offset.z) * A) + ((sample.x + offset.x) * C))/length;
-    ret[8] = -1.0f * (((sample.z + offset.z) * B) + ((sample.y + offset.y) * C))/length;
-}
-
 void CompassCalibrator::run_ellipsoid_fit()
 {
     if (_sample_buffer == nullptr) {
@@ -761,28 +784,13 @@ void CompassCalibrator::run_ellipsoid_fit()
     param_t fit1_params, fit2_params;
     fit1_params = fit2_params = _params;
 
-    float JTJ[COMPASS_CAL_NUM_ELLIPSOID_PARAMS*COMPASS_CAL_NUM_ELLIPSOID_PARAMS] = { };
-    float JTJ2[COMPASS_CAL_NUM_ELLIPSOID_PARAMS*COMPASS_CAL_NUM_ELLIPSOID_PARAMS] = { };
-    float JTFI[COMPASS_CAL_NUM_ELLIPSOID_PARAMS] = { };
+    float JTJ[COMPASS_CAL_NUM_ELLIPSOID_PARAMS*COMPASS_CAL_NUM_ELLIPSOID_PARAMS];
+    float JTJ2[COMPASS_CAL_NUM_ELLIPSOID_PARAMS*COMPASS_CAL_NUM_ELLIPSOID_PARAMS];
+    float JTFI[COMPASS_CAL_NUM_ELLIPSOID_PARAMS];
 
     // Gauss Newton Part common for all kind of extensions including LM
-    for (uint16_t k = 0; k<_samples_collected; k++) {
-        Vector3f sample = _sample_buffer[k].get();
-
-        float ellipsoid_jacob[COMPASS_CAL_NUM_ELLIPSOID_PARAMS];
-
-        calc_ellipsoid_jacob(sample, fit1_params, ellipsoid_jacob);
-
-        for (uint8_t i = 0;i < COMPASS_CAL_NUM_ELLIPSOID_PARAMS; i++) {
-            // compute JTJ
-            for (uint8_t j = 0; j < COMPASS_CAL_NUM_ELLIPSOID_PARAMS; j++) {
-                JTJ [i*COMPASS_CAL_NUM_ELLIPSOID_PARAMS+j] += ellipsoid_jacob[i] * ellipsoid_jacob[j];
-                JTJ2[i*COMPASS_CAL_NUM_ELLIPSOID_PARAMS+j] += ellipsoid_jacob[i] * ellipsoid_jacob[j];
-            }
-            // compute JTFI
-            JTFI[i] += ellipsoid_jacob[i] * calc_residual(sample, fit1_params);
-        }
-    }
+    calc_normal_equations(fit1_params, COMPASS_CAL_NUM_ELLIPSOID_PARAMS, JTJ, JTFI);
+    memcpy(JTJ2, JTJ, sizeof(JTJ2));    // a backup JTJ for LM
 
     //------------------------Levenberg-Marquardt-part-starts-here---------------------------------//
     //refer: http://en.wikipedia.org/wiki/Levenberg%E2%80%93Marquardt_algorithm#Choice_of_damping_parameter
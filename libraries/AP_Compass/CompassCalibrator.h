@@ -8,9 +8,15 @@
 
 #define COMPASS_CAL_NUM_SPHERE_PARAMS       4
 #define COMPASS_CAL_NUM_ELLIPSOID_PARAMS    9
+#ifndef COMPASS_CAL_NUM_SAMPLES
 #define COMPASS_CAL_NUM_SAMPLES             300     // number of samples required before fitting begins
+#endif
+#define COMPASS_CAL_FIT_BLOCK_SIZE          8       // samples processed at a time when fitting
 
 class CompassCalibrator {
+    // fits samples directly for the fitting benchmark
+    friend class CompassCalibratorBench;
+
 public:
     CompassCalibrator();
 
@@ -171,9 +177,6 @@ private:
     // thins out samples between step one and step two
     void thin_samples();
 
-    // calc the fitness of a single sample vs a set of parameters (offsets, diagonals, off diagonals)
-    float calc_residual(const Vector3f& sample, const param_t& params) const;
-
     // calc the fitness of the parameters (offsets, diagonals, off diagonals) vs all the samples collected
     // returns 1.0e30f if the sample buffer is empty
     float calc_mean_squared_residuals(const param_t& params) const;
@@ -181,14 +184,18 @@ private:
     // calculate initial offsets by simply taking the average values of the samples
     void calc_initial_offset();
 
+    // accumulate the normal equations for the sphere or ellipsoid fit
+    void calc_normal_equations(const param_t& params, uint8_t num_params, float* JTJ, float* JTFI) const;
+
     // run sphere fit to calculate diagonals and offdiagonals
-    void calc_sphere_jacob(const Vector3f& sample, const param_t& params, float* ret) const;
     void run_sphere_fit();
 
     // run ellipsoid fit to calculate diagonals and offdiagonals
-    void calc_ellipsoid_jacob(const Vector3f& sample, const param_t& params, float* ret) const;
     void run_ellipsoid_fit();
 
+    // run the next step of the fit
+    void run_fit_step();
+
     // update the completion mask based on a single sample
     void update_completion_mask(const Vector3f& sample);
 
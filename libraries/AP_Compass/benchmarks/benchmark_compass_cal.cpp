@@ -0,0 +1,108 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_Compass/CompassCalibrator.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+/*
+  cost of the compass calibration sphere and ellipsoid fits. No
+  recorded calibration logs are kept in the tree, so the samples are
+  generated on a rotated, offset ellipsoid with some noise, much like
+  a board with soft iron distortion rotated through all orientations
+ */
+
+class CompassCalibratorBench {
+public:
+    ~CompassCalibratorBench() {
+        if (cal != nullptr) {
+            free(cal->_sample_buffer);
+            delete cal;
+        }
+    }
+
+    // load samples for fitting directly, bypassing sample collection
+    bool set_fit_samples(const Vector3f *samples, uint16_t count) {
+        if (cal == nullptr) {
+            cal = NEW_NOTHROW CompassCalibrator();
+            if (cal == nullptr) {
+                return false;
+            }
+        }
+        if (cal->_sample_buffer == nullptr) {
+            cal->_sample_buffer = (CompassCalibrator::CompassSample*)calloc(COMPASS_CAL_NUM_SAMPLES, sizeof(CompassCalibrator::CompassSample));
+            if (cal->_sample_buffer == nullptr) {
+                return false;
+            }
+        }
+        cal->reset_state();
+        cal->_samples_collected = MIN(count, COMPASS_CAL_NUM_SAMPLES);
+        for (uint16_t i = 0; i < cal->_samples_collected; i++) {
+            cal->_sample_buffer[i].set(samples[i]);
+        }
+        cal->calc_initial_offset();
+        cal->initialize_fit();
+        return true;
+    }
+
+    void run_fit(bool ellipsoid) {
+        if (ellipsoid) {
+            cal->run_ellipsoid_fit();
+        } else {
+            cal->run_sphere_fit();
+        }
+    }
+
+    float get_fitness() const {
+        return cal->_fitness;
+    }
+
+private:
+    CompassCalibrator *cal = nullptr;
+};
+
+static void make_samples(Vector3f *samples, uint16_t count)
+{
+    const Vector3f offset(120, -45, 210);
+    const Matrix3f softiron(1.08f, 0.03f, -0.02f,
+                            0.03f, 0.94f, 0.05f,
+                            -0.02f, 0.05f, 1.02f);
+    uint32_t seed = 1;
+    for (uint16_t i = 0; i < count; i++) {
+        // spread the samples evenly over the sphere
+        const float z = 1.0f - 2.0f * (i + 0.5f) / count;
+        const float r = sqrtf(1.0f - z * z);
+        const float theta = i * 2.39996323f;
+        Vector3f v(r * cosf(theta), r * sinf(theta), z);
+        v *= 450.0f;
+        seed = seed * 1103515245U + 12345U;
+        v += Vector3f(int8_t(seed >> 8), int8_t(seed >> 16), int8_t(seed >> 24)) * 0.05f;
+        samples[i] = softiron * v - offset;
+    }
+}
+
+static void BM_CompassCalFit(benchmark::State& state, bool ellipsoid)
+{
+    static Vector3f samples[COMPASS_CAL_NUM_SAMPLES];
+    make_samples(samples, ARRAY_SIZE(samples));
+
+    CompassCalibratorBench bench;
+    if (!bench.set_fit_samples(samples, ARRAY_SIZE(samples))) {
+        state.SkipWithError("allocation failed");
+        return;
+    }
+    if (ellipsoid) {
+        // start the ellipsoid fit from a converged sphere fit
+        for (uint8_t i = 0; i < 15; i++) {
+            bench.run_fit(false);
+        }
+    }
+    while (state.KeepRunning()) {
+        bench.run_fit(ellipsoid);
+    }
+    state.counters["fitness"] = bench.get_fitness();
+}
+
+BENCHMARK_CAPTURE(BM_CompassCalFit, sphere, false);
+BENCHMARK_CAPTURE(BM_CompassCalFit, ellipsoid, true);
+
+BENCHMARK_MAIN();
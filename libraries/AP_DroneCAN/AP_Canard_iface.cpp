@@ -14,6 +14,21 @@ extern const AP_HAL::HAL& hal;
 #define DEBUG_PKTS 0
 
 #define CANARD_MSG_TYPE_FROM_ID(x)                         ((uint16_t)(((x) >> 8U)  & 0xFFFFU))
+#define CANARD_IS_SERVICE_FROM_ID(x)                       ((bool)(((x) >> 7U)  & 0x1U))
+#define CANARD_PRIORITY_FROM_ID(x)                         ((uint8_t)(((x) >> 24U) & 0x1FU))
+#define CANARD_TAIL_START_OF_TRANSFER                      0x80U
+#define CANARD_TAIL_END_OF_TRANSFER                        0x40U
+
+/*
+  actuator commands, which are replaced rather than queued behind
+  stale commands of the same type
+ */
+const uint16_t CanardInterface::actuator_data_type_ids[] {
+    UAVCAN_EQUIPMENT_ESC_RAWCOMMAND_ID,
+    UAVCAN_EQUIPMENT_ACTUATOR_ARRAYCOMMAND_ID,
+    COM_HOBBYWING_ESC_RAWCOMMAND_ID,
+    COM_HIMARK_SERVO_SERVOCMD_ID,
+};
 
 DEFINE_HANDLER_LIST_HEADS();
 DEFINE_HANDLER_LIST_SEMAPHORES();
@@ -204,7 +219,7 @@ void CanardInterface::processTestRx() {
 }
 #endif
 
-void CanardInterface::processTx(bool raw_commands_only = false) {
+void CanardInterface::processTx(bool actuator_only = false) {
     WITH_SEMAPHORE(_sem_tx);
 
     for (uint8_t iface = 0; iface < num_ifaces; iface++) {
@@ -229,12 +244,16 @@ void CanardInterface::processTx(bool raw_commands_only = false) {
             */
             iface_down = false;
         } 
-        // scan through list of pending transfers
+        // scan through list of pending transfers, collecting the
+        // frames for this interface into batches
+        const uint64_t now_us = AP_HAL::micros64();
+        uint8_t count = 0;
+        uint8_t bulk_count = 0;
+        uint8_t priority_count = 0;
         while (true) {
             auto txf = &txq->frame;
-            if (raw_commands_only &&
-                CANARD_MSG_TYPE_FROM_ID(txf->id) != UAVCAN_EQUIPMENT_ESC_RAWCOMMAND_ID &&
-                CANARD_MSG_TYPE_FROM_ID(txf->id) != COM_HOBBYWING_ESC_RAWCOMMAND_ID) {
+            const TxClass tx_cls = tx_class(txf->id);
+            if (actuator_only && tx_cls != TxClass::ACTUATOR) {
                 // look at next transfer
                 txq = txq->next;
                 if (txq == nullptr) {
@@ -242,34 +261,37 @@ void CanardInterface::processTx(bool raw_commands_only = false) {
                 }
                 continue;
             }
-            AP_HAL::CANFrame txmsg {};
-            txmsg.dlc = AP_HAL::CANFrame::dataLengthToDlc(txf->data_len);
-            memcpy(txmsg.data, txf->data, txf->data_len);
-            txmsg.id = (txf->id | AP_HAL::CANFrame::FlagEFF);
-#if HAL_CANFD_SUPPORTED
-            txmsg.canfd = txf->canfd;
-#endif
-            bool write = true;
-            bool read = false;
-            ifaces[iface]->select(read, write, &txmsg, 0);
-            if (!write) {
-                // if there is no space then we need to start from the
-                // top of the queue, so wait for the next loop
-                if (!iface_down) {
-                    break;
+            if (tx_cls == TxClass::BULK && priority_count > 0 &&
+                bulk_count >= CANARD_IFACE_BULK_FRAMES_PER_TX) {
+                // the queue is in priority order, so the rest of it
+                // is bulk traffic. Leave it for the next call
+                tx_stats.bulk_deferred++;
+                break;
+            }
+            if ((txf->iface_mask & (1U<<iface)) && (now_us < txf->deadline_usec)) {
+                if (tx_cls == TxClass::BULK) {
+                    bulk_count++;
                 } else {
-                    txf->iface_mask &= ~(1U<<iface);
+                    priority_count++;
                 }
-            } else if ((txf->iface_mask & (1U<<iface)) && (AP_HAL::micros64() < txf->deadline_usec)) {
-                // try sending to interfaces, clearing the mask if we succeed
-                if (ifaces[iface]->send(txmsg, txf->deadline_usec, 0) > 0) {
-                    txf->iface_mask &= ~(1U<<iface);
-                } else {
-                    // if we fail to send then we try sending on next interface
-                    if (!iface_down) {
+                AP_HAL::CANIface::CanTxRequest &req = tx_batch[count];
+                req.frame = AP_HAL::CANFrame{};
+                req.frame.dlc = AP_HAL::CANFrame::dataLengthToDlc(txf->data_len);
+                memcpy(req.frame.data, txf->data, txf->data_len);
+                req.frame.id = (txf->id | AP_HAL::CANFrame::FlagEFF);
+#if HAL_CANFD_SUPPORTED
+                req.frame.canfd = txf->canfd;
+#endif
+                req.deadline = txf->deadline_usec;
+                req.flags = 0;
+                tx_batch_frames[count++] = txf;
+                if (count == CANARD_IFACE_BATCH_SIZE) {
+                    const bool sent_all = send_tx_batch(iface, count, iface_down);
+                    count = 0;
+                    if (!sent_all) {
+                        // if there is no space then we need to start from the
+                        // top of the queue, so wait for the next loop
                         break;
-                    } else {
-                        txf->iface_mask &= ~(1U<<iface);
                     }
                 }
             }
@@ -279,10 +301,145 @@ void CanardInterface::processTx(bool raw_commands_only = false) {
                 break;
             }
         }
+        if (count > 0) {
+            send_tx_batch(iface, count, iface_down);
+        }
     }
 
 }
 
+/*
+  send the frames collected in tx_batch to an interface, clearing the
+  interface from the mask of each frame that was sent. Frames which
+  were not sent stay queued for the interface unless it is down. Must
+  be called with _sem_tx held
+ */
+bool CanardInterface::send_tx_batch(uint8_t iface, uint8_t count, bool iface_down)
+{
+    bool write = true;
+    bool read = false;
+    ifaces[iface]->select(read, write, &tx_batch[0].frame, 0);
+    int16_t sent = 0;
+    if (write) {
+        sent = MAX(ifaces[iface]->send_batch(tx_batch, count), int16_t(0));
+    }
+    if (sent > 0) {
+        batch_stats[iface].tx_frames += sent;
+        batch_stats[iface].tx_batches++;
+    }
+    if (iface_down) {
+        // an interface that is down drops the frames it could not take
+        sent = count;
+    }
+    for (int16_t i = 0; i < sent; i++) {
+        CanardCANFrame *txf = tx_batch_frames[i];
+        txf->iface_mask &= ~(1U<<iface);
+        if (txf->iface_mask != 0 || txf->data_len == 0 ||
+            (txf->data[txf->data_len-1] & CANARD_TAIL_END_OF_TRANSFER) == 0) {
+            continue;
+        }
+        const int8_t act = actuator_index(txf->id);
+        if (act >= 0 && actuator_queued_us[act] != 0) {
+            // the last frame of an actuator transfer has been taken
+            // by all interfaces
+            const uint32_t latency_us = MIN(AP_HAL::micros64() - actuator_queued_us[act], uint64_t(UINT32_MAX));
+            tx_stats.actuator_latency_max_us = MAX(tx_stats.actuator_latency_max_us, latency_us);
+            tx_stats.actuator_latency_sum_us += latency_us;
+            tx_stats.actuator_latency_count++;
+        }
+    }
+    return sent == count;
+}
+
+CanardInterface::TxClass CanardInterface::tx_class(uint32_t can_id)
+{
+    if (actuator_index(can_id) >= 0) {
+        return TxClass::ACTUATOR;
+    }
+    if (CANARD_PRIORITY_FROM_ID(can_id) >= CANARD_TRANSFER_PRIORITY_LOW) {
+        return TxClass::BULK;
+    }
+    return TxClass::NORMAL;
+}
+
+/*
+  return the index in actuator_data_type_ids of a frame, or -1 if it is
+  not part of an actuator command
+ */
+int8_t CanardInterface::actuator_index(uint32_t can_id)
+{
+    if (CANARD_IS_SERVICE_FROM_ID(can_id)) {
+        return -1;
+    }
+    const uint16_t data_type_id = CANARD_MSG_TYPE_FROM_ID(can_id);
+    for (uint8_t i = 0; i < ARRAY_SIZE(actuator_data_type_ids); i++) {
+        if (actuator_data_type_ids[i] == data_type_id) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/*
+  drop the queued transfers of an actuator command type. Called before
+  a new set of commands of that type is broadcast, as sending stale
+  commands ahead of it would only add latency. A transfer which has
+  been partly sent is dropped along with the rest, receivers discard
+  the incomplete transfer
+ */
+void CanardInterface::replace_actuator_commands(uint16_t data_type_id)
+{
+    int8_t act = -1;
+    for (uint8_t i = 0; i < ARRAY_SIZE(actuator_data_type_ids); i++) {
+        if (actuator_data_type_ids[i] == data_type_id) {
+            act = i;
+            break;
+        }
+    }
+    if (act < 0) {
+        return;
+    }
+    WITH_SEMAPHORE(_sem_tx);
+    uint16_t depth = 0;
+    for (auto txq = canard.tx_queue; txq != nullptr; txq = txq->next) {
+        auto &txf = txq->frame;
+        if (txf.iface_mask == 0) {
+            // already sent or dropped, waiting to be cleaned up
+            continue;
+        }
+        depth++;
+        if (actuator_index(txf.id) != act) {
+            continue;
+        }
+        if (txf.data_len > 0 && (txf.data[txf.data_len-1] & CANARD_TAIL_START_OF_TRANSFER) != 0) {
+            tx_stats.actuator_replaced++;
+        }
+        // frames with no interfaces left or past their deadline are
+        // removed by canardCleanupStaleTransfers()
+        txf.iface_mask = 0;
+        txf.deadline_usec = 0;
+    }
+    tx_stats.queue_depth_max = MAX(tx_stats.queue_depth_max, depth);
+    actuator_queued_us[act] = AP_HAL::micros64();
+}
+
+/*
+  get the transmit queue statistics, resetting the counters so that
+  each call covers the time since the last
+ */
+void CanardInterface::get_tx_stats(TxStats &stats)
+{
+    WITH_SEMAPHORE(_sem_tx);
+    stats = tx_stats;
+    memset(stats.queue_depth, 0, sizeof(stats.queue_depth));
+    for (auto txq = canard.tx_queue; txq != nullptr; txq = txq->next) {
+        if (txq->frame.iface_mask != 0) {
+            stats.queue_depth[uint8_t(tx_class(txq->frame.id))]++;
+        }
+    }
+    tx_stats = {};
+}
+
 void CanardInterface::update_rx_protocol_stats(int16_t res)
 {
     switch (res) {
@@ -327,68 +484,104 @@ void CanardInterface::update_rx_protocol_stats(int16_t res)
 }
 
 void CanardInterface::processRx() {
-    AP_HAL::CANFrame rxmsg;
     for (uint8_t i=0; i<num_ifaces; i++) {
+        if (ifaces[i] == NULL) {
+            continue;
+        }
         while(true) {
-            if (ifaces[i] == NULL) {
-                break;
-            }
             bool read_select = true;
             bool write_select = false;
             ifaces[i]->select(read_select, write_select, nullptr, 0);
             if (!read_select) { // No data pending
                 break;
             }
-            CanardCANFrame rx_frame {};
 
             //palToggleLine(HAL_GPIO_PIN_LED);
-            uint64_t timestamp;
-            AP_HAL::CANIface::CanIOFlags flags;
-            if (ifaces[i]->receive(rxmsg, timestamp, flags) <= 0) {
+            const int16_t count = ifaces[i]->receive_batch(rx_batch, CANARD_IFACE_BATCH_SIZE);
+            if (count <= 0) {
                 break;
             }
 
-            if (!rxmsg.isExtended()) {
-                // 11 bit frame, see if we have a handler
-                if (aux_11bit_driver != nullptr) {
-                    aux_11bit_driver->handle_frame(rxmsg);
-                }
-                continue;
-            }
+            {
+                // feed the whole batch to libcanard with one lock
+                WITH_SEMAPHORE(_sem_rx);
 
-            rx_frame.data_len = AP_HAL::CANFrame::dlcToDataLength(rxmsg.dlc);
-            memcpy(rx_frame.data, rxmsg.data, rx_frame.data_len);
+                BatchStats &bstats = batch_stats[i];
+                bstats.rx_frames += count;
+                bstats.rx_batches++;
+
+                const uint64_t now_us = AP_HAL::micros64();
+                for (int16_t j=0; j<count; j++) {
+                    const AP_HAL::CANIface::CanRxItem &item = rx_batch[j];
+                    if (!item.frame.isExtended()) {
+                        continue;
+                    }
+                    if (now_us > item.timestamp_us) {
+                        const uint32_t latency_us = MIN(now_us - item.timestamp_us, uint64_t(UINT32_MAX));
+                        bstats.rx_latency_max_us = MAX(bstats.rx_latency_max_us, latency_us);
+                        bstats.rx_latency_sum_us += latency_us;
+                    }
+                    bstats.rx_latency_count++;
+
+                    CanardCANFrame rx_frame {};
+                    rx_frame.data_len = AP_HAL::CANFrame::dlcToDataLength(item.frame.dlc);
+                    memcpy(rx_frame.data, item.frame.data, rx_frame.data_len);
 #if HAL_CANFD_SUPPORTED
-            rx_frame.canfd = rxmsg.canfd;
+                    rx_frame.canfd = item.frame.canfd;
 #endif
-            rx_frame.id = rxmsg.id;
+                    rx_frame.id = item.frame.id;
 #if CANARD_MULTI_IFACE
-            rx_frame.iface_id = i;
+                    rx_frame.iface_id = i;
 #endif
-            {
-                WITH_SEMAPHORE(_sem_rx);
-
-                const int16_t res = canardHandleRxFrame(&canard, &rx_frame, timestamp);
-                if (res == -CANARD_ERROR_RX_MISSED_START) {
-                    // this might remaining frames from a message that we don't accept, so check
-                    uint64_t dummy_signature;
-                    if (shouldAcceptTransfer(&canard,
-                                        &dummy_signature,
-                                        extractDataType(rx_frame.id),
-                                        extractTransferType(rx_frame.id),
-                                        1)) { // doesn't matter what we pass here
-                        update_rx_protocol_stats(res);
+                    const int16_t res = canardHandleRxFrame(&canard, &rx_frame, item.timestamp_us);
+                    if (res == -CANARD_ERROR_RX_MISSED_START) {
+                        // this might remaining frames from a message that we don't accept, so check
+                        uint64_t dummy_signature;
+                        if (shouldAcceptTransfer(&canard,
+                                            &dummy_signature,
+                                            extractDataType(rx_frame.id),
+                                            extractTransferType(rx_frame.id),
+                                            1)) { // doesn't matter what we pass here
+                            update_rx_protocol_stats(res);
+                        } else {
+                            protocol_stats.rx_ignored_not_wanted++;
+                        }
                     } else {
-                        protocol_stats.rx_ignored_not_wanted++;
+                        update_rx_protocol_stats(res);
+                    }
+                }
+            }
+
+            if (aux_11bit_driver != nullptr) {
+                // 11 bit frames, handled outside of the libcanard lock
+                for (int16_t j=0; j<count; j++) {
+                    if (!rx_batch[j].frame.isExtended()) {
+                        aux_11bit_driver->handle_frame(rx_batch[j].frame);
                     }
-                } else {
-                    update_rx_protocol_stats(res);
                 }
             }
         }
     }
 }
 
+/*
+  get the batching and latency statistics for an interface. The
+  latency statistics are reset so that each call covers the time since
+  the last
+ */
+bool CanardInterface::get_batch_stats(uint8_t iface, BatchStats &stats)
+{
+    if (iface >= num_ifaces) {
+        return false;
+    }
+    WITH_SEMAPHORE(_sem_rx);
+    stats = batch_stats[iface];
+    batch_stats[iface].rx_latency_max_us = 0;
+    batch_stats[iface].rx_latency_sum_us = 0;
+    batch_stats[iface].rx_latency_count = 0;
+    return true;
+}
+
 void CanardInterface::process(uint32_t duration_ms) {
 #if AP_TEST_DRONECAN_DRIVERS
     const uint64_t deadline = AP_HAL::micros64() + duration_ms*1000;
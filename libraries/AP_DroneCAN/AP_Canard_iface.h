@@ -7,6 +7,21 @@
 class AP_DroneCAN;
 class CANSensor;
 
+// number of frames moved between libcanard and each interface per
+// send_batch() or receive_batch() call
+#ifndef CANARD_IFACE_BATCH_SIZE
+#define CANARD_IFACE_BATCH_SIZE 8
+#endif
+
+// maximum number of bulk frames handed to each interface per
+// processTx() call when higher priority frames were also pending for
+// it, so that bulk traffic cannot fill the interface queues ahead of
+// actuator commands. Bulk traffic is not limited when nothing else is
+// waiting to be sent
+#ifndef CANARD_IFACE_BULK_FRAMES_PER_TX
+#define CANARD_IFACE_BULK_FRAMES_PER_TX 4
+#endif
+
 class CanardInterface : public Canard::Interface {
     friend class AP_DroneCAN;
 public:
@@ -36,7 +51,21 @@ public:
     /// @return true if response was added to the queue
     bool respond(uint8_t destination_node_id, const Canard::Transfer &res_transfer) override;
 
-    void processTx(bool raw_commands_only);
+    /*
+      transmit classes, highest precedence first. libcanard keeps its
+      queue in CAN priority order; on top of that, queued actuator
+      transfers are replaced by newer ones of the same type, and the
+      number of bulk frames handed to an interface at a time is limited
+      while higher priority frames are queued for it
+     */
+    enum class TxClass : uint8_t {
+        ACTUATOR,   // actuator and ESC commands
+        NORMAL,
+        BULK,       // low priority traffic, e.g. parameters and GNSS data
+        NUM_CLASSES
+    };
+
+    void processTx(bool actuator_only);
     void processRx();
 
     void process(uint32_t duration);
@@ -63,6 +92,46 @@ public:
 
     void update_rx_protocol_stats(int16_t res);
 
+    // per-interface batching and receive latency statistics
+    struct BatchStats {
+        uint32_t rx_frames;
+        uint32_t rx_batches;
+        uint32_t tx_frames;
+        uint32_t tx_batches;
+        // time from frame reception by the interface to handling by
+        // libcanard, since the last call to get_batch_stats()
+        uint32_t rx_latency_max_us;
+        uint64_t rx_latency_sum_us;
+        uint32_t rx_latency_count;
+    };
+
+    // get the statistics for an interface, resetting the latency
+    // statistics. Returns false if there is no such interface
+    bool get_batch_stats(uint8_t iface, BatchStats &stats);
+
+    // transmit queue statistics
+    struct TxStats {
+        // frames in the queue of each class when the stats were fetched
+        uint16_t queue_depth[uint8_t(TxClass::NUM_CLASSES)];
+        // the following are since the last call to get_tx_stats()
+        uint16_t queue_depth_max;       // total frames queued, sampled when actuator commands are replaced
+        uint32_t actuator_replaced;     // actuator transfers replaced before being sent
+        uint32_t bulk_deferred;         // processTx() calls that held back bulk frames
+        // time from a set of actuator commands being started to the
+        // last frame of each of its transfers being taken by all
+        // interfaces
+        uint32_t actuator_latency_max_us;
+        uint64_t actuator_latency_sum_us;
+        uint32_t actuator_latency_count;
+    };
+
+    // get the transmit queue statistics, resetting the counters
+    void get_tx_stats(TxStats &stats);
+
+    // drop queued transfers of an actuator command type before a new
+    // set of commands of that type is broadcast
+    void replace_actuator_commands(uint16_t data_type_id);
+
     uint8_t get_node_id() const override { return canard.node_id; }
 private:
     CanardInstance canard;
@@ -78,6 +147,24 @@ private:
     HAL_Semaphore _sem_rx;
     CanardTxTransfer tx_transfer;
     dronecan_protocol_Stats protocol_stats;
+    BatchStats batch_stats[HAL_NUM_CAN_IFACES];
+
+    // frames being moved to or from an interface
+    AP_HAL::CANIface::CanRxItem rx_batch[CANARD_IFACE_BATCH_SIZE];
+    AP_HAL::CANIface::CanTxRequest tx_batch[CANARD_IFACE_BATCH_SIZE];
+    CanardCANFrame *tx_batch_frames[CANARD_IFACE_BATCH_SIZE];
+
+    // send the frames in tx_batch to an interface, returning false if
+    // the interface could not take them all and is not down
+    bool send_tx_batch(uint8_t iface, uint8_t count, bool iface_down);
+
+    static TxClass tx_class(uint32_t can_id);
+    static int8_t actuator_index(uint32_t can_id);
+
+    TxStats tx_stats;
+    static const uint16_t actuator_data_type_ids[4];
+    // time the current set of commands of each actuator type was started
+    uint64_t actuator_queued_us[ARRAY_SIZE(actuator_data_type_ids)];
 
     // auxillary 11 bit CANSensor
     CANSensor *aux_11bit_driver;
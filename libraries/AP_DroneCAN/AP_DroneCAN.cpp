@@ -741,6 +741,7 @@ void AP_DroneCAN::SRV_send_actuator(void)
 {
     uint8_t starting_servo = 0;
     bool repeat_send;
+    bool replaced = false;
 
     WITH_SEMAPHORE(SRV_sem);
 
@@ -780,6 +781,11 @@ void AP_DroneCAN::SRV_send_actuator(void)
         }
         msg.commands.len = i;
         if (i > 0) {
+            if (!replaced) {
+                // drop any commands from the last update still in the queue
+                canard_iface.replace_actuator_commands(UAVCAN_EQUIPMENT_ACTUATOR_ARRAYCOMMAND_ID);
+                replaced = true;
+            }
             if (act_out_array.broadcast(msg) > 0) {
                 _srv_send_count++;
             } else {
@@ -791,6 +797,11 @@ void AP_DroneCAN::SRV_send_actuator(void)
             }
         }
     } while (repeat_send);
+
+    if (replaced) {
+        // immediately push data to CAN bus
+        canard_iface.processTx(true);
+    }
 }
 
 #if AP_DRONECAN_HIMARK_SERVO_SUPPORT
@@ -823,7 +834,10 @@ void AP_DroneCAN::SRV_send_himark(void)
     }
     msg.cmd.len = highest_to_send+1;
 
+    canard_iface.replace_actuator_commands(COM_HIMARK_SERVO_SERVOCMD_ID);
     himark_out.broadcast(msg);
+    // immediately push data to CAN bus
+    canard_iface.processTx(true);
 }
 #endif // AP_DRONECAN_HIMARK_SERVO_SUPPORT
 
@@ -862,6 +876,7 @@ void AP_DroneCAN::SRV_send_esc(void)
         }
         esc_msg.cmd.len = k;
 
+        canard_iface.replace_actuator_commands(UAVCAN_EQUIPMENT_ESC_RAWCOMMAND_ID);
         if (esc_raw.broadcast(esc_msg)) {
             _esc_send_count++;
         } else {
@@ -915,6 +930,7 @@ void AP_DroneCAN::SRV_send_esc_hobbywing(void)
         }
         esc_msg.command.len = k;
 
+        canard_iface.replace_actuator_commands(COM_HOBBYWING_ESC_RAWCOMMAND_ID);
         if (esc_hobbywing_raw.broadcast(esc_msg)) {
             _esc_send_count++;
         } else {
@@ -1939,6 +1955,69 @@ void AP_DroneCAN::logging(void)
         return;
     }
     last_log_ms = now_ms;
+
+    for (uint8_t i=0; i<canard_iface.num_ifaces; i++) {
+        CanardInterface::BatchStats bs;
+        if (!canard_iface.get_batch_stats(i, bs)) {
+            continue;
+        }
+// @LoggerMessage: CANB
+// @Description: DroneCAN interface batching and receive latency
+// @Field: TimeUS: Time since system startup
+// @Field: I: driver index
+// @Field: If: interface index within the driver
+// @Field: RF: frames received
+// @Field: RB: receive batches
+// @Field: TF: frames sent
+// @Field: TB: send batches
+// @Field: LAvg: average time from frame reception to handling since the last message
+// @Field: LMax: maximum time from frame reception to handling since the last message
+        AP::logger().WriteStreaming("CANB",
+                                    "TimeUS,I,If,RF,RB,TF,TB,LAvg,LMax",
+                                    "s#-----ss",
+                                    "F------FF",
+                                    "QBBIIIIII",
+                                    AP_HAL::micros64(),
+                                    _driver_index,
+                                    i,
+                                    bs.rx_frames,
+                                    bs.rx_batches,
+                                    bs.tx_frames,
+                                    bs.tx_batches,
+                                    uint32_t(bs.rx_latency_count > 0 ? bs.rx_latency_sum_us / bs.rx_latency_count : 0),
+                                    bs.rx_latency_max_us);
+    }
+
+    CanardInterface::TxStats ts;
+    canard_iface.get_tx_stats(ts);
+// @LoggerMessage: CANQ
+// @Description: DroneCAN transmit queue
+// @Field: TimeUS: Time since system startup
+// @Field: I: driver index
+// @Field: QA: actuator command frames queued
+// @Field: QN: normal priority frames queued
+// @Field: QB: bulk frames queued
+// @Field: QMx: maximum frames queued when actuator commands were sent since the last message
+// @Field: Rep: actuator transfers replaced by newer commands before being sent
+// @Field: Def: times bulk frames were held back to leave room for higher priority frames
+// @Field: LAvg: average time from actuator commands being queued to being taken by the interfaces
+// @Field: LMax: maximum time from actuator commands being queued to being taken by the interfaces
+    AP::logger().WriteStreaming("CANQ",
+                                "TimeUS,I,QA,QN,QB,QMx,Rep,Def,LAvg,LMax",
+                                "s#------ss",
+                                "F-------FF",
+                                "QBHHHHIIII",
+                                AP_HAL::micros64(),
+                                _driver_index,
+                                ts.queue_depth[uint8_t(CanardInterface::TxClass::ACTUATOR)],
+                                ts.queue_depth[uint8_t(CanardInterface::TxClass::NORMAL)],
+                                ts.queue_depth[uint8_t(CanardInterface::TxClass::BULK)],
+                                ts.queue_depth_max,
+                                ts.actuator_replaced,
+                                ts.bulk_deferred,
+                                uint32_t(ts.actuator_latency_count > 0 ? ts.actuator_latency_sum_us / ts.actuator_latency_count : 0),
+                                ts.actuator_latency_max_us);
+
     if (HAL_NUM_CAN_IFACES <= _driver_index) {
         // no interface?
         return;
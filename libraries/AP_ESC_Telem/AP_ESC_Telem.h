@@ -4,6 +4,9 @@
 #include <AP_Param/AP_Param.h>
 #include <SRV_Channel/SRV_Channel_config.h>
 #include "AP_ESC_Telem_Backend.h"
+#if AP_SCRIPTING_ENABLED
+#include <AP_Scripting/AP_Scripting_ArrayView.h>
+#endif
 
 #if HAL_WITH_ESC_TELEM
 
@@ -129,6 +132,17 @@ public:
       set RPM scale factor from script
      */
     void set_rpm_scale(const uint8_t esc_index, const float scale_factor);
+
+    /*
+      views of the raw data of all ESCs for scripting. Values are as
+      last reported and are not cleared when the data goes stale
+     */
+    AP_Scripting_ArrayView get_rpm_view(void) const {
+        return AP_Scripting_ArrayView(&_rpm_data[0].rpm, ESC_TELEM_MAX_ESCS, sizeof(_rpm_data[0]));
+    }
+    AP_Scripting_ArrayView get_temperature_view(void) const {
+        return AP_Scripting_ArrayView(&_telem_data[0].temperature_cdeg, ESC_TELEM_MAX_ESCS, sizeof(_telem_data[0]));
+    }
 #endif
 
 private:
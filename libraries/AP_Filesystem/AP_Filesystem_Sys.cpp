@@ -26,6 +26,8 @@
 #include <AP_CANManager/AP_CANManager.h>
 #include <AP_Scheduler/AP_Scheduler.h>
 #include <AP_Common/ExpandingString.h>
+#include <AP_Vehicle/AP_BootPhases.h>
+#include <GCS_MAVLink/GCS.h>
 
 extern const AP_HAL::HAL& hal;
 
@@ -40,6 +42,12 @@ static const SysFileList sysfs_file_list[] = {
     {"memory.txt"},
     {"uarts.txt"},
     {"timers.txt"},
+#if AP_VEHICLE_BOOT_PHASES_ENABLED
+    {"boot.txt"},
+#endif
+#if HAL_GCS_ENABLED
+    {"routes.txt"},
+#endif
 #if HAL_MAX_CAN_PROTOCOL_DRIVERS
     {"can_log.txt"},
 #endif
@@ -120,6 +128,16 @@ int AP_Filesystem_Sys::open(const char *fname, int flags, bool allow_absolute_pa
     if (strcmp(fname, "timers.txt") == 0) {
         hal.util->timer_info(*r.str);
     }
+#if AP_VEHICLE_BOOT_PHASES_ENABLED
+    if (strcmp(fname, "boot.txt") == 0 && AP::boot_phases() != nullptr) {
+        AP::boot_phases()->info(*r.str);
+    }
+#endif
+#if HAL_GCS_ENABLED
+    if (strcmp(fname, "routes.txt") == 0) {
+        GCS_MAVLINK::routing_info(*r.str);
+    }
+#endif
 #if HAL_CANMANAGER_ENABLED
     if (strcmp(fname, "can_log.txt") == 0) {
         AP::can().log_retrieve(*r.str);
@@ -58,22 +58,20 @@ extern const AP_HAL::HAL& hal;
 
 bool AP_GPS_NMEA::read(void)
 {
-    int16_t numc;
-    bool parsed = false;
-
     send_config();
 
-    numc = port->available();
-    while (numc--) {
-        char c = port->read();
-#if AP_GPS_DEBUG_LOGGING_ENABLED
-        log_data((const uint8_t *)&c, 1);
-#endif
-        if (_decode(c)) {
+    return read_spans(MIN(port->available(), uint32_t(UINT16_MAX)));
+}
+
+uint16_t AP_GPS_NMEA::parse_span(const uint8_t *data, uint16_t len, bool &parsed, bool &stop)
+{
+    for (uint16_t i = 0; i < len; i++) {
+        rx_span_remaining = len - (i + 1);
+        if (_decode(data[i])) {
             parsed = true;
         }
     }
-    return parsed;
+    return len;
 }
 
 /*
@@ -100,6 +100,9 @@ private:
     ///
     bool                        _decode(char c);
 
+    /// Feed a span of received bytes through _decode()
+    uint16_t                    parse_span(const uint8_t *data, uint16_t len, bool &parsed, bool &stop) override;
+
     /// Parses the @p as a NMEA-style decimal number with
     /// up to 3 decimal digits.
     ///
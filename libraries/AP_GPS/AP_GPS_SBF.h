@@ -62,6 +62,7 @@ public:
 
 private:
 
+    uint16_t parse_span(const uint8_t *data, uint16_t len, bool &parsed, bool &stop) override;
     bool parse(uint8_t temp);
     bool process_message();
 
@@ -647,7 +647,6 @@ AP_GPS_UBLOX::_request_port(void)
 bool
 AP_GPS_UBLOX::read(void)
 {
-    bool parsed = false;
     uint32_t millis_now = AP_HAL::millis();
 
     // walk through the gps configuration at 1 message per second
@@ -675,139 +674,187 @@ AP_GPS_UBLOX::read(void)
         }
     }
 
-    const uint16_t numc = MIN(port->available(), 8192U);
-    for (uint16_t i = 0; i < numc; i++) {        // Process bytes received
-
-        // read the next byte
-        uint8_t data;
-        if (!port->read(data)) {
-            break;
-        }
-#if AP_GPS_DEBUG_LOGGING_ENABLED
-        log_data(&data, 1);
-#endif
+    return read_spans(MIN(port->available(), 8192U));
+}
 
+/*
+  parse a span of received bytes. Between messages we skip straight to
+  the next preamble and payload bytes are copied in bulk; everything
+  else goes through the byte at a time state machine in _parse_byte()
+ */
+uint16_t AP_GPS_UBLOX::parse_span(const uint8_t *data, uint16_t len, bool &parsed, bool &stop)
+{
+    uint16_t i = 0;
+    while (i < len) {
 #if GPS_MOVING_BASELINE
         if (rtcm3_parser) {
-            if (rtcm3_parser->read(data)) {
+            // every byte needs to go to the RTCMv3 parser as well
+            const uint8_t b = data[i++];
+            rx_span_remaining = len - i;
+            if (rtcm3_parser->read(b)) {
                 // we've found a RTCMv3 packet. We stop parsing at
                 // this point and reset u-blox parse state. We need to
                 // stop parsing to give the higher level driver a
                 // chance to send the RTCMv3 packet to another (rover)
                 // GPS
                 _step = 0;
-                break;
+                stop = true;
+                return i;
             }
+            if (_parse_byte(b)) {
+                parsed = true;
+            }
+            continue;
         }
 #endif
-
-	reset:
-        switch(_step) {
-
-        // Message preamble detection
-        //
-        // If we fail to match any of the expected bytes, we reset
-        // the state machine and re-consider the failed byte as
-        // the first byte of the preamble.  This improves our
-        // chances of recovering from a mismatch and makes it less
-        // likely that we will be fooled by the preamble appearing
-        // as data in some other message.
-        //
-        case 1:
-            if (PREAMBLE2 == data) {
-                _step++;
-                break;
+        if (_step == 0) {
+            // skip anything that can't be the start of a message
+            const uint8_t *p = (const uint8_t *)memchr(&data[i], PREAMBLE1, len - i);
+            if (p == nullptr) {
+                return len;
             }
-            _step = 0;
-            Debug("reset %u", __LINE__);
-            FALLTHROUGH;
-        case 0:
-            if(PREAMBLE1 == data)
+            i = p - data;
+        } else if (_step == 6) {
+            // payload, length checked against _buffer in step 5
+            const uint16_t n = MIN(uint16_t(len - i), uint16_t(_payload_length - _payload_counter));
+            const uint8_t *p = &data[i];
+            uint8_t ck_a = _ck_a;
+            uint8_t ck_b = _ck_b;
+            for (uint16_t j = 0; j < n; j++) {
+                ck_b += (ck_a += p[j]);
+            }
+            _ck_a = ck_a;
+            _ck_b = ck_b;
+            memcpy(&_buffer[_payload_counter], p, n);
+            _payload_counter += n;
+            if (_payload_counter == _payload_length) {
                 _step++;
-            break;
+            }
+            i += n;
+            continue;
+        }
+        const uint8_t b = data[i++];
+        rx_span_remaining = len - i;
+        if (_parse_byte(b)) {
+            parsed = true;
+        }
+    }
+    return len;
+}
 
-        // Message header processing
-        //
-        // We sniff the class and message ID to decide whether we
-        // are going to gather the message bytes or just discard
-        // them.
-        //
-        // We always collect the length so that we can avoid being
-        // fooled by preamble bytes in messages.
-        //
-        case 2:
-            _step++;
-            _class = data;
-            _ck_b = _ck_a = data;                       // reset the checksum accumulators
-            break;
-        case 3:
-            _step++;
-            _ck_b += (_ck_a += data);                   // checksum byte
-            _msg_id = data;
-            break;
-        case 4:
+/*
+  process one byte, returning true if a message was parsed
+ */
+bool AP_GPS_UBLOX::_parse_byte(uint8_t data)
+{
+    bool parsed = false;
+
+	reset:
+    switch(_step) {
+
+    // Message preamble detection
+    //
+    // If we fail to match any of the expected bytes, we reset
+    // the state machine and re-consider the failed byte as
+    // the first byte of the preamble.  This improves our
+    // chances of recovering from a mismatch and makes it less
+    // likely that we will be fooled by the preamble appearing
+    // as data in some other message.
+    //
+    case 1:
+        if (PREAMBLE2 == data) {
             _step++;
-            _ck_b += (_ck_a += data);                   // checksum byte
-            _payload_length = data;                     // payload length low byte
             break;
-        case 5:
+        }
+        _step = 0;
+        Debug("reset %u", __LINE__);
+        FALLTHROUGH;
+    case 0:
+        if(PREAMBLE1 == data)
             _step++;
-            _ck_b += (_ck_a += data);                   // checksum byte
+        break;
 
-            _payload_length += (uint16_t)(data<<8);
-            if (_payload_length > sizeof(_buffer)) {
-                Debug("large payload %u", (unsigned)_payload_length);
-                // assume any payload bigger then what we know about is noise
-                _payload_length = 0;
-                _step = 0;
+    // Message header processing
+    //
+    // We sniff the class and message ID to decide whether we
+    // are going to gather the message bytes or just discard
+    // them.
+    //
+    // We always collect the length so that we can avoid being
+    // fooled by preamble bytes in messages.
+    //
+    case 2:
+        _step++;
+        _class = data;
+        _ck_b = _ck_a = data;                       // reset the checksum accumulators
+        break;
+    case 3:
+        _step++;
+        _ck_b += (_ck_a += data);                   // checksum byte
+        _msg_id = data;
+        break;
+    case 4:
+        _step++;
+        _ck_b += (_ck_a += data);                   // checksum byte
+        _payload_length = data;                     // payload length low byte
+        break;
+    case 5:
+        _step++;
+        _ck_b += (_ck_a += data);                   // checksum byte
+
+        _payload_length += (uint16_t)(data<<8);
+        if (_payload_length > sizeof(_buffer)) {
+            Debug("large payload %u", (unsigned)_payload_length);
+            // assume any payload bigger then what we know about is noise
+            _payload_length = 0;
+            _step = 0;
 				goto reset;
-            }
-            _payload_counter = 0;                       // prepare to receive payload
-            if (_payload_length == 0) {
-                // bypass payload and go straight to checksum
-                _step++;
-            }
-            break;
-
-        // Receive message data
-        //
-        case 6:
-            _ck_b += (_ck_a += data);                   // checksum byte
-            if (_payload_counter < sizeof(_buffer)) {
-                _buffer[_payload_counter] = data;
-            }
-            if (++_payload_counter == _payload_length)
-                _step++;
-            break;
+        }
+        _payload_counter = 0;                       // prepare to receive payload
+        if (_payload_length == 0) {
+            // bypass payload and go straight to checksum
+            _step++;
+        }
+        break;
 
-        // Checksum and message processing
-        //
-        case 7:
+    // Receive message data
+    //
+    case 6:
+        _ck_b += (_ck_a += data);                   // checksum byte
+        if (_payload_counter < sizeof(_buffer)) {
+            _buffer[_payload_counter] = data;
+        }
+        if (++_payload_counter == _payload_length)
             _step++;
-            if (_ck_a != data) {
-                Debug("bad cka %x should be %x", data, _ck_a);
-                _step = 0;
-				goto reset;
-            }
-            break;
-        case 8:
+        break;
+
+    // Checksum and message processing
+    //
+    case 7:
+        _step++;
+        if (_ck_a != data) {
+            Debug("bad cka %x should be %x", data, _ck_a);
             _step = 0;
-            if (_ck_b != data) {
-                Debug("bad ckb %x should be %x", data, _ck_b);
-                break;                                                  // bad checksum
-            }
+				goto reset;
+        }
+        break;
+    case 8:
+        _step = 0;
+        if (_ck_b != data) {
+            Debug("bad ckb %x should be %x", data, _ck_b);
+            break;                                                  // bad checksum
+        }
 
 #if GPS_MOVING_BASELINE
-            if (rtcm3_parser) {
-                // this is a uBlox packet, discard any partial RTCMv3 state
-                rtcm3_parser->reset();
-            }
+        if (rtcm3_parser) {
+            // this is a uBlox packet, discard any partial RTCMv3 state
+            rtcm3_parser->reset();
+        }
 #endif
-            if (_parse_gps()) {
-                parsed = true;
-            }
-            break;
+        if (_parse_gps()) {
+            parsed = true;
         }
+        break;
     }
     return parsed;
 }
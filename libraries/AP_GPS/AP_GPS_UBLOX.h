@@ -126,6 +126,8 @@ class RTCM3_Parser;
 
 class AP_GPS_UBLOX : public AP_GPS_Backend
 {
+    friend class AP_GPS_UBLOX_Test;
+
 public:
     AP_GPS_UBLOX(AP_GPS &_gps, AP_GPS::Params &_params, AP_GPS::GPS_State &_state, AP_HAL::UARTDriver *_port, AP_GPS::GPS_Role role);
     ~AP_GPS_UBLOX() override;
@@ -803,6 +805,10 @@ private:
     // Buffer parse & GPS state update
     bool        _parse_gps();
 
+    // receive state machine
+    uint16_t    parse_span(const uint8_t *data, uint16_t len, bool &parsed, bool &stop) override;
+    bool        _parse_byte(uint8_t data);
+
     // used to update fix between status and position packets
     AP_GPS::GPS_Status next_fix { AP_GPS::NO_FIX };
 
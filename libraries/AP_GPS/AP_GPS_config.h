@@ -121,3 +121,9 @@
 #ifndef AP_GPS_GPS2_RTK_SENDING_ENABLED
 #define AP_GPS_GPS2_RTK_SENDING_ENABLED HAL_GCS_ENABLED && AP_GPS_ENABLED && GPS_MAX_RECEIVERS > 1 && (AP_GPS_SBF_ENABLED || AP_GPS_ERB_ENABLED)
 #endif
+
+// number of bytes read from the UART at a time by backends that parse
+// spans of received data
+#ifndef AP_GPS_RX_SPAN_SIZE
+#define AP_GPS_RX_SPAN_SIZE 128
+#endif
@@ -52,6 +52,56 @@ AP_GPS_Backend::AP_GPS_Backend(AP_GPS &_gps, AP_GPS::Params &_params, AP_GPS::GP
     state.have_vertical_accuracy = false;
 }
 
+AP_GPS_Backend::~AP_GPS_Backend(void)
+{
+    delete[] rx_span;
+}
+
+/*
+  read from the UART a span at a time. This avoids a virtual UART call
+  and a lock per byte, and lets the backend scan for sync bytes and
+  copy payloads in bulk
+ */
+bool AP_GPS_Backend::read_spans(uint16_t max_bytes)
+{
+    if (rx_span == nullptr) {
+        rx_span = NEW_NOTHROW uint8_t[AP_GPS_RX_SPAN_SIZE];
+    }
+    // fall back to a byte at a time if we can't allocate the span
+    uint8_t *buf = rx_span != nullptr ? rx_span : &rx_byte;
+    const uint16_t buf_size = rx_span != nullptr ? AP_GPS_RX_SPAN_SIZE : 1;
+
+    bool parsed = false;
+    while (true) {
+        if (rx_span_start >= rx_span_end) {
+            // previous span fully consumed, read the next one
+            const uint16_t n = MIN(max_bytes, buf_size);
+            if (n == 0) {
+                break;
+            }
+            const ssize_t nread = port->read(buf, n);
+            if (nread <= 0) {
+                rx_span_start = rx_span_end = 0;
+                break;
+            }
+            max_bytes -= nread;
+            rx_span_start = 0;
+            rx_span_end = nread;
+        }
+        bool stop = false;
+        const uint16_t used = parse_span(&buf[rx_span_start], rx_span_end - rx_span_start, parsed, stop);
+#if AP_GPS_DEBUG_LOGGING_ENABLED
+        log_data(&buf[rx_span_start], used);
+#endif
+        rx_span_start += used;
+        rx_span_remaining = 0;
+        if (stop) {
+            break;
+        }
+    }
+    return parsed;
+}
+
 /**
    fill in time_week_ms and time_week from BCD date and time components
    assumes MTK19 millisecond form of bcd_time
@@ -223,7 +273,8 @@ void AP_GPS_Backend::send_mavlink_gps_rtk(mavlink_channel_t chan)
 void AP_GPS_Backend::set_uart_timestamp(uint16_t nbytes)
 {
     if (port) {
-        state.last_corrected_gps_time_us = port->receive_time_constraint_us(nbytes);
+        // bytes of the span not yet parsed have already left the UART
+        state.last_corrected_gps_time_us = port->receive_time_constraint_us(nbytes + rx_span_remaining);
         state.corrected_timestamp_updated = true;
     }
 }
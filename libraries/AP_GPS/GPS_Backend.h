@@ -53,7 +53,7 @@ public:
 
     // we declare a virtual destructor so that GPS drivers can
     // override with a custom destructor if need be.
-    virtual ~AP_GPS_Backend(void) {}
+    virtual ~AP_GPS_Backend(void);
 
     // The read() method is the only one needed in each driver. It
     // should return true when the backend has successfully received a
@@ -168,6 +168,25 @@ protected:
 
     virtual void set_pps_desired_freq(uint8_t freq) {}
 
+    /*
+      read up to max_bytes from the UART in spans of up to
+      AP_GPS_RX_SPAN_SIZE bytes, passing each span to
+      parse_span(). Returns true if a message was parsed
+     */
+    bool read_spans(uint16_t max_bytes);
+
+    /*
+      parse a span of received bytes, returning the number of bytes
+      consumed. All bytes must be consumed unless stop is set, in which
+      case the remaining bytes are passed to the next call. Set parsed
+      when a message has been successfully parsed
+     */
+    virtual uint16_t parse_span(const uint8_t *data, uint16_t len, bool &parsed, bool &stop) { return len; }
+
+    // bytes in the current span after the byte being parsed, so that
+    // set_uart_timestamp() can allow for bytes already read from the UART
+    uint16_t rx_span_remaining;
+
 #if AP_GPS_DEBUG_LOGGING_ENABLED
     // log some data for debugging
     void log_data(const uint8_t *data, uint16_t length);
@@ -177,6 +196,14 @@ protected:
     void set_alt_amsl_cm(AP_GPS::GPS_State &_state, int32_t alt_amsl_cm);
 
 private:
+    // span being parsed by read_spans(), allocated on first use
+    uint8_t *rx_span;
+    uint16_t rx_span_start;
+    uint16_t rx_span_end;
+    // span used if rx_span can't be allocated. This must outlive the
+    // call as a stopped parse leaves unconsumed bytes for the next one
+    uint8_t rx_byte;
+
     // itow from previous message
     uint64_t _pseudo_itow;
     int32_t _pseudo_itow_delta_ms;
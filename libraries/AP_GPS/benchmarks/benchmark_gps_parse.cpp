@@ -0,0 +1,140 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_GPS/AP_GPS.h>
+#include <AP_GPS/AP_GPS_UBLOX.h>
+#include <AP_Math/AP_Math.h>
+#include <string.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+#if AP_GPS_UBLOX_ENABLED
+
+/*
+  compare byte at a time UBX parsing, as the GPS backends did before
+  read_spans(), with AP_GPS_UBLOX::parse_span() on a stream of NAV-DOP
+  and RXM-RAWX sized messages separated by noise. RXM-RAWX isn't
+  handled unless raw logging is enabled, and NAV-DOP has a trivial
+  handler, so this mostly measures the framing
+ */
+
+static const uint8_t PREAMBLE1 = 0xb5;
+static const uint8_t PREAMBLE2 = 0x62;
+
+// a UART that discards writes, needed to construct the driver
+class NullUART : public AP_HAL::UARTDriver
+{
+public:
+    bool is_initialized() override { return true; }
+    bool tx_pending() override { return false; }
+    uint32_t txspace() override { return 1024; }
+
+protected:
+    void _begin(uint32_t baud, uint16_t rxSpace, uint16_t txSpace) override {}
+    size_t _write(const uint8_t *buffer, size_t size) override { return size; }
+    ssize_t _read(uint8_t *buffer, uint16_t count) override { return 0; }
+    void _end() override {}
+    void _flush() override {}
+    uint32_t _available() override { return 0; }
+    bool _discard_input(void) override { return true; }
+};
+
+static AP_GPS gps;
+
+class AP_GPS_UBLOX_Test
+{
+public:
+    AP_GPS_UBLOX_Test() {
+        driver = NEW_NOTHROW AP_GPS_UBLOX(gps, params, state, &uart, AP_GPS::GPS_ROLE_NORMAL);
+    }
+    ~AP_GPS_UBLOX_Test() {
+        delete driver;
+    }
+
+    void parse_byte(uint8_t data) {
+        driver->_parse_byte(data);
+    }
+    void parse_span(const uint8_t *data, uint16_t len) {
+        bool parsed = false, stop = false;
+        driver->parse_span(data, len, parsed, stop);
+    }
+
+private:
+    AP_GPS::Params params;
+    AP_GPS::GPS_State state {};
+    NullUART uart;
+    AP_GPS_UBLOX *driver;
+};
+
+// append one UBX message with a pseudo-random payload
+static uint32_t add_message(uint8_t *buf, uint8_t msg_class, uint8_t msg_id, uint16_t len, uint32_t &seed)
+{
+    uint8_t *p = buf;
+    *p++ = PREAMBLE1;
+    *p++ = PREAMBLE2;
+    *p++ = msg_class;
+    *p++ = msg_id;
+    *p++ = len & 0xff;
+    *p++ = len >> 8;
+    for (uint16_t i = 0; i < len; i++) {
+        seed = seed * 1103515245U + 12345U;
+        *p++ = seed >> 16;
+    }
+    uint8_t ck_a = 0, ck_b = 0;
+    for (uint8_t *c = &buf[2]; c < p; c++) {
+        ck_b += (ck_a += *c);
+    }
+    *p++ = ck_a;
+    *p++ = ck_b;
+    return p - buf;
+}
+
+static uint32_t make_stream(uint8_t *buf, uint32_t size)
+{
+    uint32_t seed = 1;
+    uint32_t len = 0;
+    while (len + 1500 < size) {
+        len += add_message(&buf[len], 0x01, 0x04, 18, seed);    // NAV-DOP
+        len += add_message(&buf[len], 0x02, 0x15, 16 + 32*32, seed);    // RXM-RAWX, 32 measurements
+        // a little inter-message noise, as seen after a resync
+        for (uint8_t i = 0; i < 16; i++) {
+            seed = seed * 1103515245U + 12345U;
+            buf[len++] = seed >> 16;
+        }
+    }
+    return len;
+}
+
+static uint8_t stream[64*1024];
+static const uint32_t stream_len = make_stream(stream, sizeof(stream));
+
+static void BM_UBXParseByte(benchmark::State& state)
+{
+    AP_GPS_UBLOX_Test test;
+    while (state.KeepRunning()) {
+        for (uint32_t i = 0; i < stream_len; i++) {
+            test.parse_byte(stream[i]);
+        }
+        gbenchmark_escape(&test);
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * stream_len);
+}
+
+static void BM_UBXParseSpan(benchmark::State& state)
+{
+    AP_GPS_UBLOX_Test test;
+    const uint16_t span = state.range(0);
+    while (state.KeepRunning()) {
+        for (uint32_t i = 0; i < stream_len; i += span) {
+            test.parse_span(&stream[i], MIN(uint32_t(span), stream_len - i));
+        }
+        gbenchmark_escape(&test);
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * stream_len);
+}
+
+BENCHMARK(BM_UBXParseByte);
+BENCHMARK(BM_UBXParseSpan)->Arg(16)->Arg(128)->Arg(512);
+
+#endif // AP_GPS_UBLOX_ENABLED
+
+BENCHMARK_MAIN();
@@ -0,0 +1,260 @@
+#include <AP_gtest.h>
+
+#include <AP_GPS/AP_GPS.h>
+#include <AP_GPS/AP_GPS_UBLOX.h>
+#include <AP_Math/AP_Math.h>
+#include <AP_Math/crc.h>
+#include <string.h>
+
+const AP_HAL::HAL &hal = AP_HAL::get_HAL();
+
+#if AP_GPS_UBLOX_ENABLED
+
+/*
+  a UART that returns bytes from a buffer, at most max_read at a time
+ */
+class FakeUART : public AP_HAL::UARTDriver
+{
+public:
+    void set_data(const uint8_t *_data, uint16_t _len, uint16_t _max_read) {
+        data = _data;
+        len = _len;
+        ofs = 0;
+        max_read = _max_read;
+    }
+    uint16_t remaining() const { return len - ofs; }
+
+    bool is_initialized() override { return true; }
+    bool tx_pending() override { return false; }
+    uint32_t txspace() override { return 1024; }
+
+protected:
+    void _begin(uint32_t baud, uint16_t rxSpace, uint16_t txSpace) override {}
+    size_t _write(const uint8_t *buffer, size_t size) override { return size; }
+    ssize_t _read(uint8_t *buffer, uint16_t count) override {
+        const uint16_t n = MIN(MIN(count, max_read), remaining());
+        memcpy(buffer, &data[ofs], n);
+        ofs += n;
+        return n;
+    }
+    void _end() override {}
+    void _flush() override {}
+    uint32_t _available() override { return remaining(); }
+    bool _discard_input(void) override { ofs = len; return true; }
+
+private:
+    const uint8_t *data;
+    uint16_t len;
+    uint16_t ofs;
+    uint16_t max_read;
+};
+
+static AP_GPS gps;
+
+class AP_GPS_UBLOX_Test
+{
+public:
+    AP_GPS_UBLOX_Test(AP_GPS::GPS_Role role) {
+        driver = NEW_NOTHROW AP_GPS_UBLOX(gps, params, state, &uart, role);
+    }
+    ~AP_GPS_UBLOX_Test() {
+        delete driver;
+    }
+
+    uint16_t parse_span(const uint8_t *data, uint16_t len, bool &parsed, bool &stop) {
+        return driver->parse_span(data, len, parsed, stop);
+    }
+    bool read_spans(const uint8_t *data, uint16_t len, uint16_t max_read) {
+        uart.set_data(data, len, max_read);
+        return driver->read_spans(len);
+    }
+    // continue reading from where the last read left the UART
+    bool read_spans_again() {
+        return driver->read_spans(uart.remaining());
+    }
+    bool get_RTCMV3(const uint8_t *&bytes, uint16_t &len) {
+        return driver->get_RTCMV3(bytes, len);
+    }
+    uint8_t step() const { return driver->_step; }
+    uint16_t hdop() const { return state.hdop; }
+    uint16_t uart_remaining() const { return uart.remaining(); }
+
+private:
+    AP_GPS::Params params;
+    AP_GPS::GPS_State state {};
+    FakeUART uart;
+    AP_GPS_UBLOX *driver;
+};
+
+// append a NAV-DOP message with the given hdop
+static uint16_t add_nav_dop(uint8_t *buf, uint16_t hdop)
+{
+    const uint16_t payload_len = 18;
+    uint8_t *p = buf;
+    *p++ = 0xb5;
+    *p++ = 0x62;
+    *p++ = 0x01;    // CLASS_NAV
+    *p++ = 0x04;    // MSG_DOP
+    *p++ = payload_len;
+    *p++ = 0;
+    memset(p, 0, payload_len);
+    p[0] = 100;     // itow
+    p[14] = hdop & 0xff;
+    p[15] = hdop >> 8;
+    p += payload_len;
+    uint8_t ck_a = 0, ck_b = 0;
+    for (uint8_t *c = &buf[2]; c < p; c++) {
+        ck_b += (ck_a += *c);
+    }
+    *p++ = ck_a;
+    *p++ = ck_b;
+    return p - buf;
+}
+
+TEST(AP_GPS_UBLOX, parse_span_whole_frame)
+{
+    AP_GPS_UBLOX_Test test(AP_GPS::GPS_ROLE_NORMAL);
+    uint8_t buf[64];
+    // noise, including a lone preamble byte, before the frame
+    const uint8_t noise[] { 0x00, 0x11, 0xb5, 0x22 };
+    memcpy(buf, noise, sizeof(noise));
+    const uint16_t len = sizeof(noise) + add_nav_dop(&buf[sizeof(noise)], 123);
+
+    bool parsed = false, stop = false;
+    EXPECT_EQ(len, test.parse_span(buf, len, parsed, stop));
+    EXPECT_FALSE(stop);
+    EXPECT_EQ(0, test.step());
+    EXPECT_EQ(123, test.hdop());
+}
+
+TEST(AP_GPS_UBLOX, parse_span_ends_mid_frame)
+{
+    AP_GPS_UBLOX_Test test(AP_GPS::GPS_ROLE_NORMAL);
+    uint8_t buf[64];
+    const uint16_t len = add_nav_dop(buf, 0);
+
+    // split the frame at every position, including in the header,
+    // the payload and between the checksum bytes
+    for (uint16_t split = 1; split < len; split++) {
+        const uint16_t hdop = 200 + split;
+        add_nav_dop(buf, hdop);
+        bool parsed = false, stop = false;
+        EXPECT_EQ(split, test.parse_span(buf, split, parsed, stop));
+        EXPECT_NE(hdop, test.hdop());
+        EXPECT_NE(0, test.step());
+        EXPECT_EQ(len - split, test.parse_span(&buf[split], len - split, parsed, stop));
+        EXPECT_FALSE(stop);
+        EXPECT_EQ(0, test.step());
+        EXPECT_EQ(hdop, test.hdop());
+    }
+}
+
+TEST(AP_GPS_UBLOX, parse_span_resync)
+{
+    AP_GPS_UBLOX_Test test(AP_GPS::GPS_ROLE_NORMAL);
+    uint8_t buf[128];
+    const uint16_t first = add_nav_dop(buf, 10);
+    // corrupt the first frame's checksum
+    buf[first-1] ^= 0xff;
+    uint16_t len = first;
+    len += add_nav_dop(&buf[len], 11);
+    // a header claiming a payload larger than any message
+    const uint8_t big[] { 0xb5, 0x62, 0x01, 0x04, 0xff, 0xff };
+    memcpy(&buf[len], big, sizeof(big));
+    len += sizeof(big);
+    len += add_nav_dop(&buf[len], 12);
+
+    bool parsed = false, stop = false;
+    EXPECT_EQ(first, test.parse_span(buf, first, parsed, stop));
+    EXPECT_EQ(0, test.hdop());
+    EXPECT_EQ(len - first, test.parse_span(&buf[first], len - first, parsed, stop));
+    EXPECT_EQ(12, test.hdop());
+}
+
+TEST(AP_GPS_UBLOX, read_spans)
+{
+    uint8_t buf[4*AP_GPS_RX_SPAN_SIZE];
+    uint16_t len = 0;
+    uint16_t hdop = 0;
+    while (len + 26 <= sizeof(buf)) {
+        len += add_nav_dop(&buf[len], ++hdop);
+    }
+    // whole spans, and single bytes as read when the span can't be allocated
+    const uint16_t max_reads[] { AP_GPS_RX_SPAN_SIZE, 1 };
+    for (const auto max_read : max_reads) {
+        AP_GPS_UBLOX_Test test(AP_GPS::GPS_ROLE_NORMAL);
+        test.read_spans(buf, len, max_read);
+        EXPECT_EQ(0, test.uart_remaining());
+        EXPECT_EQ(0, test.step());
+        EXPECT_EQ(hdop, test.hdop());
+    }
+}
+
+#if GPS_MOVING_BASELINE
+// append a RTCMv3 packet with a payload of n bytes
+static uint16_t add_rtcm3(uint8_t *buf, uint16_t n)
+{
+    uint8_t *p = buf;
+    *p++ = 0xd3;
+    *p++ = n >> 8;
+    *p++ = n & 0xff;
+    for (uint16_t i = 0; i < n; i++) {
+        *p++ = i;
+    }
+    const uint32_t crc = crc_crc24(buf, p - buf);
+    *p++ = crc >> 16;
+    *p++ = crc >> 8;
+    *p++ = crc;
+    return p - buf;
+}
+
+TEST(AP_GPS_UBLOX, moving_baseline_stop)
+{
+    AP_GPS_UBLOX_Test test(AP_GPS::GPS_ROLE_MB_BASE);
+    uint8_t buf[128];
+    const uint16_t rtcm_len = add_rtcm3(buf, 20);
+    const uint16_t len = rtcm_len + add_nav_dop(&buf[rtcm_len], 77);
+
+    // parsing stops at the end of the RTCMv3 packet so it can be
+    // forwarded to the rover before anything else is parsed
+    bool parsed = false, stop = false;
+    EXPECT_EQ(rtcm_len, test.parse_span(buf, len, parsed, stop));
+    EXPECT_TRUE(stop);
+    const uint8_t *bytes;
+    uint16_t n;
+    EXPECT_TRUE(test.get_RTCMV3(bytes, n));
+    EXPECT_EQ(rtcm_len, n);
+    EXPECT_EQ(0, test.hdop());
+
+    stop = false;
+    EXPECT_EQ(len - rtcm_len, test.parse_span(&buf[rtcm_len], len - rtcm_len, parsed, stop));
+    EXPECT_FALSE(stop);
+    EXPECT_EQ(77, test.hdop());
+}
+
+TEST(AP_GPS_UBLOX, moving_baseline_read_spans_leftover)
+{
+    uint8_t buf[128];
+    const uint16_t rtcm_len = add_rtcm3(buf, 20);
+    const uint16_t len = rtcm_len + add_nav_dop(&buf[rtcm_len], 78);
+
+    const uint16_t max_reads[] { AP_GPS_RX_SPAN_SIZE, 1 };
+    for (const auto max_read : max_reads) {
+        AP_GPS_UBLOX_Test test(AP_GPS::GPS_ROLE_MB_BASE);
+        test.read_spans(buf, len, max_read);
+        const uint8_t *bytes;
+        uint16_t n;
+        EXPECT_TRUE(test.get_RTCMV3(bytes, n));
+        EXPECT_EQ(0, test.hdop());
+        // bytes after the RTCMv3 packet are parsed on the next call,
+        // whether still in the span or yet to be read
+        test.read_spans_again();
+        EXPECT_EQ(0, test.uart_remaining());
+        EXPECT_EQ(78, test.hdop());
+    }
+}
+#endif // GPS_MOVING_BASELINE
+
+#endif // AP_GPS_UBLOX_ENABLED
+
+AP_GTEST_MAIN()
@@ -95,8 +95,8 @@ const AP_Param::GroupInfo AP_GyroFFT::var_info[] = {
 
     // @Param: WINDOW_SIZE
     // @DisplayName: FFT window size
-    // @Description: Size of window to be used in FFT calculations. Takes effect on reboot. Must be a power of 2 and between 32 and 512. Larger windows give greater frequency resolution but poorer time resolution, consume more CPU time and may not be appropriate for all vehicles. Time and frequency resolution are given by the sample-rate / window-size. Windows of 256 are only really recommended for F7 class boards, windows of 512 or more H7 class.
-    // @Range: 32 1024
+    // @Description: Size of window to be used in FFT calculations. Takes effect on reboot. Must be a power of 2 and between 32 and 512, or up to 2048 on Linux boards. Larger windows give greater frequency resolution but poorer time resolution, consume more CPU time and may not be appropriate for all vehicles. Time and frequency resolution are given by the sample-rate / window-size. Windows of 256 are only really recommended for F7 class boards, windows of 512 or more H7 class.
+    // @Range: 32 2048
     // @User: Advanced
     // @RebootRequired: True
     AP_GROUPINFO("WINDOW_SIZE", 5, AP_GyroFFT, _window_size, FFT_DEFAULT_WINDOW_SIZE),
@@ -169,8 +169,8 @@ const AP_Param::GroupInfo AP_GyroFFT::var_info[] = {
 
     // @Param: OPTIONS
     // @DisplayName: FFT options
-    // @Description: FFT configuration options. Values: 1:Apply the FFT *after* the filter bank,2:Check noise at the motor frequencies using ESC data as a reference
-    // @Bitmask: 0:Enable post-filter FFT,1:Check motor noise
+    // @Description: FFT configuration options. Values: 1:Apply the FFT *after* the filter bank,2:Check noise at the motor frequencies using ESC data as a reference,4:Analyse all three axes concurrently in separate threads so that each axis is updated at the full FFT rate, only available on Linux boards with several cores
+    // @Bitmask: 0:Enable post-filter FFT,1:Check motor noise,2:Analyse axes concurrently
     // @User: Advanced
     // @RebootRequired: True
     AP_GROUPINFO("OPTIONS", 15, AP_GyroFFT, _options, 0),
@@ -216,7 +216,9 @@ void AP_GyroFFT::init(uint16_t loop_rate_hz)
 
     // check that we support the window size requested and it is a power of 2
     _window_size.set(1 << lrintf(log2f(_window_size.get())));
-#if defined(STM32H7) || CONFIG_HAL_BOARD == HAL_BOARD_LINUX || CONFIG_HAL_BOARD == HAL_BOARD_SITL
+#if CONFIG_HAL_BOARD == HAL_BOARD_LINUX || CONFIG_HAL_BOARD == HAL_BOARD_SITL
+    _window_size.set(constrain_int16(_window_size, 32, 2048));
+#elif defined(STM32H7)
     _window_size.set(constrain_int16(_window_size, 32, 512));
 #else
     _window_size.set(constrain_int16(_window_size, 32, 256));
@@ -317,9 +319,38 @@ void AP_GyroFFT::init(uint16_t loop_rate_hz)
         GCS_SEND_TEXT(MAV_SEVERITY_WARNING, "Failed to initialize DSP engine");
         return;
     }
+    for (uint8_t axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        _axis_state[axis] = _state;
+    }
+    _num_threads = 1;
+
+#if AP_GYROFFT_CONCURRENT_ENABLED
+    // analysing axes concurrently needs a DSP engine per axis so that they
+    // can run in separate threads
+    if (_options & uint32_t(Options::ConcurrentAxes)) {
+        bool ok = true;
+        for (uint8_t axis = 1; axis < XYZ_AXIS_COUNT && ok; axis++) {
+            _axis_state[axis] = hal.dsp->fft_init(_window_size, _fft_sampling_rate_hz, _num_frames);
+            ok = _axis_state[axis] != nullptr;
+        }
+        if (ok) {
+            _num_threads = XYZ_AXIS_COUNT;
+        } else {
+            GCS_SEND_TEXT(MAV_SEVERITY_WARNING, "AP_GyroFFT: concurrent axes disabled, out of memory");
+            for (uint8_t axis = 1; axis < XYZ_AXIS_COUNT; axis++) {
+                if (_axis_state[axis] != _state) {
+                    delete _axis_state[axis];
+                }
+                _axis_state[axis] = _state;
+            }
+        }
+    }
+#endif
 
     // per-axis frame time
     _frame_time_ms = _samples_per_frame * 1000 / _fft_sampling_rate_hz;
+    // a change in vibration shows up in the estimate once it fills half the window
+    _window_delay_us = uint32_t(_window_size) * 500000U / _fft_sampling_rate_hz;
     // The update rate for the output, defaults are 1Khz / (1 - 0.5) * 32 == 62hz
     const float output_rate = static_cast<float>(_fft_sampling_rate_hz) / static_cast<float>(_samples_per_frame);
     // establish suitable defaults for the detected values
@@ -352,8 +383,10 @@ void AP_GyroFFT::init(uint16_t loop_rate_hz)
         _snr_threshold_db.set_default(FFT_SNR_PFILT_DEFAULT);
     }
 
-    // the number of cycles required to have a proper noise reference
-    _noise_cycles = (_window_size / _samples_per_frame) * XYZ_AXIS_COUNT;
+    // the number of cycles required on each axis to have a proper noise reference
+    for (uint8_t axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        _noise_cycles[axis] = _window_size / _samples_per_frame;
+    }
 
     // finally we are done
     _initialized = true;
@@ -403,6 +436,15 @@ void AP_GyroFFT::update()
     WITH_SEMAPHORE(_sem);
 
     _config._analysis_enabled = _analysis_enabled;
+
+    // the notch filters pick up new estimates from here, so this is where the
+    // latency of an estimate ends
+    const uint32_t now_us = AP_HAL::micros();
+    for (uint8_t axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        if (_thread_state._last_output_us[axis] != _global_state._last_output_us[axis]) {
+            _notch_latency_us[axis] = now_us - _thread_state._frame_start_us[axis] + _window_delay_us;
+        }
+    }
     _global_state = _thread_state;
 
     // calculate health based on being 5 frames behind, SITL needs longer
@@ -428,7 +470,7 @@ void AP_GyroFFT::update()
     }
 }
 
-// analyse gyro data using FFT, returns number of samples still held
+// analyse gyro data using FFT on each axis in turn, returns number of samples still held
 // called from FFT thread
 uint16_t AP_GyroFFT::run_cycle()
 {
@@ -436,15 +478,31 @@ uint16_t AP_GyroFFT::run_cycle()
         return 0;
     }
 
+    if (analyse_axis(_update_axis)) {
+        // move onto the next axis
+        _update_axis = (_update_axis + 1) % XYZ_AXIS_COUNT;
+    }
+
+    // samples remaining in the next axis
+    return get_available_samples(_update_axis);
+}
+
+// analyse a frame of gyro data on one axis if there are enough samples
+// called from FFT thread, concurrently for each axis if the axes have their own threads
+bool AP_GyroFFT::analyse_axis(uint8_t axis)
+{
+    if (!analysis_enabled()) {
+        return false;
+    }
+
     if (!_sem.take(HAL_SEMAPHORE_BLOCK_FOREVER)) {
-        return 0;
+        return false;
     }
 
     // do we have enough samples for another pass?
-    if (!start_analysis()) {
-        uint16_t new_sample_count =  get_available_samples(_update_axis);
+    if (!start_analysis(axis)) {
         _sem.give();
-        return new_sample_count;
+        return false;
     }
 
     // take a copy of the config inside the semaphore
@@ -453,27 +511,31 @@ uint16_t AP_GyroFFT::run_cycle()
     _sem.give();
 
     uint32_t now = AP_HAL::micros();
+    AP_HAL::DSP::FFTWindowState* state = _axis_state[axis];
 
     // get the appropriate gyro buffer
-    FloatBuffer& gyro_buffer = (_sample_mode == 0 ?_ins->get_raw_gyro_window(_update_axis) : _downsampled_gyro_data[_update_axis]);
+    FloatBuffer& gyro_buffer = (_sample_mode == 0 ?_ins->get_raw_gyro_window(axis) : _downsampled_gyro_data[axis]);
     // if we have many more samples than the window size then we are struggling to 
     // stay ahead of the gyro loop so drop samples so that this cycle will use all available samples
-    if (gyro_buffer.available() > uint32_t(_state->_window_size + uint16_t(_samples_per_frame >> 1))) { // half the frame size is a heuristic
-        gyro_buffer.advance(gyro_buffer.available() - _state->_window_size);
+    if (gyro_buffer.available() > uint32_t(state->_window_size + uint16_t(_samples_per_frame >> 1))) { // half the frame size is a heuristic
+        gyro_buffer.advance(gyro_buffer.available() - state->_window_size);
     }
     // let's go!
-    hal.dsp->fft_start(_state, gyro_buffer, _samples_per_frame);
+    hal.dsp->fft_start(state, gyro_buffer, _samples_per_frame);
 
     // calculate FFT and update filters outside the semaphore
-    uint16_t bin_max = hal.dsp->fft_analyse(_state, config._fft_start_bin, config._fft_end_bin, config._attenuation_cutoff);
+    uint16_t bin_max = hal.dsp->fft_analyse(state, config._fft_start_bin, config._fft_end_bin, config._attenuation_cutoff);
 
     // something has been detected, update the peak frequency and associated metrics
-    update_ref_energy(bin_max);
-    calculate_noise(false, config);
+    update_ref_energy(axis, bin_max);
+    calculate_noise(axis, false, config);
 
     // record how we are doing
-    _thread_state._last_output_us[_update_axis] = AP_HAL::micros();
-    _output_cycle_micros = _thread_state._last_output_us[_update_axis] - now;
+    _thread_state._frame_start_us[axis] = now;
+    _thread_state._last_output_us[axis] = AP_HAL::micros();
+    if (axis == 0) {
+        _output_cycle_micros = _thread_state._last_output_us[axis] - now;
+    }
 
 #if AP_SIM_ENABLED && HAL_LOGGING_ENABLED
     // extra logging when running simulations
@@ -484,34 +546,30 @@ uint16_t AP_GyroFFT::run_cycle()
         "F----------",
         "QBfffffffff",
         AP_HAL::micros64(),
-        _update_axis,
-        _state->_peak_data[0]._freq_hz,
-        _state->_peak_data[1]._freq_hz,
-        _state->_peak_data[2]._freq_hz,
-        _state->_peak_data[0]._noise_width_hz,
-        _state->_peak_data[1]._noise_width_hz,
-        _state->_peak_data[2]._noise_width_hz,
-        _state->_freq_bins[_state->_peak_data[0]._bin],
-        _state->_freq_bins[_state->_peak_data[1]._bin],
-        _state->_freq_bins[_state->_peak_data[2]._bin]);
+        axis,
+        state->_peak_data[0]._freq_hz,
+        state->_peak_data[1]._freq_hz,
+        state->_peak_data[2]._freq_hz,
+        state->_peak_data[0]._noise_width_hz,
+        state->_peak_data[1]._noise_width_hz,
+        state->_peak_data[2]._noise_width_hz,
+        state->_freq_bins[state->_peak_data[0]._bin],
+        state->_freq_bins[state->_peak_data[1]._bin],
+        state->_freq_bins[state->_peak_data[2]._bin]);
 #endif
 
-    // move onto the next axis
-    _update_axis = (_update_axis + 1) % XYZ_AXIS_COUNT;
-
     // ready to receive another frame, because lock contention is so expensive we don't lock
     // around this flag but rather rely on the semaphore at the beginning of the loop to
     // ensure eventual visibility to the main loop
-    _thread_state._analysis_started = false;
+    _thread_state._analysis_started[axis] = false;
 
-    // samples remaining in the next axis
-    return get_available_samples(_update_axis);
+    return true;
 }
 
 // whether analysis can be run again or not
 // called from FFT thread with the semaphore held
-bool AP_GyroFFT::start_analysis() {
-    if (_thread_state._analysis_started) {
+bool AP_GyroFFT::start_analysis(uint8_t axis) {
+    if (_thread_state._analysis_started[axis]) {
         return false;
     }
     // don't run any more gyro cycles once noise is calibrated and the self-test is running
@@ -519,8 +577,8 @@ bool AP_GyroFFT::start_analysis() {
         return false;
     }
 
-    if (get_available_samples(_update_axis) >= _state->_window_size) {
-        _thread_state._analysis_started = true;
+    if (get_available_samples(axis) >= _axis_state[axis]->_window_size) {
+        _thread_state._analysis_started[axis] = true;
         return true;
     }
     return false;
@@ -557,9 +615,22 @@ void AP_GyroFFT::update_parameters(bool force)
 
 // thread for processing gyro data via FFT
 void AP_GyroFFT::update_thread(void)
+{
+    axis_thread(XYZ_AXIS_COUNT);
+}
+
+// body of the FFT threads, analysing one axis when the axes are
+// analysed concurrently or all of them in turn
+void AP_GyroFFT::axis_thread(uint8_t axis)
 {
     while (true) {
-        uint16_t remaining_samples = run_cycle();
+        uint16_t remaining_samples;
+        if (axis < XYZ_AXIS_COUNT) {
+            analyse_axis(axis);
+            remaining_samples = analysis_enabled() ? get_available_samples(axis) : 0;
+        } else {
+            remaining_samples = run_cycle();
+        }
         // this is to stop us burning CPU while waiting for samples, the reduction by _samples_per_frame is a heuristic to prevent waiting too long
         // and missing frames (easy to see in SITL because the noise will keep calibrating)
         // we always delay by at least 1us to give logging a chance to run at the same priority
@@ -585,7 +656,23 @@ bool AP_GyroFFT::start_update_thread(void)
         return true;
     }
 
-    if (!hal.scheduler->thread_create(FUNCTOR_BIND_MEMBER(&AP_GyroFFT::update_thread, void), "apm_fft", FFT_STACK_SIZE, AP_HAL::Scheduler::PRIORITY_IO, 0)) {
+    if (concurrent_axes()) {
+        // name each axis thread so they can be scheduled separately
+        const struct {
+            AP_HAL::MemberProc proc;
+            const char *name;
+        } threads[] {
+            { FUNCTOR_BIND_MEMBER(&AP_GyroFFT::update_thread_x, void), "apm_fft0" },
+            { FUNCTOR_BIND_MEMBER(&AP_GyroFFT::update_thread_y, void), "apm_fft1" },
+            { FUNCTOR_BIND_MEMBER(&AP_GyroFFT::update_thread_z, void), "apm_fft2" },
+        };
+        for (const auto &t : threads) {
+            if (!hal.scheduler->thread_create(t.proc, t.name, FFT_STACK_SIZE, AP_HAL::Scheduler::PRIORITY_IO, 0)) {
+                AP_HAL::panic("Failed to start AP_GyroFFT update thread");
+                return false;
+            }
+        }
+    } else if (!hal.scheduler->thread_create(FUNCTOR_BIND_MEMBER(&AP_GyroFFT::update_thread, void), "apm_fft", FFT_STACK_SIZE, AP_HAL::Scheduler::PRIORITY_IO, 0)) {
         AP_HAL::panic("Failed to start AP_GyroFFT update thread");
         return false;
     }
@@ -608,9 +695,11 @@ bool AP_GyroFFT::pre_arm_check(char *failure_msg, const uint8_t failure_msg_len)
     }
 
     // analysis is started in the main thread, don't trample on in-flight analysis
-    if (_global_state._analysis_started) {
-        hal.util->snprintf(failure_msg, failure_msg_len, "FFT still analyzing");
-        return false;
+    for (uint8_t axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        if (_global_state._analysis_started[axis]) {
+            hal.util->snprintf(failure_msg, failure_msg_len, "FFT still analyzing");
+            return false;
+        }
     }
 
     // still calibrating noise so not ready
@@ -976,6 +1065,17 @@ float AP_GyroFFT::calculate_weighted_freq_hz(const Vector3f& energy, const Vecto
 // @Field: FHZ: FFT health, Z-axis
 // @Field: Tc: FFT cycle time
 
+// @LoggerMessage: FTN4
+// @Description: FFT notch update latency
+// @Field: TimeUS: microseconds since system startup
+// @Field: Conc: true if the axes are analysed concurrently
+// @Field: LtX: time from the middle of the analysed window to the roll estimate being available to the notch filters
+// @Field: LtY: time from the middle of the analysed window to the pitch estimate being available to the notch filters
+// @Field: LtZ: time from the middle of the analysed window to the yaw estimate being available to the notch filters
+// @Field: TcX: time taken to analyse the last roll frame
+// @Field: TcY: time taken to analyse the last pitch frame
+// @Field: TcZ: time taken to analyse the last yaw frame
+
 #if HAL_LOGGING_ENABLED
 
 // log gyro fft messages
@@ -1008,6 +1108,19 @@ void AP_GyroFFT::write_log_messages()
         log_noise_peak(2, FrequencyPeak::UPPER_SHOULDER);
     }
 
+    AP::logger().WriteStreaming(
+        "FTN4",
+        "TimeUS,Conc,LtX,LtY,LtZ,TcX,TcY,TcZ",
+        "s-ssssss",
+        "F-FFFFFF",
+        "QBIIIIII",
+        AP_HAL::micros64(),
+        uint8_t(concurrent_axes()),
+        _notch_latency_us.x, _notch_latency_us.y, _notch_latency_us.z,
+        _global_state._last_output_us.x - _global_state._frame_start_us.x,
+        _global_state._last_output_us.y - _global_state._frame_start_us.y,
+        _global_state._last_output_us.z - _global_state._frame_start_us.z);
+
 #if DEBUG_FFT
     const uint32_t now = AP_HAL::millis();
     // output at 1hz
@@ -1077,150 +1190,150 @@ float AP_GyroFFT::get_weighted_noise_center_bandwidth_hz() const
 
 // calculate noise frequencies from FFT data provided by the HAL subsystem
 // called from FFT thread
-void AP_GyroFFT::calculate_noise(bool calibrating, const EngineConfig& config)
+void AP_GyroFFT::calculate_noise(uint8_t axis, bool calibrating, const EngineConfig& config)
 {
     // calculate the SNR and center frequency energy
     float weighted_center_freq_hz = 0.0f;
 
-    uint8_t num_peaks = calculate_tracking_peaks(weighted_center_freq_hz, calibrating, config);
+    uint8_t num_peaks = calculate_tracking_peaks(axis, weighted_center_freq_hz, calibrating, config);
 
-    _thread_state._center_freq_bin[_update_axis] = _state->_peak_data[_thread_state._center_peak[_update_axis]]._bin;
-    _thread_state._center_freq_hz[_update_axis] = weighted_center_freq_hz;
+    _thread_state._center_freq_bin[axis] = _axis_state[axis]->_peak_data[_thread_state._center_peak[axis]]._bin;
+    _thread_state._center_freq_hz[axis] = weighted_center_freq_hz;
     // record the last time we had a good signal on this axis
     if (num_peaks > 0) {
-        _thread_state._health_ms[_update_axis] = AP_HAL::millis();
+        _thread_state._health_ms[axis] = AP_HAL::millis();
     } else {
-        _thread_state._health_ms[_update_axis] = 0;
+        _thread_state._health_ms[axis] = 0;
     }
-    _thread_state._health[_update_axis] = num_peaks;
+    _thread_state._health[axis] = num_peaks;
     FrequencyPeak tracked_peak = FrequencyPeak::CENTER;
 
     // record the tracked peak for harmonic fit, but only if we have more than one noise peak
     // this checks filtered energies and so can allow energies to be closer together
-    if (num_peaks > 1 && _tracked_peaks > 1 && !is_zero(get_tl_noise_center_freq_hz(FrequencyPeak::CENTER, _update_axis))) {
-        if (get_tl_noise_center_freq_hz(FrequencyPeak::CENTER, _update_axis) > get_tl_noise_center_freq_hz(FrequencyPeak::LOWER_SHOULDER, _update_axis)
+    if (num_peaks > 1 && _tracked_peaks > 1 && !is_zero(get_tl_noise_center_freq_hz(FrequencyPeak::CENTER, axis))) {
+        if (get_tl_noise_center_freq_hz(FrequencyPeak::CENTER, axis) > get_tl_noise_center_freq_hz(FrequencyPeak::LOWER_SHOULDER, axis)
             // ignore the fit if there is too big a discrepancy between the energies
-            && get_tl_center_freq_energy(FrequencyPeak::CENTER, _update_axis) < get_tl_center_freq_energy(FrequencyPeak::LOWER_SHOULDER, _update_axis) * FFT_HARMONIC_FIT_MULT) {
+            && get_tl_center_freq_energy(FrequencyPeak::CENTER, axis) < get_tl_center_freq_energy(FrequencyPeak::LOWER_SHOULDER, axis) * FFT_HARMONIC_FIT_MULT) {
             tracked_peak = FrequencyPeak::LOWER_SHOULDER;
-        } else if (num_peaks > 2 && get_tl_noise_center_freq_hz(FrequencyPeak::CENTER, _update_axis) > get_tl_noise_center_freq_hz(FrequencyPeak::UPPER_SHOULDER, _update_axis)
+        } else if (num_peaks > 2 && get_tl_noise_center_freq_hz(FrequencyPeak::CENTER, axis) > get_tl_noise_center_freq_hz(FrequencyPeak::UPPER_SHOULDER, axis)
             // ignore the fit if there is too big a discrepancy between the energies
-            && get_tl_center_freq_energy(FrequencyPeak::CENTER, _update_axis) < get_tl_center_freq_energy(FrequencyPeak::UPPER_SHOULDER, _update_axis) * FFT_HARMONIC_FIT_MULT) {
+            && get_tl_center_freq_energy(FrequencyPeak::CENTER, axis) < get_tl_center_freq_energy(FrequencyPeak::UPPER_SHOULDER, axis) * FFT_HARMONIC_FIT_MULT) {
             tracked_peak = FrequencyPeak::UPPER_SHOULDER;
         }
     }
 
-    _thread_state._tracked_peak[_update_axis] = tracked_peak;
+    _thread_state._tracked_peak[axis] = tracked_peak;
 
     // if targetting more than one harmonic then make sure we get the fundamental
     // on larger copters the second harmonic often has more energy
     // if the highest peak is above the second highest then check for harmonic fit
     // comparisons are made using filter, normalised data
-    if (_thread_state._tracked_peak[_update_axis] != FrequencyPeak::CENTER) {
+    if (_thread_state._tracked_peak[axis] != FrequencyPeak::CENTER) {
         // calculate the fit and filter at 10hz
-        const float harmonic_fit = 100.0f * fabsf(get_tl_noise_center_freq_hz(FrequencyPeak::CENTER, _update_axis)
-            - get_tl_noise_center_freq_hz(tracked_peak, _update_axis) * _harmonic_multiplier)
-            / get_tl_noise_center_freq_hz(FrequencyPeak::CENTER, _update_axis);
+        const float harmonic_fit = 100.0f * fabsf(get_tl_noise_center_freq_hz(FrequencyPeak::CENTER, axis)
+            - get_tl_noise_center_freq_hz(tracked_peak, axis) * _harmonic_multiplier)
+            / get_tl_noise_center_freq_hz(FrequencyPeak::CENTER, axis);
 
         // calculate the fit and filter at 10hz
         if (isfinite(harmonic_fit)) {
-            _thread_state._harmonic_fit[_update_axis] = _harmonic_fit_filter[_update_axis].apply(harmonic_fit);
+            _thread_state._harmonic_fit[axis] = _harmonic_fit_filter[axis].apply(harmonic_fit);
         }
     } else {
-        _thread_state._harmonic_fit[_update_axis] = 100.0f;
+        _thread_state._harmonic_fit[axis] = 100.0f;
     }
 #if DEBUG_FFT
     WITH_SEMAPHORE(_sem);
     _debug_state = _thread_state;
-    _debug_max_freq_bin = _state->get_freq_bin(_state->_peak_data[FrequencyPeak::CENTER]._bin);
-    _debug_max_bin_freq = _state->_peak_data[FrequencyPeak::CENTER]._freq_hz;
+    _debug_max_freq_bin = _axis_state[axis]->get_freq_bin(_axis_state[axis]->_peak_data[FrequencyPeak::CENTER]._bin);
+    _debug_max_bin_freq = _axis_state[axis]->_peak_data[FrequencyPeak::CENTER]._freq_hz;
     _debug_snr = snr;
-    _debug_max_bin = _state->_peak_data[FrequencyPeak::CENTER]._bin;
+    _debug_max_bin = _axis_state[axis]->_peak_data[FrequencyPeak::CENTER]._bin;
 #endif
 }
 
 
 // calculate noise peaks based on the frequencies closest to the recent historical average, switching peaks around as necessary
-uint8_t AP_GyroFFT::calculate_tracking_peaks(float& weighted_center_freq_hz, bool calibrating, const EngineConfig& config)
+uint8_t AP_GyroFFT::calculate_tracking_peaks(uint8_t axis, float& weighted_center_freq_hz, bool calibrating, const EngineConfig& config)
 {
     uint8_t num_peaks = 0;
-    FrequencyData freqs(*this, config);
+    FrequencyData freqs(*this, axis, config);
 
     // the noise peaks are returned by the HAL in decreasing order of magnitude, however each peak can temporarily
     // switch places with another depending on a whole host of hardware and software factors
     // thus we must be able to temporarily reassign the peaks so that the filtered values track
     // a continuous frequency
     DistanceMatrix distance_matrix;
-    find_distance_matrix(distance_matrix, freqs, config);
+    find_distance_matrix(axis, distance_matrix, freqs, config);
 
     FrequencyPeak center = find_closest_peak(FrequencyPeak::CENTER, distance_matrix);
     FrequencyPeak lower = find_closest_peak(FrequencyPeak::LOWER_SHOULDER, distance_matrix, 1 << center);
     FrequencyPeak upper = find_closest_peak(FrequencyPeak::UPPER_SHOULDER, distance_matrix, 1 << center | 1 << lower);
 
     // if we have had the maximum number of swapped cycles, force a full calculation
-    if (calibrating || _distorted_cycles[_update_axis] == 0) {
-        num_peaks = calculate_tracking_peaks(weighted_center_freq_hz, freqs, config);
+    if (calibrating || _distorted_cycles[axis] == 0) {
+        num_peaks = calculate_tracking_peaks(axis, weighted_center_freq_hz, freqs, config);
 #if DEBUG_FFT
         printf("Skipped update, order would have been is %d/%.1f(%.1f) %d/%.1f(%.1f) %d/%.1f(%.1f) n = %d\n",
-            center, _state->_peak_data[center]._freq_hz, get_tl_noise_center_freq_hz(FrequencyPeak::CENTER, _update_axis),
-            lower, _state->_peak_data[lower]._freq_hz, get_tl_noise_center_freq_hz(FrequencyPeak::LOWER_SHOULDER, _update_axis),
-            upper, _state->_peak_data[upper]._freq_hz, get_tl_noise_center_freq_hz(FrequencyPeak::UPPER_SHOULDER, _update_axis), num_peaks);
+            center, _axis_state[axis]->_peak_data[center]._freq_hz, get_tl_noise_center_freq_hz(FrequencyPeak::CENTER, axis),
+            lower, _axis_state[axis]->_peak_data[lower]._freq_hz, get_tl_noise_center_freq_hz(FrequencyPeak::LOWER_SHOULDER, axis),
+            upper, _axis_state[axis]->_peak_data[upper]._freq_hz, get_tl_noise_center_freq_hz(FrequencyPeak::UPPER_SHOULDER, axis), num_peaks);
 #endif
         return num_peaks;
     }
 
     // another peak is closer to what is currently considered the center frequency
     if (center != FrequencyPeak::CENTER || lower != FrequencyPeak::LOWER_SHOULDER || upper != FrequencyPeak::UPPER_SHOULDER) {
-        if (lower != FrequencyPeak::NONE && calculate_filtered_noise(FrequencyPeak::LOWER_SHOULDER, lower, freqs, config)) {
+        if (lower != FrequencyPeak::NONE && calculate_filtered_noise(axis, FrequencyPeak::LOWER_SHOULDER, lower, freqs, config)) {
             num_peaks++;
         } else {
             lower = FrequencyPeak::NONE;
         }
-        if (upper != FrequencyPeak::NONE && calculate_filtered_noise(FrequencyPeak::UPPER_SHOULDER, upper, freqs, config)) {
+        if (upper != FrequencyPeak::NONE && calculate_filtered_noise(axis, FrequencyPeak::UPPER_SHOULDER, upper, freqs, config)) {
             num_peaks++;
         } else {
             upper = FrequencyPeak::NONE;
         }
-        if (center != FrequencyPeak::NONE && calculate_filtered_noise(FrequencyPeak::CENTER,  center, freqs, config)) {
+        if (center != FrequencyPeak::NONE && calculate_filtered_noise(axis, FrequencyPeak::CENTER,  center, freqs, config)) {
             num_peaks++;
         } else {
             center = FrequencyPeak::NONE;
         }
         weighted_center_freq_hz = freqs.get_weighted_frequency(center);
-        _thread_state._center_peak[_update_axis] = center;
-        update_snr_values(freqs);
+        _thread_state._center_peak[axis] = center;
+        update_snr_values(axis, freqs);
         // if two adjacent peaks have simply swapped, we will allow this to continue indefinitely
         // as there is no loss of fidelity
         if (!((center == FrequencyPeak::LOWER_SHOULDER && lower == FrequencyPeak::CENTER)
             || (center == FrequencyPeak::UPPER_SHOULDER && upper == FrequencyPeak::CENTER))) {
-            _distorted_cycles[_update_axis]--;
+            _distorted_cycles[axis]--;
         }
         return num_peaks;
     }
 
-    num_peaks = calculate_tracking_peaks(weighted_center_freq_hz, freqs, config);
+    num_peaks = calculate_tracking_peaks(axis, weighted_center_freq_hz, freqs, config);
 
     return num_peaks;
 }
 
 // calculate the noise and whether valid for each peak
-uint8_t AP_GyroFFT::calculate_tracking_peaks(float& weighted_center_freq_hz, const FrequencyData& freqs, const EngineConfig& config)
+uint8_t AP_GyroFFT::calculate_tracking_peaks(uint8_t axis, float& weighted_center_freq_hz, const FrequencyData& freqs, const EngineConfig& config)
 {
     uint8_t num_peaks = 0;
-    if (calculate_filtered_noise(FrequencyPeak::LOWER_SHOULDER, FrequencyPeak::LOWER_SHOULDER, freqs, config)) {
+    if (calculate_filtered_noise(axis, FrequencyPeak::LOWER_SHOULDER, FrequencyPeak::LOWER_SHOULDER, freqs, config)) {
         num_peaks++;
     }
-    if (calculate_filtered_noise(FrequencyPeak::UPPER_SHOULDER, FrequencyPeak::UPPER_SHOULDER, freqs, config)) {
+    if (calculate_filtered_noise(axis, FrequencyPeak::UPPER_SHOULDER, FrequencyPeak::UPPER_SHOULDER, freqs, config)) {
         num_peaks++;
     }
-    if (calculate_filtered_noise(FrequencyPeak::CENTER, FrequencyPeak::CENTER, freqs, config)) {
+    if (calculate_filtered_noise(axis, FrequencyPeak::CENTER, FrequencyPeak::CENTER, freqs, config)) {
         num_peaks++;
     }
     // record the number of cycles where something was tracked
-    _distorted_cycles[_update_axis] = constrain_int16(_distorted_cycles[_update_axis] + 1, 0, FFT_MAX_MISSED_UPDATES);
+    _distorted_cycles[axis] = constrain_int16(_distorted_cycles[axis] + 1, 0, FFT_MAX_MISSED_UPDATES);
     weighted_center_freq_hz = freqs.get_weighted_frequency(FrequencyPeak::CENTER);
-    _thread_state._center_peak[_update_axis] = FrequencyPeak::CENTER;
+    _thread_state._center_peak[axis] = FrequencyPeak::CENTER;
 
-    update_snr_values(freqs);
+    update_snr_values(axis, freqs);
 
     return num_peaks;
 }
@@ -1228,50 +1341,50 @@ uint8_t AP_GyroFFT::calculate_tracking_peaks(float& weighted_center_freq_hz, con
 // calculate noise frequencies from FFT data provided by the HAL subsystem
 // target_peak is the filtered record we want to apply the new fft data to, source peak is where the fft data is coming from
 // called from FFT thread
-bool AP_GyroFFT::calculate_filtered_noise(FrequencyPeak target_peak, FrequencyPeak source_peak, const FrequencyData& freqs, const EngineConfig& config)
+bool AP_GyroFFT::calculate_filtered_noise(uint8_t axis, FrequencyPeak target_peak, FrequencyPeak source_peak, const FrequencyData& freqs, const EngineConfig& config)
 {
     if (source_peak > FrequencyPeak::MAX_TRACKED_PEAKS) {
         // if we failed to find a signal, carry on using the previous readings
-        if (_missed_cycles[_update_axis][target_peak]++ < FFT_MAX_MISSED_UPDATES) {
+        if (_missed_cycles[axis][target_peak]++ < FFT_MAX_MISSED_UPDATES) {
             return true; // the peak is synthetic
         }
-        update_tl_center_freq_energy(target_peak, _update_axis, 0.0f);
-        update_tl_noise_center_bandwidth_hz(target_peak, _update_axis, _bandwidth_hover_hz);
-        update_tl_noise_center_freq_hz(target_peak, _update_axis, config._fft_min_hz);
+        update_tl_center_freq_energy(target_peak, axis, 0.0f);
+        update_tl_noise_center_bandwidth_hz(target_peak, axis, _bandwidth_hover_hz);
+        update_tl_noise_center_freq_hz(target_peak, axis, config._fft_min_hz);
         return false;
     }
 
-    AP_HAL::DSP::FrequencyPeakData* peak_data = &_state->_peak_data[source_peak];
+    AP_HAL::DSP::FrequencyPeakData* peak_data = &_axis_state[axis]->_peak_data[source_peak];
 
     const uint16_t nb = peak_data->_bin;
 
     if (freqs.is_valid(FrequencyPeak(source_peak))) {
         // total peak energy requires an integration, as an approximation use amplitude * noise width * 5/6
-        update_tl_center_freq_energy(target_peak, _update_axis, _state->get_freq_bin(nb) * peak_data->_noise_width_hz * 0.8333f);
-        update_tl_noise_center_bandwidth_hz(target_peak, _update_axis, peak_data->_noise_width_hz);
-        update_tl_noise_center_freq_hz(target_peak, _update_axis, freqs.get_weighted_frequency(FrequencyPeak(source_peak)));
-        _missed_cycles[_update_axis][target_peak] = 0;
+        update_tl_center_freq_energy(target_peak, axis, _axis_state[axis]->get_freq_bin(nb) * peak_data->_noise_width_hz * 0.8333f);
+        update_tl_noise_center_bandwidth_hz(target_peak, axis, peak_data->_noise_width_hz);
+        update_tl_noise_center_freq_hz(target_peak, axis, freqs.get_weighted_frequency(FrequencyPeak(source_peak)));
+        _missed_cycles[axis][target_peak] = 0;
         return true;
     }
 
     // if we failed to find a signal, carry on using the previous readings
-    if (_missed_cycles[_update_axis][target_peak]++ < FFT_MAX_MISSED_UPDATES) {
+    if (_missed_cycles[axis][target_peak]++ < FFT_MAX_MISSED_UPDATES) {
         return true; // the peak is synthetic
     }
 
     // we failed to find a signal for more than FFT_MAX_MISSED_UPDATES cycles
-    update_tl_center_freq_energy(target_peak, _update_axis, _state->get_freq_bin(nb) * peak_data->_noise_width_hz * 0.8333f);     // use the actual energy detected rather than 0
-    update_tl_noise_center_bandwidth_hz(target_peak, _update_axis, _bandwidth_hover_hz);
-    update_tl_noise_center_freq_hz(target_peak, _update_axis, config._fft_min_hz);
+    update_tl_center_freq_energy(target_peak, axis, _axis_state[axis]->get_freq_bin(nb) * peak_data->_noise_width_hz * 0.8333f);     // use the actual energy detected rather than 0
+    update_tl_noise_center_bandwidth_hz(target_peak, axis, _bandwidth_hover_hz);
+    update_tl_noise_center_freq_hz(target_peak, axis, config._fft_min_hz);
 
     return false;
 }
 
-void AP_GyroFFT::update_snr_values(const FrequencyData& freqs)
+void AP_GyroFFT::update_snr_values(uint8_t axis, const FrequencyData& freqs)
 {
-    _thread_state._center_freq_snr[FrequencyPeak::CENTER][_update_axis] = freqs.get_signal_to_noise(FrequencyPeak::CENTER);
-    _thread_state._center_freq_snr[FrequencyPeak::LOWER_SHOULDER][_update_axis] = freqs.get_signal_to_noise(FrequencyPeak::LOWER_SHOULDER);
-    _thread_state._center_freq_snr[FrequencyPeak::UPPER_SHOULDER][_update_axis] = freqs.get_signal_to_noise(FrequencyPeak::UPPER_SHOULDER);
+    _thread_state._center_freq_snr[FrequencyPeak::CENTER][axis] = freqs.get_signal_to_noise(FrequencyPeak::CENTER);
+    _thread_state._center_freq_snr[FrequencyPeak::LOWER_SHOULDER][axis] = freqs.get_signal_to_noise(FrequencyPeak::LOWER_SHOULDER);
+    _thread_state._center_freq_snr[FrequencyPeak::UPPER_SHOULDER][axis] = freqs.get_signal_to_noise(FrequencyPeak::UPPER_SHOULDER);
 }
 
 
@@ -1289,27 +1402,27 @@ float AP_GyroFFT::MedianLowPassFilter3dFloat::apply(uint8_t axis, float sample)
 }
 
 // initialize a FrequencyData structure with peak frequency information for use in the swapping algorithm
-AP_GyroFFT::FrequencyData::FrequencyData(const AP_GyroFFT& gyrofft, const EngineConfig& config)
+AP_GyroFFT::FrequencyData::FrequencyData(const AP_GyroFFT& gyrofft, uint8_t axis, const EngineConfig& config)
 {
     for (uint8_t i = 0; i < FrequencyPeak::MAX_TRACKED_PEAKS; i++) {
-        valid[i] = gyrofft.get_weighted_frequency(FrequencyPeak(i), frequency[i], snr[i], config);
+        valid[i] = gyrofft.get_weighted_frequency(axis, FrequencyPeak(i), frequency[i], snr[i], config);
     }
 }
 
 // calculate noise frequencies from FFT data provided by the HAL subsystem
-bool AP_GyroFFT::get_weighted_frequency(FrequencyPeak peak, float& weighted_peak_freq_hz, float& snr, const EngineConfig& config) const
+bool AP_GyroFFT::get_weighted_frequency(uint8_t axis, FrequencyPeak peak, float& weighted_peak_freq_hz, float& snr, const EngineConfig& config) const
 {
-    AP_HAL::DSP::FrequencyPeakData* peak_data = &_state->_peak_data[peak];
+    AP_HAL::DSP::FrequencyPeakData* peak_data = &_axis_state[axis]->_peak_data[peak];
 
     const uint16_t bin = peak_data->_bin;
 
     // calculate the SNR and center frequency energy
-    const float max_energy = MAX(1.0f, _state->get_freq_bin(bin));
-    const float ref_energy = MAX(1.0f, _ref_energy[bin][_update_axis]);
+    const float max_energy = MAX(1.0f, _axis_state[axis]->get_freq_bin(bin));
+    const float ref_energy = MAX(1.0f, _ref_energy[bin][axis]);
     snr = 10.f * (log10f(max_energy) - log10f(ref_energy));
 
     // if the bin energy is above the noise threshold then we have a signal
-    if (!_thread_state._noise_needs_calibration && isfinite(_state->get_freq_bin(bin)) && snr > config._snr_threshold_db) {
+    if (!_thread_state._noise_needs_calibration && isfinite(_axis_state[axis]->get_freq_bin(bin)) && snr > config._snr_threshold_db) {
         weighted_peak_freq_hz = constrain_float(peak_data->_freq_hz, (float)config._fft_min_hz, (float)config._fft_max_hz);
         return true;
     }
@@ -1320,12 +1433,12 @@ bool AP_GyroFFT::get_weighted_frequency(FrequencyPeak peak, float& weighted_peak
 }
 
 // calculate a matrix of distances between the current filtered estimates and instantaneous values from the current cycle
-void AP_GyroFFT::find_distance_matrix(DistanceMatrix& distance_matrix, const FrequencyData& freqs, const EngineConfig& config) const
+void AP_GyroFFT::find_distance_matrix(uint8_t axis, DistanceMatrix& distance_matrix, const FrequencyData& freqs, const EngineConfig& config) const
 {
     float curr_freqs[FrequencyPeak::MAX_TRACKED_PEAKS];
     // get the current frequency estimate for all peaks
     for (uint8_t i = 0; i < FrequencyPeak::MAX_TRACKED_PEAKS; i++) {
-        curr_freqs[i] = get_tl_noise_center_freq_hz(FrequencyPeak(i), _update_axis);
+        curr_freqs[i] = get_tl_noise_center_freq_hz(FrequencyPeak(i), axis);
     }
     // calculate the matrix
     for (uint8_t i = 0; i < FrequencyPeak::MAX_TRACKED_PEAKS; i++) {
@@ -1355,7 +1468,7 @@ AP_GyroFFT::FrequencyPeak AP_GyroFFT::find_closest_peak(const FrequencyPeak targ
 
 // calculate noise baseline from FFT data provided by the HAL subsystem
 // called from FFT thread
-void AP_GyroFFT::update_ref_energy(uint16_t max_bin)
+void AP_GyroFFT::update_ref_energy(uint8_t axis, uint16_t max_bin)
 {
     if (!_thread_state._noise_needs_calibration) {
         return;
@@ -1363,23 +1476,23 @@ void AP_GyroFFT::update_ref_energy(uint16_t max_bin)
 
     // according to https://www.tcd.ie/Physics/research/groups/magnetism/files/lectures/py5021/MagneticSensors3.pdf sensor noise is not necessarily gaussian
     // determine a PS noise reference at each of the possible center frequencies
-    if (_noise_cycles == 0 && _noise_calibration_cycles[_update_axis] > 0) {
-        for (uint16_t i = 1; i < _state->_bin_count; i++) {
-            _ref_energy[i][_update_axis] += _state->get_freq_bin(i);
+    if (_noise_cycles[axis] == 0 && _noise_calibration_cycles[axis] > 0) {
+        for (uint16_t i = 1; i < _axis_state[axis]->_bin_count; i++) {
+            _ref_energy[i][axis] += _axis_state[axis]->get_freq_bin(i);
         }
-        if (--_noise_calibration_cycles[_update_axis] == 0) {
-            for (uint16_t i = 1; i < _state->_bin_count; i++) {
+        if (--_noise_calibration_cycles[axis] == 0) {
+            for (uint16_t i = 1; i < _axis_state[axis]->_bin_count; i++) {
                 const float cycles = (static_cast<float>(_window_size) / static_cast<float>(_samples_per_frame)) * 2;
                 // overall random noise is reduced by sqrt(N) when averaging periodigrams so adjust for that
-                _ref_energy[i][_update_axis] = (_ref_energy[i][_update_axis] / cycles) * sqrtf(cycles);
+                _ref_energy[i][axis] = (_ref_energy[i][axis] / cycles) * sqrtf(cycles);
             }
 
             WITH_SEMAPHORE(_sem);
-            _thread_state._noise_needs_calibration &= ~(1 << _update_axis);
+            _thread_state._noise_needs_calibration &= ~(1 << axis);
         }
     }
-    else if (_noise_cycles > 0) {
-        _noise_cycles--;
+    else if (_noise_cycles[axis] > 0) {
+        _noise_cycles[axis]--;
     }
 }
 
@@ -1437,7 +1550,7 @@ float AP_GyroFFT::self_test(float frequency, FloatBuffer& test_window)
         GCS_SEND_TEXT(MAV_SEVERITY_WARNING, "FFT: self-test failed, failed to find frequency %.1f", frequency);
     }
 
-    calculate_noise(true, _config);
+    calculate_noise(0, true, _config);
 
     float max_divergence = 0;
     // make sure the selected frequencies are in the right bin
@@ -30,6 +30,11 @@
 
 #define DEBUG_FFT   0
 
+// analysing all axes concurrently needs a core per axis to pay off
+#ifndef AP_GYROFFT_CONCURRENT_ENABLED
+#define AP_GYROFFT_CONCURRENT_ENABLED (CONFIG_HAL_BOARD == HAL_BOARD_LINUX || CONFIG_HAL_BOARD == HAL_BOARD_SITL)
+#endif
+
 // a library that leverages the HAL DSP support to perform FFT analysis on gyro samples
 class AP_GyroFFT
 {
@@ -40,7 +45,8 @@ public:
 
     enum class Options : uint32_t {
         FFTPostFilter = 1 << 0,
-        ESCNoiseCheck = 1 << 1
+        ESCNoiseCheck = 1 << 1,
+        ConcurrentAxes = 1 << 2,
     };
 
     AP_GyroFFT();
@@ -60,6 +66,10 @@ public:
     void update_parameters() { update_parameters(false); }
     // thread for processing gyro data via FFT
     void update_thread();
+    // threads for processing one axis each when analysing concurrently
+    void update_thread_x() { axis_thread(0); }
+    void update_thread_y() { axis_thread(1); }
+    void update_thread_z() { axis_thread(2); }
     // start the update thread
     bool start_update_thread();
     // is the subsystem enabled
@@ -111,6 +121,8 @@ public:
     bool using_post_filter_samples() const { return (_options & uint32_t(Options::FFTPostFilter)) != 0; }
     // post filter mask of IMUs
     bool check_esc_noise() const { return (_options & uint32_t(Options::ESCNoiseCheck)) != 0; }
+    // whether each axis is analysed in its own thread
+    bool concurrent_axes() const { return _num_threads > 1; }
     // look for a frequency in the detected noise
     float has_noise_at_frequency_hz(float freq) const;
     static float calculate_notch_frequency(float* freqs, uint16_t numpeaks, float harmonic_fit, uint8_t& harmonics);
@@ -164,7 +176,7 @@ private:
     // structure for holding noise peak data while calculating swaps
     class FrequencyData {
     public:
-        FrequencyData(const AP_GyroFFT& gyrofft, const EngineConfig& config);
+        FrequencyData(const AP_GyroFFT& gyrofft, uint8_t axis, const EngineConfig& config);
         float get_weighted_frequency(FrequencyPeak i) const { return frequency[i]; }
         float get_signal_to_noise(FrequencyPeak i) const { return snr[i]; }
         bool is_valid(FrequencyPeak i) const { return valid[i]; }
@@ -192,26 +204,30 @@ private:
     }
     // write single log messages
     void log_noise_peak(uint8_t id, FrequencyPeak peak) const;
+    // analyse a frame of gyro data on one axis if one is ready, returns true if a frame was analysed
+    bool analyse_axis(uint8_t axis);
+    // analyse axis, or all axes in turn if axis is XYZ_AXIS_COUNT, forever
+    void axis_thread(uint8_t axis);
     // calculate the peak noise frequency
-    void calculate_noise(bool calibrating, const EngineConfig& config);
+    void calculate_noise(uint8_t axis, bool calibrating, const EngineConfig& config);
     // calculate noise peaks based on energy and history
-    uint8_t calculate_tracking_peaks(float& weighted_peak_freq_hz, bool calibrating, const EngineConfig& config);
-    uint8_t calculate_tracking_peaks(float& weighted_center_freq_hz, const FrequencyData& freqs, const EngineConfig& config);
+    uint8_t calculate_tracking_peaks(uint8_t axis, float& weighted_peak_freq_hz, bool calibrating, const EngineConfig& config);
+    uint8_t calculate_tracking_peaks(uint8_t axis, float& weighted_center_freq_hz, const FrequencyData& freqs, const EngineConfig& config);
     // calculate noise peak frequency characteristics
-    bool calculate_filtered_noise(FrequencyPeak target_peak, FrequencyPeak source_peak, const FrequencyData& freqs, const EngineConfig& config);
-    void update_snr_values(const FrequencyData& freqs);
+    bool calculate_filtered_noise(uint8_t axis, FrequencyPeak target_peak, FrequencyPeak source_peak, const FrequencyData& freqs, const EngineConfig& config);
+    void update_snr_values(uint8_t axis, const FrequencyData& freqs);
     // get the weighted frequency
-    bool get_weighted_frequency(FrequencyPeak peak, float& weighted_peak_freq_hz, float& snr, const EngineConfig& config) const;
+    bool get_weighted_frequency(uint8_t axis, FrequencyPeak peak, float& weighted_peak_freq_hz, float& snr, const EngineConfig& config) const;
     // return the tracked noise peak
     FrequencyPeak get_tracked_noise_peak() const;
     // calculate the distance matrix between the current estimates and the current cycle
-    void find_distance_matrix(DistanceMatrix& distance_matrix, const FrequencyData& freqs, const EngineConfig& config) const;
+    void find_distance_matrix(uint8_t axis, DistanceMatrix& distance_matrix, const FrequencyData& freqs, const EngineConfig& config) const;
     // return the instantaneous peak that is closest to the target estimate peak
     FrequencyPeak find_closest_peak(const FrequencyPeak target, const DistanceMatrix& distance_matrix, uint8_t ignore = 0) const;
     // detected peak frequency weighted by energy
     float calculate_weighted_freq_hz(const Vector3f& energy, const Vector3f& freq) const;
     // update the estimation of the background noise energy
-    void update_ref_energy(uint16_t max_bin);
+    void update_ref_energy(uint8_t axis, uint16_t max_bin);
     // test frequency detection for all of the allowable bins
     float self_test_bin_frequencies();
     // detect the provided frequency
@@ -219,7 +235,7 @@ private:
     // whether to run analysis or not
     bool analysis_enabled() const { return _initialized && _analysis_enabled && _thread_created; };
     // whether analysis can be run again or not
-    bool start_analysis();
+    bool start_analysis(uint8_t axis);
     // return samples available in the gyro window
     uint16_t get_available_samples(uint8_t axis) {
         return _sample_mode == 0 ?_ins->get_raw_gyro_window(axis).available() : _downsampled_gyro_data[axis].available();
@@ -253,14 +269,16 @@ private:
         Vector3f _center_freq_hz_filtered[FrequencyPeak::MAX_TRACKED_PEAKS];
         // when we last calculated a value
         Vector3ul _last_output_us;
+        // when the analysis that produced the last value started
+        Vector3ul _frame_start_us;
         // filtered energy of the detected peak frequency
         Vector3f _center_freq_energy_filtered[FrequencyPeak::MAX_TRACKED_PEAKS];
         // filtered detected peak width
         Vector3f _center_bandwidth_hz_filtered[FrequencyPeak::MAX_TRACKED_PEAKS];
         // axes that still require noise calibration
         uint8_t _noise_needs_calibration : 3;
-        // whether the analyzer is mid-cycle
-        bool _analysis_started;
+        // whether the analyzer is mid-cycle on each axis
+        bool _analysis_started[XYZ_AXIS_COUNT];
     };
 
     // Shared FFT engine state local to the FFT thread
@@ -272,8 +290,13 @@ private:
     uint16_t _samples_per_frame;
     // number of ms that a frame should take to process to sustain output rate
     uint16_t _frame_time_ms;
-    // last cycle time
+    // last cycle time of the X axis, written only by the thread analysing it
     uint32_t _output_cycle_micros;
+    // time from the middle of the analysed window to the estimate being
+    // available to the notch filters, per axis
+    Vector3ul _notch_latency_us;
+    // half the duration of the FFT window
+    uint32_t _window_delay_us;
     // downsampled gyro data circular buffer for frequency analysis
     FloatBuffer _downsampled_gyro_data[XYZ_AXIS_COUNT];
     // accumulator for sampled gyro data
@@ -283,12 +306,16 @@ private:
 
     // state of the FFT engine
     AP_HAL::DSP::FFTWindowState* _state;
+    // state of the FFT engine used for each axis, all are _state unless the axes are analysed concurrently
+    AP_HAL::DSP::FFTWindowState* _axis_state[XYZ_AXIS_COUNT];
     // update state machine step information
     uint8_t _update_axis;
+    // number of FFT threads, one per axis when analysing concurrently
+    uint8_t _num_threads;
     // noise base of the gyros
     Vector3f* _ref_energy;
     // the number of cycles required to have a proper noise reference
-    uint16_t _noise_cycles;
+    uint16_t _noise_cycles[XYZ_AXIS_COUNT];
     // number of cycles over which to generate noise ensemble averages
     uint16_t _noise_calibration_cycles[XYZ_AXIS_COUNT];
     // current _sample_mode
@@ -0,0 +1,119 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_HAL/utility/RealFFT.h>
+#include <AP_Math/AP_Math.h>
+
+#include <complex>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+#if AP_HAL_REALFFT_ENABLED
+
+typedef std::complex<float> complexf;
+
+/*
+  the in-place complex Cooley–Tukey FFT that the SITL DSP used before
+  RealFFT, for comparison. The CMSIS path only runs on ARM so can't be
+  benchmarked here
+ */
+static void generic_fft(complexf *samples, uint16_t fftlen)
+{
+    uint16_t m = 0;
+    while ((1U << m) < fftlen) {
+        m++;
+    }
+    for (uint16_t k = 0; k < fftlen; k++) {
+        uint16_t ki = k, kr = 0;
+        for (uint16_t i=1; i<=m; i++) {
+            kr <<= 1;
+            if (ki % 2 == 1) {
+                kr++;
+            }
+            ki >>= 1;
+        }
+        if (kr > k) {
+            complexf t = samples[kr];
+            samples[kr] = samples[k];
+            samples[k] = t;
+        }
+    }
+
+    uint16_t istep = 2;
+    while (istep <= fftlen) {
+        uint16_t is2 = istep / 2;
+        uint16_t astep = fftlen / istep;
+        for (uint16_t km = 0; km < is2; km++) {
+            uint16_t a  = km * astep;
+            complexf w(sinf(2 * M_PI * (a+(fftlen/4)) / fftlen), sinf(2 * M_PI * a / fftlen));
+            for (uint16_t ki = 0; ki <= (fftlen - istep); ki += istep) {
+                uint16_t i = km + ki;
+                uint16_t j = is2 + i;
+                complexf t = w * samples[j];
+                complexf q = samples[i];
+                samples[j] = q - t;
+                samples[i] = q + t;
+            }
+        }
+        istep <<= 1;
+    }
+}
+
+static void fill(float *v, uint16_t length)
+{
+    for (uint16_t i = 0; i < length; i++) {
+        v[i] = sinf(0.3f * i) + 0.5f * cosf(1.7f * i);
+    }
+}
+
+static void BM_RealFFT(benchmark::State& state)
+{
+    const uint16_t length = state.range(0);
+    RealFFT rfft;
+    rfft.init(length);
+    float *input = new float[length];
+    float *output = new float[length + 2];
+    float *power = new float[length / 2];
+    fill(input, length);
+
+    while (state.KeepRunning()) {
+        rfft.transform(input, output, power);
+        gbenchmark_escape(output);
+        gbenchmark_escape(power);
+    }
+
+    delete[] input;
+    delete[] output;
+    delete[] power;
+}
+
+static void BM_GenericFFT(benchmark::State& state)
+{
+    const uint16_t length = state.range(0);
+    float *input = new float[length];
+    complexf *buf = new complexf[length];
+    float *power = new float[length / 2];
+    fill(input, length);
+
+    while (state.KeepRunning()) {
+        for (uint16_t i = 0; i < length; i++) {
+            buf[i] = complexf(input[i], 0);
+        }
+        generic_fft(buf, length);
+        for (uint16_t i = 0; i < length / 2; i++) {
+            power[i] = std::norm(buf[i]);
+        }
+        gbenchmark_escape(buf);
+        gbenchmark_escape(power);
+    }
+
+    delete[] input;
+    delete[] buf;
+    delete[] power;
+}
+
+BENCHMARK(BM_RealFFT)->RangeMultiplier(2)->Range(32, 2048);
+BENCHMARK(BM_GenericFFT)->RangeMultiplier(2)->Range(32, 2048);
+
+#endif // AP_HAL_REALFFT_ENABLED
+
+BENCHMARK_MAIN();
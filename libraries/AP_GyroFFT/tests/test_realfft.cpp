@@ -0,0 +1,61 @@
+#include <AP_gtest.h>
+#include <AP_HAL/utility/RealFFT.h>
+#include <AP_Math/AP_Math.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+#if AP_HAL_REALFFT_ENABLED
+
+/*
+  check RealFFT against a direct double precision DFT for all the
+  window sizes that AP_GyroFFT allows
+ */
+TEST(RealFFTTest, MatchesDFT)
+{
+    for (uint16_t length = 8; length <= 2048; length *= 2) {
+        RealFFT rfft;
+        ASSERT_TRUE(rfft.init(length));
+        EXPECT_EQ(rfft.length(), length);
+
+        float *input = new float[length];
+        float *output = new float[length + 2];
+        float *power = new float[length / 2];
+        for (uint16_t i = 0; i < length; i++) {
+            input[i] = sinf(0.3f * i) + 0.5f * cosf(1.7f * i) + 0.1f * (i % 5);
+        }
+        rfft.transform(input, output, power);
+
+        double max_mag = 0;
+        double max_err = 0;
+        for (uint16_t k = 0; k <= length / 2; k++) {
+            double re = 0, im = 0;
+            for (uint16_t n = 0; n < length; n++) {
+                const double angle = -2 * M_PI * k * n / length;
+                re += input[n] * cos(angle);
+                im += input[n] * sin(angle);
+            }
+            max_mag = MAX(max_mag, sqrt(re * re + im * im));
+            max_err = MAX(max_err, fabs(output[2*k] - re));
+            max_err = MAX(max_err, fabs(output[2*k + 1] - im));
+            if (k < length / 2) {
+                EXPECT_NEAR(power[k], output[2*k] * output[2*k] + output[2*k + 1] * output[2*k + 1], 1.0e-3 * (1 + power[k]));
+            }
+        }
+        EXPECT_LT(max_err, 1.0e-5 * max_mag);
+
+        delete[] input;
+        delete[] output;
+        delete[] power;
+    }
+}
+
+TEST(RealFFTTest, BadLength)
+{
+    RealFFT rfft;
+    EXPECT_FALSE(rfft.init(4));
+    EXPECT_FALSE(rfft.init(100));
+}
+
+#endif // AP_HAL_REALFFT_ENABLED
+
+AP_GTEST_MAIN()
@@ -103,6 +103,36 @@ int16_t AP_HAL::CANIface::send(const CANFrame& frame, uint64_t tx_deadline, CanI
     return 1;
 }
 
+/*
+  send a batch of frames one at a time through the child class send()
+ */
+int16_t AP_HAL::CANIface::send_batch(const CanTxRequest* requests, uint16_t count)
+{
+    for (uint16_t i=0; i<count; i++) {
+        const int16_t res = send(requests[i].frame, requests[i].deadline, requests[i].flags);
+        if (res <= 0) {
+            return i > 0 ? i : res;
+        }
+    }
+    return count;
+}
+
+/*
+  receive a batch of frames one at a time through the child class receive()
+ */
+int16_t AP_HAL::CANIface::receive_batch(CanRxItem* items, uint16_t max_items)
+{
+    for (uint16_t i=0; i<max_items; i++) {
+        CanRxItem &item = items[i];
+        item.flags = 0;
+        const int16_t res = receive(item.frame, item.timestamp_us, item.flags);
+        if (res <= 0) {
+            return i > 0 ? i : res;
+        }
+    }
+    return max_items;
+}
+
 /*
   register a callback for for sending CAN_FRAME messages.
   On success the returned callback_id can be used to unregister the callback
@@ -158,6 +158,13 @@ public:
         }
     };
 
+    // Single frame to be sent with send_batch()
+    struct CanTxRequest {
+        CANFrame frame;
+        uint64_t deadline = 0;
+        CanIOFlags flags = 0;
+    };
+
     struct CanFilterConfig {
         uint32_t id = 0;
         uint32_t mask = 0;
@@ -201,6 +208,18 @@ public:
     // must be called on child class
     virtual int16_t receive(CANFrame& out_frame, uint64_t& out_ts_monotonic, CanIOFlags& out_flags);
 
+    // Put frames in queue to be sent in order, stopping at the first frame that
+    // could not be queued. Returns negative if an error occurred on the first frame,
+    // otherwise the number of frames queued. The default implementation calls send()
+    // for each frame, interfaces that can queue several frames more cheaply than
+    // that should override it
+    virtual int16_t send_batch(const CanTxRequest* requests, uint16_t count);
+
+    // Non blocking receive of up to max_items frames, returns negative if error occurred
+    // before any frame was received, otherwise the number of frames received. The default
+    // implementation calls receive() for each frame
+    virtual int16_t receive_batch(CanRxItem* items, uint16_t max_items);
+
     //Configure filters so as to reject frames that are not going to be handled by us
     virtual bool configureFilters(const CanFilterConfig* filter_configs, uint16_t num_configs)
     {
@@ -191,6 +191,38 @@ bool AP_HAL::Device::read_registers(uint8_t first_reg, uint8_t *recv, uint32_t r
     return result;
 }
 
+bool AP_HAL::Device::read_registers_list(const uint8_t *first_regs, uint8_t *const *recv,
+                                         const uint32_t *recv_len, uint8_t count)
+{
+    if (count > TRANSFER_LIST_MAX) {
+        return false;
+    }
+    uint8_t regs[TRANSFER_LIST_MAX];
+    Transfer transfers[TRANSFER_LIST_MAX];
+    for (uint8_t i = 0; i < count; i++) {
+        regs[i] = first_regs[i] | _read_flag;
+        transfers[i] = Transfer{&regs[i], 1, recv[i], recv_len[i]};
+    }
+    const bool result = transfer_list(transfers, count);
+    if (_register_rw_callback != nullptr && result) {
+        for (uint8_t i = 0; i < count; i++) {
+            _register_rw_callback(first_regs[i], recv[i], recv_len[i], false);
+        }
+    }
+    return result;
+}
+
+bool AP_HAL::Device::transfer_list(const Transfer *transfers, uint8_t count)
+{
+    for (uint8_t i = 0; i < count; i++) {
+        const Transfer &t = transfers[i];
+        if (!transfer(t.send, t.send_len, t.recv, t.recv_len)) {
+            return false;
+        }
+    }
+    return true;
+}
+
 bool AP_HAL::Device::transfer_bank(uint8_t bank, const uint8_t *send, uint32_t send_len,
                         uint8_t *recv, uint32_t recv_len)
 {
@@ -68,6 +68,16 @@ public:
 
     FUNCTOR_TYPEDEF(BankSelectCb, bool, uint8_t);
 
+    /*
+     * One entry in a transaction list, see #transfer_list()
+     */
+    struct Transfer {
+        const uint8_t *send;
+        uint32_t send_len;
+        uint8_t *recv;
+        uint32_t recv_len;
+    };
+
     Device(enum BusType type)
     {
         _bus_id.devid_s.bus_type = type;
@@ -124,6 +134,17 @@ public:
     virtual bool transfer(const uint8_t *send, uint32_t send_len,
                           uint8_t *recv, uint32_t recv_len) = 0;
 
+    /*
+     * Perform a list of transfers, each one a separate bus transaction
+     * as done by #transfer(). Backends that can queue several
+     * transactions behind a single bus operation override this to save
+     * the per transfer overhead. The default performs them one at a
+     * time.
+     *
+     * Return: true if all transfers were successful, false on the first
+     * failure.
+     */
+    virtual bool transfer_list(const Transfer *transfers, uint8_t count);
 
     /*
      * Sets the required flags before transaction starts
@@ -149,6 +170,18 @@ public:
      */
     bool read_registers(uint8_t first_reg, uint8_t *recv, uint32_t recv_len);
 
+    /**
+     * Wrapper function over #transfer_list() to read several blocks of
+     * registers in one go. Block i is read as #read_registers() would with
+     * first_regs[i], into recv[i] for recv_len[i] bytes. At most
+     * TRANSFER_LIST_MAX blocks can be read.
+     *
+     * Return: true on a successful transfer, false on failure.
+     */
+    bool read_registers_list(const uint8_t *first_regs, uint8_t *const *recv,
+                             const uint32_t *recv_len, uint8_t count);
+    static const uint8_t TRANSFER_LIST_MAX = 16;
+
     /**
      * Wrapper function over #transfer() to write a byte to the register reg.
      * The transfer is done by sending reg and val in that order.
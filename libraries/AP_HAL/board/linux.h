@@ -38,6 +38,7 @@
     #endif
     #define HAL_BARO_PROBE_LIST PROBE_BARO_SPI(MS56XX, "ms5611")
     #define HAL_MAG_PROBE_LIST PROBE_MAG_IMU(AK8963, mpu9250, 0, ROTATION_NONE)
+    #define HAL_MAG_PROBE_USES_INS 1
     #define HAL_PROBE_EXTERNAL_I2C_COMPASSES
     #define AP_NOTIFY_GPIO_LED_3_ENABLED 1
     #define HAL_GPIO_A_LED_PIN        61
@@ -136,6 +137,7 @@
     #define HAL_INS_PROBE_LIST PROBE_IMU_SPI(Invensense, "mpu9250", ROTATION_NONE)
     #define HAL_BARO_PROBE_LIST PROBE_BARO_I2C(MS56XX, 1, 0x77)
     #define HAL_MAG_PROBE_LIST PROBE_MAG_IMU(AK8963, mpu9250, 0, ROTATION_NONE)
+    #define HAL_MAG_PROBE_USES_INS 1
     #define HAL_PROBE_EXTERNAL_I2C_COMPASSES
 #elif CONFIG_HAL_BOARD_SUBTYPE == HAL_BOARD_SUBTYPE_LINUX_NAVIO2
     #define HAL_HAVE_SERVO_VOLTAGE 1
@@ -143,6 +145,7 @@
     #define HAL_BARO_PROBE_LIST PROBE_BARO_I2C(MS56XX, 1, 0x77)
     #define HAL_MAG_PROBE1 PROBE_MAG_SPI(LSM9DS1, "lsm9ds1_m",  ROTATION_ROLL_180)
     #define HAL_MAG_PROBE2 PROBE_MAG_IMU(AK8963, mpu9250, 0, ROTATION_NONE)
+    #define HAL_MAG_PROBE_USES_INS 1
     #define HAL_MAG_PROBE_LIST HAL_MAG_PROBE1; HAL_MAG_PROBE2
     #define HAL_PROBE_EXTERNAL_I2C_COMPASSES
     #define AP_NOTIFY_SYSFS_LED_ENABLED 1
@@ -151,6 +154,7 @@
     #define HAL_INS_PROBE_LIST PROBE_IMU_SPI(Invensense, "mpu9250", ROTATION_YAW_270)
     #define HAL_BARO_PROBE_LIST PROBE_BARO_SPI(MS56XX, "ms5611")
     #define HAL_MAG_PROBE_LIST PROBE_MAG_IMU(AK8963, mpu9250, 0, ROTATION_NONE)
+    #define HAL_MAG_PROBE_USES_INS 1
     #define HAL_PROBE_EXTERNAL_I2C_COMPASSES
     #define AP_NOTIFY_GPIO_LED_3_ENABLED 1
     #define HAL_GPIO_A_LED_PIN        24
@@ -166,6 +170,7 @@
     #define HAL_INS_PROBE_LIST PROBE_IMU_SPI(Invensense, "mpu9250", ROTATION_NONE)
     #define HAL_BARO_PROBE_LIST PROBE_BARO_SPI(MS56XX, "ms5611")
     #define HAL_MAG_PROBE_LIST PROBE_MAG_IMU(AK8963, mpu9250, 0, ROTATION_NONE)
+    #define HAL_MAG_PROBE_USES_INS 1
     #define HAL_PROBE_EXTERNAL_I2C_COMPASSES
 #elif CONFIG_HAL_BOARD_SUBTYPE == HAL_BOARD_SUBTYPE_LINUX_BBBMINI
     #define AP_NOTIFY_GPIO_LED_3_ENABLED 1
@@ -179,6 +184,7 @@
     #define HAL_BARO_PROBE_LIST PROBE_BARO_SPI(MS56XX, "ms5611")
     #define HAL_MAG_PROBE1 PROBE_MAG_IMU(AK8963, mpu9250, 0, ROTATION_NONE)
     #define HAL_MAG_PROBE2 PROBE_MAG_IMU(AK8963, mpu9250, 1, ROTATION_NONE)
+    #define HAL_MAG_PROBE_USES_INS 1
     #define HAL_MAG_PROBE_LIST HAL_MAG_PROBE1; HAL_MAG_PROBE2
     #define HAL_PROBE_EXTERNAL_I2C_COMPASSES
     #define HAL_OPTFLOW_PX4FLOW_I2C_BUS 2
@@ -205,6 +211,7 @@
     #define HAL_INS_PROBE_LIST PROBE_IMU_I2C(Invensense, 2, 0x68, ROTATION_NONE)
     #define HAL_BARO_PROBE_LIST PROBE_BARO_I2C(BMP280, 2, 0x76)
     #define HAL_MAG_PROBE_LIST PROBE_MAG_IMU_I2C(AK8963, mpu9250, 2, 0x0c, ROTATION_NONE)
+    #define HAL_MAG_PROBE_USES_INS 1
     #define HAL_PROBE_EXTERNAL_I2C_COMPASSES
     #define HAL_OPTFLOW_PX4FLOW_I2C_BUS 1
     #define HAL_RANGEFINDER_LIGHTWARE_I2C_BUS 1
@@ -219,6 +226,7 @@
     #define HAL_INS_PROBE_LIST PROBE_IMU_SPI(Invensense, "mpu9250", ROTATION_NONE)
     #define HAL_BARO_PROBE_LIST PROBE_BARO_SPI(BMP280, "bmp280")
     #define HAL_MAG_PROBE_LIST PROBE_MAG_IMU(AK8963, mpu9250, 0, ROTATION_NONE)
+    #define HAL_MAG_PROBE_USES_INS 1
     #define HAL_PROBE_EXTERNAL_I2C_COMPASSES
     #define HAL_OPTFLOW_PX4FLOW_I2C_BUS 2
     #define HAL_RANGEFINDER_LIGHTWARE_I2C_BUS 2
@@ -229,6 +237,7 @@
     #define HAL_INS_PROBE2 PROBE_IMU_SPI(Invensense, "mpu9250", ROTATION_NONE)
     #define HAL_INS_PROBE_LIST HAL_INS_PROBE1; HAL_INS_PROBE2
     #define HAL_MAG_PROBE_LIST PROBE_MAG_IMU(AK8963, mpu9250, 0, ROTATION_NONE)
+    #define HAL_MAG_PROBE_USES_INS 1
     #define HAL_PROBE_EXTERNAL_I2C_COMPASSES
     #define AP_NOTIFY_GPIO_LED_3_ENABLED 1
     #define HAL_GPIO_A_LED_PIN        17
@@ -242,6 +251,7 @@
     #define HAL_INS_PROBE_LIST PROBE_IMU_SPI(Invensense, "mpu9250", ROTATION_YAW_270)
     #define HAL_BARO_PROBE_LIST PROBE_BARO_SPI(MS56XX, "ms5611")
     #define HAL_MAG_PROBE_LIST PROBE_MAG_IMU(AK8963, mpu9250, 0, ROTATION_NONE)
+    #define HAL_MAG_PROBE_USES_INS 1
     #define HAL_PROBE_EXTERNAL_I2C_COMPASSES
     #define AP_NOTIFY_GPIO_LED_3_ENABLED 1
     #define HAL_GPIO_A_LED_PIN        24
@@ -259,6 +269,7 @@
 #elif CONFIG_HAL_BOARD_SUBTYPE == HAL_BOARD_SUBTYPE_LINUX_DARK
     #define HAL_INS_PROBE_LIST PROBE_IMU_SPI(Invensense, "mpu9250", ROTATION_NONE)
     #define HAL_MAG_PROBE_LIST PROBE_MAG_IMU(AK8963, mpu9250, 0, ROTATION_NONE)
+    #define HAL_MAG_PROBE_USES_INS 1
     #define HAL_BARO_PROBE_LIST PROBE_BARO_I2C(MS56XX, 1, 0x77)
     #define AP_NOTIFY_GPIO_LED_3_ENABLED 1
     #define HAL_GPIO_A_LED_PIN        24
@@ -295,6 +306,7 @@
     #define HAL_INS_PROBE_LIST PROBE_IMU_SPI(Invensense, "mpu9250", ROTATION_NONE)
     #define HAL_BARO_PROBE_LIST PROBE_BARO_SPI(MS56XX, "ms5611")
     #define HAL_MAG_PROBE_LIST PROBE_MAG_IMU(AK8963, mpu9250, 0, ROTATION_NONE)
+    #define HAL_MAG_PROBE_USES_INS 1
     #define HAL_PROBE_EXTERNAL_I2C_COMPASSES
     #define HAL_NUM_CAN_IFACES 1
     #define HAL_CAN_DRIVER_DEFAULT 1
@@ -326,6 +338,7 @@
 
         #define HAL_INS_PROBE_LIST PROBE_IMU_SPI(Invensense, "mpu9250", ROTATION_NONE)
         #define HAL_MAG_PROBE_LIST PROBE_MAG_IMU(AK8963, mpu9250, 0, ROTATION_NONE)
+        #define HAL_MAG_PROBE_USES_INS 1
         #define HAL_BARO_PROBE_LIST PROBE_BARO_I2C(BMP085, 1, 0x77) 
         //#define HAL_MAG_PROBE_LIST PROBE_MAG_I2C(QMC5883L, 1, 0x0d,true ,  ROTATION_NONE)
 
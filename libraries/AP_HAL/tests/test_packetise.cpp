@@ -0,0 +1,57 @@
+#include <AP_gtest.h>
+#include <AP_HAL/AP_HAL.h>
+#include <AP_HAL/utility/packetise.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+#if AP_MAVLINK_PACKETISE_ENABLED
+
+#include <GCS_MAVLink/GCS_MAVLink.h>
+
+// write an unsigned MAVLink2 frame with a payload of len bytes
+static void write_frame(ByteBuffer &buf, uint8_t len)
+{
+    uint8_t frame[12 + 255] {};
+    frame[0] = MAVLINK_STX;
+    frame[1] = len;
+    buf.write(frame, 12 + len);
+}
+
+TEST(Packetise, OneFramePerPacket)
+{
+    ByteBuffer buf{4096};
+    write_frame(buf, 20);
+    write_frame(buf, 30);
+    EXPECT_EQ(mavlink_packetise(buf, buf.available()), 32U);
+    // incomplete frame
+    EXPECT_EQ(mavlink_packetise(buf, 20), 0U);
+}
+
+TEST(Packetise, Coalesce)
+{
+    ByteBuffer buf{4096};
+    MAVLinkCoalesce coalesce;
+
+    // frames that don't fill a datagram wait for the latency
+    write_frame(buf, 20);
+    write_frame(buf, 30);
+    EXPECT_EQ(coalesce.bytes_to_send(buf, buf.available(), 1000), 0U);
+    EXPECT_EQ(coalesce.bytes_to_send(buf, buf.available(), 1000 + AP_MAVLINK_COALESCE_LATENCY_MS), 32U + 42U);
+    buf.advance(32 + 42);
+    EXPECT_EQ(coalesce.bytes_to_send(buf, buf.available(), 2000), 0U);
+
+    // a full datagram goes at once, and the frames left over wait
+    // only until the latency from when they were first seen
+    for (uint8_t i = 0; i < 10; i++) {
+        write_frame(buf, 255);
+    }
+    const uint16_t full = (AP_MAVLINK_COALESCE_MAX_LEN / 267) * 267;
+    EXPECT_EQ(coalesce.bytes_to_send(buf, buf.available(), 3000), full);
+    buf.advance(full);
+    EXPECT_EQ(coalesce.bytes_to_send(buf, buf.available(), 3000), 0U);
+    EXPECT_EQ(coalesce.bytes_to_send(buf, buf.available(), 3000 + AP_MAVLINK_COALESCE_LATENCY_MS), buf.available());
+}
+
+#endif  // AP_MAVLINK_PACKETISE_ENABLED
+
+AP_GTEST_MAIN()
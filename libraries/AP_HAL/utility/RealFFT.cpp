@@ -0,0 +1,251 @@
+/*
+ * This file is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "RealFFT.h"
+
+#if AP_HAL_REALFFT_ENABLED
+
+#include <math.h>
+#include <string.h>
+
+/*
+  four floats handled together. With SSE or NEON each operation on a
+  v4sf is a single instruction, without them the compiler splits it
+  into scalar operations
+ */
+typedef float v4sf __attribute__((vector_size(16)));
+
+// the working arrays are not guaranteed to be 16 byte aligned, so
+// vectors are moved in and out with memcpy(), which compiles to an
+// unaligned load or store
+static inline v4sf load4(const float *p)
+{
+    v4sf v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline void store4(float *p, const v4sf &v)
+{
+    memcpy(p, &v, sizeof(v));
+}
+
+RealFFT::~RealFFT()
+{
+    delete[] _bitrev;
+    delete[] _re;
+    delete[] _im;
+    delete[] _tw_re;
+    delete[] _tw_im;
+    delete[] _split_re;
+    delete[] _split_im;
+}
+
+bool RealFFT::init(uint16_t length)
+{
+    if (length < 8 || length > 32768 || (length & (length - 1)) != 0) {
+        return false;
+    }
+    _length = length;
+    _cpoints = length / 2;
+    _log2_cpoints = 0;
+    while ((1U << _log2_cpoints) < _cpoints) {
+        _log2_cpoints++;
+    }
+
+    _bitrev = NEW_NOTHROW uint16_t[_cpoints];
+    _re = NEW_NOTHROW float[_cpoints];
+    _im = NEW_NOTHROW float[_cpoints];
+    // the stages together need fewer than _cpoints twiddles
+    _tw_re = NEW_NOTHROW float[_cpoints];
+    _tw_im = NEW_NOTHROW float[_cpoints];
+    _split_re = NEW_NOTHROW float[_cpoints/2 + 1];
+    _split_im = NEW_NOTHROW float[_cpoints/2 + 1];
+    if (_bitrev == nullptr || _re == nullptr || _im == nullptr ||
+        _tw_re == nullptr || _tw_im == nullptr ||
+        _split_re == nullptr || _split_im == nullptr) {
+        return false;
+    }
+
+    for (uint16_t i = 0; i < _cpoints; i++) {
+        uint16_t r = 0;
+        for (uint8_t b = 0; b < _log2_cpoints; b++) {
+            if (i & (1U << b)) {
+                r |= 1U << (_log2_cpoints - 1 - b);
+            }
+        }
+        _bitrev[i] = r;
+    }
+
+    // radix-4 stages need W(2h)^j and W(4h)^j for j < h, the final
+    // radix-2 stage needs W(2h)^j, where W(n) = e^(-2*pi*i/n)
+    uint16_t tw = 0;
+    uint16_t h = 1;
+    for (; h * 4 <= _cpoints; h *= 4) {
+        for (uint16_t j = 0; j < h; j++, tw++) {
+            _tw_re[tw] = cos(-M_PI * j / h);
+            _tw_im[tw] = sin(-M_PI * j / h);
+        }
+        for (uint16_t j = 0; j < h; j++, tw++) {
+            _tw_re[tw] = cos(-M_PI * j / (2 * h));
+            _tw_im[tw] = sin(-M_PI * j / (2 * h));
+        }
+    }
+    if (h < _cpoints) {
+        for (uint16_t j = 0; j < h; j++, tw++) {
+            _tw_re[tw] = cos(-M_PI * j / h);
+            _tw_im[tw] = sin(-M_PI * j / h);
+        }
+    }
+
+    for (uint16_t k = 0; k <= _cpoints/2; k++) {
+        _split_re[k] = cos(-2 * M_PI * k / _length);
+        _split_im[k] = sin(-2 * M_PI * k / _length);
+    }
+
+    return true;
+}
+
+// in-place FFT of _re/_im, which are in bit reversed order
+void RealFFT::complex_fft()
+{
+    float *re = _re;
+    float *im = _im;
+    const float *tw_re = _tw_re;
+    const float *tw_im = _tw_im;
+
+    /*
+      the first radix-4 stage has all twiddles equal to one
+     */
+    uint16_t h = 1;
+    if (_cpoints >= 4) {
+        for (uint16_t k = 0; k < _cpoints; k += 4) {
+            const float a1r = re[k] + re[k+1],   a1i = im[k] + im[k+1];
+            const float b1r = re[k] - re[k+1],   b1i = im[k] - im[k+1];
+            const float c1r = re[k+2] + re[k+3], c1i = im[k+2] + im[k+3];
+            const float d1r = re[k+2] - re[k+3], d1i = im[k+2] - im[k+3];
+            re[k]   = a1r + c1r; im[k]   = a1i + c1i;
+            re[k+2] = a1r - c1r; im[k+2] = a1i - c1i;
+            // d1 rotated by -i
+            re[k+1] = b1r + d1i; im[k+1] = b1i - d1r;
+            re[k+3] = b1r - d1i; im[k+3] = b1i + d1r;
+        }
+        tw_re += 2;
+        tw_im += 2;
+        h = 4;
+    }
+
+    /*
+      remaining radix-4 stages, four butterflies at a time. Each is
+      two radix-2 stages fused so the data is loaded and stored once
+     */
+    for (; h * 4 <= _cpoints; h *= 4) {
+        for (uint16_t k = 0; k < _cpoints; k += 4 * h) {
+            for (uint16_t j = 0; j < h; j += 4) {
+                const uint16_t ia = k + j;
+                const uint16_t ib = ia + h;
+                const uint16_t ic = ib + h;
+                const uint16_t id = ic + h;
+
+                const v4sf w1r = load4(&tw_re[j]), w1i = load4(&tw_im[j]);
+                const v4sf w2r = load4(&tw_re[h + j]), w2i = load4(&tw_im[h + j]);
+
+                const v4sf ar = load4(&re[ia]), ai = load4(&im[ia]);
+                const v4sf br = load4(&re[ib]), bi = load4(&im[ib]);
+                const v4sf cr = load4(&re[ic]), ci = load4(&im[ic]);
+                const v4sf dr = load4(&re[id]), di = load4(&im[id]);
+
+                // first radix-2 stage
+                const v4sf tbr = br * w1r - bi * w1i, tbi = br * w1i + bi * w1r;
+                const v4sf tdr = dr * w1r - di * w1i, tdi = dr * w1i + di * w1r;
+                const v4sf a1r = ar + tbr, a1i = ai + tbi;
+                const v4sf b1r = ar - tbr, b1i = ai - tbi;
+                const v4sf c1r = cr + tdr, c1i = ci + tdi;
+                const v4sf d1r = cr - tdr, d1i = ci - tdi;
+
+                // second radix-2 stage, d1 gets an extra rotation by -i
+                const v4sf c2r = c1r * w2r - c1i * w2i, c2i = c1r * w2i + c1i * w2r;
+                const v4sf d2r = d1r * w2i + d1i * w2r, d2i = d1i * w2i - d1r * w2r;
+
+                store4(&re[ia], a1r + c2r); store4(&im[ia], a1i + c2i);
+                store4(&re[ic], a1r - c2r); store4(&im[ic], a1i - c2i);
+                store4(&re[ib], b1r + d2r); store4(&im[ib], b1i + d2i);
+                store4(&re[id], b1r - d2r); store4(&im[id], b1i - d2i);
+            }
+        }
+        tw_re += 2 * h;
+        tw_im += 2 * h;
+    }
+
+    /*
+      final radix-2 stage when log2(_cpoints) is odd
+     */
+    if (h < _cpoints) {
+        for (uint16_t j = 0; j < h; j += 4) {
+            const v4sf wr = load4(&tw_re[j]), wi = load4(&tw_im[j]);
+            const v4sf ar = load4(&re[j]), ai = load4(&im[j]);
+            const v4sf br = load4(&re[j + h]), bi = load4(&im[j + h]);
+            const v4sf tr = br * wr - bi * wi, ti = br * wi + bi * wr;
+            store4(&re[j], ar + tr); store4(&im[j], ai + ti);
+            store4(&re[j + h], ar - tr); store4(&im[j + h], ai - ti);
+        }
+    }
+}
+
+void RealFFT::transform(const float *input, float *output, float *power)
+{
+    // pack pairs of real samples as complex points in bit reversed order
+    for (uint16_t i = 0; i < _cpoints; i++) {
+        const uint16_t r = _bitrev[i];
+        _re[r] = input[2*i];
+        _im[r] = input[2*i + 1];
+    }
+
+    complex_fft();
+
+    /*
+      split the N/2 point complex result Z into the N point real
+      result X. With E and O the transforms of the even and odd samples
+        E[k] = (Z[k] + conj(Z[N/2-k])) / 2
+        O[k] = -i * (Z[k] - conj(Z[N/2-k])) / 2
+        X[k] = E[k] + W^k * O[k]
+        X[N/2-k] = conj(E[k] - W^k * O[k])
+     */
+    const uint16_t m = _cpoints;
+    output[0] = _re[0] + _im[0];
+    output[1] = 0;
+    output[2*m] = _re[0] - _im[0];
+    output[2*m + 1] = 0;
+    for (uint16_t k = 1; k <= m/2; k++) {
+        const float ar = _re[k], ai = _im[k];
+        const float br = _re[m - k], bi = -_im[m - k];
+        const float er = 0.5f * (ar + br), ei = 0.5f * (ai + bi);
+        const float or_ = 0.5f * (ai - bi), oi = -0.5f * (ar - br);
+        const float tr = _split_re[k] * or_ - _split_im[k] * oi;
+        const float ti = _split_re[k] * oi + _split_im[k] * or_;
+        output[2*k] = er + tr;
+        output[2*k + 1] = ei + ti;
+        output[2*(m - k)] = er - tr;
+        output[2*(m - k) + 1] = ti - ei;
+    }
+
+    if (power != nullptr) {
+        for (uint16_t k = 0; k < m; k++) {
+            power[k] = output[2*k] * output[2*k] + output[2*k + 1] * output[2*k + 1];
+        }
+    }
+}
+
+#endif // AP_HAL_REALFFT_ENABLED
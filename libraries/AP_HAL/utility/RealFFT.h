@@ -0,0 +1,84 @@
+/*
+ * This file is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <AP_HAL/AP_HAL_Boards.h>
+#include <AP_Common/AP_Common.h>
+#include <stdint.h>
+
+#ifndef AP_HAL_REALFFT_ENABLED
+#define AP_HAL_REALFFT_ENABLED (HAL_WITH_DSP && (CONFIG_HAL_BOARD == HAL_BOARD_SITL || CONFIG_HAL_BOARD == HAL_BOARD_LINUX))
+#endif
+
+#if AP_HAL_REALFFT_ENABLED
+
+/*
+  real input FFT for the DSP backends of boards without CMSIS
+
+  A real FFT of N points is computed as a complex FFT of N/2 points
+  followed by a split step. The complex FFT is radix-4 decimation in
+  time, with a final radix-2 stage when log2(N/2) is odd. The real and
+  imaginary parts are kept in separate arrays so that each stage runs
+  four butterflies at a time in SSE or NEON registers through the
+  compiler's generic vector extensions. The bit reversal permutation
+  and all twiddle factors are computed once by init()
+ */
+class RealFFT {
+public:
+    RealFFT() {}
+    ~RealFFT();
+
+    CLASS_NO_COPY(RealFFT);
+
+    // allocate the tables for an FFT of length points, which must be a
+    // power of 2 between 8 and 32768. Returns false if out of memory
+    bool init(uint16_t length);
+
+    uint16_t length() const { return _length; }
+
+    /*
+      forward transform of length real samples in input, with the same
+      sign convention as CMSIS arm_rfft_fast_f32(). The length/2+1
+      complex bins from DC to Nyquist are written to output as
+      interleaved real and imaginary parts, so output must hold
+      length+2 floats. If power is not null the squared magnitude of
+      the length/2 bins below Nyquist is written to it
+     */
+    void transform(const float *input, float *output, float *power = nullptr);
+
+private:
+    void complex_fft();
+
+    uint16_t _length = 0;
+    // number of complex points, _length/2
+    uint16_t _cpoints = 0;
+    // log2 of _cpoints
+    uint8_t _log2_cpoints = 0;
+
+    // input index for each complex point in bit reversed order
+    uint16_t *_bitrev = nullptr;
+    // working complex data
+    float *_re = nullptr;
+    float *_im = nullptr;
+    // twiddles for each radix-4 or radix-2 stage, packed one stage
+    // after another
+    float *_tw_re = nullptr;
+    float *_tw_im = nullptr;
+    // twiddles for the real split, e^(-2*pi*i*k/_length) for k up to _cpoints/2
+    float *_split_re = nullptr;
+    float *_split_im = nullptr;
+};
+
+#endif // AP_HAL_REALFFT_ENABLED
@@ -0,0 +1,58 @@
+/*
+ * This file is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include "RealFFT.h"
+
+#if AP_HAL_REALFFT_ENABLED
+
+#include <AP_HAL/AP_HAL.h>
+
+/*
+  FFT analysis on the CPU using RealFFT, for the HALs without CMSIS.
+  Each HAL's DSP class derives from this
+ */
+class RealFFT_DSP : public AP_HAL::DSP {
+public:
+    // initialise an FFT instance
+    virtual FFTWindowState* fft_init(uint16_t window_size, uint16_t sample_rate, uint8_t sliding_window_size) override;
+    // start an FFT analysis with an ObjectBuffer
+    virtual void fft_start(FFTWindowState* state, FloatBuffer& samples, uint16_t advance) override;
+    // perform remaining steps of an FFT analysis
+    virtual uint16_t fft_analyse(FFTWindowState* state, uint16_t start_bin, uint16_t end_bin, float noise_att_cutoff) override;
+
+    // RealFFT-based FFT state
+    class FFTWindowStateRealFFT : public AP_HAL::DSP::FFTWindowState {
+        friend class RealFFT_DSP;
+
+    public:
+        FFTWindowStateRealFFT(uint16_t window_size, uint16_t sample_rate, uint8_t sliding_window_size);
+        virtual ~FFTWindowStateRealFFT();
+
+    private:
+        RealFFT rfft;
+    };
+
+private:
+    void step_hanning(FFTWindowStateRealFFT* fft, FloatBuffer& samples, uint16_t advance);
+    void step_fft(FFTWindowStateRealFFT* fft);
+    void mult_f32(const float* v1, const float* v2, float* vout, uint16_t len);
+    void vector_max_float(const float* vin, uint16_t len, float* maxValue, uint16_t* maxIndex) const override;
+    void vector_scale_float(const float* vin, float scale, float* vout, uint16_t len) const override;
+    float vector_mean_float(const float* vin, uint16_t len) const override;
+    void vector_add_float(const float* vin1, const float* vin2, float* vout, uint16_t len) const override;
+};
+
+#endif // AP_HAL_REALFFT_ENABLED
@@ -41,6 +41,7 @@
 #include <arpa/inet.h>
 #include <sys/select.h>
 #include <sys/time.h>
+#include <sys/uio.h>
 #endif
 
 #include <errno.h>
@@ -303,6 +304,20 @@ ssize_t SOCKET_CLASS_NAME::send(const void *buf, size_t size) const
     return CALL_PREFIX(send)(fd, buf, size, MSG_NOSIGNAL);
 }
 
+/*
+  send data gathered from iovcnt buffers
+ */
+ssize_t SOCKET_CLASS_NAME::sendv(const struct iovec *iov, int iovcnt) const
+{
+    if (fd == -1) {
+        return -1;
+    }
+    struct msghdr msg {};
+    msg.msg_iov = const_cast<struct iovec *>(iov);
+    msg.msg_iovlen = iovcnt;
+    return CALL_PREFIX(sendmsg)(fd, &msg, MSG_NOSIGNAL);
+}
+
 /*
   send some data with address as a uint32_t
  */
@@ -27,6 +27,8 @@
 
 #define IP4_STR_LEN 16
 
+struct iovec;
+
 class SOCKET_CLASS_NAME {
 public:
     SOCKET_CLASS_NAME(bool _datagram);
@@ -42,6 +44,8 @@ public:
     void set_broadcast(void) const;
 
     ssize_t send(const void *pkt, size_t size) const;
+    // send iovcnt buffers in one call, as one datagram on UDP sockets
+    ssize_t sendv(const struct iovec *iov, int iovcnt) const;
     ssize_t sendto(const void *buf, size_t size, const char *address, uint16_t port);
     ssize_t sendto(const void *buf, size_t size, uint32_t address, uint16_t port);
     ssize_t recv(void *pkt, size_t size, uint32_t timeout_ms);
@@ -7,6 +7,36 @@
 #if AP_MAVLINK_PACKETISE_ENABLED
 #include <GCS_MAVLink/GCS_MAVLink.h>
 
+/*
+  return the length of the MAVLink frame starting at ofs in writebuf,
+  or zero if the n bytes from ofs do not hold all of it yet
+ */
+static uint16_t frame_length(ByteBuffer &writebuf, uint16_t ofs, uint16_t n)
+{
+    const int16_t b = writebuf.peek(ofs);
+
+    // cope with both MAVLink1 and MAVLink2 packets
+    uint8_t min_length = (b == MAVLINK_STX_MAVLINK1)?8:12;
+    if (n < min_length) {
+        return 0;
+    }
+
+    // the length of the packet is the 2nd byte
+    const int16_t len = writebuf.peek(ofs+1);
+    if (b == MAVLINK_STX) {
+        // This is Mavlink2. Check for signed packet with extra 13 bytes
+        const int16_t incompat_flags = writebuf.peek(ofs+2);
+        if (incompat_flags & MAVLINK_IFLAG_SIGNED) {
+            min_length += MAVLINK_SIGNATURE_BLOCK_LEN;
+        }
+    }
+
+    if (n < len+min_length) {
+        return 0;
+    }
+    return len+min_length;
+}
+
 /*
   return the number of bytes to send for a packetised connection
  */
@@ -35,36 +65,60 @@ uint16_t mavlink_packetise(ByteBuffer &writebuf, uint16_t n)
         return n;
     }
 
-    // cope with both MAVLink1 and MAVLink2 packets
-    uint8_t min_length = (b == MAVLINK_STX_MAVLINK1)?8:12;
+    // send just 1 packet at a time (so MAVLink packets are aligned on
+    // UDP boundaries), or nothing if we don't have a full packet yet
+    return frame_length(writebuf, 0, n);
+}
 
-    // this looks like a MAVLink packet - try to write on
-    // packet boundaries when possible
-    if (n < min_length) {
-        // we need to wait for more data to arrive
+/*
+  return the number of bytes to send now as one datagram
+ */
+uint16_t MAVLinkCoalesce::bytes_to_send(ByteBuffer &writebuf, uint16_t n, uint32_t now_ms)
+{
+    if (n == 0) {
+        pending = false;
         return 0;
     }
+    const int16_t b = writebuf.peek(0);
+    if (b != MAVLINK_STX_MAVLINK1 && b != MAVLINK_STX) {
+        return mavlink_packetise(writebuf, n);
+    }
+    if (!pending) {
+        pending = true;
+        first_pending_ms = now_ms;
+    }
 
-    // the length of the packet is the 2nd byte
-    int16_t len = writebuf.peek(1);
-    if (b == MAVLINK_STX) {
-        // This is Mavlink2. Check for signed packet with extra 13 bytes
-        int16_t incompat_flags = writebuf.peek(2);
-        if (incompat_flags & MAVLINK_IFLAG_SIGNED) {
-            min_length += MAVLINK_SIGNATURE_BLOCK_LEN;
+    // add whole frames until the next would not fit, or the next
+    // bytes are not a frame start
+    uint16_t total = 0;
+    bool full = false;
+    while (total < n) {
+        const int16_t stx = writebuf.peek(total);
+        if (stx != MAVLINK_STX_MAVLINK1 && stx != MAVLINK_STX) {
+            full = true;
+            break;
         }
+        const uint16_t len = frame_length(writebuf, total, n - total);
+        if (len == 0) {
+            break;
+        }
+        if (total + len > AP_MAVLINK_COALESCE_MAX_LEN) {
+            full = true;
+            break;
+        }
+        total += len;
     }
 
-    if (n < len+min_length) {
-        // we don't have a full packet yet
+    if (total == 0 ||
+        (!full && now_ms - first_pending_ms < AP_MAVLINK_COALESCE_LATENCY_MS)) {
+        // wait for more frames
         return 0;
     }
-    if (n > len+min_length) {
-        // send just 1 packet at a time (so MAVLink packets
-        // are aligned on UDP boundaries)
-        n = len+min_length;
-    }
-    return n;
+
+    // any frames left behind are at least as old as the ones going,
+    // so they keep first_pending_ms
+    pending = total < n;
+    return total;
 }
 
 #endif // AP_MAVLINK_PACKETISE_ENABLED
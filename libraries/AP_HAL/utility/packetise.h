@@ -6,8 +6,40 @@
 #define AP_MAVLINK_PACKETISE_ENABLED HAL_GCS_ENABLED
 #endif
 
+// largest datagram to coalesce MAVLink frames into. This is the UDP
+// payload that fits an Ethernet MTU of 1500 without fragmentation
+#ifndef AP_MAVLINK_COALESCE_MAX_LEN
+#define AP_MAVLINK_COALESCE_MAX_LEN 1472
+#endif
+
+// longest time to hold frames waiting for more to fill a datagram
+#ifndef AP_MAVLINK_COALESCE_LATENCY_MS
+#define AP_MAVLINK_COALESCE_LATENCY_MS 5
+#endif
+
 /*
   return the number of bytes to send for a packetised connection
 */
 uint16_t mavlink_packetise(ByteBuffer &writebuf, uint16_t n);
 
+#if AP_MAVLINK_PACKETISE_ENABLED
+/*
+  pack as many whole MAVLink frames as fit in a datagram of
+  AP_MAVLINK_COALESCE_MAX_LEN bytes, rather than sending one frame per
+  datagram. A datagram that isn't full is held until
+  AP_MAVLINK_COALESCE_LATENCY_MS after its first frame was seen, so a
+  frame is delayed by at most that plus the period of the caller.
+  Non-MAVLink bytes are sent as mavlink_packetise() would
+ */
+class MAVLinkCoalesce {
+public:
+    // return the number of bytes of the n in writebuf to send now as
+    // one datagram, or zero to wait for more
+    uint16_t bytes_to_send(ByteBuffer &writebuf, uint16_t n, uint32_t now_ms);
+
+private:
+    // time frames were first seen waiting to be sent
+    uint32_t first_pending_ms = 0;
+    bool pending = false;
+};
+#endif
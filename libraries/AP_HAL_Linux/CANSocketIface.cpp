@@ -152,8 +152,8 @@ int CANIface::_openSocket(const std::string& iface_name)
     return ret;
 }
 
-int16_t CANIface::send(const AP_HAL::CANFrame& frame, const uint64_t tx_deadline,
-                       const CANIface::CanIOFlags flags)
+void CANIface::_queueTx(const AP_HAL::CANFrame& frame, const uint64_t tx_deadline,
+                        const CANIface::CanIOFlags flags)
 {
     CanTxItem tx_item {};
     tx_item.frame = frame;
@@ -166,15 +166,35 @@ int16_t CANIface::send(const AP_HAL::CANFrame& frame, const uint64_t tx_deadline
     tx_item.setup = true;
     tx_item.index = _tx_frame_counter;
     tx_item.deadline = tx_deadline;
-    WITH_SEMAPHORE(sem);
     _tx_queue.emplace(tx_item);
     _tx_frame_counter++;
     stats.tx_requests++;
+}
+
+int16_t CANIface::send(const AP_HAL::CANFrame& frame, const uint64_t tx_deadline,
+                       const CANIface::CanIOFlags flags)
+{
+    WITH_SEMAPHORE(sem);
+    _queueTx(frame, tx_deadline, flags);
     _pollRead();     // Read poll is necessary because it can release the pending TX flag
     _pollWrite();
     return AP_HAL::CANIface::send(frame, tx_deadline, flags);
 }
 
+int16_t CANIface::send_batch(const CanTxRequest* requests, uint16_t count)
+{
+    WITH_SEMAPHORE(sem);
+    for (uint16_t i = 0; i < count; i++) {
+        _queueTx(requests[i].frame, requests[i].deadline, requests[i].flags);
+    }
+    _pollRead();
+    _pollWrite();
+    for (uint16_t i = 0; i < count; i++) {
+        AP_HAL::CANIface::send(requests[i].frame, requests[i].deadline, requests[i].flags);
+    }
+    return count;
+}
+
 int16_t CANIface::receive(AP_HAL::CANFrame& out_frame, uint64_t& out_timestamp_us,
                           CANIface::CanIOFlags& out_flags)
 {
@@ -198,6 +218,26 @@ int16_t CANIface::receive(AP_HAL::CANFrame& out_frame, uint64_t& out_timestamp_u
     return AP_HAL::CANIface::receive(out_frame, out_timestamp_us, out_flags);
 }
 
+int16_t CANIface::receive_batch(CanRxItem* items, uint16_t max_items)
+{
+    WITH_SEMAPHORE(sem);
+    if (_rx_queue.size() < max_items) {
+        _pollRead();
+    }
+    uint16_t count = 0;
+    while (count < max_items && !_rx_queue.empty()) {
+        items[count++] = _rx_queue.front();
+        (void)_rx_queue.pop();
+    }
+    if (count > 0 && sem_handle != nullptr) {
+        sem_handle->signal();
+    }
+    for (uint16_t i = 0; i < count; i++) {
+        AP_HAL::CANIface::receive(items[i].frame, items[i].timestamp_us, items[i].flags);
+    }
+    return count;
+}
+
 bool CANIface::_hasReadyTx()
 {
     WITH_SEMAPHORE(sem);
@@ -268,132 +308,203 @@ uint32_t CANIface::getErrorCount() const
 
 void CANIface::_pollWrite()
 {
+    WITH_SEMAPHORE(sem);
     while (_hasReadyTx()) {
-        WITH_SEMAPHORE(sem);
-        const CanTxItem tx = _tx_queue.top();
-        uint64_t curr_time = AP_HAL::micros64();
-        if (tx.deadline >= curr_time) {
-            // hal.console->printf("%x TDEAD: %lu CURRT: %lu DEL: %lu\n",tx.frame.id,  tx.deadline, curr_time, tx.deadline-curr_time);
-            const int res = _write(tx.frame);
-            if (res == 1) {                   // Transmitted successfully
-                _incrementNumFramesInSocketTxQueue();
-                if (tx.loopback) {
-                    _pending_loopback_ids.insert(tx.frame.id);
-                }
-                stats.tx_success++;
-                stats.last_transmit_us = curr_time;
-            } else if (res == 0) {            // Not transmitted, nor is it an error
-                stats.tx_overflow++;
-                break;                        // Leaving the loop, the frame remains enqueued for the next retry
-            } else {                          // Transmission error
-                stats.tx_rejected++;
+        // take as many frames as the socket TX queue has room for, in
+        // priority order, and hand them to the socket in one call
+        CanTxItem batch[CAN_MAX_SOCKET_BATCH];
+        uint8_t count = 0;
+        const uint64_t curr_time = AP_HAL::micros64();
+        while (count < CAN_MAX_SOCKET_BATCH && !_tx_queue.empty() &&
+               _frames_in_socket_tx_queue + count < _max_frames_in_socket_tx_queue) {
+            const CanTxItem& tx = _tx_queue.top();
+            if (tx.deadline >= curr_time) {
+                batch[count++] = tx;
+            } else {
+                stats.tx_timedout++;
             }
-        } else {
-            // hal.console->printf("TDEAD: %lu CURRT: %lu DEL: %lu\n", tx.deadline, curr_time, curr_time-tx.deadline);
-            stats.tx_timedout++;
+            (void)_tx_queue.pop();
+        }
+        if (count == 0) {
+            continue;
         }
 
-        // Removing the frame from the queue even if transmission failed
-        (void)_tx_queue.pop();
+        bool buffer_full = false;
+        const int res = _write(batch, count, buffer_full);
+        stats.num_tx_writes++;
+        const uint8_t sent = res > 0 ? res : 0;
+        for (uint8_t i = 0; i < sent; i++) {
+            _incrementNumFramesInSocketTxQueue();
+            if (batch[i].loopback) {
+                _pending_loopback_ids.insert(batch[i].frame.id);
+            }
+            stats.tx_success++;
+            stats.last_transmit_us = curr_time;
+        }
+        if (sent == count) {
+            continue;
+        }
+        uint8_t retry_from = sent;
+        if (!buffer_full) {
+            // Transmission error, the failed frame is dropped
+            stats.tx_rejected++;
+            retry_from++;
+        }
+        // frames not yet written stay enqueued for the next retry
+        for (uint8_t i = retry_from; i < count; i++) {
+            _tx_queue.push(batch[i]);
+        }
+        if (buffer_full) {
+            stats.tx_overflow++;
+            break;
+        }
     }
 }
 
 bool CANIface::_pollRead()
 {
+    bool accepted = false;
     uint8_t iterations_count = 0;
     while (iterations_count < CAN_MAX_POLL_ITERATIONS_COUNT)
     {
         iterations_count++;
-        CanRxItem rx;
-        rx.timestamp_us = AP_HAL::micros64();  // Monotonic timestamp is not required to be precise (unlike UTC)
-        bool loopback = false;
-        const int res = _read(rx.frame, rx.timestamp_us, loopback);
-        if (res == 1) {
+        CanRxItem rx[CAN_MAX_SOCKET_BATCH];
+        bool loopback[CAN_MAX_SOCKET_BATCH] {};
+        uint8_t num_read = 0;
+        const int res = _read(rx, loopback, CAN_MAX_SOCKET_BATCH, num_read);
+        if (res < 0) {
+            stats.rx_errors++;
+            break;
+        }
+        if (num_read == 0) {
+            break;
+        }
+        stats.num_rx_reads++;
+        WITH_SEMAPHORE(sem);
+        for (uint8_t i = 0; i < res; i++) {
             bool accept = true;
-            if (loopback) {           // We receive loopback for all CAN frames
+            if (loopback[i]) {        // We receive loopback for all CAN frames
                 _confirmSentFrame();
-                rx.flags |= Loopback;
-                accept = _wasInPendingLoopbackSet(rx.frame);
+                rx[i].flags |= Loopback;
+                accept = _wasInPendingLoopbackSet(rx[i].frame);
                 stats.tx_confirmed++;
             }
             if (accept) {
-                WITH_SEMAPHORE(sem);
-                _rx_queue.push(rx);
+                _rx_queue.push(rx[i]);
                 stats.rx_received++;
-                return true;
+                accepted = true;
             }
-        } else if (res == 0) {
-            break;
-        } else {
-            stats.rx_errors++;
+        }
+        if (accepted || num_read < CAN_MAX_SOCKET_BATCH) {
             break;
         }
     }
-    return false;
+    return accepted;
 }
 
-int CANIface::_write(const AP_HAL::CANFrame& frame) const
+/*
+  write frames to the socket with one sendmmsg() call. Returns the
+  number of frames written or negative on error. buffer_full is set if
+  writing stopped because the socket buffer was full, which is not an
+  error
+ */
+int CANIface::_write(const CanTxItem* items, uint8_t count, bool& buffer_full) const
 {
+    buffer_full = false;
     if (_fd < 0) {
         return -1;
     }
-    errno = 0;
-
-    const can_frame sockcan_frame = makeSocketCanFrame(frame);
+    can_frame sockcan_frames[CAN_MAX_SOCKET_BATCH];
+    iovec iov[CAN_MAX_SOCKET_BATCH];
+    mmsghdr msgs[CAN_MAX_SOCKET_BATCH];
+    if (count > CAN_MAX_SOCKET_BATCH) {
+        count = CAN_MAX_SOCKET_BATCH;
+    }
+    memset(msgs, 0, sizeof(msgs[0]) * count);
+    for (uint8_t i = 0; i < count; i++) {
+        sockcan_frames[i] = makeSocketCanFrame(items[i].frame);
+        iov[i].iov_base = &sockcan_frames[i];
+        iov[i].iov_len = sizeof(sockcan_frames[i]);
+        msgs[i].msg_hdr.msg_iov = &iov[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+    }
 
-    const int res = write(_fd, &sockcan_frame, sizeof(sockcan_frame));
-    if (res <= 0) {
+    errno = 0;
+    const int res = sendmmsg(_fd, msgs, count, MSG_DONTWAIT);
+    if (res < 0) {
         if (errno == ENOBUFS || errno == EAGAIN) {  // Writing is not possible atm, not an error
+            buffer_full = true;
             return 0;
         }
         return res;
     }
-    if (res != sizeof(sockcan_frame)) {
-        return -1;
+    if (res < count) {
+        // sendmmsg() does not report why it stopped early, the error
+        // is returned by the next call
+        buffer_full = true;
     }
-    return 1;
+    return res;
 }
 
-
-int CANIface::_read(AP_HAL::CANFrame& frame, uint64_t& timestamp_us, bool& loopback) const
+/*
+  read up to max_items frames from the socket with one recvmmsg()
+  call. Returns the number of frames placed in items or negative on
+  error. num_read is the number of frames taken from the socket,
+  including those rejected by the filters
+ */
+int CANIface::_read(CanRxItem* items, bool* loopback, uint8_t max_items, uint8_t& num_read) const
 {
+    num_read = 0;
     if (_fd < 0) {
         return -1;
     }
-    auto iov = iovec();
-    auto sockcan_frame = can_frame();
-    iov.iov_base = &sockcan_frame;
-    iov.iov_len  = sizeof(sockcan_frame);
+    can_frame sockcan_frames[CAN_MAX_SOCKET_BATCH];
+    iovec iov[CAN_MAX_SOCKET_BATCH];
+    mmsghdr msgs[CAN_MAX_SOCKET_BATCH];
     union {
         uint8_t data[CMSG_SPACE(sizeof(::timeval))];
         struct cmsghdr align;
-    } control;
-
-    auto msg = msghdr();
-    msg.msg_iov    = &iov;
-    msg.msg_iovlen = 1;
-    msg.msg_control = control.data;
-    msg.msg_controllen = sizeof(control.data);
+    } control[CAN_MAX_SOCKET_BATCH];
+    if (max_items > CAN_MAX_SOCKET_BATCH) {
+        max_items = CAN_MAX_SOCKET_BATCH;
+    }
+    memset(msgs, 0, sizeof(msgs[0]) * max_items);
+    for (uint8_t i = 0; i < max_items; i++) {
+        iov[i].iov_base = &sockcan_frames[i];
+        iov[i].iov_len  = sizeof(sockcan_frames[i]);
+        msgs[i].msg_hdr.msg_iov    = &iov[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+        msgs[i].msg_hdr.msg_control = control[i].data;
+        msgs[i].msg_hdr.msg_controllen = sizeof(control[i].data);
+    }
 
-    const int res = recvmsg(_fd, &msg, MSG_DONTWAIT);
+    const int res = recvmmsg(_fd, msgs, max_items, MSG_DONTWAIT, nullptr);
     if (res <= 0) {
         return (res < 0 && errno == EWOULDBLOCK) ? 0 : res;
     }
-    /*
-     * Flags
-     */
-    loopback = (msg.msg_flags & static_cast<int>(MSG_CONFIRM)) != 0;
-
-    if (!loopback && !_checkHWFilters(sockcan_frame)) {
-        return 0;
-    }
+    num_read = res;
 
-    frame = makeUavcanFrame(sockcan_frame);
     /*
      * Timestamp
      */
-    timestamp_us = AP_HAL::micros64();
-    return 1;
+    const uint64_t timestamp_us = AP_HAL::micros64();
+
+    int count = 0;
+    for (int i = 0; i < res; i++) {
+        /*
+         * Flags
+         */
+        const bool is_loopback = (msgs[i].msg_hdr.msg_flags & static_cast<int>(MSG_CONFIRM)) != 0;
+        if (!is_loopback && !_checkHWFilters(sockcan_frames[i])) {
+            continue;
+        }
+        items[count].frame = makeUavcanFrame(sockcan_frames[i]);
+        items[count].timestamp_us = timestamp_us;
+        items[count].flags = 0;
+        loopback[count] = is_loopback;
+        count++;
+    }
+    return count;
 }
 
 // Might block forever, only to be used for testing
@@ -553,7 +664,9 @@ void CANIface::get_stats(ExpandingString &str)
                "num_tx_poll_req:  %u\n"
                "num_poll_waits:   %u\n"
                "num_poll_tx_events: %u\n"
-               "num_poll_rx_events: %u\n",
+               "num_poll_rx_events: %u\n"
+               "num_rx_reads:   %u\n"
+               "num_tx_writes:  %u\n",
                stats.tx_requests,
                stats.tx_rejected,
                stats.tx_overflow,
@@ -567,7 +680,9 @@ void CANIface::get_stats(ExpandingString &str)
                stats.num_tx_poll_req,
                stats.num_poll_waits,
                stats.num_poll_tx_events,
-               stats.num_poll_rx_events);
+               stats.num_poll_rx_events,
+               stats.num_rx_reads,
+               stats.num_tx_writes);
 }
 
 #endif
@@ -53,6 +53,8 @@ enum class SocketCanError
 #define CAN_MAX_POLL_ITERATIONS_COUNT 100
 #define CAN_MAX_INIT_TRIES_COUNT 100
 #define CAN_FILTER_NUMBER 8
+// maximum number of frames moved by one recvmmsg() or sendmmsg() call
+#define CAN_MAX_SOCKET_BATCH 16
 
 class CANIface: public AP_HAL::CANIface {
 public:
@@ -77,6 +79,12 @@ public:
     int16_t receive(AP_HAL::CANFrame& out_frame, uint64_t& out_timestamp_us,
                     CanIOFlags& out_flags) override;
 
+    // Queue several frames with one lock and one socket write
+    int16_t send_batch(const CanTxRequest* requests, uint16_t count) override;
+
+    // Receive several frames with one lock and one socket read
+    int16_t receive_batch(CanRxItem* items, uint16_t max_items) override;
+
     // Set Filters to ignore frames not to be handled by us
     bool configureFilters(const CanFilterConfig* filter_configs,
                           uint16_t num_configs) override;
@@ -120,9 +128,11 @@ private:
 
     bool _pollRead();
 
-    int _write(const AP_HAL::CANFrame& frame) const;
+    int _write(const CanTxItem* items, uint8_t count, bool& buffer_full) const;
+
+    int _read(CanRxItem* items, bool* loopback, uint8_t max_items, uint8_t& num_read) const;
 
-    int _read(AP_HAL::CANFrame& frame, uint64_t& ts_usec, bool& loopback) const;
+    void _queueTx(const AP_HAL::CANFrame& frame, uint64_t tx_deadline, CanIOFlags flags);
 
     void _incrementNumFramesInSocketTxQueue();
 
@@ -171,6 +181,8 @@ private:
         uint32_t num_poll_waits;
         uint32_t num_poll_tx_events;
         uint32_t num_poll_rx_events;
+        uint32_t num_rx_reads;
+        uint32_t num_tx_writes;
     } stats;
 
 protected:
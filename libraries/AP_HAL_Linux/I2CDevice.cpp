@@ -197,6 +197,71 @@ bool I2CDevice::transfer(const uint8_t *send, uint32_t send_len,
     return r != -1;
 }
 
+static bool i2c_rdwr(int fd, struct i2c_msg *msgs, unsigned nmsgs, unsigned retries)
+{
+    struct i2c_rdwr_ioctl_data i2c_data = { };
+
+    i2c_data.msgs = msgs;
+    i2c_data.nmsgs = nmsgs;
+
+    int r;
+    do {
+        r = ::ioctl(fd, I2C_RDWR, &i2c_data);
+    } while (r == -1 && retries-- > 0);
+
+    return r != -1;
+}
+
+/*
+  queue the transfers behind as few I2C_RDWR ioctls as possible. The
+  messages of one ioctl are separated by repeated starts, so each
+  transfer is still a separate transaction for the device
+ */
+bool I2CDevice::transfer_list(const Transfer *transfers, uint8_t count)
+{
+    if (_split_transfers) {
+        return AP_HAL::I2CDevice::transfer_list(transfers, count);
+    }
+
+    struct i2c_msg msgs[I2C_RDRW_IOCTL_MAX_MSGS];
+    unsigned nmsgs = 0;
+
+    for (uint8_t i = 0; i < count; i++) {
+        const Transfer &t = transfers[i];
+        const bool has_send = t.send && t.send_len != 0;
+        const bool has_recv = t.recv && t.recv_len != 0;
+
+        /* interpret it as an input error if nothing has to be done */
+        if (!has_send && !has_recv) {
+            return false;
+        }
+
+        if (nmsgs + has_send + has_recv > I2C_RDRW_IOCTL_MAX_MSGS) {
+            if (!i2c_rdwr(_bus.fd, msgs, nmsgs, _retries)) {
+                return false;
+            }
+            nmsgs = 0;
+        }
+
+        if (has_send) {
+            msgs[nmsgs].addr = _address;
+            msgs[nmsgs].flags = 0;
+            msgs[nmsgs].buf = const_cast<uint8_t*>(t.send);
+            msgs[nmsgs].len = t.send_len;
+            nmsgs++;
+        }
+        if (has_recv) {
+            msgs[nmsgs].addr = _address;
+            msgs[nmsgs].flags = I2C_M_RD;
+            msgs[nmsgs].buf = t.recv;
+            msgs[nmsgs].len = t.recv_len;
+            nmsgs++;
+        }
+    }
+
+    return nmsgs == 0 || i2c_rdwr(_bus.fd, msgs, nmsgs, _retries);
+}
+
 bool I2CDevice::read_registers_multiple(uint8_t first_reg, uint8_t *recv,
                                         uint32_t recv_len, uint8_t times)
 {
@@ -251,6 +316,9 @@ AP_HAL::Semaphore *I2CDevice::get_semaphore()
 AP_HAL::Device::PeriodicHandle I2CDevice::register_periodic_callback(
     uint32_t period_usec, AP_HAL::Device::PeriodicCb cb)
 {
+    // devices on this bus may be registering from another thread
+    WITH_SEMAPHORE(_bus.sem);
+
     TimerPollable *p = _bus.thread.add_timer(cb, &_bus, period_usec);
     if (!p) {
         AP_HAL::panic("Could not create periodic callback");
@@ -286,6 +354,8 @@ I2CDeviceManager::get_device_ptr(uint8_t bus, uint8_t address,
                                  bool use_smbus,
                                  uint32_t timeout_ms)
 {
+    WITH_SEMAPHORE(_sem);
+
     for (uint8_t i = 0, n = _buses.size(); i < n; i++) {
         if (_buses[i]->bus == bus) {
             return _create_device(*_buses[i], address);
@@ -326,6 +396,8 @@ I2CDeviceManager::_create_device(I2CBus &b, uint8_t address) const
 
 void I2CDeviceManager::_unregister(I2CBus &b)
 {
+    WITH_SEMAPHORE(_sem);
+
     if (--b.ref > 0) {
         return;
     }
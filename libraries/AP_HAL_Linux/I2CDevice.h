@@ -57,6 +57,9 @@ public:
     bool transfer(const uint8_t *send, uint32_t send_len,
                   uint8_t *recv, uint32_t recv_len) override;
 
+    /* See AP_HAL::Device::transfer_list() */
+    bool transfer_list(const Transfer *transfers, uint8_t count) override;
+
     bool read_registers_multiple(uint8_t first_reg, uint8_t *recv,
                                  uint32_t recv_len, uint8_t times) override;
 
@@ -126,6 +129,8 @@ protected:
     void _unregister(I2CBus &b);
     AP_HAL::I2CDevice *_create_device(I2CBus &b, uint8_t address) const;
 
+    // protects _buses, sensors may be probed from several threads
+    Semaphore _sem;
     std::vector<I2CBus*> _buses;
 };
 
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <AP_Logger/LogStructure.h>
+
+#define LOG_IDS_FROM_HAL_LINUX \
+    LOG_TLAT_MSG
+
+// @LoggerMessage: TLAT
+// @Description: Linux periodic thread timing
+// @Field: TimeUS: Time since system startup
+// @Field: Name: thread name
+// @Field: Rate: thread rate
+// @Field: N: wakeups since the last message
+// @Field: Miss: periods missed since the last message
+// @Field: LAvg: average wakeup lateness since the last message
+// @Field: LMax: largest wakeup lateness since the last message
+// @Field: RAvg: average runtime since the last message
+// @Field: RMax: largest runtime since the last message
+struct PACKED log_TLAT {
+    LOG_PACKET_HEADER;
+    uint64_t time_us;
+    char name[16];
+    uint16_t rate;
+    uint32_t wakeups;
+    uint32_t missed;
+    uint32_t late_avg;
+    uint32_t late_max;
+    uint32_t run_avg;
+    uint32_t run_max;
+};
+
+#if CONFIG_HAL_BOARD == HAL_BOARD_LINUX
+#define LOG_STRUCTURE_FROM_HAL_LINUX                                    \
+    { LOG_TLAT_MSG, sizeof(log_TLAT),                                   \
+      "TLAT", "QNHIIIIII", "TimeUS,Name,Rate,N,Miss,LAvg,LMax,RAvg,RMax", "s-z--ssss", "F----FFFF", true },
+#else
+#define LOG_STRUCTURE_FROM_HAL_LINUX
+#endif
@@ -333,19 +333,12 @@ bool SPIDevice::transfer(const uint8_t *send, uint32_t send_len,
     }
 #endif
 
-    int r;
-    if (_desc.mode != _bus.last_mode) {
-        r = ioctl(fd, SPI_IOC_WR_MODE, &_desc.mode);
-        if (r < 0) {
-            hal.console->printf("SPIDevice: error on setting mode fd=%d (%s)\n",
-                                fd, strerror(errno));
-            return false;
-        }
-        _bus.last_mode = _desc.mode;
+    if (!_set_mode()) {
+        return false;
     }
 
     _cs_assert();
-    r = ioctl(fd, SPI_IOC_MESSAGE(nmsgs), &msgs);
+    int r = ioctl(fd, SPI_IOC_MESSAGE(nmsgs), &msgs);
     _cs_release();
 
     if (r == -1) {
@@ -357,6 +350,77 @@ bool SPIDevice::transfer(const uint8_t *send, uint32_t send_len,
     return true;
 }
 
+/*
+  queue all the transfers behind one SPI_IOC_MESSAGE ioctl. The kernel
+  releases CS after the last message of each transfer when cs_change
+  is set, so each transfer is still a separate transaction for the
+  device
+ */
+bool SPIDevice::transfer_list(const Transfer *transfers, uint8_t count)
+{
+    if (_desc.cs_pin != SPI_CS_KERNEL || count > TRANSFER_LIST_MAX) {
+        // a userspace CS can't be toggled between the messages of one ioctl
+        return AP_HAL::SPIDevice::transfer_list(transfers, count);
+    }
+
+    struct spi_ioc_transfer msgs[2 * TRANSFER_LIST_MAX] = { };
+    unsigned nmsgs = 0;
+    int fd = _bus.fd[_desc.subdev];
+
+    for (uint8_t i = 0; i < count; i++) {
+        const Transfer &t = transfers[i];
+        const unsigned first = nmsgs;
+        if (t.send && t.send_len != 0) {
+            msgs[nmsgs].tx_buf = (uint64_t) t.send;
+            msgs[nmsgs].len = t.send_len;
+            msgs[nmsgs].speed_hz = _speed;
+            msgs[nmsgs].bits_per_word = _desc.bits_per_word;
+            nmsgs++;
+        }
+        if (t.recv && t.recv_len != 0) {
+            msgs[nmsgs].rx_buf = (uint64_t) t.recv;
+            msgs[nmsgs].len = t.recv_len;
+            msgs[nmsgs].speed_hz = _speed;
+            msgs[nmsgs].bits_per_word = _desc.bits_per_word;
+            nmsgs++;
+        }
+        if (nmsgs == first) {
+            return false;
+        }
+        // deselect the device between transfers, but not after the last
+        // one or the kernel would keep it selected
+        msgs[nmsgs - 1].cs_change = (i + 1 < count);
+    }
+
+    if (!_set_mode()) {
+        return false;
+    }
+
+    int r = ioctl(fd, SPI_IOC_MESSAGE(nmsgs), &msgs);
+    if (r == -1) {
+        hal.console->printf("SPIDevice: error transferring data fd=%d (%s)\n",
+                            fd, strerror(errno));
+        return false;
+    }
+
+    return true;
+}
+
+bool SPIDevice::_set_mode()
+{
+    if (_desc.mode == _bus.last_mode) {
+        return true;
+    }
+    int fd = _bus.fd[_desc.subdev];
+    if (ioctl(fd, SPI_IOC_WR_MODE, &_desc.mode) < 0) {
+        hal.console->printf("SPIDevice: error on setting mode fd=%d (%s)\n",
+                            fd, strerror(errno));
+        return false;
+    }
+    _bus.last_mode = _desc.mode;
+    return true;
+}
+
 bool SPIDevice::transfer_fullduplex(const uint8_t *send, uint8_t *recv,
                                     uint32_t len)
 {
@@ -422,6 +486,9 @@ AP_HAL::Semaphore *SPIDevice::get_semaphore()
 AP_HAL::Device::PeriodicHandle SPIDevice::register_periodic_callback(
     uint32_t period_usec, AP_HAL::Device::PeriodicCb cb)
 {
+    // devices on this bus may be registering from another thread
+    WITH_SEMAPHORE(_bus.sem);
+
     TimerPollable *p = _bus.thread.add_timer(cb, &_bus, period_usec);
     if (!p) {
         AP_HAL::panic("Could not create periodic callback");
@@ -463,6 +530,8 @@ SPIDeviceManager::get_device(const char *name)
         return AP_HAL::OwnPtr<AP_HAL::SPIDevice>(nullptr);
     }
 
+    WITH_SEMAPHORE(_sem);
+
     /* Find if bus already exists */
     for (uint8_t i = 0, n = _buses.size(); i < n; i++) {
         if (_buses[i]->bus == desc->bus) {
@@ -515,6 +584,8 @@ SPIDeviceManager::_create_device(SPIBus &b, SPIDesc &desc) const
 
 void SPIDeviceManager::_unregister(SPIBus &b)
 {
+    WITH_SEMAPHORE(_sem);
+
     if (b.ref == 0 || --b.ref > 0) {
         return;
     }
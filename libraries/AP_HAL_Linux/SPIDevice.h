@@ -22,6 +22,8 @@
 #include <AP_HAL/HAL.h>
 #include <AP_HAL/SPIDevice.h>
 
+#include "Semaphores.h"
+
 namespace Linux {
 
 class SPIBus;
@@ -42,6 +44,9 @@ public:
     bool transfer(const uint8_t *send, uint32_t send_len,
                   uint8_t *recv, uint32_t recv_len) override;
 
+    /* See AP_HAL::Device::transfer_list() */
+    bool transfer_list(const Transfer *transfers, uint8_t count) override;
+
     /* See AP_HAL::SPIDevice::transfer_fullduplex() */
     bool transfer_fullduplex(const uint8_t *send, uint8_t *recv,
                              uint32_t len) override;
@@ -63,6 +68,11 @@ protected:
     AP_HAL::DigitalSource *_cs;
     uint32_t _speed;
 
+    /*
+     * Set the SPI mode of the bus for this device if another device changed it
+     */
+    bool _set_mode();
+
     /*
      * Select device if using userspace CS
      */
@@ -109,6 +119,8 @@ protected:
     void _unregister(SPIBus &b);
     AP_HAL::OwnPtr<AP_HAL::SPIDevice> _create_device(SPIBus &b, SPIDesc &device_desc) const;
 
+    // protects _buses, sensors may be probed from several threads
+    Semaphore _sem;
     std::vector<SPIBus*> _buses;
 
     static const uint8_t _n_device_desc;
@@ -114,6 +114,24 @@ int SPIUARTDriver::_write_fd(const uint8_t *buf, uint16_t size)
     return ret;
 }
 
+int SPIUARTDriver::_writev_fd(const struct iovec *iov, int iovcnt)
+{
+    if (_external) {
+        return UARTDriver::_writev_fd(iov, iovcnt);
+    }
+
+    int total = 0;
+    for (int i = 0; i < iovcnt; i++) {
+        const int ret = _write_fd((const uint8_t *)iov[i].iov_base, iov[i].iov_len);
+        if (ret <= 0) {
+            break;
+        }
+        total += ret;
+    }
+
+    return total;
+}
+
 int SPIUARTDriver::_read_fd(uint8_t *buf, uint16_t n)
 {
     static uint8_t ff_stub[100] = {0xff};
@@ -139,6 +157,12 @@ int SPIUARTDriver::_read_fd(uint8_t *buf, uint16_t n)
     return n;
 }
 
+int SPIUARTDriver::_get_read_fd() const
+{
+    // the SPI UART has to be polled
+    return _external ? UARTDriver::_get_read_fd() : -1;
+}
+
 void SPIUARTDriver::_timer_tick(void)
 {
     if (_external) {
@@ -9,6 +9,7 @@
 #include <sys/time.h>
 #include <unistd.h>
 
+#include <AP_Common/ExpandingString.h>
 #include <AP_HAL/AP_HAL.h>
 #include <AP_Math/AP_Math.h>
 #include <AP_Vehicle/AP_Vehicle_Type.h>
@@ -65,7 +66,7 @@ Scheduler::Scheduler()
 }
 
 
-void Scheduler::init_realtime()
+void Scheduler::init_realtime(int policy, int prio)
 {
 #if APM_BUILD_TYPE(APM_BUILD_Replay)
     // we don't run Replay in real-time...
@@ -81,24 +82,55 @@ void Scheduler::init_realtime()
 
     mlockall(MCL_CURRENT|MCL_FUTURE);
 
-    struct sched_param param = { .sched_priority = APM_LINUX_MAIN_PRIORITY };
-    if (pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) == -1) {
+    struct sched_param param = { .sched_priority = prio };
+    if (pthread_setschedparam(pthread_self(), policy, &param) == -1) {
         AP_HAL::panic("Scheduler: failed to set scheduling parameters: %s",
                       strerror(errno));
     }
 }
 
-void Scheduler::init_cpu_affinity()
+void Scheduler::init_cpu_affinity(const cpu_set_t *main_cpus)
 {
     if (!CPU_COUNT(&_cpu_affinity)) {
-        return;
+        if (main_cpus == nullptr) {
+            return;
+        }
+        // threads would inherit the cpus of the main thread, keep the
+        // ones the process started with for them instead
+        if (sched_getaffinity(0, sizeof(_cpu_affinity), &_cpu_affinity) != 0) {
+            AP_HAL::panic("Failed to get affinity for main process: %m");
+        }
     }
 
-    if (sched_setaffinity(0, sizeof(_cpu_affinity), &_cpu_affinity) != 0) {
+    const cpu_set_t &cpus = main_cpus != nullptr ? *main_cpus : _cpu_affinity;
+    if (sched_setaffinity(0, sizeof(cpus), &cpus) != 0) {
         AP_HAL::panic("Failed to set affinity for main process: %m");
     }
 }
 
+bool Scheduler::get_thread_placement(const char *name, int &policy, int &prio, cpu_set_t &cpus) const
+{
+    if (_thread_policy.apply(name, policy, prio, cpus)) {
+        return true;
+    }
+    if (!CPU_COUNT(&_cpu_affinity)) {
+        return false;
+    }
+    cpus = _cpu_affinity;
+    return true;
+}
+
+void Scheduler::thread_info(ExpandingString &str)
+{
+    // periodic threads give their average/largest wakeup lateness and
+    // runtime, and a histogram of the lateness in these bins
+    str.printf("BINS=<10us,<20us,<50us,<100us,<200us,<500us,<1ms,>=1ms\n");
+    if (Thread::print_info(str, "ap-main", _main_ctx, 0, _main_last_cpu_ns, _main_last_info_us)) {
+        str.printf("\n");
+    }
+    Thread::threads_info(str);
+}
+
 void Scheduler::init()
 {
     int ret;
@@ -117,8 +149,13 @@ void Scheduler::init()
 
     _main_ctx = pthread_self();
 
-    init_realtime();
-    init_cpu_affinity();
+    int main_policy = SCHED_FIFO;
+    int main_prio = APM_LINUX_MAIN_PRIORITY;
+    cpu_set_t main_cpus;
+    const bool main_pinned = _thread_policy.apply("ap-main", main_policy, main_prio, main_cpus);
+
+    init_realtime(main_policy, main_prio);
+    init_cpu_affinity(main_pinned ? &main_cpus : nullptr);
 
     /* set barrier to N + 1 threads: worker threads + main */
     unsigned n_threads = ARRAY_SIZE(sched_table) + 1;
@@ -359,6 +396,39 @@ bool Scheduler::SchedulerThread::_run()
     return PeriodicThread::_run();
 }
 
+bool Scheduler::UARTThread::_run()
+{
+    _sched._wait_all_threads();
+
+    if (_period_usec == 0) {
+        return false;
+    }
+
+    while (!_should_exit) {
+        // read callbacks run from inside poll()
+        if (_sched._uart_poller.poll(_period_usec / 1000) < 0) {
+            _sched.microsleep(_period_usec);
+        }
+        _task();
+    }
+
+    _started = false;
+    _should_exit = false;
+
+    return true;
+}
+
+bool Scheduler::UARTThread::stop()
+{
+    if (!PeriodicThread::stop()) {
+        return false;
+    }
+
+    _sched._uart_poller.wakeup();
+
+    return true;
+}
+
 void Scheduler::teardown()
 {
     _timer_thread.stop();
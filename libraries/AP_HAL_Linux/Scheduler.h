@@ -4,8 +4,10 @@
 
 #include "AP_HAL_Linux.h"
 
+#include "Poller.h"
 #include "Semaphores.h"
 #include "Thread.h"
+#include "ThreadPolicy.h"
 
 #define LINUX_SCHEDULER_MAX_TIMER_PROCS 10
 #define LINUX_SCHEDULER_MAX_TIMESLICED_PROCS 10
@@ -60,6 +62,25 @@ public:
      */
     void set_cpu_affinity(const cpu_set_t &cpu_affinity) { _cpu_affinity = cpu_affinity; }
 
+    /*
+      placement of individual threads, loaded from the --thread-policy
+      file before init()
+     */
+    ThreadPolicy &thread_policy() { return _thread_policy; }
+
+    /*
+      apply the thread policy and cpu affinity to a new thread. Returns
+      true and fills in cpus if the thread needs its cpu affinity set
+     */
+    bool get_thread_placement(const char *name, int &policy, int &prio, cpu_set_t &cpus) const;
+
+    // append a line for the main thread and each other thread to str
+    void thread_info(ExpandingString &str);
+
+    // poller the uart thread sleeps in, UARTs register their devices
+    // with it to be read as soon as they have data
+    Poller &uart_poller() { return _uart_poller; }
+
 private:
     class SchedulerThread : public PeriodicThread {
     public:
@@ -74,9 +95,30 @@ private:
         Scheduler &_sched;
     };
 
-    void     init_realtime();
+    /*
+      the uart thread waits on _uart_poller rather than sleeping for a
+      fixed period, so it handles received data as soon as it arrives.
+      Its period is the longest it waits before writing pending data
+     */
+    class UARTThread : public SchedulerThread {
+    public:
+        UARTThread(Thread::task_t t, Scheduler &sched)
+            : SchedulerThread(t, sched)
+        { }
+
+        bool stop() override;
+
+    protected:
+        bool _run() override;
+
+        // wakeup lateness means nothing for this thread
+        void _print_stats(ExpandingString &str) override { }
+        bool _log_stats() override { return false; }
+    };
+
+    void     init_realtime(int policy, int prio);
 
-    void     init_cpu_affinity();
+    void     init_cpu_affinity(const cpu_set_t *main_cpus);
 
     void _wait_all_threads();
 
@@ -101,7 +143,7 @@ private:
     SchedulerThread _timer_thread{FUNCTOR_BIND_MEMBER(&Scheduler::_timer_task, void), *this};
     SchedulerThread _io_thread{FUNCTOR_BIND_MEMBER(&Scheduler::_io_task, void), *this};
     SchedulerThread _rcin_thread{FUNCTOR_BIND_MEMBER(&Scheduler::_rcin_task, void), *this};
-    SchedulerThread _uart_thread{FUNCTOR_BIND_MEMBER(&Scheduler::_uart_task, void), *this};
+    UARTThread _uart_thread{FUNCTOR_BIND_MEMBER(&Scheduler::_uart_task, void), *this};
 
     void _timer_task();
     void _io_task();
@@ -116,7 +158,13 @@ private:
     pthread_t _main_ctx;
 
     Semaphore _io_semaphore;
+    Poller _uart_poller;
     cpu_set_t _cpu_affinity;
+    ThreadPolicy _thread_policy;
+
+    // cpu use of the main thread for thread_info()
+    uint64_t _main_last_cpu_ns;
+    uint64_t _main_last_info_us;
 };
 
 }
@@ -2,6 +2,7 @@
 
 #include <stdint.h>
 #include <stdlib.h>
+#include <sys/uio.h>
 
 #include "AP_HAL_Linux.h"
 
@@ -23,4 +24,30 @@ public:
 
     /* Depends on lower level to implement, most devices are fine with defaults */
     virtual void set_parity(int v) { }
+
+    /*
+     * Write the iovcnt buffers in iov. Devices that can should do it in a
+     * single system call, and datagram devices as a single datagram.
+     */
+    virtual ssize_t writev(const struct iovec *iov, int iovcnt)
+    {
+        ssize_t total = 0;
+        for (int i = 0; i < iovcnt; i++) {
+            const ssize_t ret = write((const uint8_t *)iov[i].iov_base, iov[i].iov_len);
+            if (ret < 0) {
+                return total > 0 ? total : ret;
+            }
+            total += ret;
+            if ((size_t)ret < iov[i].iov_len) {
+                break;
+            }
+        }
+        return total;
+    }
+
+    /*
+     * File descriptor that becomes readable when read() has data, or -1
+     * if the device has to be polled. It may change after open() or read().
+     */
+    virtual int get_read_fd() const { return -1; }
 };
@@ -9,17 +9,35 @@
 #include <unistd.h>
 
 #include <AP_HAL/AP_HAL.h>
+#include <AP_Math/crc.h>
 
 using namespace Linux;
 
 /*
-  This stores 'eeprom' data on the SD card, with a 4k size, and a
+  This stores 'eeprom' data on the SD card, with a 16k size, and a
   in-memory buffer. This keeps the latency down.
+
+  Changes are not written back into the storage file. They are
+  appended to a journal, coalescing a burst of writes such as a
+  parameter upload into one write and one fdatasync(). When the journal
+  grows past LINUX_STORAGE_JOURNAL_MAX the storage file is rewritten
+  through a temporary file and rename(), and the journal emptied. The
+  new file holds the storage as of the last journal write, not any
+  later changes, so replaying the journal over it gives the same
+  contents. On startup the journal is replayed over the storage file
+  up to the first record with a bad crc, so a power loss at any point
+  leaves the storage as it was after the last record written in full,
+  and is then compacted the same way.
  */
 
 // name the storage file after the sketch so you can use the same board
 // card for ArduCopter and ArduPlane
 #define STORAGE_FILE AP_BUILD_TARGET_NAME ".stg"
+#define STORAGE_JOURNAL_FILE STORAGE_FILE ".jnl"
+#define STORAGE_TMP_FILE STORAGE_FILE ".tmp"
+
+// crc seed so a zero filled journal is not valid
+#define STORAGE_JOURNAL_CRC_SEED 0x4A524E4CU
 
 extern const AP_HAL::HAL& hal;
 
@@ -121,7 +139,7 @@ int Storage::_storage_create(const char *dpath)
     fsync(fd);
     fsync(dfd);
 
-    close(dfd);
+    _dir_fd = dfd;
 
     return fd;
 
@@ -138,13 +156,19 @@ void Storage::init()
         return;
     }
 
-    _dirty_mask = 0;
-
     dpath = hal.util->get_custom_storage_directory();
     if (!dpath) {
         dpath = HAL_BOARD_STORAGE_DIRECTORY;
     }
 
+    _open(dpath);
+    _initialised = true;
+}
+
+void Storage::_open(const char *dpath)
+{
+    memset(_dirty_mask, 0, sizeof(_dirty_mask));
+
     int fd = _storage_create(dpath);
     if (fd == -1) {
         AP_HAL::panic("Cannot create storage %s (%m)", dpath);
@@ -157,16 +181,57 @@ void Storage::init()
         AP_HAL::panic("Failed to read %s (%m)", dpath);
     }
 
+    _journal_fd = openat(_dir_fd, STORAGE_JOURNAL_FILE, O_RDWR|O_CREAT|O_APPEND|O_CLOEXEC, 0666);
+    if (_journal_fd == -1) {
+        close(fd);
+        AP_HAL::panic("Failed to open %s/%s (%m)", dpath, STORAGE_JOURNAL_FILE);
+    }
+
     _fd = fd;
-    _initialised = true;
+    _replay_journal();
+    memcpy(_journaled, _buffer, sizeof(_journaled));
+
+    // fold the journal into the storage file so it holds the current
+    // contents rather than those of the last compaction. If this fails
+    // the journal is still good and is appended to as before
+    if (_journal_size > 0 && !_compact()) {
+        fprintf(stderr, "Failed to compact storage journal (%m)\n");
+    }
+}
+
+void Storage::_replay_journal()
+{
+    uint32_t valid = 0;
+    JournalRecord rec;
+    uint8_t data[LINUX_STORAGE_MAX_WRITE];
+
+    while (pread(_journal_fd, &rec, sizeof(rec), valid) == sizeof(rec)) {
+        if (rec.length == 0 || rec.length > sizeof(data) ||
+            rec.offset + rec.length > sizeof(_buffer) ||
+            pread(_journal_fd, data, rec.length, valid + sizeof(rec)) != rec.length) {
+            break;
+        }
+        uint32_t crc = crc_crc32(STORAGE_JOURNAL_CRC_SEED, (const uint8_t *)&rec.offset, 4);
+        crc = crc_crc32(crc, data, rec.length);
+        if (crc != rec.crc) {
+            break;
+        }
+        memcpy(&_buffer[rec.offset], data, rec.length);
+        valid += sizeof(rec) + rec.length;
+    }
+
+    // drop a record torn by a power loss so appends follow the last
+    // good one
+    if (ftruncate(_journal_fd, valid) == -1) {
+        fprintf(stderr, "Failed to truncate storage journal (%m)\n");
+    }
+    _journal_size = valid;
 }
 
 /*
-  mark some lines as dirty. Note that there is no attempt to avoid
-  the race condition between this code and the _timer_tick() code
-  below, which both update _dirty_mask. If we lose the race then the
-  result is that a line is written more than once, but it won't result
-  in a line not being written.
+  mark some chunks as dirty. The bits are set and cleared atomically
+  so a chunk changed while _write_journal() runs is written again on
+  the next call
  */
 void Storage::_mark_dirty(uint16_t loc, uint16_t length)
 {
@@ -174,11 +239,17 @@ void Storage::_mark_dirty(uint16_t loc, uint16_t length)
         return;
     }
     uint16_t end = loc + length - 1;
-    for (uint8_t line=loc>>LINUX_STORAGE_LINE_SHIFT;
-         line <= end>>LINUX_STORAGE_LINE_SHIFT;
-         line++) {
-        _dirty_mask |= 1U << line;
+    for (uint16_t chunk=loc>>LINUX_STORAGE_CHUNK_SHIFT;
+         chunk <= end>>LINUX_STORAGE_CHUNK_SHIFT;
+         chunk++) {
+        __atomic_fetch_or(&_dirty_mask[chunk / 32], 1U << (chunk % 32), __ATOMIC_RELAXED);
+    }
+
+    const uint32_t now_ms = AP_HAL::millis();
+    if (_first_dirty_ms == 0) {
+        _first_dirty_ms = now_ms;
     }
+    _last_dirty_ms = now_ms;
 }
 
 void Storage::read_block(void *dst, uint16_t loc, size_t n)
@@ -197,60 +268,157 @@ void Storage::write_block(uint16_t loc, const void *src, size_t n)
     }
     if (memcmp(src, &_buffer[loc], n) != 0) {
         init();
+        WITH_SEMAPHORE(_sem);
         memcpy(&_buffer[loc], src, n);
         _mark_dirty(loc, n);
     }
 }
 
-void Storage::_timer_tick(void)
+bool Storage::_write_journal()
 {
-    if (!_initialised || _dirty_mask == 0 || _fd == -1) {
-        return;
-    }
+    uint32_t dirty[ARRAY_SIZE(_dirty_mask)];
+    uint32_t len = 0;
 
-    // write out the first dirty set of lines. We don't write more
-    // than one to keep the latency of this call to a minimum
-    uint8_t i, n;
-    for (i=0; i<LINUX_STORAGE_NUM_LINES; i++) {
-        if (_dirty_mask & (1<<i)) {
-            break;
+    /*
+      take the dirty chunks and copy them out together, so a
+      write_block() is either wholly in this journal write or wholly
+      in the next one
+     */
+    {
+        WITH_SEMAPHORE(_sem);
+
+        for (uint8_t i=0; i<ARRAY_SIZE(_dirty_mask); i++) {
+            dirty[i] = __atomic_exchange_n(&_dirty_mask[i], 0, __ATOMIC_RELAXED);
+        }
+
+        // one record for each run of dirty chunks
+        uint16_t chunk = 0;
+        while (chunk < LINUX_STORAGE_NUM_CHUNKS) {
+            if (!(dirty[chunk / 32] & (1U << (chunk % 32)))) {
+                chunk++;
+                continue;
+            }
+            uint16_t n = 1;
+            while (chunk + n < LINUX_STORAGE_NUM_CHUNKS &&
+                   n < (LINUX_STORAGE_MAX_WRITE >> LINUX_STORAGE_CHUNK_SHIFT) &&
+                   (dirty[(chunk + n) / 32] & (1U << ((chunk + n) % 32)))) {
+                n++;
+            }
+
+            JournalRecord rec;
+            rec.offset = chunk << LINUX_STORAGE_CHUNK_SHIFT;
+            rec.length = n << LINUX_STORAGE_CHUNK_SHIFT;
+            uint8_t *data = &_journal_buf[len + sizeof(rec)];
+            memcpy(data, &_buffer[rec.offset], rec.length);
+            rec.crc = crc_crc32(STORAGE_JOURNAL_CRC_SEED, (const uint8_t *)&rec.offset, 4);
+            rec.crc = crc_crc32(rec.crc, data, rec.length);
+            memcpy(&_journal_buf[len], &rec, sizeof(rec));
+            len += sizeof(rec) + rec.length;
+
+            chunk += n;
         }
     }
-    if (i == LINUX_STORAGE_NUM_LINES) {
-        // this shouldn't be possible
-        return;
+
+    if (len == 0) {
+        return true;
     }
-    uint32_t write_mask = (1U<<i);
-    // see how many lines to write
-    for (n=1; (i+n) < LINUX_STORAGE_NUM_LINES &&
-             n < (LINUX_STORAGE_MAX_WRITE>>LINUX_STORAGE_LINE_SHIFT); n++) {
-        if (!(_dirty_mask & (1<<(n+i)))) {
-            break;
+
+    if (write(_journal_fd, _journal_buf, len) != (ssize_t)len ||
+        fdatasync(_journal_fd) != 0) {
+        // put the chunks back for the next attempt
+        for (uint8_t i=0; i<ARRAY_SIZE(_dirty_mask); i++) {
+            __atomic_fetch_or(&_dirty_mask[i], dirty[i], __ATOMIC_RELAXED);
         }
-        // mark that line clean
-        write_mask |= (1<<(n+i));
+        return false;
+    }
+    _journal_size += len;
+
+    // the records are now in the journal, so are part of what a
+    // replay gives
+    for (uint32_t ofs = 0; ofs < len; ) {
+        JournalRecord rec;
+        memcpy(&rec, &_journal_buf[ofs], sizeof(rec));
+        memcpy(&_journaled[rec.offset], &_journal_buf[ofs + sizeof(rec)], rec.length);
+        ofs += sizeof(rec) + rec.length;
+    }
+
+    return true;
+}
+
+bool Storage::_compact_file()
+{
+    int fd = openat(_dir_fd, STORAGE_TMP_FILE, O_RDWR|O_CREAT|O_TRUNC|O_CLOEXEC, 0666);
+    if (fd == -1) {
+        return false;
     }
 
     /*
-      write the lines. This also updates _dirty_mask. Note that
-      because this is a SCHED_FIFO thread it will not be preempted
-      by the main task except during blocking calls. This means we
-      don't need a semaphore around the _dirty_mask updates.
+      write the journaled contents rather than _buffer, which may hold
+      changes not in the journal yet. If power is lost before the
+      journal is emptied it is replayed over this file, which then
+      gives the same contents as this file
      */
-    if (lseek(_fd, i<<LINUX_STORAGE_LINE_SHIFT, SEEK_SET) == (i<<LINUX_STORAGE_LINE_SHIFT)) {
-        _dirty_mask &= ~write_mask;
-        if (write(_fd, &_buffer[i<<LINUX_STORAGE_LINE_SHIFT], n<<LINUX_STORAGE_LINE_SHIFT) != n<<LINUX_STORAGE_LINE_SHIFT) {
-            // write error - likely EINTR
-            _dirty_mask |= write_mask;
-            close(_fd);
-            _fd = -1;
-        }
-        if (_dirty_mask == 0) {
-            if (fsync(_fd) != 0) {
-                close(_fd);
-                _fd = -1;
-            }
-        }
+    if (write(fd, _journaled, sizeof(_journaled)) != sizeof(_journaled) ||
+        fsync(fd) != 0 ||
+        renameat(_dir_fd, STORAGE_TMP_FILE, _dir_fd, STORAGE_FILE) != 0 ||
+        fsync(_dir_fd) != 0) {
+        close(fd);
+        return false;
+    }
+
+    close(_fd);
+    _fd = fd;
+
+    return true;
+}
+
+bool Storage::_compact()
+{
+    if (!_compact_file()) {
+        return false;
+    }
+
+    if (ftruncate(_journal_fd, 0) != 0 || fsync(_journal_fd) != 0) {
+        return false;
+    }
+    _journal_size = 0;
+
+    return true;
+}
+
+void Storage::_close_files()
+{
+    close(_journal_fd);
+    _journal_fd = -1;
+    close(_fd);
+    _fd = -1;
+}
+
+/*
+  write out changes once they have stopped coming in. Runs in the io
+  thread, so the main and timer threads never wait for the disk
+ */
+void Storage::_timer_tick(void)
+{
+    if (!_initialised || _first_dirty_ms == 0 || _journal_fd == -1) {
+        return;
+    }
+
+    const uint32_t now_ms = AP_HAL::millis();
+    if (now_ms - _last_dirty_ms < LINUX_STORAGE_COALESCE_MS &&
+        now_ms - _first_dirty_ms < LINUX_STORAGE_MAX_DELAY_MS) {
+        return;
+    }
+    // changes from here on start a new burst
+    _first_dirty_ms = 0;
+
+    if (!_write_journal()) {
+        _close_files();
+        return;
+    }
+
+    if (_journal_size > LINUX_STORAGE_JOURNAL_MAX && !_compact()) {
+        _close_files();
     }
 }
 
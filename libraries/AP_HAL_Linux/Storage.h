@@ -3,17 +3,27 @@
 #include <AP_HAL/AP_HAL.h>
 
 #define LINUX_STORAGE_SIZE HAL_STORAGE_SIZE
+// changes are tracked and journaled in chunks of this size
+#define LINUX_STORAGE_CHUNK_SHIFT 6
+#define LINUX_STORAGE_CHUNK_SIZE (1<<LINUX_STORAGE_CHUNK_SHIFT)
+#define LINUX_STORAGE_NUM_CHUNKS (LINUX_STORAGE_SIZE/LINUX_STORAGE_CHUNK_SIZE)
+// most data in one journal record
 #define LINUX_STORAGE_MAX_WRITE 512
-#define LINUX_STORAGE_LINE_SHIFT 9
-#define LINUX_STORAGE_LINE_SIZE (1<<LINUX_STORAGE_LINE_SHIFT)
-#define LINUX_STORAGE_NUM_LINES (LINUX_STORAGE_SIZE/LINUX_STORAGE_LINE_SIZE)
+// changes are journaled once there have been none for
+// LINUX_STORAGE_COALESCE_MS, or the oldest has waited
+// LINUX_STORAGE_MAX_DELAY_MS
+#define LINUX_STORAGE_COALESCE_MS 100
+#define LINUX_STORAGE_MAX_DELAY_MS 1000
+// journal size at which the storage file is rewritten and the
+// journal emptied
+#define LINUX_STORAGE_JOURNAL_MAX (64 * 1024)
 
 namespace Linux {
 
 class Storage : public AP_HAL::Storage
 {
 public:
-    Storage() : _fd(-1),_dirty_mask(0) { }
+    Storage() : _fd(-1), _dir_fd(-1), _journal_fd(-1) { }
 
     static Storage *from(AP_HAL::Storage *storage) {
         return static_cast<Storage*>(storage);
@@ -37,13 +47,54 @@ public:
     virtual void _timer_tick(void) override;
 
 protected:
+    /*
+      each record in the journal is this header followed by length
+      bytes of data for offset in the storage. The crc covers the
+      offset, length and data
+     */
+    struct PACKED JournalRecord {
+        uint32_t crc;
+        uint16_t offset;
+        uint16_t length;
+    };
+
     void _mark_dirty(uint16_t loc, uint16_t length);
     int _storage_create(const char *dpath);
+    // open the storage in dpath, replay the journal and compact it
+    void _open(const char *dpath);
+
+    // apply the journal to _buffer and drop any partly written record
+    // at its end
+    void _replay_journal();
+    // append the dirty chunks to the journal and sync it
+    bool _write_journal();
+    // rewrite the storage file from _journaled and empty the journal
+    bool _compact();
+    // the first step of _compact(), replacing the storage file
+    bool _compact_file();
+    void _close_files();
 
+    // the storage file, its directory and the journal of changes to it
     int _fd;
+    int _dir_fd;
+    int _journal_fd;
+    uint32_t _journal_size;
+
     volatile bool _initialised;
-    volatile uint32_t _dirty_mask;
+    // held while _buffer and _dirty_mask change, and while
+    // _write_journal() takes a copy of the dirty chunks
+    HAL_Semaphore _sem;
+    // chunks changed since they were last journaled
+    uint32_t _dirty_mask[LINUX_STORAGE_NUM_CHUNKS / 32];
+    volatile uint32_t _first_dirty_ms;
+    volatile uint32_t _last_dirty_ms;
     uint8_t _buffer[LINUX_STORAGE_SIZE];
+    // the storage as of the last journal write, which is what a replay
+    // of the journal gives. Only used by the io thread
+    uint8_t _journaled[LINUX_STORAGE_SIZE];
+
+    // journal records for one _write_journal(), at worst one record per chunk
+    uint8_t _journal_buf[LINUX_STORAGE_SIZE + LINUX_STORAGE_NUM_CHUNKS * sizeof(JournalRecord)];
 };
 
 }
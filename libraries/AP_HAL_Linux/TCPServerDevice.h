@@ -18,6 +18,12 @@ public:
     virtual void set_speed(uint32_t speed) override;
     virtual ssize_t write(const uint8_t *buf, uint16_t n) override;
     virtual ssize_t read(uint8_t *buf, uint16_t n) override;
+    virtual ssize_t writev(const struct iovec *iov, int iovcnt) override;
+
+    // the listening socket until a client connects, so read() can accept it
+    virtual int get_read_fd() const override {
+        return sock != nullptr ? sock->get_read_fd() : listener.get_read_fd();
+    }
 
 private:
     SocketAPM_native listener{false};
@@ -20,10 +20,13 @@
 #include <limits.h>
 #include <sys/types.h>
 #include <stdio.h>
+#include <time.h>
 #include <unistd.h>
 #include <utility>
 
+#include <AP_Common/ExpandingString.h>
 #include <AP_HAL/AP_HAL.h>
+#include <AP_Logger/AP_Logger.h>
 #include <AP_Math/AP_Math.h>
 #include "Scheduler.h"
 
@@ -33,6 +36,21 @@ extern const AP_HAL::HAL &hal;
 
 namespace Linux {
 
+// started threads, for threads_info()
+static Thread *_threads;
+static pthread_mutex_t _threads_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+Thread::~Thread()
+{
+    pthread_mutex_lock(&_threads_mutex);
+    for (Thread **t = &_threads; *t != nullptr; t = &(*t)->_next) {
+        if (*t == this) {
+            *t = _next;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&_threads_mutex);
+}
 
 void *Thread::_run_trampoline(void *arg)
 {
@@ -164,6 +182,11 @@ bool Thread::start(const char *name, int policy, int prio)
         return false;
     }
 
+    // the thread policy given on the command line can move the thread
+    // to other cpus or change its priority
+    cpu_set_t cpus;
+    const bool set_cpus = Scheduler::from(hal.scheduler)->get_thread_placement(name, policy, prio, cpus);
+
     struct sched_param param = { .sched_priority = prio };
     pthread_attr_t attr;
     int r;
@@ -184,6 +207,11 @@ bool Thread::start(const char *name, int policy, int prio)
         }
     }
 
+    if (set_cpus && (r = pthread_attr_setaffinity_np(&attr, sizeof(cpus), &cpus)) != 0) {
+        AP_HAL::panic("Failed to set cpu affinity for thread '%s': %s",
+                      name, strerror(r));
+    }
+
     if (_stack_size) {
         if (pthread_attr_setstacksize(&attr, _stack_size) != 0) {
             return false;
@@ -199,8 +227,21 @@ bool Thread::start(const char *name, int policy, int prio)
 
     if (name) {
         pthread_setname_np(_ctx, name);
+        strncpy(_name, name, sizeof(_name) - 1);
     }
 
+    // a stopped thread can be started again and is already listed
+    pthread_mutex_lock(&_threads_mutex);
+    Thread *t = _threads;
+    while (t != nullptr && t != this) {
+        t = t->_next;
+    }
+    if (t == nullptr) {
+        _next = _threads;
+        _threads = this;
+    }
+    pthread_mutex_unlock(&_threads_mutex);
+
     _started = true;
 
     return true;
@@ -227,6 +268,96 @@ bool Thread::join()
     return true;
 }
 
+bool Thread::print_info(ExpandingString &str, const char *name, pthread_t ctx,
+                        size_t stack_usage, uint64_t &last_cpu_ns, uint64_t &last_us)
+{
+    clockid_t clock;
+    struct timespec ts;
+    int policy;
+    struct sched_param param;
+    cpu_set_t cpus;
+    if (pthread_getcpuclockid(ctx, &clock) != 0 ||
+        clock_gettime(clock, &ts) != 0 ||
+        pthread_getschedparam(ctx, &policy, &param) != 0 ||
+        pthread_getaffinity_np(ctx, sizeof(cpus), &cpus) != 0) {
+        // the thread has exited
+        return false;
+    }
+
+    const uint64_t cpu_ns = ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+    const uint64_t now_us = AP_HAL::micros64();
+    float load = 0;
+    if (last_us != 0 && now_us > last_us) {
+        load = 0.1f * (cpu_ns - last_cpu_ns) / (now_us - last_us);
+    }
+    last_cpu_ns = cpu_ns;
+    last_us = now_us;
+
+    // cpus as a list of ranges, as taken by --cpu-affinity
+    char cpu_list[32] {};
+    size_t len = 0;
+    for (int i = 0; i < CPU_SETSIZE && len < sizeof(cpu_list) - 1; i++) {
+        if (!CPU_ISSET(i, &cpus) || (i > 0 && CPU_ISSET(i - 1, &cpus))) {
+            continue;
+        }
+        int last = i;
+        while (last + 1 < CPU_SETSIZE && CPU_ISSET(last + 1, &cpus)) {
+            last++;
+        }
+        const char *sep = len > 0 ? "," : "";
+        if (last == i) {
+            len += snprintf(&cpu_list[len], sizeof(cpu_list) - len, "%s%d", sep, i);
+        } else {
+            len += snprintf(&cpu_list[len], sizeof(cpu_list) - len, "%s%d-%d", sep, i, last);
+        }
+    }
+
+    str.printf("%-15.15s %s PRI=%2d CPUS=%-7s LOAD=%5.1f%% STACK=%u",
+               name, policy == SCHED_FIFO ? "FIFO " : "OTHER",
+               param.sched_priority, cpu_list, load, unsigned(stack_usage));
+    return true;
+}
+
+void Thread::threads_info(ExpandingString &str)
+{
+    pthread_mutex_lock(&_threads_mutex);
+    for (Thread *t = _threads; t != nullptr; t = t->_next) {
+        if (t->_started &&
+            print_info(str, t->_name, t->_ctx, t->get_stack_usage(),
+                       t->_last_cpu_ns, t->_last_info_us)) {
+            t->_print_stats(str);
+            str.printf("\n");
+        }
+    }
+    pthread_mutex_unlock(&_threads_mutex);
+}
+
+void Thread::log_next_thread()
+{
+    // position in the list of the next thread to log
+    static uint8_t next;
+
+    pthread_mutex_lock(&_threads_mutex);
+    uint8_t count = 0;
+    for (Thread *t = _threads; t != nullptr; t = t->_next) {
+        count++;
+    }
+    // skip threads without timing, at most once round the list
+    for (uint8_t tries = 0; tries < count; tries++) {
+        if (next >= count) {
+            next = 0;
+        }
+        Thread *t = _threads;
+        for (uint8_t i = 0; i < next; i++) {
+            t = t->_next;
+        }
+        next++;
+        if (t->_started && t->_log_stats()) {
+            break;
+        }
+    }
+    pthread_mutex_unlock(&_threads_mutex);
+}
 
 bool PeriodicThread::set_rate(uint32_t rate_hz)
 {
@@ -259,16 +390,27 @@ bool PeriodicThread::_run()
     uint64_t next_run_usec = AP_HAL::micros64() + _period_usec;
 
     while (!_should_exit) {
-        uint64_t dt = next_run_usec - AP_HAL::micros64();
+        uint64_t now = AP_HAL::micros64();
+        uint64_t dt = next_run_usec - now;
         if (dt > _period_usec) {
             // we've lost sync - restart
-            next_run_usec = AP_HAL::micros64();
+            if (now > next_run_usec) {
+                _stats.missed += (now - next_run_usec) / _period_usec;
+            }
+            next_run_usec = now;
         } else {
             Scheduler::from(hal.scheduler)->microsleep(dt);
+            now = AP_HAL::micros64();
+            _update_lateness(now > next_run_usec ? now - next_run_usec : 0);
         }
         next_run_usec += _period_usec;
 
         _task();
+
+        const uint32_t run_us = AP_HAL::micros64() - now;
+        _stats.run_sum_us += run_us;
+        _stats.run_max_us = MAX(_stats.run_max_us, run_us);
+        _stats.log_run_max_us = MAX(_stats.log_run_max_us, run_us);
     }
 
     _started = false;
@@ -277,6 +419,69 @@ bool PeriodicThread::_run()
     return true;
 }
 
+// upper bounds of the wakeup lateness histogram bins, the last bin
+// takes the rest
+static const uint16_t late_bins_us[PeriodicThread::LATE_BINS - 1] {
+    10, 20, 50, 100, 200, 500, 1000
+};
+
+void PeriodicThread::_update_lateness(uint32_t late_us)
+{
+    _stats.wakeups++;
+    _stats.late_sum_us += late_us;
+    _stats.late_max_us = MAX(_stats.late_max_us, late_us);
+    _stats.log_late_max_us = MAX(_stats.log_late_max_us, late_us);
+
+    uint8_t bin = 0;
+    while (bin < ARRAY_SIZE(late_bins_us) && late_us >= late_bins_us[bin]) {
+        bin++;
+    }
+    _stats.late_bins[bin]++;
+}
+
+void PeriodicThread::_print_stats(ExpandingString &str)
+{
+    const uint32_t wakeups = _stats.wakeups;
+    str.printf(" RATE=%u MISS=%u LATE=%u/%uus RUN=%u/%uus BINS=",
+               unsigned(1000000ULL / _period_usec), unsigned(_stats.missed),
+               unsigned(wakeups ? _stats.late_sum_us / wakeups : 0), unsigned(_stats.late_max_us),
+               unsigned(wakeups ? _stats.run_sum_us / wakeups : 0), unsigned(_stats.run_max_us));
+    for (uint8_t i = 0; i < LATE_BINS; i++) {
+        str.printf("%s%u", i > 0 ? "," : "", unsigned(_stats.late_bins[i]));
+    }
+}
+
+bool PeriodicThread::_log_stats()
+{
+#if HAL_LOGGING_ENABLED
+    const uint32_t wakeups = _stats.wakeups - _logged_wakeups;
+    struct log_TLAT pkt {
+        LOG_PACKET_HEADER_INIT(LOG_TLAT_MSG),
+        time_us  : AP_HAL::micros64(),
+        name     : {},
+        rate     : uint16_t(1000000ULL / _period_usec),
+        wakeups  : wakeups,
+        missed   : _stats.missed - _logged_missed,
+        late_avg : wakeups ? (_stats.late_sum_us - _logged_late_sum_us) / wakeups : 0,
+        late_max : _stats.log_late_max_us,
+        run_avg  : wakeups ? (_stats.run_sum_us - _logged_run_sum_us) / wakeups : 0,
+        run_max  : _stats.log_run_max_us,
+    };
+    strncpy_noterm(pkt.name, _name, sizeof(pkt.name));
+    AP::logger().WriteBlock(&pkt, sizeof(pkt));
+
+    _logged_wakeups += wakeups;
+    _logged_missed += pkt.missed;
+    _logged_late_sum_us = _stats.late_sum_us;
+    _logged_run_sum_us = _stats.run_sum_us;
+    _stats.log_late_max_us = 0;
+    _stats.log_run_max_us = 0;
+    return true;
+#else
+    return false;
+#endif
+}
+
 bool PeriodicThread::stop()
 {
     if (!is_started()) {
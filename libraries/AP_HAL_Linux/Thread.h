@@ -22,6 +22,8 @@
 
 #include <AP_HAL/utility/functor.h>
 
+class ExpandingString;
+
 namespace Linux {
 
 /*
@@ -33,7 +35,7 @@ public:
 
     Thread(task_t t) : _task(t) { }
 
-    virtual ~Thread() { }
+    virtual ~Thread();
 
     bool start(const char *name, int policy, int prio);
 
@@ -51,9 +53,31 @@ public:
 
     bool join();
 
+    /*
+      append a line for each running thread to str, with its scheduling
+      policy, cpus and the share of a cpu it used since the last call.
+      Periodic threads add their wakeup lateness and runtime
+     */
+    static void threads_info(ExpandingString &str);
+
+    // append the start of a line in the format of threads_info() for
+    // thread ctx. Returns false if the thread has exited
+    static bool print_info(ExpandingString &str, const char *name, pthread_t ctx,
+                           size_t stack_usage, uint64_t &last_cpu_ns, uint64_t &last_us);
+
+    // log the timing of the next periodic thread in the list. Called at
+    // 10Hz by the logger
+    static void log_next_thread();
+
 protected:
     static void *_run_trampoline(void *arg);
 
+    // append the timing of the thread to its line in threads_info()
+    virtual void _print_stats(ExpandingString &str) { }
+
+    // log the timing of the thread, returns false if it has none
+    virtual bool _log_stats() { return false; }
+
     /*
      * Run the task assigned in the constructor. May be overriden in case it's
      * preferred to use Thread as an interface or when user wants to aggregate
@@ -75,6 +99,12 @@ protected:
     } _stack_debug;
 
     size_t _stack_size = 0;
+
+    // list of started threads for threads_info()
+    char _name[16] {};
+    uint64_t _last_cpu_ns = 0;
+    uint64_t _last_info_us = 0;
+    Thread *_next = nullptr;
 };
 
 class PeriodicThread : public Thread {
@@ -87,10 +117,42 @@ public:
 
     bool stop() override;
 
+    // number of wakeup lateness histogram bins
+    static const uint8_t LATE_BINS = 8;
+
 protected:
     bool _run() override;
 
+    void _print_stats(ExpandingString &str) override;
+    bool _log_stats() override;
+
+    void _update_lateness(uint32_t late_us);
+
     uint64_t _period_usec = 0;
+
+    /*
+      timing since the thread started, updated by the thread itself
+      each period and read without locking by threads_info() and the
+      logger. The sums wrap, readers use differences
+     */
+    struct {
+        uint32_t wakeups;
+        uint32_t missed;
+        uint32_t late_sum_us;
+        uint32_t late_max_us;
+        uint32_t run_sum_us;
+        uint32_t run_max_us;
+        uint32_t late_bins[LATE_BINS];
+        // largest since the last log message, reset by the logger
+        uint32_t log_late_max_us;
+        uint32_t log_run_max_us;
+    } _stats {};
+
+    // _stats at the last log message
+    uint32_t _logged_wakeups = 0;
+    uint32_t _logged_missed = 0;
+    uint32_t _logged_late_sum_us = 0;
+    uint32_t _logged_run_sum_us = 0;
 };
 
 }
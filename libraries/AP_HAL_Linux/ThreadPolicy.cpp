@@ -0,0 +1,114 @@
+/*
+ * This file is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "ThreadPolicy.h"
+
+#include <fnmatch.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <AP_HAL/AP_HAL.h>
+
+#include "Util.h"
+
+using namespace Linux;
+
+extern const AP_HAL::HAL& hal;
+
+bool ThreadPolicy::load(const char *path)
+{
+    FILE *f = fopen(path, "r");
+    if (f == nullptr) {
+        fprintf(stderr, "ThreadPolicy: unable to open %s: %m\n", path);
+        return false;
+    }
+
+    char line[100];
+    unsigned lineno = 0;
+    bool ret = true;
+    _num_entries = 0;
+
+    while (fgets(line, sizeof(line), f) != nullptr) {
+        lineno++;
+
+        char name[sizeof(Entry::name)], cpus[32], prio[8];
+        const int n = sscanf(line, "%15s %31s %7s", name, cpus, prio);
+        if (n <= 0 || name[0] == '#') {
+            continue;
+        }
+
+        if (_num_entries >= ARRAY_SIZE(_entries)) {
+            fprintf(stderr, "ThreadPolicy: %s:%u: too many entries\n", path, lineno);
+            ret = false;
+            break;
+        }
+
+        Entry &e = _entries[_num_entries];
+        strcpy(e.name, name);
+
+        bool valid = n == 3;
+        e.prio = -1;
+        if (valid && strcmp(prio, "-") != 0) {
+            char *endptr;
+            const long p = strtol(prio, &endptr, 10);
+            valid = *endptr == '\0' && p >= 0 && p <= 99;
+            e.prio = p;
+        }
+        if (!valid) {
+            fprintf(stderr, "ThreadPolicy: %s:%u: bad entry: %s", path, lineno, line);
+            ret = false;
+            break;
+        }
+
+        e.has_cpus = strcmp(cpus, "-") != 0;
+        if (e.has_cpus && !Util::from(hal.util)->parse_cpu_set(cpus, &e.cpus)) {
+            fprintf(stderr, "ThreadPolicy: %s:%u: bad cpu set: %s\n", path, lineno, cpus);
+            ret = false;
+            break;
+        }
+
+        _num_entries++;
+    }
+
+    fclose(f);
+    return ret;
+}
+
+bool ThreadPolicy::apply(const char *name, int &policy, int &prio, cpu_set_t &cpus) const
+{
+    if (name == nullptr) {
+        return false;
+    }
+
+    for (uint8_t i = 0; i < _num_entries; i++) {
+        const Entry &e = _entries[i];
+        if (fnmatch(e.name, name, 0) != 0) {
+            continue;
+        }
+        if (e.prio == 0) {
+            policy = SCHED_OTHER;
+            prio = 0;
+        } else if (e.prio > 0) {
+            policy = SCHED_FIFO;
+            prio = e.prio;
+        }
+        if (e.has_cpus) {
+            cpus = e.cpus;
+        }
+        return e.has_cpus;
+    }
+
+    return false;
+}
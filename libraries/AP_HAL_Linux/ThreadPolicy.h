@@ -0,0 +1,66 @@
+/*
+ * This file is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <sched.h>
+#include <stdint.h>
+
+#define LINUX_THREAD_POLICY_MAX_ENTRIES 16
+
+namespace Linux {
+
+/*
+  placement of threads on cpus and their realtime priority, loaded from
+  a file given with --thread-policy. Each line is
+
+    <name> <cpus> <priority>
+
+  where name is a thread name, which may contain shell wildcards, such
+  as ap-timer, ap-spi-* or log_io. The main thread is ap-main. cpus is
+  a cpu set in the form of --cpu-affinity and priority is a SCHED_FIFO
+  priority from 1 to 99, or 0 for SCHED_OTHER. Either may be - to keep
+  the default. Lines starting with # are comments and the first
+  matching line is used, for example:
+
+    ap-main    2    -
+    ap-spi-*   3    18
+    ap-timer   2    -
+    log_io     0-1  0
+ */
+class ThreadPolicy {
+public:
+    // read the policy from path. Returns false and prints the offending
+    // line if the file can't be parsed
+    bool load(const char *path);
+
+    /*
+      apply the policy for thread name to its default scheduling policy
+      and priority. Returns true and fills in cpus if the thread should
+      have its own cpu affinity
+     */
+    bool apply(const char *name, int &policy, int &prio, cpu_set_t &cpus) const;
+
+private:
+    struct Entry {
+        char name[16];
+        // -1 to keep the default
+        int16_t prio;
+        bool has_cpus;
+        cpu_set_t cpus;
+    } _entries[LINUX_THREAD_POLICY_MAX_ENTRIES];
+    uint8_t _num_entries;
+};
+
+}
@@ -5,6 +5,7 @@
 #include <poll.h>
 #include <stdio.h>
 #include <sys/ioctl.h>
+#include <sys/uio.h>
 #include <asm/ioctls.h>
 #include <asm/termbits.h>
 #include <unistd.h>
@@ -69,6 +70,22 @@ ssize_t UARTDevice::write(const uint8_t *buf, uint16_t n)
     return ret;
 }
 
+ssize_t UARTDevice::writev(const struct iovec *iov, int iovcnt)
+{
+    struct pollfd fds;
+    fds.fd = _fd;
+    fds.events = POLLOUT;
+    fds.revents = 0;
+
+    ssize_t ret = 0;
+
+    if (poll(&fds, 1, 0) == 1) {
+        ret = ::writev(_fd, iov, iovcnt);
+    }
+
+    return ret;
+}
+
 void UARTDevice::set_blocking(bool blocking)
 {
     int flags = fcntl(_fd, F_GETFL, 0);
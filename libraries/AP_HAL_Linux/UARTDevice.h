@@ -20,6 +20,8 @@ public:
         return _flow_control;
     }
     virtual void set_parity(int v) override;
+    virtual ssize_t writev(const struct iovec *iov, int iovcnt) override;
+    virtual int get_read_fd() const override { return _fd; }
 
 private:
     void _disable_crlf();
@@ -14,12 +14,15 @@
 #include <sys/socket.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <sys/epoll.h>
+#include <sys/uio.h>
 #include <termios.h>
 #include <unistd.h>
 
 #include <AP_HAL/AP_HAL.h>
 
 #include "ConsoleDevice.h"
+#include "Scheduler.h"
 #include "TCPServerDevice.h"
 #include "UARTDevice.h"
 #include "UDPDevice.h"
@@ -121,11 +124,33 @@ void UARTDriver::_deallocate_buffers()
     _writebuf.set_size(0);
 }
 
+/*
+  return true if name is one of the comma separated flags
+ */
+static bool flag_is_set(const char *flags, const char *name)
+{
+    const size_t len = strlen(name);
+    while (flags != nullptr) {
+        if (strncmp(flags, name, len) == 0 && (flags[len] == ',' || flags[len] == '\0')) {
+            return true;
+        }
+        flags = strchr(flags, ',');
+        if (flags != nullptr) {
+            flags++;
+        }
+    }
+    return false;
+}
+
 /*
     Device path accepts the following syntaxes:
         - /dev/ttyO1
         - tcp:*:1243:wait
         - udp:192.168.2.15:1243
+        - udp:192.168.2.255:1243:bcast,coalesce
+
+    UDP flags are comma separated. With coalesce several MAVLink
+    packets are sent in each UDP packet
 */
 AP_HAL::OwnPtr<SerialDevice> UARTDriver::_parseDevicePath(const char *arg)
 {
@@ -179,9 +204,12 @@ AP_HAL::OwnPtr<SerialDevice> UARTDriver::_parseDevicePath(const char *arg)
     AP_HAL::OwnPtr<SerialDevice> device = nullptr;
 
     if (strcmp(protocol, "udp") == 0 || strcmp(protocol, "udpin") == 0) {
-        bool bcast = (_flag && strcmp(_flag, "bcast") == 0);
+        bool bcast = flag_is_set(_flag, "bcast");
 #if HAL_GCS_ENABLED
         _packetise = true;
+#endif
+#if AP_MAVLINK_PACKETISE_ENABLED
+        _coalesce = flag_is_set(_flag, "coalesce");
 #endif
         if (strcmp(protocol, "udp") == 0) {
             device = NEW_NOTHROW UDPDevice(_ip, _base_port, bcast, false);
@@ -213,6 +241,7 @@ void UARTDriver::_end()
         hal.scheduler->delay(1);
     }
 
+    _update_read_pollable();
     _device->close();
     _deallocate_buffers();
 }
@@ -269,7 +298,12 @@ ssize_t UARTDriver::_read(uint8_t *buffer, uint16_t count)
         return 0;
     }
 
-    return _readbuf.read(buffer, count);
+    const ssize_t ret = _readbuf.read(buffer, count);
+    if (_read_paused && ret > 0) {
+        // there is room again, get the uart thread to wait on the fd
+        Scheduler::from(hal.scheduler)->uart_poller().wakeup();
+    }
+    return ret;
 }
 
 bool UARTDriver::_discard_input()
@@ -278,6 +312,9 @@ bool UARTDriver::_discard_input()
         return false;
     }
     _readbuf.clear();
+    if (_read_paused) {
+        Scheduler::from(hal.scheduler)->uart_poller().wakeup();
+    }
     return true;
 }
 
@@ -317,6 +354,21 @@ int UARTDriver::_write_fd(const uint8_t *buf, uint16_t n)
     return _device->write(buf, n);
 }
 
+/*
+  try writing iovcnt buffers in one go, handling an unresponsive port
+ */
+int UARTDriver::_writev_fd(const struct iovec *iov, int iovcnt)
+{
+    if (!_connected) {
+        _connected = _device->open();
+    }
+    if (!_connected) {
+        return 0;
+    }
+
+    return _device->writev(iov, iovcnt);
+}
+
 /*
   try reading n bytes, handling an unresponsive port
  */
@@ -336,38 +388,31 @@ bool UARTDriver::_write_pending_bytes(void)
     uint32_t available_bytes = _writebuf.available();
     uint16_t n = available_bytes;
 
-#if HAL_GCS_ENABLED
-    if (_packetise && n > 0) {
+#if AP_MAVLINK_PACKETISE_ENABLED
+    if (_coalesce) {
+        // send as many whole MAVLink packets as fit in a UDP packet
+        n = _coalescer.bytes_to_send(_writebuf, n, AP_HAL::millis());
+    } else if (_packetise && n > 0) {
         // send on MAVLink packet boundaries if possible
         n = mavlink_packetise(_writebuf, n);
     }
 #endif
 
     if (n > 0) {
-        int ret;
-
-        if (_packetise) {
-            // keep as a single UDP packet
-            uint8_t tmpbuf[n];
-            _writebuf.peekbytes(tmpbuf, n);
-            ret = _write_fd(tmpbuf, n);
-            if (ret > 0)
-                _writebuf.advance(ret);
-        } else {
-            ByteBuffer::IoVec vec[2];
-            const auto n_vec = _writebuf.peekiovec(vec, n);
-            for (int i = 0; i < n_vec; i++) {
-                ret = _write_fd(vec[i].data, (uint16_t)vec[i].len);
-                if (ret < 0) {
-                    break;
-                }
-                _writebuf.advance(ret);
-
-                /* We wrote less than we asked for, stop */
-                if ((unsigned)ret != vec[i].len) {
-                    break;
-                }
-            }
+        /*
+          both parts of the ring buffer go out in one system call, which
+          keeps a packetised write as a single UDP packet
+         */
+        ByteBuffer::IoVec vec[2];
+        struct iovec iov[2];
+        const auto n_vec = _writebuf.peekiovec(vec, n);
+        for (int i = 0; i < n_vec; i++) {
+            iov[i].iov_base = vec[i].data;
+            iov[i].iov_len = vec[i].len;
+        }
+        const int ret = _writev_fd(iov, n_vec);
+        if (ret > 0) {
+            _writebuf.advance(ret);
         }
     }
 
@@ -375,22 +420,10 @@ bool UARTDriver::_write_pending_bytes(void)
 }
 
 /*
-  push any pending bytes to/from the serial port. This is called at
-  1kHz in the timer thread. Doing it this way reduces the system call
-  overhead in the main task enormously.
+  fill the read buffer from the device
  */
-void UARTDriver::_timer_tick(void)
+void UARTDriver::_fill_read_buffer()
 {
-    if (!_initialised) return;
-
-    _in_timer = true;
-
-    uint8_t num_send = 10;
-    while (num_send != 0 && _write_pending_bytes()) {
-        num_send--;
-    }
-
-    // try to fill the read buffer
     int ret;
     ByteBuffer::IoVec vec[2];
 
@@ -411,6 +444,79 @@ void UARTDriver::_timer_tick(void)
             break;
         }
     }
+}
+
+void UARTDriver::ReadPollable::on_can_read()
+{
+    if (!_uart._initialised) {
+        return;
+    }
+
+    _uart._in_timer = true;
+    _uart._fill_read_buffer();
+    if (_uart._readbuf.space() == 0) {
+        // stop waiting on the fd until read() makes room
+        Scheduler::from(hal.scheduler)->uart_poller().unregister_pollable(this);
+        _uart._read_paused = true;
+    }
+    _uart._in_timer = false;
+}
+
+/*
+  keep the poller of the uart thread waiting on the file descriptor
+  the device currently reads from. A TCP device changes it when a
+  client connects or disconnects, and it is gone once the device is
+  closed. A fd taken out of the poller because the read buffer
+  filled is put back once there is room
+ */
+void UARTDriver::_update_read_pollable()
+{
+    const int fd = _initialised ? _get_read_fd() : -1;
+    Poller &poller = Scheduler::from(hal.scheduler)->uart_poller();
+    if (fd == _read_pollable.get_fd()) {
+        if (_read_paused && _readbuf.space() > 0) {
+            _read_paused = false;
+            if (!poller.register_pollable(&_read_pollable, EPOLLIN)) {
+                _read_pollable.set_fd(-1);
+            }
+        }
+        return;
+    }
+
+    if (!_read_paused) {
+        poller.unregister_pollable(&_read_pollable);
+    }
+    _read_paused = false;
+    _read_pollable.set_fd(fd);
+    if (fd >= 0 && !poller.register_pollable(&_read_pollable, EPOLLIN)) {
+        _read_pollable.set_fd(-1);
+    }
+}
+
+/*
+  push any pending bytes to the serial port, and read from it if it
+  can't be polled. This is called by the uart thread whenever it wakes
+  up, which is when a device has data or at APM_LINUX_UART_RATE.
+  Doing it this way reduces the system call overhead in the main
+  task enormously.
+ */
+void UARTDriver::_timer_tick(void)
+{
+    if (!_initialised) return;
+
+    _in_timer = true;
+
+    _update_read_pollable();
+
+    uint8_t num_send = 10;
+    while (num_send != 0 && _write_pending_bytes()) {
+        num_send--;
+    }
+
+    // devices without a file descriptor to wait on are read each tick
+    if (_read_pollable.get_fd() < 0) {
+        _fill_read_buffer();
+    }
 
     _in_timer = false;
 }
@@ -2,8 +2,10 @@
 
 #include <AP_HAL/utility/OwnPtr.h>
 #include <AP_HAL/utility/RingBuffer.h>
+#include <AP_HAL/utility/packetise.h>
 
 #include "AP_HAL_Linux.h"
+#include "Poller.h"
 #include "SerialDevice.h"
 #include "Semaphores.h"
 
@@ -68,6 +70,10 @@ private:
     char *_flag;
     bool _connected; // true if a client has connected
     bool _packetise; // true if writes should try to be on mavlink boundaries
+#if AP_MAVLINK_PACKETISE_ENABLED
+    bool _coalesce; // true if packetised writes should pack several frames per packet
+    MAVLinkCoalesce _coalescer;
+#endif
 
     void _allocate_buffers(uint16_t rxS, uint16_t txS);
     void _deallocate_buffers();
@@ -78,6 +84,31 @@ private:
     uint64_t _receive_timestamp[2];
     uint8_t _receive_timestamp_idx;
 
+    /*
+      reads from the device as soon as the uart thread's poller sees it
+      readable, rather than on each tick
+     */
+    class ReadPollable : public Pollable {
+    public:
+        ReadPollable(UARTDriver &uart) : _uart(uart) { }
+        // the device owns the file descriptor
+        ~ReadPollable() { _fd = -1; }
+
+        void set_fd(int fd) { _fd = fd; }
+        void on_can_read() override;
+
+    private:
+        UARTDriver &_uart;
+    } _read_pollable{*this};
+    // true while the read fd is out of the poller because _readbuf is
+    // full. The fd is level triggered so would otherwise keep waking
+    // the uart thread
+    volatile bool _read_paused;
+
+    // register the device's read fd with the poller when it changes
+    void _update_read_pollable();
+    void _fill_read_buffer();
+
 protected:
     const char *device_path;
     volatile bool _initialised;
@@ -88,8 +119,13 @@ protected:
     ByteBuffer _writebuf{0};
 
     virtual int _write_fd(const uint8_t *buf, uint16_t n);
+    virtual int _writev_fd(const struct iovec *iov, int iovcnt);
     virtual int _read_fd(uint8_t *buf, uint16_t n);
 
+    // file descriptor that is readable when _read_fd() has data, or -1
+    // if it has to be polled on every tick
+    virtual int _get_read_fd() const { return _device->get_read_fd(); }
+
     Linux::Semaphore _write_mutex;
 
     bool _discard_input() override;
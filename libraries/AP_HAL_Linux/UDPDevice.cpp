@@ -2,6 +2,7 @@
 
 #include <fcntl.h>
 #include <stdio.h>
+#include <string.h>
 #include <sys/ioctl.h>
 
 #include <AP_HAL/AP_HAL.h>
@@ -33,6 +34,35 @@ ssize_t UDPDevice::write(const uint8_t *buf, uint16_t n)
     return socket.sendto(buf, n, _ip, _port);
 }
 
+/*
+  send the buffers as one datagram. Before the socket is connected it
+  has to go through sendto(), which needs them gathered into one buffer
+ */
+ssize_t UDPDevice::writev(const struct iovec *iov, int iovcnt)
+{
+    if (_connected) {
+        if (!socket.pollout(0)) {
+            return -1;
+        }
+        return socket.sendv(iov, iovcnt);
+    }
+
+    size_t len = 0;
+    for (int i = 0; i < iovcnt; i++) {
+        len += iov[i].iov_len;
+    }
+    if (len > UINT16_MAX) {
+        return -1;
+    }
+    uint8_t buf[len];
+    uint8_t *p = buf;
+    for (int i = 0; i < iovcnt; i++) {
+        memcpy(p, iov[i].iov_base, iov[i].iov_len);
+        p += iov[i].iov_len;
+    }
+    return write(buf, len);
+}
+
 ssize_t UDPDevice::read(uint8_t *buf, uint16_t n)
 {
     ssize_t ret = socket.recv(buf, n, 0);
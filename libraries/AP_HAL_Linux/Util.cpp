@@ -10,6 +10,7 @@
 #include <AP_HAL/AP_HAL.h>
 
 #include "Heat_Pwm.h"
+#include "Scheduler.h"
 #include "Util.h"
 
 using namespace Linux;
@@ -296,3 +297,17 @@ bool Util::parse_cpu_set(const char *str, cpu_set_t *cpu_set) const
 
     return true;
 }
+
+void Util::thread_info(ExpandingString &str)
+{
+    Scheduler::from(hal.scheduler)->thread_info(str);
+}
+
+/*
+  called at 10Hz by the logging thread, logs the wakeup lateness and
+  runtime of the next periodic thread on each call
+*/
+void Util::log_stack_info(void)
+{
+    Thread::log_next_thread();
+}
@@ -95,6 +95,12 @@ public:
     // fills data with random values of requested size
     bool get_random_vals(uint8_t* data, size_t size) override;
 
+    // scheduling and cpu use of each thread, for @SYS/threads.txt
+    void thread_info(ExpandingString &str) override;
+
+    // log the timing of the next periodic thread
+    void log_stack_info(void) override;
+
 private:
 #if CONFIG_HAL_BOARD_SUBTYPE == HAL_BOARD_SUBTYPE_LINUX_DISCO
     static ToneAlarm_Disco _toneAlarm;
@@ -0,0 +1,152 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_HAL/AP_HAL.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+#if CONFIG_HAL_BOARD == HAL_BOARD_LINUX
+
+#include <fcntl.h>
+#include <linux/i2c.h>
+#include <linux/i2c-dev.h>
+#include <linux/spi/spidev.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+/*
+  cost of register reads done with one ioctl per read, as
+  SPIDevice::transfer() and I2CDevice::transfer() do, against all of
+  the reads queued behind one ioctl, as transfer_list() does.
+
+  Set BENCH_SPIDEV to a spidev node such as /dev/spidev0.0, and
+  BENCH_I2CDEV and BENCH_I2CADDR to an i2c-dev node and a device
+  address, to include the bus time. Otherwise the ioctls go to
+  /dev/null and fail straight away, which measures only the syscall
+  overhead that batching saves
+ */
+
+#define MAX_READS 16
+#define READ_LEN 14
+
+static int open_dev(const char *env)
+{
+    const char *path = getenv(env);
+    return open(path != nullptr ? path : "/dev/null", O_RDWR | O_CLOEXEC);
+}
+
+static uint16_t i2c_address()
+{
+    const char *addr = getenv("BENCH_I2CADDR");
+    return addr != nullptr ? strtoul(addr, nullptr, 0) : 0x68;
+}
+
+// fill in a register read of READ_LEN bytes as two messages
+static void spi_read(struct spi_ioc_transfer *msgs, const uint8_t *reg, uint8_t *buf)
+{
+    memset(msgs, 0, 2 * sizeof(*msgs));
+    msgs[0].tx_buf = (uint64_t) reg;
+    msgs[0].len = 1;
+    msgs[1].rx_buf = (uint64_t) buf;
+    msgs[1].len = READ_LEN;
+}
+
+static void BM_SPIReadPerIoctl(benchmark::State& state)
+{
+    const uint8_t nreads = state.range(0);
+    const int fd = open_dev("BENCH_SPIDEV");
+    uint8_t reg = 0x80;
+    uint8_t buf[MAX_READS][READ_LEN];
+    struct spi_ioc_transfer msgs[2];
+
+    while (state.KeepRunning()) {
+        for (uint8_t i = 0; i < nreads; i++) {
+            spi_read(msgs, &reg, buf[i]);
+            int r = ioctl(fd, SPI_IOC_MESSAGE(2), msgs);
+            gbenchmark_escape(&r);
+        }
+    }
+    close(fd);
+}
+
+static void BM_SPIReadBatched(benchmark::State& state)
+{
+    const uint8_t nreads = state.range(0);
+    const int fd = open_dev("BENCH_SPIDEV");
+    uint8_t reg = 0x80;
+    uint8_t buf[MAX_READS][READ_LEN];
+    struct spi_ioc_transfer msgs[2 * MAX_READS];
+
+    while (state.KeepRunning()) {
+        for (uint8_t i = 0; i < nreads; i++) {
+            spi_read(&msgs[2 * i], &reg, buf[i]);
+            msgs[2 * i + 1].cs_change = (i + 1 < nreads);
+        }
+        int r = ioctl(fd, SPI_IOC_MESSAGE(2 * nreads), msgs);
+        gbenchmark_escape(&r);
+    }
+    close(fd);
+}
+
+// fill in a register read of READ_LEN bytes as two messages
+static void i2c_read(struct i2c_msg *msgs, uint16_t addr, uint8_t *reg, uint8_t *buf)
+{
+    msgs[0].addr = addr;
+    msgs[0].flags = 0;
+    msgs[0].buf = reg;
+    msgs[0].len = 1;
+    msgs[1].addr = addr;
+    msgs[1].flags = I2C_M_RD;
+    msgs[1].buf = buf;
+    msgs[1].len = READ_LEN;
+}
+
+static void BM_I2CReadPerIoctl(benchmark::State& state)
+{
+    const uint8_t nreads = state.range(0);
+    const int fd = open_dev("BENCH_I2CDEV");
+    const uint16_t addr = i2c_address();
+    uint8_t reg = 0;
+    uint8_t buf[MAX_READS][READ_LEN];
+    struct i2c_msg msgs[2];
+    struct i2c_rdwr_ioctl_data data { msgs, 2 };
+
+    while (state.KeepRunning()) {
+        for (uint8_t i = 0; i < nreads; i++) {
+            i2c_read(msgs, addr, &reg, buf[i]);
+            int r = ioctl(fd, I2C_RDWR, &data);
+            gbenchmark_escape(&r);
+        }
+    }
+    close(fd);
+}
+
+static void BM_I2CReadBatched(benchmark::State& state)
+{
+    const uint8_t nreads = state.range(0);
+    const int fd = open_dev("BENCH_I2CDEV");
+    const uint16_t addr = i2c_address();
+    uint8_t reg = 0;
+    uint8_t buf[MAX_READS][READ_LEN];
+    struct i2c_msg msgs[2 * MAX_READS];
+    struct i2c_rdwr_ioctl_data data { msgs, uint32_t(2 * nreads) };
+
+    while (state.KeepRunning()) {
+        for (uint8_t i = 0; i < nreads; i++) {
+            i2c_read(&msgs[2 * i], addr, &reg, buf[i]);
+        }
+        int r = ioctl(fd, I2C_RDWR, &data);
+        gbenchmark_escape(&r);
+    }
+    close(fd);
+}
+
+BENCHMARK(BM_SPIReadPerIoctl)->Arg(1)->Arg(4)->Arg(MAX_READS);
+BENCHMARK(BM_SPIReadBatched)->Arg(1)->Arg(4)->Arg(MAX_READS);
+BENCHMARK(BM_I2CReadPerIoctl)->Arg(1)->Arg(4)->Arg(MAX_READS);
+BENCHMARK(BM_I2CReadBatched)->Arg(1)->Arg(4)->Arg(MAX_READS);
+
+#endif // CONFIG_HAL_BOARD == HAL_BOARD_LINUX
+
+BENCHMARK_MAIN();
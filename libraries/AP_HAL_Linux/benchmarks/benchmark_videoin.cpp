@@ -1,6 +1,8 @@
 #include <AP_gbenchmark.h>
 #include <AP_HAL/AP_HAL.h>
 
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
 #if CONFIG_HAL_BOARD_SUBTYPE == HAL_BOARD_SUBTYPE_LINUX_BEBOP
 
 #include <AP_HAL_Linux/VideoIn.h>
@@ -65,4 +67,4 @@ static void BM_YuyvToGrey(benchmark::State& state)
 BENCHMARK(BM_YuyvToGrey)->Arg(64 * 64)->Arg(320 * 240)->Arg(640 * 480);
 #endif
 
-BENCHMARK_MAIN()
+BENCHMARK_MAIN();
@@ -0,0 +1,204 @@
+/*
+ * This file is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <AP_gtest.h>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_HAL_Linux/Storage.h>
+
+using namespace Linux;
+
+const AP_HAL::HAL &hal = AP_HAL::get_HAL();
+
+/*
+  storage opened in a directory of the test's choosing, with access to
+  the journal and storage file to simulate a power loss
+ */
+class StorageTest : public Storage {
+public:
+    StorageTest(const char *dpath) {
+        _open(dpath);
+        _initialised = true;
+    }
+    ~StorageTest() {
+        _close_files();
+        close(_dir_fd);
+    }
+
+    bool write_journal() { return _write_journal(); }
+
+    // a record whose data was cut short by a power loss
+    void append_torn_record() {
+        JournalRecord rec {};
+        rec.offset = 0;
+        rec.length = LINUX_STORAGE_CHUNK_SIZE;
+        uint8_t buf[sizeof(rec) + 10];
+        memset(buf, 0xaa, sizeof(buf));
+        memcpy(buf, &rec, sizeof(rec));
+        ASSERT_EQ(ssize_t(sizeof(buf)), write(_journal_fd, buf, sizeof(buf)));
+    }
+
+    // blocks allocated to the journal but never written, as some
+    // filesystems leave after a power loss
+    void append_zeros() {
+        uint8_t buf[4096] {};
+        ASSERT_EQ(ssize_t(sizeof(buf)), write(_journal_fd, buf, sizeof(buf)));
+    }
+
+    // a compaction that renamed the new file into place but lost
+    // power before emptying the journal
+    bool compact_file() { return _compact_file(); }
+
+    off_t journal_size() {
+        struct stat st;
+        return fstat(_journal_fd, &st) == 0 ? st.st_size : -1;
+    }
+
+    bool file_matches(const uint8_t *expected) {
+        static uint8_t buf[LINUX_STORAGE_SIZE];
+        return pread(_fd, buf, sizeof(buf), 0) == sizeof(buf) &&
+            memcmp(buf, expected, sizeof(buf)) == 0;
+    }
+};
+
+class LinuxStorage : public ::testing::Test {
+protected:
+    void SetUp() override {
+        strcpy(dpath, "/tmp/ap_storage_XXXXXX");
+        ASSERT_NE(nullptr, mkdtemp(dpath));
+    }
+    void TearDown() override {
+        DIR *d = opendir(dpath);
+        if (d != nullptr) {
+            struct dirent *e;
+            while ((e = readdir(d)) != nullptr) {
+                unlinkat(dirfd(d), e->d_name, 0);
+            }
+            closedir(d);
+        }
+        rmdir(dpath);
+    }
+
+    // write a pattern to storage, a chunk and a half from loc
+    static void write_pattern(Storage &s, uint16_t loc, uint8_t v) {
+        uint8_t buf[LINUX_STORAGE_CHUNK_SIZE * 3 / 2];
+        for (uint16_t i = 0; i < sizeof(buf); i++) {
+            buf[i] = v + i;
+        }
+        s.write_block(loc, buf, sizeof(buf));
+    }
+
+    static void contents(Storage &s, uint8_t *buf) {
+        s.read_block(buf, 0, LINUX_STORAGE_SIZE);
+    }
+
+    char dpath[32];
+    uint8_t expected[LINUX_STORAGE_SIZE];
+    uint8_t actual[LINUX_STORAGE_SIZE];
+};
+
+TEST_F(LinuxStorage, replay_torn_journal)
+{
+    {
+        StorageTest s(dpath);
+        write_pattern(s, 10, 1);
+        ASSERT_TRUE(s.write_journal());
+        write_pattern(s, 1000, 2);
+        ASSERT_TRUE(s.write_journal());
+        contents(s, expected);
+        s.append_torn_record();
+    }
+    {
+        // the torn record is dropped and the rest compacted into the
+        // storage file
+        StorageTest s(dpath);
+        contents(s, actual);
+        EXPECT_EQ(0, memcmp(expected, actual, sizeof(actual)));
+        EXPECT_EQ(0, s.journal_size());
+        EXPECT_TRUE(s.file_matches(expected));
+
+        write_pattern(s, 2000, 3);
+        ASSERT_TRUE(s.write_journal());
+        contents(s, expected);
+        s.append_zeros();
+    }
+    {
+        // a zero filled tail is not mistaken for records
+        StorageTest s(dpath);
+        contents(s, actual);
+        EXPECT_EQ(0, memcmp(expected, actual, sizeof(actual)));
+        EXPECT_EQ(0, s.journal_size());
+        EXPECT_TRUE(s.file_matches(expected));
+    }
+}
+
+TEST_F(LinuxStorage, compact_interrupted)
+{
+    {
+        StorageTest s(dpath);
+        write_pattern(s, 100, 1);
+        ASSERT_TRUE(s.write_journal());
+        // overlaps the first write, so replaying the journal in the
+        // wrong order or only in part gives different contents
+        write_pattern(s, 130, 2);
+        ASSERT_TRUE(s.write_journal());
+        contents(s, expected);
+        ASSERT_TRUE(s.compact_file());
+    }
+    {
+        // replaying the journal over the compacted file gives the same
+        // contents
+        StorageTest s(dpath);
+        contents(s, actual);
+        EXPECT_EQ(0, memcmp(expected, actual, sizeof(actual)));
+        EXPECT_EQ(0, s.journal_size());
+        EXPECT_TRUE(s.file_matches(expected));
+    }
+}
+
+TEST_F(LinuxStorage, compact_interrupted_with_unjournaled_changes)
+{
+    {
+        StorageTest s(dpath);
+        write_pattern(s, 100, 1);
+        write_pattern(s, 1000, 2);
+        ASSERT_TRUE(s.write_journal());
+        contents(s, expected);
+        // changes not yet journaled, one to a chunk that is in the
+        // journal and one to a chunk that isn't
+        write_pattern(s, 110, 3);
+        write_pattern(s, 3000, 4);
+        ASSERT_TRUE(s.compact_file());
+        // the compacted file holds only what is in the journal
+        EXPECT_TRUE(s.file_matches(expected));
+    }
+    {
+        // the storage is as it was after the journal write, rather than
+        // a mix of journaled and unjournaled changes
+        StorageTest s(dpath);
+        contents(s, actual);
+        EXPECT_EQ(0, memcmp(expected, actual, sizeof(actual)));
+        EXPECT_EQ(0, s.journal_size());
+        EXPECT_TRUE(s.file_matches(expected));
+    }
+}
+
+AP_GTEST_MAIN()
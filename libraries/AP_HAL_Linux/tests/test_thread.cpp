@@ -117,4 +117,39 @@ TEST(LinuxThread, periodic_thread)
     EXPECT_TRUE(thr.join());
 }
 
+class TestPeriodicThread2 : public PeriodicThread {
+public:
+    TestPeriodicThread2() : PeriodicThread{FUNCTOR_BIND_MEMBER(&TestPeriodicThread2::_task, void)} { }
+
+    uint32_t wakeups() const { return _stats.wakeups; }
+    uint32_t binned() const {
+        uint32_t n = 0;
+        for (uint8_t i = 0; i < LATE_BINS; i++) {
+            n += _stats.late_bins[i];
+        }
+        return n;
+    }
+    uint32_t run_max_us() const { return _stats.run_max_us; }
+
+protected:
+    void _task() { usleep(100); }
+};
+
+TEST(LinuxThread, periodic_thread_stats)
+{
+    TestPeriodicThread2 thr;
+    EXPECT_TRUE(thr.set_rate(200));
+    EXPECT_TRUE(thr.start(nullptr, 0, 0));
+
+    usleep(100000);
+
+    EXPECT_TRUE(thr.stop());
+    EXPECT_TRUE(thr.join());
+
+    // every wakeup from sleep lands in one lateness bin
+    EXPECT_GT(thr.wakeups(), 0U);
+    EXPECT_EQ(thr.binned(), thr.wakeups());
+    EXPECT_GE(thr.run_max_us(), 100U);
+}
+
 AP_GTEST_MAIN()
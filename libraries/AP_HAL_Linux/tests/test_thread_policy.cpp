@@ -0,0 +1,79 @@
+#include <AP_gtest.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_HAL_Linux/ThreadPolicy.h>
+
+using namespace Linux;
+
+const AP_HAL::HAL &hal = AP_HAL::get_HAL();
+
+static bool load_policy(ThreadPolicy &policy, const char *text)
+{
+    char path[] = "/tmp/thread_policy_XXXXXX";
+    const int fd = mkstemp(path);
+    if (fd < 0) {
+        return false;
+    }
+    FILE *f = fdopen(fd, "w");
+    fputs(text, f);
+    fclose(f);
+    const bool ret = policy.load(path);
+    unlink(path);
+    return ret;
+}
+
+TEST(LinuxThreadPolicy, apply)
+{
+    ThreadPolicy policy;
+    ASSERT_TRUE(load_policy(policy,
+                            "# name cpus priority\n"
+                            "ap-spi-*   3     18\n"
+                            "ap-timer   2     -\n"
+                            "log_io     0-1   0\n"
+                            "\n"
+                            "ap-*       -     5\n"));
+
+    int pol = SCHED_FIFO;
+    int prio = 12;
+    cpu_set_t cpus;
+    EXPECT_TRUE(policy.apply("ap-spi-0", pol, prio, cpus));
+    EXPECT_EQ(pol, SCHED_FIFO);
+    EXPECT_EQ(prio, 18);
+    EXPECT_EQ(CPU_COUNT(&cpus), 1);
+    EXPECT_TRUE(CPU_ISSET(3, &cpus));
+
+    prio = 15;
+    EXPECT_TRUE(policy.apply("ap-timer", pol, prio, cpus));
+    EXPECT_EQ(prio, 15);
+    EXPECT_TRUE(CPU_ISSET(2, &cpus));
+
+    EXPECT_TRUE(policy.apply("log_io", pol, prio, cpus));
+    EXPECT_EQ(pol, SCHED_OTHER);
+    EXPECT_EQ(prio, 0);
+    EXPECT_EQ(CPU_COUNT(&cpus), 2);
+
+    // first match wins, and this one leaves the cpus alone
+    pol = SCHED_FIFO;
+    EXPECT_FALSE(policy.apply("ap-io", pol, prio, cpus));
+    EXPECT_EQ(prio, 5);
+
+    prio = 10;
+    EXPECT_FALSE(policy.apply("apm_fft", pol, prio, cpus));
+    EXPECT_EQ(prio, 10);
+    EXPECT_FALSE(policy.apply(nullptr, pol, prio, cpus));
+}
+
+TEST(LinuxThreadPolicy, bad_entries)
+{
+    ThreadPolicy policy;
+    EXPECT_FALSE(load_policy(policy, "ap-timer 2\n"));
+    EXPECT_FALSE(load_policy(policy, "ap-timer 2 100\n"));
+    EXPECT_FALSE(load_policy(policy, "ap-timer x 10\n"));
+    EXPECT_FALSE(policy.load("/nonexistent/threads.conf"));
+}
+
+AP_GTEST_MAIN()
@@ -0,0 +1,90 @@
+/*
+ * This file is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <AP_gtest.h>
+
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_HAL_Linux/Scheduler.h>
+#include <AP_HAL_Linux/UARTDriver.h>
+
+using namespace Linux;
+
+const AP_HAL::HAL &hal = AP_HAL::get_HAL();
+
+/*
+  a UART that reads from a pipe. /dev/null stands in as the device so
+  that begin() has something to open
+ */
+class PipeUART : public UARTDriver {
+public:
+    PipeUART(int fd) : UARTDriver(false), _fd(fd) {
+        set_device_path("/dev/null");
+    }
+
+protected:
+    int _get_read_fd() const override { return _fd; }
+    int _read_fd(uint8_t *buf, uint16_t n) override { return ::read(_fd, buf, n); }
+
+private:
+    int _fd;
+};
+
+TEST(LinuxUARTDriver, full_read_buffer_does_not_spin)
+{
+    int fds[2];
+    ASSERT_EQ(0, pipe2(fds, O_NONBLOCK | O_CLOEXEC));
+
+    PipeUART uart(fds[0]);
+    uart.begin(115200, 8192, 8192);
+    ASSERT_TRUE(uart.is_initialized());
+    // the first tick puts the pipe in the uart thread's poller
+    uart._timer_tick();
+
+    Poller &poller = Scheduler::from(hal.scheduler)->uart_poller();
+    EXPECT_EQ(0, poller.poll(0));
+
+    // write more than the read buffer holds
+    uint8_t data[2*8192];
+    memset(data, 0x55, sizeof(data));
+    ASSERT_EQ(ssize_t(sizeof(data)), write(fds[1], data, sizeof(data)));
+
+    // the pipe stays readable, but once the read buffer is full the
+    // poller must stop returning events for it
+    int wakeups = 0;
+    while (poller.poll(0) > 0 && wakeups < 100) {
+        wakeups++;
+    }
+    EXPECT_LT(wakeups, 100);
+    const uint32_t buffered = uart.available();
+    EXPECT_GT(buffered, 0U);
+    EXPECT_EQ(0, poller.poll(0));
+    EXPECT_EQ(buffered, uart.available());
+
+    // reading makes room, and the next tick waits on the pipe again
+    uint8_t buf[4096];
+    EXPECT_EQ(ssize_t(sizeof(buf)), uart.read(buf, sizeof(buf)));
+    uart._timer_tick();
+    EXPECT_GT(poller.poll(0), 0);
+    EXPECT_EQ(buffered, uart.available());
+
+    uart.end();
+    close(fds[0]);
+    close(fds[1]);
+}
+
+AP_GTEST_MAIN()
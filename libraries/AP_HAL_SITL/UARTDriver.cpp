@@ -90,6 +90,7 @@ void UARTDriver::_begin(uint32_t baud, uint16_t rxSpace, uint16_t txSpace)
              tcpclient:192.168.2.15:5762
              udpclient:127.0.0.1
              udpclient:127.0.0.1:14550
+             udpclient:127.0.0.1:14550:coalesce  // several MAVLink packets per UDP packet
              mcast:
              mcast:239.255.145.50:14550
              uart:/dev/ttyUSB0:57600
@@ -142,6 +143,10 @@ void UARTDriver::_begin(uint32_t baud, uint16_t rxSpace, uint16_t txSpace)
                 ::printf("UDP connection %s:%u\n", ip, port);
                 _udp_start_client(ip, port);
             }
+#if AP_MAVLINK_PACKETISE_ENABLED
+            const char *flag = strtok_r(nullptr, ":", &saveptr);
+            _coalesce = flag && strcmp(flag, "coalesce") == 0;
+#endif
         } else if (strcmp(devtype, "mcast") == 0) {
             // udp multicast connection
             const char *ip = args1 && *args1?args1:mcast_ip_default;
@@ -840,8 +845,10 @@ void UARTDriver::handle_writing_from_writebuffer_to_device()
     if (_packetise) {
         uint16_t n = _writebuffer.available();
         n = MIN(n, max_bytes);
-#if HAL_GCS_ENABLED
-        if (n > 0) {
+#if AP_MAVLINK_PACKETISE_ENABLED
+        if (_coalesce) {
+            n = _coalescer.bytes_to_send(_writebuffer, n, AP_HAL::millis());
+        } else if (n > 0) {
             n = mavlink_packetise(_writebuffer, n);
         }
 #endif
@@ -8,6 +8,7 @@
 #include "AP_HAL_SITL_Namespace.h"
 #include <AP_HAL/utility/Socket_native.h>
 #include <AP_HAL/utility/RingBuffer.h>
+#include <AP_HAL/utility/packetise.h>
 #include <AP_CSVReader/AP_CSVReader.h>
 #include <AP_HAL/utility/DataRateLimit.h>
 
@@ -111,6 +112,11 @@ private:
     uint64_t _receive_timestamp;
     bool _is_udp;
     bool _packetise;
+#if AP_MAVLINK_PACKETISE_ENABLED
+    // pack several MAVLink packets into each UDP packet
+    bool _coalesce;
+    MAVLinkCoalesce _coalescer;
+#endif
     uint16_t _mc_myport;
 
     // for baud-rate limiting:
@@ -734,6 +734,10 @@ void AP_Logger::WriteBlock(const void *pBuffer, uint16_t size) {
 #if APM_BUILD_TYPE(APM_BUILD_Replay)
     save_format_Replay(pBuffer);
 #endif
+    if (size >= LOG_PACKET_HEADER_LEN &&
+        !rate_table_should_log(((const uint8_t *)pBuffer)[2])) {
+        return;
+    }
     FOR_EACH_BACKEND(WriteBlock(pBuffer, size));
 }
 
@@ -743,6 +747,11 @@ bool AP_Logger::WriteBlock_first_succeed(const void *pBuffer, uint16_t size)
     if (_next_backend == 0) {
         return false;
     }
+    if (size >= LOG_PACKET_HEADER_LEN &&
+        !rate_table_should_log(((const uint8_t *)pBuffer)[2])) {
+        // deliberately not logged; this is not a failure
+        return true;
+    }
     
     for (uint8_t i=1; i<_next_backend; i++) {
         backends[i]->WriteBlock(pBuffer, size);
@@ -782,8 +791,12 @@ void AP_Logger::WriteCriticalBlock(const void *pBuffer, uint16_t size) {
     FOR_EACH_BACKEND(WriteCriticalBlock(pBuffer, size));
 }
 
-void AP_Logger::WritePrioritisedBlock(const void *pBuffer, uint16_t size, bool is_critical) {
-    FOR_EACH_BACKEND(WritePrioritisedBlock(pBuffer, size, is_critical));
+void AP_Logger::WritePrioritisedBlock(const void *pBuffer, uint16_t size, bool is_critical, bool writev_streaming) {
+    if (!is_critical && size >= LOG_PACKET_HEADER_LEN &&
+        !rate_table_should_log(((const uint8_t *)pBuffer)[2])) {
+        return;
+    }
+    FOR_EACH_BACKEND(WritePrioritisedBlock(pBuffer, size, is_critical, writev_streaming));
 }
 
 // change me to "DoTimeConsumingPreparations"?
@@ -1038,6 +1051,10 @@ void AP_Logger::WriteV(const char *name, const char *labels, const char *units,
         return;
     }
 
+    if (!is_critical && !rate_table_should_log(f->msg_type)) {
+        return;
+    }
+
     for (uint8_t i=0; i<_next_backend; i++) {
         va_list arg_copy;
         va_copy(arg_copy, arg_list);
@@ -1067,6 +1084,28 @@ bool AP_Logger::allow_start_ekf() const
 }
 
 #if CONFIG_HAL_BOARD == HAL_BOARD_SITL
+/*
+  check that the format passed to WriteStatic matches the
+  LogStructure for the message type; each type is only checked once
+ */
+void AP_Logger::validate_static_fmt(const uint8_t msg_type, const char *fmt)
+{
+    if (static_fmt_validated.get(msg_type)) {
+        return;
+    }
+    static_fmt_validated.set(msg_type);
+    const struct LogStructure *s = structure_for_msg_type(msg_type);
+    if (s == nullptr) {
+        AP_HAL::panic("No structure for static msg_type=%u", msg_type);
+    }
+    if (strncmp(s->format, fmt, LS_FORMAT_SIZE) != 0) {
+        char name[LS_NAME_SIZE+1] {};
+        strncpy_noterm(name, s->name, LS_NAME_SIZE);
+        AP_HAL::panic("Static format mismatch for %u (%s) (expected=%s got=%s)",
+                      msg_type, name, s->format, fmt);
+    }
+}
+
 bool AP_Logger::assert_same_fmt_for_name(const AP_Logger::log_write_fmt *f,
                                                const char *name,
                                                const char *labels,
@@ -1431,6 +1470,9 @@ void AP_Logger::io_thread(void)
     uint32_t last_stack_us = last_run_us;
     uint32_t last_crash_check_us = last_run_us;
     bool done_crash_dump_save = false;
+#if HAL_LOGGER_RATE_TABLE_ENABLED
+    uint32_t last_rate_table_check_us = last_run_us;
+#endif
 
     while (true) {
         uint32_t now = AP_HAL::micros();
@@ -1456,6 +1498,13 @@ void AP_Logger::io_thread(void)
             last_crash_check_us = now;
             done_crash_dump_save = check_crash_dump_save();
         }
+#if HAL_LOGGER_RATE_TABLE_ENABLED
+        // pick up changes to the per-message rate table every 5s
+        if (now - last_rate_table_check_us > 5000000U) {
+            last_rate_table_check_us = now;
+            rate_table.update();
+        }
+#endif
 #if HAL_LOGGER_FILE_CONTENTS_ENABLED
         file_content_update();
 #endif
@@ -1486,25 +1535,19 @@ void AP_Logger::start_io_thread(void)
 // Wrote an event packet
 void AP_Logger::Write_Event(LogEvent id)
 {
-    const struct log_Event pkt{
-        LOG_PACKET_HEADER_INIT(LOG_EVENT_MSG),
-        time_us  : AP_HAL::micros64(),
-        id       : (uint8_t)id
-    };
-    WriteCriticalBlock(&pkt, sizeof(pkt));
+    AP_LOGGER_WRITE_STATIC_CRITICAL(*this, LOG_EVENT_MSG, "QB",
+                                    AP_HAL::micros64(),
+                                    uint8_t(id));
 }
 
 // Write an error packet
 void AP_Logger::Write_Error(LogErrorSubsystem sub_system,
                             LogErrorCode error_code)
 {
-  const struct log_Error pkt{
-      LOG_PACKET_HEADER_INIT(LOG_ERROR_MSG),
-      time_us       : AP_HAL::micros64(),
-      sub_system    : uint8_t(sub_system),
-      error_code    : uint8_t(error_code),
-  };
-  WriteCriticalBlock(&pkt, sizeof(pkt));
+    AP_LOGGER_WRITE_STATIC_CRITICAL(*this, LOG_ERROR_MSG, "QBB",
+                                    AP_HAL::micros64(),
+                                    uint8_t(sub_system),
+                                    uint8_t(error_code));
 }
 
 /*
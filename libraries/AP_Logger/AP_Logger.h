@@ -9,6 +9,7 @@
 
 #include <AP_HAL/AP_HAL.h>
 #include <AP_Common/AP_Common.h>
+#include <AP_Common/Bitmask.h>
 #include <AP_Param/AP_Param.h>
 #include <AP_Mission/AP_Mission.h>
 #include <AP_Logger/LogStructure.h>
@@ -17,6 +18,8 @@
 #include <stdint.h>
 
 #include "LoggerMessageWriter.h"
+#include "AP_Logger_StaticWrite.h"
+#include "AP_Logger_RateTable.h"
 
 class AP_Logger_Backend;
 
@@ -190,6 +193,7 @@ class AP_Logger
 {
     friend class AP_Logger_Backend; // for _num_types
     friend class AP_Logger_RateLimiter;
+    friend class AP_Logger_RateTable;
 
 public:
     FUNCTOR_TYPEDEF(vehicle_startup_message_Writer, void);
@@ -294,6 +298,25 @@ public:
     void WriteCritical(const char *name, const char *labels, const char *units, const char *mults, const char *fmt, ...);
     void WriteV(const char *name, const char *labels, const char *units, const char *mults, const char *fmt, va_list arg_list, bool is_critical=false, bool is_streaming=false);
 
+    // write a message whose format is known at compile time; use via
+    // the AP_LOGGER_WRITE_STATIC macros in AP_Logger_StaticWrite.h,
+    // which check the arguments against fmt and supply PAYLOAD_LEN
+    template <uint16_t PAYLOAD_LEN, typename... Args>
+    void WriteStatic(uint8_t msg_type, const char *fmt, bool is_critical, bool is_streaming, const Args&... args) {
+        if (!is_critical && !rate_table_should_log(msg_type)) {
+            return;
+        }
+        uint8_t buf[LOG_PACKET_HEADER_LEN + PAYLOAD_LEN];
+        buf[0] = HEAD_BYTE1;
+        buf[1] = HEAD_BYTE2;
+        buf[2] = msg_type;
+        AP_Logger_Static::put_fields(&buf[LOG_PACKET_HEADER_LEN], fmt, args...);
+#if CONFIG_HAL_BOARD == HAL_BOARD_SITL
+        validate_static_fmt(msg_type, fmt);
+#endif
+        WritePrioritisedBlock(buf, sizeof(buf), is_critical, is_streaming);
+    }
+
     void Write_PID(uint8_t msg_type, const class AP_PIDInfo &info);
 
     // returns true if logging of a message should be attempted
@@ -429,7 +452,7 @@ protected:
     /* might be useful if you have a boolean indicating a message is
      * important... */
     void WritePrioritisedBlock(const void *pBuffer, uint16_t size,
-                               bool is_critical);
+                               bool is_critical, bool writev_streaming=false);
 
 private:
     #define LOGGER_MAX_BACKENDS 2
@@ -468,6 +491,19 @@ private:
 
     bool _armed;
 
+    // return false if the per-message rate table says a non-critical
+    // message of type msg_type should not be written now
+    bool rate_table_should_log(uint8_t msg_type) {
+#if HAL_LOGGER_RATE_TABLE_ENABLED
+        return rate_table.should_log(msg_type);
+#else
+        return true;
+#endif
+    }
+#if HAL_LOGGER_RATE_TABLE_ENABLED
+    AP_Logger_RateTable rate_table{*this};
+#endif
+
     // state to help us not log unnecessary RCIN values:
     bool should_log_rcin2;
 
@@ -492,6 +528,9 @@ private:
     double multiplier_name(const uint8_t multiplier_id);
     bool seen_ids[256] = { };
     bool labels_string_is_good(const char *labels) const;
+    // check a WriteStatic format against the LogStructure for msg_type
+    void validate_static_fmt(uint8_t msg_type, const char *fmt);
+    Bitmask<256> static_fmt_validated;
 #endif
 
     bool _writes_enabled:1;
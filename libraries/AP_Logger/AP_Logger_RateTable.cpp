@@ -0,0 +1,196 @@
+#include "AP_Logger_config.h"
+
+#if HAL_LOGGER_RATE_TABLE_ENABLED
+
+#include "AP_Logger_RateTable.h"
+#include "AP_Logger.h"
+
+#include <AP_Filesystem/AP_Filesystem.h>
+#include <AP_Math/AP_Math.h>
+#include <AP_Scheduler/AP_Scheduler.h>
+#include <GCS_MAVLink/GCS.h>
+
+extern const AP_HAL::HAL& hal;
+
+/*
+  parse one line of the rate table file. Returns false for blank
+  lines, comments and malformed lines
+ */
+bool AP_Logger_RateTable::parse_line(char *line, Entry &e)
+{
+    char *saveptr = nullptr;
+    const char *name = strtok_r(line, ", \t\r\n", &saveptr);
+    if (name == nullptr || name[0] == '#') {
+        return false;
+    }
+    const size_t name_len = strlen(name);
+    if (name_len >= LS_NAME_SIZE) {
+        return false;
+    }
+    const char *rate_s = strtok_r(nullptr, ", \t\r\n", &saveptr);
+    if (rate_s == nullptr) {
+        return false;
+    }
+    const float rate_hz = atof(rate_s);
+    const char *decimate_s = strtok_r(nullptr, ", \t\r\n", &saveptr);
+    const int32_t decimate = decimate_s != nullptr ? strtol(decimate_s, nullptr, 10) : 1;
+    if (decimate < 1 || decimate > UINT8_MAX) {
+        return false;
+    }
+
+    memset(&e, 0, sizeof(e));
+    memcpy(e.name, name, name_len);
+    e.msg_type = -1;
+    e.disabled = is_negative(rate_hz);
+    e.interval_ms = is_positive(rate_hz) ? MIN(1000.0 / rate_hz, UINT16_MAX) : 0;
+    e.decimate = decimate;
+    return true;
+}
+
+/*
+  read the table from the file. Returns false if the file could not
+  be read, in which case new_entries is not allocated
+ */
+bool AP_Logger_RateTable::load(Entry *&new_entries, uint8_t &count)
+{
+    int fd = AP::FS().open(AP_LOGGER_RATE_TABLE_FILE, O_RDONLY);
+    if (fd == -1) {
+        return false;
+    }
+    new_entries = NEW_NOTHROW Entry[AP_LOGGER_RATE_TABLE_MAX_ENTRIES];
+    if (new_entries == nullptr) {
+        AP::FS().close(fd);
+        return false;
+    }
+    count = 0;
+    char line[64];
+    while (count < AP_LOGGER_RATE_TABLE_MAX_ENTRIES &&
+           AP::FS().fgets(line, sizeof(line), fd)) {
+        if (parse_line(line, new_entries[count])) {
+            count++;
+        }
+    }
+    AP::FS().close(fd);
+    return true;
+}
+
+/*
+  check for a new or changed table file
+ */
+void AP_Logger_RateTable::update(void)
+{
+    AP_Filesystem::stat_t st;
+    const bool present = AP::FS().stat(AP_LOGGER_RATE_TABLE_FILE, st);
+    if (present == file_present &&
+        (!present || (st.size == file_size && st.mtime == file_mtime))) {
+        // unchanged
+        return;
+    }
+
+    Entry *new_entries = nullptr;
+    uint8_t count = 0;
+    if (present && !load(new_entries, count)) {
+        // try again next time
+        return;
+    }
+    file_present = present;
+    file_size = present ? st.size : 0;
+    file_mtime = present ? st.mtime : 0;
+
+    Entry *old_entries;
+    {
+        WITH_SEMAPHORE(sem);
+        old_entries = entries;
+        entries = new_entries;
+        num_entries = count;
+        checked.clearall();
+        limited.clearall();
+    }
+    delete[] old_entries;
+
+    if (present) {
+        GCS_SEND_TEXT(MAV_SEVERITY_INFO, "Logger: %u rate table entries", unsigned(count));
+    }
+}
+
+/*
+  find the entry for msg_type, resolving names to message types the
+  first time each message type is seen. Must be called with sem held
+ */
+AP_Logger_RateTable::Entry *AP_Logger_RateTable::entry_for_msg_type(uint8_t msg_type)
+{
+    if (!checked.get(msg_type)) {
+        checked.set(msg_type);
+        const char *name = nullptr;
+        const struct LogStructure *s = front.structure_for_msg_type(msg_type);
+        if (s != nullptr) {
+            name = s->name;
+        } else {
+            const struct AP_Logger::log_write_fmt *f = front.log_write_fmt_for_msg_type(msg_type);
+            if (f != nullptr) {
+                name = f->name;
+            }
+        }
+        if (name != nullptr) {
+            for (uint8_t i=0; i<num_entries; i++) {
+                if (strncmp(entries[i].name, name, LS_NAME_SIZE-1) == 0) {
+                    entries[i].msg_type = msg_type;
+                    limited.set(msg_type);
+                    break;
+                }
+            }
+        }
+    }
+    if (!limited.get(msg_type)) {
+        return nullptr;
+    }
+    for (uint8_t i=0; i<num_entries; i++) {
+        if (entries[i].msg_type == msg_type) {
+            return &entries[i];
+        }
+    }
+    return nullptr;
+}
+
+bool AP_Logger_RateTable::should_log_slow(uint8_t msg_type)
+{
+    WITH_SEMAPHORE(sem);
+
+    Entry *e = entry_for_msg_type(msg_type);
+    if (e == nullptr) {
+        return true;
+    }
+    if (e->disabled) {
+        return false;
+    }
+
+#if !defined(HAL_BUILD_AP_PERIPH)
+    // multi-instance messages (e.g. one IMU message per sensor) are
+    // written in the same scheduler tick; give every instance the
+    // same decision
+    const uint16_t sched_ticks = AP::scheduler().ticks();
+    if (sched_ticks == e->last_sched_count) {
+        return e->last_return;
+    }
+    e->last_sched_count = sched_ticks;
+#endif
+
+    bool ret = true;
+    const uint16_t now = AP_HAL::millis16();
+    if (e->interval_ms != 0 && uint16_t(now - e->last_ms) < e->interval_ms) {
+        ret = false;
+    }
+    if (ret && e->decimate > 1) {
+        ret = (e->decimate_count == 0);
+        if (++e->decimate_count >= e->decimate) {
+            e->decimate_count = 0;
+        }
+    }
+    if (ret) {
+        e->last_ms = now;
+    }
+    e->last_return = ret;
+    return ret;
+}
+
+#endif  // HAL_LOGGER_RATE_TABLE_ENABLED
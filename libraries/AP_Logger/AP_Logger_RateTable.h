@@ -0,0 +1,89 @@
+#pragma once
+
+#include "AP_Logger_config.h"
+
+#if HAL_LOGGER_RATE_TABLE_ENABLED
+
+#include <AP_Common/Bitmask.h>
+#include <AP_HAL/Semaphores.h>
+#include "LogStructure.h"
+
+/*
+  per-message rate limiting and decimation
+
+  The table is read from a text file (AP_LOGGER_RATE_TABLE_FILE), one
+  message per line:
+
+    # NAME  RATE_HZ  [DECIMATE]
+    IMU     50
+    PIDR    0        4
+    NTUN    -1
+
+  RATE_HZ is the maximum rate the message will be logged at, 0 for no
+  rate limit and negative to stop logging the message altogether.
+  DECIMATE logs only one in every DECIMATE messages that pass the rate
+  limit (default 1).  Messages written as critical are never limited.
+
+  The file is re-read by the logger IO thread whenever it changes, so
+  rates can be changed at runtime, e.g. by uploading a new file via
+  MAVFTP.  Checks are made in the AP_Logger frontend before a message
+  is handed to the backends, so a limited message costs no buffer
+  space in any backend.
+ */
+class AP_Logger_RateTable
+{
+public:
+    AP_Logger_RateTable(const class AP_Logger &_front) :
+        front(_front) {}
+
+    CLASS_NO_COPY(AP_Logger_RateTable);
+
+    // return true if a non-critical message of type msg_type should
+    // be written now
+    bool should_log(uint8_t msg_type) {
+        if (checked.get(msg_type) && !limited.get(msg_type)) {
+            return true;
+        }
+        return should_log_slow(msg_type);
+    }
+
+    // reload the table if the file has changed. Called from the
+    // logger IO thread
+    void update(void);
+
+private:
+    const class AP_Logger &front;
+
+    struct Entry {
+        char name[LS_NAME_SIZE];
+        int16_t msg_type;       // -1 until the name is first seen
+        uint16_t interval_ms;   // 0 for no rate limit
+        bool disabled;
+        uint8_t decimate;
+        uint8_t decimate_count;
+        uint16_t last_ms;
+        uint16_t last_sched_count;
+        bool last_return;
+    };
+
+    Entry *entries;
+    uint8_t num_entries;
+    HAL_Semaphore sem;
+
+    // msg_types which have been looked up in the table
+    Bitmask<256> checked;
+    // msg_types which have an entry in the table
+    Bitmask<256> limited;
+
+    // size and modification time of the file when last loaded
+    uint32_t file_size;
+    uint32_t file_mtime;
+    bool file_present;
+
+    bool should_log_slow(uint8_t msg_type);
+    Entry *entry_for_msg_type(uint8_t msg_type);
+    bool load(Entry *&new_entries, uint8_t &count);
+    static bool parse_line(char *line, Entry &e);
+};
+
+#endif  // HAL_LOGGER_RATE_TABLE_ENABLED
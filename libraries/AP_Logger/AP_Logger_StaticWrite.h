@@ -0,0 +1,254 @@
+#pragma once
+
+/*
+  compile-time checked writer for messages with a fixed format
+
+  Messages described in LogStructure.h are normally written by filling
+  in a packed structure and handing it to WriteBlock().  The helpers
+  in this file allow the same message to be written directly from its
+  format string:
+
+    AP_LOGGER_WRITE_STATIC(*this, LOG_EVENT_MSG, "QB",
+                           AP_HAL::micros64(), uint8_t(id));
+
+  The format string is parsed by the compiler.  The number of
+  arguments and the type of each argument are checked against the
+  format characters with static_assert, and the message length is a
+  compile-time constant, so the values are serialised straight into a
+  buffer of exactly the right size with no runtime format parsing and
+  no va_list.
+
+  Integer arguments must not be wider than their field and must have
+  the same signedness (an unsigned value may go into a wider signed
+  field).  'f' and 'g' fields take a float, 'd' takes a float or
+  double, 'n', 'N' and 'Z' take a C string and 'a' takes a pointer to
+  int16_t[32].  Enumerations must be cast to the field type.
+
+  On SITL the format string is also checked against the LogStructure
+  entry for the message type the first time each type is written.
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <type_traits>
+#include <AP_Common/float16.h>
+
+namespace AP_Logger_Static {
+
+// number of bytes used by a format character, zero if the character
+// is not a valid format character
+constexpr uint8_t field_size(char c)
+{
+    return
+        (c == 'b' || c == 'B' || c == 'M') ? 1 :
+        (c == 'h' || c == 'H' || c == 'c' || c == 'C' || c == 'g') ? 2 :
+        (c == 'i' || c == 'I' || c == 'e' || c == 'E' || c == 'L' || c == 'f' || c == 'n') ? 4 :
+        (c == 'd' || c == 'q' || c == 'Q') ? 8 :
+        (c == 'N') ? 16 :
+        (c == 'Z') ? 64 :
+        (c == 'a') ? 64 :
+        0;
+}
+
+// true if every character in fmt is a valid format character
+constexpr bool valid_fmt(const char *fmt)
+{
+    return *fmt == 0 || (field_size(*fmt) != 0 && valid_fmt(fmt+1));
+}
+
+// number of fields described by fmt
+constexpr uint8_t field_count(const char *fmt)
+{
+    return *fmt == 0 ? 0 : 1 + field_count(fmt+1);
+}
+
+// length of the message body (excluding the packet header)
+constexpr uint16_t payload_len(const char *fmt)
+{
+    return *fmt == 0 ? 0 : field_size(*fmt) + payload_len(fmt+1);
+}
+
+// true if an integer of type T can be stored in a field of type F
+// without losing range
+template <typename T, typename F>
+struct int_fits : std::integral_constant<bool,
+    std::is_integral<T>::value &&
+    sizeof(T) <= sizeof(F) &&
+    (std::is_signed<T>::value == std::is_signed<F>::value ||
+     (!std::is_signed<T>::value && sizeof(T) < sizeof(F)))> {};
+
+template <typename T>
+struct is_string : std::integral_constant<bool,
+    std::is_same<T, const char *>::value ||
+    std::is_same<T, char *>::value> {};
+
+template <typename T>
+struct is_int16_array : std::integral_constant<bool,
+    std::is_same<T, const int16_t *>::value ||
+    std::is_same<T, int16_t *>::value> {};
+
+// true if a (decayed) argument of type T may be written to a field
+// described by format character c
+template <typename T>
+constexpr bool accepts(char c)
+{
+    return
+        (c == 'b') ? int_fits<T, int8_t>::value :
+        (c == 'B' || c == 'M') ? int_fits<T, uint8_t>::value :
+        (c == 'h' || c == 'c') ? int_fits<T, int16_t>::value :
+        (c == 'H' || c == 'C') ? int_fits<T, uint16_t>::value :
+        (c == 'i' || c == 'e' || c == 'L') ? int_fits<T, int32_t>::value :
+        (c == 'I' || c == 'E') ? int_fits<T, uint32_t>::value :
+        (c == 'q') ? int_fits<T, int64_t>::value :
+        (c == 'Q') ? int_fits<T, uint64_t>::value :
+        (c == 'f' || c == 'g') ? std::is_same<T, float>::value :
+        (c == 'd') ? std::is_floating_point<T>::value :
+        (c == 'n' || c == 'N' || c == 'Z') ? is_string<T>::value :
+        (c == 'a') ? is_int16_array<T>::value :
+        false;
+}
+
+/*
+  argument type list, obtained with
+  decltype(AP_Logger_Static::types_of(args...)).  types_of is never
+  defined; it is only used in unevaluated context
+ */
+template <typename... Args> struct TypeList {};
+
+template <typename... Args>
+TypeList<typename std::decay<Args>::type...> types_of(Args&&...);
+
+template <typename L> struct Checker;
+
+template <>
+struct Checker<TypeList<>> {
+    static constexpr uint8_t count = 0;
+    static constexpr bool types_match(const char *fmt) { return true; }
+};
+
+template <typename T, typename... Rest>
+struct Checker<TypeList<T, Rest...>> {
+    static constexpr uint8_t count = 1 + sizeof...(Rest);
+    static constexpr bool types_match(const char *fmt) {
+        return *fmt != 0 && accepts<T>(*fmt) && Checker<TypeList<Rest...>>::types_match(fmt+1);
+    }
+};
+
+/*
+  serialisation of single fields.  Types have already been checked
+  against the format, so these only need to handle the conversions
+  that accepts() allows
+ */
+template <typename F, typename T>
+inline void put(uint8_t *&p, const T &v)
+{
+    const F tmp = F(v);
+    memcpy(p, &tmp, sizeof(F));
+    p += sizeof(F);
+}
+
+inline void put_field(uint8_t *&p, char c, const char *s)
+{
+    const uint8_t len = field_size(c);
+    const size_t slen = (s != nullptr) ? strnlen(s, len) : 0;
+    memcpy(p, s, slen);
+    memset(p+slen, 0, len-slen);
+    p += len;
+}
+
+inline void put_field(uint8_t *&p, char c, const int16_t *a)
+{
+    memcpy(p, a, sizeof(int16_t[32]));
+    p += sizeof(int16_t[32]);
+}
+
+template <typename T,
+          typename std::enable_if<std::is_arithmetic<T>::value, int>::type = 0>
+inline void put_field(uint8_t *&p, char c, const T &v)
+{
+    switch (c) {
+    case 'b':
+        put<int8_t>(p, v);
+        break;
+    case 'B':
+    case 'M':
+        put<uint8_t>(p, v);
+        break;
+    case 'h':
+    case 'c':
+        put<int16_t>(p, v);
+        break;
+    case 'H':
+    case 'C':
+        put<uint16_t>(p, v);
+        break;
+    case 'i':
+    case 'e':
+    case 'L':
+        put<int32_t>(p, v);
+        break;
+    case 'I':
+    case 'E':
+        put<uint32_t>(p, v);
+        break;
+    case 'q':
+        put<int64_t>(p, v);
+        break;
+    case 'Q':
+        put<uint64_t>(p, v);
+        break;
+    case 'f':
+        put<float>(p, v);
+        break;
+    case 'd':
+        put<double>(p, v);
+        break;
+    case 'g': {
+        Float16_t tmp;
+        tmp.set(v);
+        memcpy(p, &tmp, sizeof(tmp));
+        p += sizeof(tmp);
+        break;
+    }
+    }
+}
+
+// write all fields; fmt is a constant so the switch in put_field()
+// folds away once inlined
+inline void put_fields(uint8_t *p, const char *fmt) {}
+
+template <typename T, typename... Rest>
+inline void put_fields(uint8_t *p, const char *fmt, const T &v, const Rest&... rest)
+{
+    put_field(p, *fmt, v);
+    put_fields(p, fmt+1, rest...);
+}
+
+}  // namespace AP_Logger_Static
+
+/*
+  write a message with a format known at compile time. logger is the
+  AP_Logger to write to, msg_type a LogMessages value and fmt a string
+  literal which must match the format in the LogStructure entry for
+  msg_type
+ */
+#define AP_LOGGER_WRITE_STATIC_PRIO(logger, msg_type, fmt, is_critical, is_streaming, ...) \
+    do {                                                                \
+        static_assert(AP_Logger_Static::valid_fmt(fmt),                 \
+                      "invalid log format string \"" fmt "\"");         \
+        typedef AP_Logger_Static::Checker<decltype(AP_Logger_Static::types_of(__VA_ARGS__))> _ap_log_checker; \
+        static_assert(_ap_log_checker::count == AP_Logger_Static::field_count(fmt), \
+                      "wrong number of arguments for log format \"" fmt "\""); \
+        static_assert(_ap_log_checker::types_match(fmt),                \
+                      "argument types do not match log format \"" fmt "\""); \
+        (logger).WriteStatic<AP_Logger_Static::payload_len(fmt)>(msg_type, fmt, is_critical, is_streaming, __VA_ARGS__); \
+    } while (0)
+
+#define AP_LOGGER_WRITE_STATIC(logger, msg_type, fmt, ...) \
+    AP_LOGGER_WRITE_STATIC_PRIO(logger, msg_type, fmt, false, false, __VA_ARGS__)
+
+#define AP_LOGGER_WRITE_STATIC_STREAMING(logger, msg_type, fmt, ...) \
+    AP_LOGGER_WRITE_STATIC_PRIO(logger, msg_type, fmt, false, true, __VA_ARGS__)
+
+#define AP_LOGGER_WRITE_STATIC_CRITICAL(logger, msg_type, fmt, ...) \
+    AP_LOGGER_WRITE_STATIC_PRIO(logger, msg_type, fmt, true, false, __VA_ARGS__)
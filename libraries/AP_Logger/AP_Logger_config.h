@@ -51,6 +51,20 @@
 #define HAL_LOGGER_FILE_CONTENTS_ENABLED HAL_LOGGING_FILESYSTEM_ENABLED && !AP_FILESYSTEM_LITTLEFS_ENABLED
 #endif
 
+// per-message rate limits read from a file in the log directory
+#ifndef HAL_LOGGER_RATE_TABLE_ENABLED
+#define HAL_LOGGER_RATE_TABLE_ENABLED HAL_LOGGING_FILESYSTEM_ENABLED
+#endif
+
+#if HAL_LOGGER_RATE_TABLE_ENABLED
+#ifndef AP_LOGGER_RATE_TABLE_FILE
+#define AP_LOGGER_RATE_TABLE_FILE HAL_BOARD_LOG_DIRECTORY "/LOGRATE.TXT"
+#endif
+#ifndef AP_LOGGER_RATE_TABLE_MAX_ENTRIES
+#define AP_LOGGER_RATE_TABLE_MAX_ENTRIES 16
+#endif
+#endif
+
 // range of IDs to allow for new messages during replay. It is very
 // useful to be able to add new messages during a replay, but we need
 // to avoid colliding with existing messages
@@ -143,6 +143,7 @@ const struct MultiplierStructure log_Multipliers[] = {
 #include <AP_ESC_Telem/LogStructure.h>
 #include <AP_AIS/LogStructure.h>
 #include <AP_HAL_ChibiOS/LogStructure.h>
+#include <AP_HAL_Linux/LogStructure.h>
 #include <AP_RPM/LogStructure.h>
 #include <AC_Fence/LogStructure.h>
 #include <AP_Landing/LogStructure.h>
@@ -609,6 +610,7 @@ struct PACKED log_Scripting {
     uint32_t run_time;
     int32_t total_mem;
     int32_t run_mem;
+    uint32_t script_mem;
 };
 
 struct PACKED log_MotBatt {
@@ -1105,7 +1107,8 @@ struct PACKED log_VER {
 // @Field: Name: script name
 // @Field: Runtime: run time
 // @Field: Total_mem: total memory usage of all scripts
-// @Field: Run_mem: run memory usage
+// @Field: Run_mem: run memory usage; when loading a script, the peak memory used while loading
+// @Field: Mem: memory currently allocated by this script
 
 // @LoggerMessage: VER
 // @Description: Ardupilot version
@@ -1223,6 +1226,7 @@ LOG_STRUCTURE_FROM_NAVEKF3 \
 LOG_STRUCTURE_FROM_NAVEKF \
 LOG_STRUCTURE_FROM_AHRS \
 LOG_STRUCTURE_FROM_HAL_CHIBIOS \
+LOG_STRUCTURE_FROM_HAL_LINUX \
 LOG_STRUCTURE_FROM_HAL \
 LOG_STRUCTURE_FROM_RPM \
 LOG_STRUCTURE_FROM_FENCE \
@@ -1254,7 +1258,7 @@ LOG_STRUCTURE_FROM_VISUALODOM \
       "FILE",   "NIBZ",       "FileName,Offset,Length,Data", "----", "----" }, \
 LOG_STRUCTURE_FROM_AIS \
     { LOG_SCRIPTING_MSG, sizeof(log_Scripting), \
-      "SCR",   "QNIii", "TimeUS,Name,Runtime,Total_mem,Run_mem", "s#sbb", "F-F--", true }, \
+      "SCR",   "QNIiiI", "TimeUS,Name,Runtime,Total_mem,Run_mem,Mem", "s#sbbb", "F-F---", true }, \
     { LOG_VER_MSG, sizeof(log_VER), \
       "VER",   "QBHBBBBIZHBBII", "TimeUS,BT,BST,Maj,Min,Pat,FWT,GH,FWS,APJ,BU,FV,IMI,ICI", "s-------------", "F-------------", false }, \
     { LOG_MOTBATT_MSG, sizeof(log_MotBatt), \
@@ -1288,6 +1292,7 @@ enum LogMessages : uint8_t {
     LOG_IDS_FROM_ESC_TELEM,
     LOG_IDS_FROM_BATTMONITOR,
     LOG_IDS_FROM_HAL_CHIBIOS,
+    LOG_IDS_FROM_HAL_LINUX,
     LOG_IDS_FROM_MISSION,
 
     LOG_IDS_FROM_GPS,
@@ -0,0 +1,75 @@
+#include <AP_gtest.h>
+#include <AP_HAL/AP_HAL.h>
+
+#include <AP_Logger/LogStructure.h>
+#include <AP_Logger/AP_Logger_StaticWrite.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+// compile-time properties of format strings
+static_assert(AP_Logger_Static::valid_fmt("QBIBB"), "valid format rejected");
+static_assert(!AP_Logger_Static::valid_fmt("QBx"), "invalid format accepted");
+static_assert(AP_Logger_Static::field_count("QNff") == 4, "bad field count");
+static_assert(AP_Logger_Static::payload_len("QNff") + LOG_PACKET_HEADER_LEN == sizeof(log_Parameter), "bad length");
+static_assert(AP_Logger_Static::accepts<uint8_t>('B'), "uint8_t rejected for B");
+static_assert(AP_Logger_Static::accepts<uint16_t>('i'), "uint16_t rejected for i");
+static_assert(!AP_Logger_Static::accepts<uint32_t>('i'), "uint32_t accepted for i");
+static_assert(!AP_Logger_Static::accepts<int8_t>('B'), "int8_t accepted for B");
+static_assert(!AP_Logger_Static::accepts<double>('f'), "double accepted for f");
+static_assert(AP_Logger_Static::accepts<const char *>('N'), "string rejected for N");
+
+// serialising from the format must give the same bytes as filling
+// the packed structure
+TEST(AP_Logger_Static, Parameter)
+{
+    struct log_Parameter pkt{
+        LOG_PACKET_HEADER_INIT(LOG_PARAMETER_MSG),
+        time_us       : 123456789ULL,
+        name          : {},
+        value         : 0.135f,
+        default_value : 0.1f
+    };
+    strncpy(pkt.name, "ATC_RAT_RLL_P", sizeof(pkt.name));
+
+    uint8_t buf[sizeof(pkt)] {};
+    buf[0] = HEAD_BYTE1;
+    buf[1] = HEAD_BYTE2;
+    buf[2] = LOG_PARAMETER_MSG;
+    AP_Logger_Static::put_fields(&buf[LOG_PACKET_HEADER_LEN], "QNff",
+                                 uint64_t(123456789ULL), "ATC_RAT_RLL_P", 0.135f, 0.1f);
+    EXPECT_EQ(0, memcmp(buf, &pkt, sizeof(pkt)));
+}
+
+TEST(AP_Logger_Static, StringTruncation)
+{
+    uint8_t buf[4];
+    memset(buf, 0xff, sizeof(buf));
+    AP_Logger_Static::put_fields(buf, "n", "ABCDEFG");
+    EXPECT_EQ(0, memcmp(buf, "ABCD", 4));
+
+    memset(buf, 0xff, sizeof(buf));
+    AP_Logger_Static::put_fields(buf, "n", "AB");
+    const uint8_t expected[4] { 'A', 'B', 0, 0 };
+    EXPECT_EQ(0, memcmp(buf, expected, 4));
+}
+
+TEST(AP_Logger_Static, Integers)
+{
+    uint8_t buf[1+2+4+8];
+    AP_Logger_Static::put_fields(buf, "bHiq", int8_t(-3), uint8_t(200), int16_t(-1000), int32_t(-70000));
+    int8_t b;
+    uint16_t h;
+    int32_t i;
+    int64_t q;
+    memcpy(&b, &buf[0], sizeof(b));
+    memcpy(&h, &buf[1], sizeof(h));
+    memcpy(&i, &buf[3], sizeof(i));
+    memcpy(&q, &buf[7], sizeof(q));
+    EXPECT_EQ(-3, b);
+    EXPECT_EQ(200, h);
+    EXPECT_EQ(-1000, i);
+    EXPECT_EQ(-70000, q);
+}
+
+AP_GTEST_PANIC()
+AP_GTEST_MAIN()
@@ -95,6 +95,34 @@ static void swap_float(float &f1, float &f2)
     f2 = tmp;
 }
 
+/*
+  polynomial approximation of atan2f(). The angle is reduced to
+  [0,pi/4] using the octant of (x,y) and the 11th order minimax
+  polynomial for atan(a) over [0,1] is evaluated with Horner's method
+ */
+float fast_atan2f(const float y, const float x)
+{
+    const float ax = fabsf(x);
+    const float ay = fabsf(y);
+    const float max_xy = MAX(ax, ay);
+    if (is_zero(max_xy)) {
+        return 0;
+    }
+    const float a = MIN(ax, ay) / max_xy;
+    const float s = a * a;
+    float r = a * (0.99997726f + s * (-0.33262347f + s * (0.19354346f + s * (-0.11643287f + s * (0.05265332f + s * -0.01172120f)))));
+    if (ay > ax) {
+        r = float(M_PI_2) - r;
+    }
+    if (x < 0) {
+        r = float(M_PI) - r;
+    }
+    if (y < 0) {
+        r = -r;
+    }
+    return r;
+}
+
 /*
  * linear interpolation based on a variable in a range
  */
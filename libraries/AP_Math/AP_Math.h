@@ -109,6 +109,14 @@ float safe_asin(const T v);
 template <typename T>
 float safe_sqrt(const T v);
 
+/*
+ * a polynomial approximation of atan2f(), accurate to within 3e-6
+ * radians over the whole circle and several times faster than atan2f()
+ * on boards without a hardware atan2. Returns zero if both x and y
+ * are zero
+ */
+float fast_atan2f(const float y, const float x);
+
 // matrix multiplication of two NxN matrices
 template <typename T>
 void mat_mul(const T *A, const T *B, T *C, uint16_t n);
@@ -0,0 +1,162 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_Math/AP_Math.h>
+#include <AP_Math/control.h>
+#include <AP_Math/SCurve.h>
+#include <AP_Math/SplineCurve.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+/*
+  kinematic shaping and path generation run by the position
+  controller and waypoint navigation on every loop
+ */
+
+static const float dt = 0.0025f;
+
+static void BM_SqrtController(benchmark::State& state)
+{
+    float error = 150.0f;
+
+    while (state.KeepRunning()) {
+        gbenchmark_escape(&error);
+        float out = sqrt_controller(error, 1.0f, 250.0f, dt);
+        gbenchmark_escape(&out);
+    }
+}
+
+static void BM_SqrtControllerXY(benchmark::State& state)
+{
+    Vector2f error(150.0f, -80.0f);
+
+    while (state.KeepRunning()) {
+        gbenchmark_escape(&error);
+        Vector2f out = sqrt_controller(error, 1.0f, 250.0f, dt);
+        gbenchmark_escape(&out);
+    }
+}
+
+static void BM_ShapePosVelAccel(benchmark::State& state)
+{
+    float accel = 0.0f;
+
+    while (state.KeepRunning()) {
+        shape_pos_vel_accel(1000.0, 200.0f, 0.0f,
+                            0.0, 150.0f, accel,
+                            -250.0f, 500.0f,
+                            -250.0f, 250.0f,
+                            500.0f, dt, false);
+        gbenchmark_escape(&accel);
+    }
+}
+
+static void BM_ShapePosVelAccelXY(benchmark::State& state)
+{
+    const Vector2p pos_input(1000.0, -500.0);
+    const Vector2f vel_input(200.0f, -100.0f);
+    const Vector2f accel_input;
+    const Vector2p pos;
+    const Vector2f vel(150.0f, 0.0f);
+    Vector2f accel;
+
+    while (state.KeepRunning()) {
+        shape_pos_vel_accel_xy(pos_input, vel_input, accel_input,
+                               pos, vel, accel,
+                               500.0f, 250.0f,
+                               500.0f, dt, false);
+        gbenchmark_escape(&accel);
+    }
+}
+
+static void BM_UpdatePosVelAccelXY(benchmark::State& state)
+{
+    Vector2p pos;
+    Vector2f vel(150.0f, 0.0f);
+    const Vector2f accel(10.0f, -5.0f);
+    const Vector2f limit;
+
+    while (state.KeepRunning()) {
+        update_pos_vel_accel_xy(pos, vel, accel, dt, limit, Vector2f(), Vector2f());
+        gbenchmark_escape(&pos);
+        gbenchmark_escape(&vel);
+    }
+}
+
+static void BM_SCurveCalculateTrack(benchmark::State& state)
+{
+    const Vector3f origin;
+    const Vector3f destination(10000.0f, 5000.0f, 1000.0f);
+
+    while (state.KeepRunning()) {
+        SCurve scurve;
+        scurve.calculate_track(origin, destination,
+                               1000.0f, 250.0f, 150.0f,
+                               250.0f, 100.0f,
+                               10.0f, 1000.0f);
+        gbenchmark_escape(&scurve);
+    }
+}
+
+static void BM_SCurveAdvanceTarget(benchmark::State& state)
+{
+    const Vector3f origin;
+    const Vector3f destination(10000.0f, 5000.0f, 1000.0f);
+    SCurve prev_leg, this_leg, next_leg;
+    this_leg.calculate_track(origin, destination,
+                             1000.0f, 250.0f, 150.0f,
+                             250.0f, 100.0f,
+                             10.0f, 1000.0f);
+    // start two seconds into the leg, after the acceleration phase
+    Vector3f target_pos, target_vel, target_accel;
+    for (uint8_t i = 0; i < 20; i++) {
+        IGNORE_RETURN(this_leg.advance_target_along_track(prev_leg, next_leg, 200.0f, 250.0f, false, 0.1f, target_pos, target_vel, target_accel));
+    }
+    const SCurve start = this_leg;
+
+    uint32_t count = 0;
+    while (state.KeepRunning()) {
+        if (++count == 1000) {
+            // stay well inside the leg
+            count = 0;
+            this_leg = start;
+        }
+        bool finished = this_leg.advance_target_along_track(prev_leg, next_leg, 200.0f, 250.0f, false, dt, target_pos, target_vel, target_accel);
+        gbenchmark_escape(&finished);
+        gbenchmark_escape(&target_pos);
+    }
+}
+
+static void BM_SplineCurveAdvanceTarget(benchmark::State& state)
+{
+    SplineCurve spline;
+    spline.set_speed_accel(1000.0f, 250.0f, 150.0f, 250.0f, 100.0f);
+    spline.set_origin_and_destination(Vector3f(), Vector3f(10000.0f, 5000.0f, 1000.0f),
+                                      Vector3f(500.0f, 0.0f, 0.0f), Vector3f(0.0f, 500.0f, 0.0f));
+    Vector3f target_pos, target_vel;
+    for (uint16_t i = 0; i < 100; i++) {
+        spline.advance_target_along_track(0.1f, target_pos, target_vel);
+    }
+    const SplineCurve start = spline;
+
+    uint32_t count = 0;
+    while (state.KeepRunning()) {
+        if (++count == 1000) {
+            count = 0;
+            spline = start;
+        }
+        spline.advance_target_along_track(dt, target_pos, target_vel);
+        gbenchmark_escape(&target_pos);
+        gbenchmark_escape(&target_vel);
+    }
+}
+
+BENCHMARK(BM_SqrtController);
+BENCHMARK(BM_SqrtControllerXY);
+BENCHMARK(BM_ShapePosVelAccel);
+BENCHMARK(BM_ShapePosVelAccelXY);
+BENCHMARK(BM_UpdatePosVelAccelXY);
+BENCHMARK(BM_SCurveCalculateTrack);
+BENCHMARK(BM_SCurveAdvanceTarget);
+BENCHMARK(BM_SplineCurveAdvanceTarget);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,236 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_Common/Location.h>
+#include <AP_Common/LocationReference.h>
+#include <AP_Math/AP_Math.h>
+#include <GCS_MAVLink/GCS_Dummy.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+const struct AP_Param::GroupInfo        GCS_MAVLINK_Parameters::var_info[] = {
+    AP_GROUPEND
+};
+GCS_Dummy _gcs;
+
+/*
+  position math run by navigation on every loop
+ */
+
+static const Location home{-353632620, 1491652370, 58400, Location::AltFrame::ABSOLUTE};
+static const Location target{-353642740, 1491656560, 60000, Location::AltFrame::ABSOLUTE};
+
+static void BM_LocationOffset(benchmark::State& state)
+{
+    while (state.KeepRunning()) {
+        Location loc = home;
+        loc.offset(123.4f, -56.7f);
+        gbenchmark_escape(&loc);
+    }
+}
+
+static void BM_LocationOffsetBearing(benchmark::State& state)
+{
+    while (state.KeepRunning()) {
+        Location loc = home;
+        loc.offset_bearing(37.5f, 250.0f);
+        gbenchmark_escape(&loc);
+    }
+}
+
+static void BM_LocationGetDistance(benchmark::State& state)
+{
+    while (state.KeepRunning()) {
+        ftype distance = home.get_distance(target);
+        gbenchmark_escape(&distance);
+    }
+}
+
+static void BM_LocationGetDistanceNE(benchmark::State& state)
+{
+    while (state.KeepRunning()) {
+        Vector2f ne = home.get_distance_NE(target);
+        gbenchmark_escape(&ne);
+    }
+}
+
+static void BM_LocationGetDistanceNED(benchmark::State& state)
+{
+    while (state.KeepRunning()) {
+        Vector3f ned = home.get_distance_NED(target);
+        gbenchmark_escape(&ned);
+    }
+}
+
+static void BM_LocationGetBearing(benchmark::State& state)
+{
+    while (state.KeepRunning()) {
+        ftype bearing = home.get_bearing(target);
+        gbenchmark_escape(&bearing);
+    }
+}
+
+/*
+  the same with the longitude scale cached in a LocationReference
+ */
+
+static const LocationReference home_ref{home};
+
+static void BM_LocationReferenceOffset(benchmark::State& state)
+{
+    while (state.KeepRunning()) {
+        Location loc = home;
+        home_ref.offset(loc, 123.4f, -56.7f);
+        gbenchmark_escape(&loc);
+    }
+}
+
+static void BM_LocationReferenceGetDistance(benchmark::State& state)
+{
+    while (state.KeepRunning()) {
+        ftype distance = home_ref.get_distance(target);
+        gbenchmark_escape(&distance);
+    }
+}
+
+static void BM_LocationReferenceGetDistanceNE(benchmark::State& state)
+{
+    while (state.KeepRunning()) {
+        Vector2f ne = home_ref.get_distance_NE(target);
+        gbenchmark_escape(&ne);
+    }
+}
+
+static void BM_LocationReferenceGetBearing(benchmark::State& state)
+{
+    while (state.KeepRunning()) {
+        ftype bearing = home_ref.get_bearing(target);
+        gbenchmark_escape(&bearing);
+    }
+}
+
+// a polygon fence worth of points, converted one at a time and as a batch
+#define NUM_POINTS 64
+
+static void fill_points(Location *points)
+{
+    for (uint8_t i=0; i<NUM_POINTS; i++) {
+        points[i] = home;
+        points[i].offset_bearing(i * (360.0f / NUM_POINTS), 500.0f + 10 * i);
+    }
+}
+
+static void BM_LocationGetDistanceNEPoints(benchmark::State& state)
+{
+    Location points[NUM_POINTS];
+    fill_points(points);
+    Vector2f ne[NUM_POINTS];
+
+    while (state.KeepRunning()) {
+        for (uint8_t i=0; i<NUM_POINTS; i++) {
+            ne[i] = home.get_distance_NE(points[i]);
+        }
+        gbenchmark_escape(ne);
+    }
+}
+
+static void BM_LocationReferenceGetDistanceNEBatch(benchmark::State& state)
+{
+    Location points[NUM_POINTS];
+    fill_points(points);
+    Vector2f ne[NUM_POINTS];
+
+    while (state.KeepRunning()) {
+        home_ref.get_distance_NE(points, ne, NUM_POINTS);
+        gbenchmark_escape(ne);
+    }
+}
+
+static void BM_Atan2f(benchmark::State& state)
+{
+    float y = 0.3f;
+    const float x = -0.7f;
+
+    while (state.KeepRunning()) {
+        gbenchmark_escape(&y);
+        float angle = atan2f(y, x);
+        gbenchmark_escape(&angle);
+    }
+}
+
+static void BM_FastAtan2f(benchmark::State& state)
+{
+    float y = 0.3f;
+    const float x = -0.7f;
+
+    while (state.KeepRunning()) {
+        gbenchmark_escape(&y);
+        float angle = fast_atan2f(y, x);
+        gbenchmark_escape(&angle);
+    }
+}
+
+static void BM_HorizontalDistanceCm(benchmark::State& state)
+{
+    const Vector2f origin(100.0f, -200.0f);
+    const Vector2f destination(-3000.0f, 4500.0f);
+
+    while (state.KeepRunning()) {
+        float distance = get_horizontal_distance_cm(origin, destination);
+        gbenchmark_escape(&distance);
+    }
+}
+
+static void BM_BearingCd(benchmark::State& state)
+{
+    const Vector2f origin(100.0f, -200.0f);
+    const Vector2f destination(-3000.0f, 4500.0f);
+
+    while (state.KeepRunning()) {
+        float bearing = get_bearing_cd(origin, destination);
+        gbenchmark_escape(&bearing);
+    }
+}
+
+static void BM_LLHToECEF(benchmark::State& state)
+{
+    const Vector3d llh(radians(-35.363262), radians(149.165237), 584.0);
+
+    while (state.KeepRunning()) {
+        Vector3d ecef;
+        wgsllh2ecef(llh, ecef);
+        gbenchmark_escape(&ecef);
+    }
+}
+
+static void BM_ECEFToLLH(benchmark::State& state)
+{
+    Vector3d ecef;
+    wgsllh2ecef(Vector3d(radians(-35.363262), radians(149.165237), 584.0), ecef);
+
+    while (state.KeepRunning()) {
+        Vector3d llh;
+        wgsecef2llh(ecef, llh);
+        gbenchmark_escape(&llh);
+    }
+}
+
+BENCHMARK(BM_LocationOffset);
+BENCHMARK(BM_LocationOffsetBearing);
+BENCHMARK(BM_LocationGetDistance);
+BENCHMARK(BM_LocationGetDistanceNE);
+BENCHMARK(BM_LocationGetDistanceNED);
+BENCHMARK(BM_LocationGetBearing);
+BENCHMARK(BM_LocationReferenceOffset);
+BENCHMARK(BM_LocationReferenceGetDistance);
+BENCHMARK(BM_LocationReferenceGetDistanceNE);
+BENCHMARK(BM_LocationReferenceGetBearing);
+BENCHMARK(BM_LocationGetDistanceNEPoints);
+BENCHMARK(BM_LocationReferenceGetDistanceNEBatch);
+BENCHMARK(BM_Atan2f);
+BENCHMARK(BM_FastAtan2f);
+BENCHMARK(BM_HorizontalDistanceCm);
+BENCHMARK(BM_BearingCd);
+BENCHMARK(BM_LLHToECEF);
+BENCHMARK(BM_ECEFToLLH);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,159 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_Math/AP_Math.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+/*
+  rotations as used by the attitude controllers and the EKF
+ */
+
+static void BM_QuaternionMultiply(benchmark::State& state)
+{
+    Quaternion q1, q2;
+    q1.from_euler(0.1f, 0.2f, 0.3f);
+    q2.from_euler(-0.3f, 0.05f, 1.2f);
+
+    while (state.KeepRunning()) {
+        Quaternion q3 = q1 * q2;
+        gbenchmark_escape(&q3);
+    }
+}
+
+static void BM_QuaternionRotateVector(benchmark::State& state)
+{
+    Quaternion q;
+    q.from_euler(0.1f, 0.2f, 0.3f);
+    Vector3f v(1.0f, 2.0f, 3.0f);
+
+    while (state.KeepRunning()) {
+        Vector3f r = q * v;
+        gbenchmark_escape(&r);
+    }
+}
+
+static void BM_QuaternionFromEuler(benchmark::State& state)
+{
+    float roll = 0.1f;
+
+    while (state.KeepRunning()) {
+        Quaternion q;
+        q.from_euler(roll, 0.2f, 0.3f);
+        gbenchmark_escape(&q);
+        gbenchmark_escape(&roll);
+    }
+}
+
+static void BM_QuaternionToEuler(benchmark::State& state)
+{
+    Quaternion q;
+    q.from_euler(0.1f, 0.2f, 0.3f);
+
+    while (state.KeepRunning()) {
+        float roll, pitch, yaw;
+        gbenchmark_escape(&q);
+        q.to_euler(roll, pitch, yaw);
+        gbenchmark_escape(&roll);
+        gbenchmark_escape(&pitch);
+        gbenchmark_escape(&yaw);
+    }
+}
+
+static void BM_QuaternionFromAxisAngle(benchmark::State& state)
+{
+    Vector3f v(0.01f, -0.02f, 0.005f);
+
+    while (state.KeepRunning()) {
+        Quaternion q;
+        gbenchmark_escape(&v);
+        q.from_axis_angle(v);
+        gbenchmark_escape(&q);
+    }
+}
+
+static void BM_QuaternionRotationMatrix(benchmark::State& state)
+{
+    Quaternion q;
+    q.from_euler(0.1f, 0.2f, 0.3f);
+
+    while (state.KeepRunning()) {
+        Matrix3f m;
+        gbenchmark_escape(&q);
+        q.rotation_matrix(m);
+        gbenchmark_escape(&m);
+    }
+}
+
+static void BM_Matrix3FromEuler(benchmark::State& state)
+{
+    float roll = 0.1f;
+
+    while (state.KeepRunning()) {
+        Matrix3f m;
+        m.from_euler(roll, 0.2f, 0.3f);
+        gbenchmark_escape(&m);
+        gbenchmark_escape(&roll);
+    }
+}
+
+static void BM_Matrix3RotateVector(benchmark::State& state)
+{
+    Matrix3f m;
+    m.from_euler(0.1f, 0.2f, 0.3f);
+    Vector3f v(1.0f, 2.0f, 3.0f);
+
+    while (state.KeepRunning()) {
+        Vector3f r = m * v;
+        gbenchmark_escape(&r);
+    }
+}
+
+static void BM_Matrix3MulTranspose(benchmark::State& state)
+{
+    Matrix3f m;
+    m.from_euler(0.1f, 0.2f, 0.3f);
+    Vector3f v(1.0f, 2.0f, 3.0f);
+
+    while (state.KeepRunning()) {
+        Vector3f r = m.mul_transpose(v);
+        gbenchmark_escape(&r);
+    }
+}
+
+static void BM_Matrix3Rotate(benchmark::State& state)
+{
+    Matrix3f m;
+    m.from_euler(0.1f, 0.2f, 0.3f);
+    const Vector3f gyro(0.001f, -0.002f, 0.0005f);
+
+    while (state.KeepRunning()) {
+        m.rotate(gyro);
+        m.normalize();
+        gbenchmark_escape(&m);
+    }
+}
+
+static void BM_VectorRotation(benchmark::State& state)
+{
+    Vector3f v(1.0f, 2.0f, 3.0f);
+    const enum Rotation rotation = Rotation(state.range(0));
+
+    while (state.KeepRunning()) {
+        v.rotate(rotation);
+        gbenchmark_escape(&v);
+    }
+}
+
+BENCHMARK(BM_QuaternionMultiply);
+BENCHMARK(BM_QuaternionRotateVector);
+BENCHMARK(BM_QuaternionFromEuler);
+BENCHMARK(BM_QuaternionToEuler);
+BENCHMARK(BM_QuaternionFromAxisAngle);
+BENCHMARK(BM_QuaternionRotationMatrix);
+BENCHMARK(BM_Matrix3FromEuler);
+BENCHMARK(BM_Matrix3RotateVector);
+BENCHMARK(BM_Matrix3MulTranspose);
+BENCHMARK(BM_Matrix3Rotate);
+BENCHMARK(BM_VectorRotation)->Arg(ROTATION_YAW_90)->Arg(ROTATION_ROLL_180_YAW_45)->Arg(ROTATION_PITCH_7);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,166 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_Math/AP_Math.h>
+#include <AP_Math/vectorN.h>
+#include <AP_Math/matrixN.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+/*
+  the generic loops that VectorN and MatrixN used before their fixed
+  size loops were unrolled, for comparison
+ */
+template <typename T, uint8_t N>
+struct LoopVectorN {
+    T v[N];
+
+    void add(const LoopVectorN &a) {
+        for (uint8_t i=0; i<N; i++) {
+            v[i] += a.v[i];
+        }
+    }
+
+    void scale(const T num) {
+        for (uint8_t i=0; i<N; i++) {
+            v[i] *= num;
+        }
+    }
+
+    T dot(const LoopVectorN &a) const {
+        float ret = 0;
+        for (uint8_t i=0; i<N; i++) {
+            ret += v[i] * a.v[i];
+        }
+        return ret;
+    }
+
+    void mult(const T A[N][N], const LoopVectorN &B) {
+        for (uint8_t i = 0; i < N; i++) {
+            v[i] = 0;
+            for (uint8_t k = 0; k < N; k++) {
+                v[i] += A[i][k] * B.v[k];
+            }
+        }
+    }
+};
+
+template <typename T, uint8_t N>
+static void fill(T *v, T start)
+{
+    for (uint8_t i=0; i<N; i++) {
+        v[i] = start + T(0.1) * i;
+    }
+}
+
+template <typename T, uint8_t N>
+static void BM_VectorNAddScale(benchmark::State& state)
+{
+    VectorN<T,N> a, b;
+    fill<T,N>(&a[0], T(1));
+    fill<T,N>(&b[0], T(-2));
+
+    while (state.KeepRunning()) {
+        a += b;
+        a *= T(0.5);
+        gbenchmark_escape(&a);
+    }
+}
+
+template <typename T, uint8_t N>
+static void BM_LoopVectorNAddScale(benchmark::State& state)
+{
+    LoopVectorN<T,N> a, b;
+    fill<T,N>(a.v, T(1));
+    fill<T,N>(b.v, T(-2));
+
+    while (state.KeepRunning()) {
+        a.add(b);
+        a.scale(T(0.5));
+        gbenchmark_escape(&a);
+    }
+}
+
+template <typename T, uint8_t N>
+static void BM_VectorNDot(benchmark::State& state)
+{
+    VectorN<T,N> a, b;
+    fill<T,N>(&a[0], T(1));
+    fill<T,N>(&b[0], T(-2));
+
+    while (state.KeepRunning()) {
+        T d = a * b;
+        gbenchmark_escape(&d);
+        gbenchmark_escape(&a);
+    }
+}
+
+template <typename T, uint8_t N>
+static void BM_LoopVectorNDot(benchmark::State& state)
+{
+    LoopVectorN<T,N> a, b;
+    fill<T,N>(a.v, T(1));
+    fill<T,N>(b.v, T(-2));
+
+    while (state.KeepRunning()) {
+        T d = a.dot(b);
+        gbenchmark_escape(&d);
+        gbenchmark_escape(&a);
+    }
+}
+
+static void BM_MatrixN4Mult(benchmark::State& state)
+{
+    VectorN<float,4> a, b, c;
+    fill<float,4>(&a[0], 1);
+    fill<float,4>(&b[0], -2);
+    MatrixN<float,4> m;
+    m.mult(a, b);
+
+    while (state.KeepRunning()) {
+        c.mult(m, a);
+        m.mult(c, b);
+        gbenchmark_escape(&m);
+        gbenchmark_escape(&c);
+    }
+}
+
+static void BM_LoopMatrixN4Mult(benchmark::State& state)
+{
+    LoopVectorN<float,4> a, b, c;
+    fill<float,4>(a.v, 1);
+    fill<float,4>(b.v, -2);
+    float m[4][4];
+    for (uint8_t i = 0; i < 4; i++) {
+        for (uint8_t j = 0; j < 4; j++) {
+            m[i][j] = a.v[i] * b.v[j];
+        }
+    }
+
+    while (state.KeepRunning()) {
+        c.mult(m, a);
+        for (uint8_t i = 0; i < 4; i++) {
+            for (uint8_t j = 0; j < 4; j++) {
+                m[i][j] = c.v[i] * b.v[j];
+            }
+        }
+        gbenchmark_escape(&m);
+        gbenchmark_escape(&c);
+    }
+}
+
+BENCHMARK_TEMPLATE(BM_VectorNAddScale, float, 3);
+BENCHMARK_TEMPLATE(BM_LoopVectorNAddScale, float, 3);
+BENCHMARK_TEMPLATE(BM_VectorNAddScale, float, 24);
+BENCHMARK_TEMPLATE(BM_LoopVectorNAddScale, float, 24);
+BENCHMARK_TEMPLATE(BM_VectorNAddScale, double, 24);
+BENCHMARK_TEMPLATE(BM_LoopVectorNAddScale, double, 24);
+BENCHMARK_TEMPLATE(BM_VectorNDot, float, 4);
+BENCHMARK_TEMPLATE(BM_LoopVectorNDot, float, 4);
+BENCHMARK_TEMPLATE(BM_VectorNDot, float, 9);
+BENCHMARK_TEMPLATE(BM_LoopVectorNDot, float, 9);
+BENCHMARK_TEMPLATE(BM_VectorNDot, double, 24);
+BENCHMARK_TEMPLATE(BM_LoopVectorNDot, double, 24);
+BENCHMARK(BM_MatrixN4Mult);
+BENCHMARK(BM_LoopMatrixN4Mult);
+
+BENCHMARK_MAIN();
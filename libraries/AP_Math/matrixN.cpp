@@ -11,22 +11,22 @@
 template <typename T, uint8_t N>
 void MatrixN<T,N>::mult(const VectorN<T,N> &A, const VectorN<T,N> &B)
 {
-    for (uint8_t i = 0; i < N; i++) {
-        for (uint8_t j = 0; j < N; j++) {
+    VectorN_loop<0,N>::apply([&](uint8_t i) {
+        VectorN_loop<0,N>::apply([&](uint8_t j) {
             v[i][j] = A[i] * B[j];
-        }
-    }
+        });
+    });
 }
 
 // subtract B from the matrix
 template <typename T, uint8_t N>
 MatrixN<T,N> &MatrixN<T,N>::operator -=(const MatrixN<T,N> &B)
 {
-    for (uint8_t i = 0; i < N; i++) {
-        for (uint8_t j = 0; j < N; j++) {
+    VectorN_loop<0,N>::apply([&](uint8_t i) {
+        VectorN_loop<0,N>::apply([&](uint8_t j) {
             v[i][j] -= B.v[i][j];
-        }
-    }
+        });
+    });
     return *this;
 }
 
@@ -34,11 +34,11 @@ MatrixN<T,N> &MatrixN<T,N>::operator -=(const MatrixN<T,N> &B)
 template <typename T, uint8_t N>
 MatrixN<T,N> &MatrixN<T,N>::operator +=(const MatrixN<T,N> &B)
 {
-    for (uint8_t i = 0; i < N; i++) {
-        for (uint8_t j = 0; j < N; j++) {
+    VectorN_loop<0,N>::apply([&](uint8_t i) {
+        VectorN_loop<0,N>::apply([&](uint8_t j) {
             v[i][j] += B.v[i][j];
-        }
-    }
+        });
+    });
     return *this;
 }
 
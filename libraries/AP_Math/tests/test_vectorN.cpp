@@ -0,0 +1,83 @@
+#include <AP_gtest.h>
+
+#include <AP_Math/AP_Math.h>
+#include <AP_Math/vectorN.h>
+#include <AP_Math/matrixN.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+/*
+  check that VectorN gives bit for bit the same results as plain loops
+  over its elements, whether or not its loops are unrolled
+ */
+template <uint8_t N>
+static void check_vectorN(void)
+{
+    VectorN<float,N> a, b;
+    float ra[N], rb[N];
+    for (uint8_t i=0; i<N; i++) {
+        ra[i] = a[i] = 1.1f + 0.37f * i;
+        rb[i] = b[i] = -2.3f / (i+1);
+    }
+
+    const VectorN<float,N> sum = a + b;
+    const VectorN<float,N> diff = a - b;
+    const VectorN<float,N> scaled = a * 0.3f;
+    const VectorN<float,N> divided = a / 7.0f;
+    VectorN<float,N> acc = a;
+    acc += b;
+    acc *= 1.7f;
+    acc -= a;
+    acc /= 3.0f;
+
+    float dot = 0;
+    for (uint8_t i=0; i<N; i++) {
+        EXPECT_EQ(sum[i], ra[i] + rb[i]);
+        EXPECT_EQ(diff[i], ra[i] - rb[i]);
+        EXPECT_EQ(scaled[i], ra[i] * 0.3f);
+        EXPECT_EQ(divided[i], ra[i] / 7.0f);
+        float r = ra[i] + rb[i];
+        r *= 1.7f;
+        r -= ra[i];
+        r /= 3.0f;
+        EXPECT_EQ(acc[i], r);
+        dot += ra[i] * rb[i];
+    }
+    EXPECT_EQ(a * b, dot);
+}
+
+TEST(VectorNTest, Operators)
+{
+    check_vectorN<3>();
+    check_vectorN<4>();
+    check_vectorN<9>();
+    check_vectorN<24>();
+}
+
+TEST(MatrixNTest, Mult)
+{
+    VectorN<float,4> a, b;
+    for (uint8_t i=0; i<4; i++) {
+        a[i] = 0.9f + 0.13f * i;
+        b[i] = -1.7f / (i+1);
+    }
+    MatrixN<float,4> m;
+    m.mult(a, b);
+    MatrixN<float,4> m2 = m;
+    m2 += m;
+    m2 -= m;
+
+    VectorN<float,4> c, c2;
+    c.mult(m, a);
+    c2.mult(m2, a);
+    for (uint8_t i=0; i<4; i++) {
+        float r = 0;
+        for (uint8_t k=0; k<4; k++) {
+            r += (a[i] * b[k]) * a[k];
+        }
+        EXPECT_EQ(c[i], r);
+        EXPECT_EQ(c2[i], r);
+    }
+}
+
+AP_GTEST_MAIN()
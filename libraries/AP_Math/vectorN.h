@@ -16,6 +16,7 @@
 
 #include <cmath>
 #include <string.h>
+#include <AP_HAL/AP_HAL_Boards.h>
 #include "matrixN.h"
 
 #ifndef MATH_CHECK_INDEXES
@@ -26,9 +27,55 @@
 #include <assert.h>
 #endif
 
+/*
+  largest VectorN and MatrixN size whose element loops are unrolled at
+  compile time. Unrolling trades flash for speed, so it is only on by
+  default on boards where flash is plentiful. 24 covers the EKF state
+  covariance rows
+ */
+#ifndef AP_MATH_VECTORN_UNROLL_MAX
+#if CONFIG_HAL_BOARD == HAL_BOARD_SITL || CONFIG_HAL_BOARD == HAL_BOARD_LINUX
+#define AP_MATH_VECTORN_UNROLL_MAX 24
+#else
+#define AP_MATH_VECTORN_UNROLL_MAX 0
+#endif
+#endif
+
 template <typename T, uint8_t N>
 class MatrixN;
 
+/*
+  call f(i) for each i from I to N-1 in order. Sizes up to
+  AP_MATH_VECTORN_UNROLL_MAX are expanded at compile time into a
+  straight sequence of calls, larger sizes use a loop. As the order of
+  the calls is the same either way, unrolling does not change the
+  result of any floating point operation
+ */
+template <uint8_t I, uint8_t N, bool unroll = (N <= AP_MATH_VECTORN_UNROLL_MAX)>
+struct VectorN_loop {
+    template <typename F>
+    static inline void apply(F f) {
+        for (uint8_t i = I; i < N; i++) {
+            f(i);
+        }
+    }
+};
+
+template <uint8_t I, uint8_t N>
+struct VectorN_loop<I, N, true> {
+    template <typename F>
+    static inline __attribute__((always_inline)) void apply(F f) {
+        f(I);
+        VectorN_loop<I+1, N, true>::apply(f);
+    }
+};
+
+template <uint8_t N>
+struct VectorN_loop<N, N, true> {
+    template <typename F>
+    static inline __attribute__((always_inline)) void apply(F) {}
+};
+
 
 template <typename T, uint8_t N>
 class VectorN
@@ -77,98 +124,98 @@ public:
     // negation
     VectorN<T,N> operator -(void) const {
         VectorN<T,N> v2;
-        for (uint8_t i=0; i<N; i++) {
+        VectorN_loop<0,N>::apply([&](uint8_t i) {
             v2[i] = - _v[i];
-        }
+        });
         return v2;
     }
 
     // addition
     VectorN<T,N> operator +(const VectorN<T,N> &v) const {
         VectorN<T,N> v2;
-        for (uint8_t i=0; i<N; i++) {
+        VectorN_loop<0,N>::apply([&](uint8_t i) {
             v2[i] = _v[i] + v[i];
-        }
+        });
         return v2;
     }
 
     // subtraction
     VectorN<T,N> operator -(const VectorN<T,N> &v) const {
         VectorN<T,N> v2;
-        for (uint8_t i=0; i<N; i++) {
+        VectorN_loop<0,N>::apply([&](uint8_t i) {
             v2[i] = _v[i] - v[i];
-        }
+        });
         return v2;
     }
 
     // uniform scaling
     VectorN<T,N> operator *(const T num) const {
         VectorN<T,N> v2;
-        for (uint8_t i=0; i<N; i++) {
+        VectorN_loop<0,N>::apply([&](uint8_t i) {
             v2[i] = _v[i] * num;
-        }
+        });
         return v2;
     }
 
     // uniform scaling
     VectorN<T,N> operator  /(const T num) const {
         VectorN<T,N> v2;
-        for (uint8_t i=0; i<N; i++) {
+        VectorN_loop<0,N>::apply([&](uint8_t i) {
             v2[i] = _v[i] / num;
-        }
+        });
         return v2;
     }
 
     // addition
     VectorN<T,N> &operator +=(const VectorN<T,N> &v) {
-        for (uint8_t i=0; i<N; i++) {
+        VectorN_loop<0,N>::apply([&](uint8_t i) {
             _v[i] += v[i];
-        }
+        });
         return *this;
     }
 
     // subtraction
     VectorN<T,N> &operator -=(const VectorN<T,N> &v) {
-        for (uint8_t i=0; i<N; i++) {
+        VectorN_loop<0,N>::apply([&](uint8_t i) {
             _v[i] -= v[i];
-        }
+        });
         return *this;
     }
 
     // uniform scaling
     VectorN<T,N> &operator *=(const T num) {
-        for (uint8_t i=0; i<N; i++) {
+        VectorN_loop<0,N>::apply([&](uint8_t i) {
             _v[i] *= num;
-        }
+        });
         return *this;
     }
 
     // uniform scaling
     VectorN<T,N> &operator /=(const T num) {
-        for (uint8_t i=0; i<N; i++) {
+        VectorN_loop<0,N>::apply([&](uint8_t i) {
             _v[i] /= num;
-        }
+        });
         return *this;
     }
 
     // dot product
     T operator *(const VectorN<T,N> &v) const {
         float ret = 0;
-        for (uint8_t i=0; i<N; i++) {
+        VectorN_loop<0,N>::apply([&](uint8_t i) {
             ret += _v[i] * v._v[i];
-        }
+        });
         return ret;
     }
     
     // multiplication of a matrix by a vector, in-place
     // C = A * B
     void mult(const MatrixN<T,N> &A, const VectorN<T,N> &B) {
-        for (uint8_t i = 0; i < N; i++) {
+        VectorN_loop<0,N>::apply([&](uint8_t i) {
             _v[i] = 0;
-            for (uint8_t k = 0; k < N; k++) {
+            VectorN_loop<0,N>::apply([&](uint8_t k) {
                 _v[i] += A.v[i][k] * B[k];
-            }
-        }
+            });
+        });
     }
 
 protected:
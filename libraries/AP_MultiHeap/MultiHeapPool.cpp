@@ -0,0 +1,298 @@
+/*
+  size-class pool allocator layered over MultiHeap
+ */
+
+#include "MultiHeapPool.h"
+
+#if ENABLE_HEAP
+
+#include <AP_Math/AP_Math.h>
+
+/*
+  size of the chunks that small allocations are carved from
+ */
+#ifndef MULTIHEAP_POOL_CHUNK_SIZE
+#define MULTIHEAP_POOL_CHUNK_SIZE 1024U
+#endif
+
+// header in front of large allocations, holding the owner. Kept at 8
+// bytes to preserve the alignment of the underlying allocation
+#define LARGE_HEADER_SIZE 8U
+
+// number of entries to grow the chunk index by
+#define CHUNK_INDEX_INCREMENT 16U
+
+const uint16_t MultiHeapPool::class_sizes[NUM_CLASSES] { 8, 16, 24, 32, 48, 64, 96, 128 };
+
+int8_t MultiHeapPool::size_class(uint32_t size)
+{
+    for (uint8_t i=0; i<NUM_CLASSES; i++) {
+        if (size <= class_sizes[i]) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void MultiHeapPool::add_usage(uint8_t owner, int32_t delta)
+{
+    if (owner < MAX_OWNERS) {
+        owner_usage[owner] += delta;
+    }
+}
+
+/*
+  return index into chunks[] of the first chunk with an address
+  greater than ptr
+ */
+uint16_t MultiHeapPool::chunk_index(const void *ptr) const
+{
+    uint16_t lo = 0, hi = num_chunks;
+    while (lo < hi) {
+        const uint16_t mid = (lo + hi) / 2;
+        if ((const void *)chunks[mid] <= ptr) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+/*
+  find the chunk holding ptr, or nullptr if ptr is a large allocation
+ */
+MultiHeapPool::Chunk *MultiHeapPool::find_chunk(const void *ptr) const
+{
+    const uint16_t idx = chunk_index(ptr);
+    if (idx == 0) {
+        return nullptr;
+    }
+    Chunk *c = chunks[idx-1];
+    const uint8_t *p = (const uint8_t *)ptr;
+    if (p >= c->slots && p < c->slots + c->num_slots * class_sizes[c->size_class]) {
+        return c;
+    }
+    return nullptr;
+}
+
+void MultiHeapPool::remove_from_free_list(Chunk *c)
+{
+    if (!c->on_free_list) {
+        return;
+    }
+    Chunk **pp = &free_chunks[c->size_class];
+    while (*pp != nullptr) {
+        if (*pp == c) {
+            *pp = c->next_free;
+            break;
+        }
+        pp = &(*pp)->next_free;
+    }
+    c->next_free = nullptr;
+    c->on_free_list = false;
+}
+
+MultiHeapPool::Chunk *MultiHeapPool::new_chunk(uint8_t sc)
+{
+    if (num_chunks == max_chunks) {
+        Chunk **new_chunks = (Chunk **)heap.allocate((max_chunks + CHUNK_INDEX_INCREMENT) * sizeof(Chunk *));
+        if (new_chunks == nullptr) {
+            return nullptr;
+        }
+        if (chunks != nullptr) {
+            memcpy(new_chunks, chunks, num_chunks * sizeof(Chunk *));
+            heap.deallocate(chunks);
+        }
+        chunks = new_chunks;
+        max_chunks += CHUNK_INDEX_INCREMENT;
+    }
+
+    uint8_t *mem = (uint8_t *)heap.allocate(MULTIHEAP_POOL_CHUNK_SIZE);
+    if (mem == nullptr) {
+        return nullptr;
+    }
+
+    /*
+      layout is the Chunk header, one owner byte per slot, then the
+      slots aligned to 8 bytes
+     */
+    const uint16_t size = class_sizes[sc];
+    const uint16_t num_slots = (MULTIHEAP_POOL_CHUNK_SIZE - sizeof(Chunk) - 8) / (size + 1);
+    Chunk *c = (Chunk *)mem;
+    c->owners = mem + sizeof(Chunk);
+    c->slots = mem + ((sizeof(Chunk) + num_slots + 7) & ~7U);
+    c->num_slots = num_slots;
+    c->size_class = sc;
+    c->used = 0;
+    c->free_list = nullptr;
+    for (int16_t i=num_slots-1; i>=0; i--) {
+        void *slot = c->slots + i * size;
+        *(void **)slot = c->free_list;
+        c->free_list = slot;
+    }
+
+    // insert into the address-ordered index
+    const uint16_t idx = chunk_index(c);
+    memmove(&chunks[idx+1], &chunks[idx], (num_chunks - idx) * sizeof(Chunk *));
+    chunks[idx] = c;
+    num_chunks++;
+
+    c->next_free = free_chunks[sc];
+    free_chunks[sc] = c;
+    c->on_free_list = true;
+
+    return c;
+}
+
+void MultiHeapPool::free_chunk(Chunk *c)
+{
+    remove_from_free_list(c);
+    const uint16_t idx = chunk_index(c) - 1;
+    memmove(&chunks[idx], &chunks[idx+1], (num_chunks - idx - 1) * sizeof(Chunk *));
+    num_chunks--;
+    heap.deallocate(c);
+}
+
+void *MultiHeapPool::allocate(uint32_t size, uint8_t owner)
+{
+    if (size == 0) {
+        return nullptr;
+    }
+    const int8_t sc = size_class(size);
+    if (sc < 0) {
+        uint8_t *p = (uint8_t *)heap.allocate(size + LARGE_HEADER_SIZE);
+        if (p == nullptr) {
+            return nullptr;
+        }
+        p[0] = owner;
+        large_bytes += size;
+        add_usage(owner, size);
+        return p + LARGE_HEADER_SIZE;
+    }
+
+    Chunk *c = free_chunks[sc];
+    if (c == nullptr) {
+        c = new_chunk(sc);
+        if (c == nullptr) {
+            return nullptr;
+        }
+    }
+    uint8_t *slot = (uint8_t *)c->free_list;
+    c->free_list = *(void **)slot;
+    c->used++;
+    if (c->free_list == nullptr) {
+        remove_from_free_list(c);
+    }
+    c->owners[(slot - c->slots) / class_sizes[sc]] = owner;
+    add_usage(owner, size);
+    return slot;
+}
+
+void MultiHeapPool::deallocate(void *ptr, uint32_t size)
+{
+    if (ptr == nullptr) {
+        return;
+    }
+    Chunk *c = find_chunk(ptr);
+    if (c == nullptr) {
+        uint8_t *p = (uint8_t *)ptr - LARGE_HEADER_SIZE;
+        add_usage(p[0], -int32_t(size));
+        large_bytes -= size;
+        heap.deallocate(p);
+        return;
+    }
+
+    const uint8_t sc = c->size_class;
+    add_usage(c->owners[((uint8_t *)ptr - c->slots) / class_sizes[sc]], -int32_t(size));
+    *(void **)ptr = c->free_list;
+    c->free_list = ptr;
+    c->used--;
+    if (!c->on_free_list) {
+        c->next_free = free_chunks[sc];
+        free_chunks[sc] = c;
+        c->on_free_list = true;
+    }
+    if (c->used == 0 && free_chunks[sc]->next_free != nullptr) {
+        // keep at most one empty chunk per class so memory can go
+        // back to other sizes
+        free_chunk(c);
+    }
+}
+
+uint8_t MultiHeapPool::get_owner(const void *ptr, uint32_t size) const
+{
+    const Chunk *c = find_chunk(ptr);
+    if (c == nullptr) {
+        return ((const uint8_t *)ptr - LARGE_HEADER_SIZE)[0];
+    }
+    return c->owners[((const uint8_t *)ptr - c->slots) / class_sizes[c->size_class]];
+}
+
+void *MultiHeapPool::change_size(void *ptr, uint32_t old_size, uint32_t new_size, uint8_t owner)
+{
+    if (ptr == nullptr) {
+        return allocate(new_size, owner);
+    }
+    if (new_size == 0) {
+        deallocate(ptr, old_size);
+        return nullptr;
+    }
+
+    Chunk *c = find_chunk(ptr);
+    if (c != nullptr && size_class(new_size) == c->size_class) {
+        // still fits in the same slot
+        add_usage(c->owners[((uint8_t *)ptr - c->slots) / class_sizes[c->size_class]], int32_t(new_size) - int32_t(old_size));
+        return ptr;
+    }
+
+    owner = get_owner(ptr, old_size);
+    void *newp = allocate(new_size, owner);
+    if (newp == nullptr) {
+        if (old_size >= new_size) {
+            // Lua assumes that the allocator never fails when
+            // osize >= nsize. Frees find the slot or large allocation
+            // from the pointer, so the old block can stay in use
+            add_usage(owner, int32_t(new_size) - int32_t(old_size));
+            if (c == nullptr) {
+                large_bytes -= old_size - new_size;
+            }
+            return ptr;
+        }
+        return nullptr;
+    }
+    memcpy(newp, ptr, MIN(old_size, new_size));
+    deallocate(ptr, old_size);
+    return newp;
+}
+
+void MultiHeapPool::trim(void)
+{
+    for (uint8_t sc=0; sc<NUM_CLASSES; sc++) {
+        Chunk *c = free_chunks[sc];
+        while (c != nullptr) {
+            Chunk *next = c->next_free;
+            if (c->used == 0) {
+                free_chunk(c);
+            }
+            c = next;
+        }
+    }
+    if (num_chunks == 0 && chunks != nullptr) {
+        heap.deallocate(chunks);
+        chunks = nullptr;
+        max_chunks = 0;
+    }
+}
+
+void MultiHeapPool::get_stats(Stats &stats) const
+{
+    stats.chunk_bytes = num_chunks * MULTIHEAP_POOL_CHUNK_SIZE;
+    stats.slot_bytes = 0;
+    for (uint16_t i=0; i<num_chunks; i++) {
+        stats.slot_bytes += chunks[i]->used * class_sizes[chunks[i]->size_class];
+    }
+    stats.large_bytes = large_bytes;
+}
+
+#endif // ENABLE_HEAP
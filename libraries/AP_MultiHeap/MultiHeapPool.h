@@ -0,0 +1,98 @@
+/*
+  size-class pool allocator layered over MultiHeap
+
+  Small allocations are served from fixed size slots carved out of
+  chunks allocated from the MultiHeap, which makes them O(1) and keeps
+  them from fragmenting the underlying heaps. Larger allocations go
+  straight to the MultiHeap with a small header.
+
+  Every allocation is tagged with an owner (for scripting, the script
+  that was running when the allocation was made) so that memory use
+  can be accounted and limited per owner. Owner 0 is the shared owner.
+
+  Like MultiHeap::change_size(), the caller must supply the accurate
+  size of an existing allocation when freeing or resizing it.
+ */
+
+#pragma once
+
+#include "AP_MultiHeap.h"
+
+#if ENABLE_HEAP
+
+#include <AP_Common/AP_Common.h>
+
+class MultiHeapPool {
+public:
+    MultiHeapPool(MultiHeap &_heap) : heap(_heap) {}
+
+    CLASS_NO_COPY(MultiHeapPool);
+
+    static const uint8_t MAX_OWNERS = 32;
+
+    // operates like realloc(). A new allocation (ptr == nullptr) is
+    // attributed to owner; a resized allocation keeps its owner
+    void *change_size(void *ptr, uint32_t old_size, uint32_t new_size, uint8_t owner);
+
+    // return the owner of an existing allocation
+    uint8_t get_owner(const void *ptr, uint32_t size) const;
+
+    // bytes currently allocated by owner, as requested by the caller
+    uint32_t get_owner_usage(uint8_t owner) const {
+        return owner < MAX_OWNERS ? owner_usage[owner] : 0;
+    }
+
+    // return chunks with no allocations to the MultiHeap
+    void trim(void);
+
+    struct Stats {
+        uint32_t chunk_bytes;   // bytes held in chunks for small allocations
+        uint32_t slot_bytes;    // bytes of chunk slots in use
+        uint32_t large_bytes;   // bytes allocated directly from the MultiHeap
+    };
+    void get_stats(Stats &stats) const;
+
+private:
+    MultiHeap &heap;
+
+    struct Chunk {
+        Chunk *next_free;       // next chunk of this class with free slots
+        void *free_list;        // free slots in this chunk
+        uint16_t used;          // slots in use
+        uint16_t num_slots;
+        uint8_t size_class;
+        bool on_free_list;      // true if in the class's list of chunks with free slots
+        uint8_t *owners;        // owner of each slot
+        uint8_t *slots;
+    };
+
+    // chunks ordered by address, for finding the chunk of a slot
+    Chunk **chunks = nullptr;
+    uint16_t num_chunks = 0;
+    uint16_t max_chunks = 0;
+
+    static const uint8_t NUM_CLASSES = 8;
+    static const uint16_t class_sizes[NUM_CLASSES];
+
+    // chunks of each size class that have free slots
+    Chunk *free_chunks[NUM_CLASSES] {};
+
+    uint32_t owner_usage[MAX_OWNERS] {};
+    uint32_t large_bytes = 0;
+
+    // size class for an allocation, or -1 for large allocations
+    static int8_t size_class(uint32_t size);
+
+    void *allocate(uint32_t size, uint8_t owner);
+    void deallocate(void *ptr, uint32_t size);
+
+    Chunk *new_chunk(uint8_t size_class);
+    void free_chunk(Chunk *c);
+    Chunk *find_chunk(const void *ptr) const;
+    uint16_t chunk_index(const void *ptr) const;
+    void remove_from_free_list(Chunk *c);
+
+    void add_usage(uint8_t owner, int32_t delta);
+};
+
+#endif // ENABLE_HEAP
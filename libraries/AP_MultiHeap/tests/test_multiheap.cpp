@@ -1,5 +1,6 @@
 #include <AP_gtest.h>
 #include <AP_MultiHeap/AP_MultiHeap.h>
+#include <AP_MultiHeap/MultiHeapPool.h>
 #include <AP_HAL/AP_HAL.h>
 #include <AP_Math/AP_Math.h>
 
@@ -54,4 +55,65 @@ TEST(MultiHeap, Tests)
     delete[] allocs;
 }
 
+TEST(MultiHeap, Pool)
+{
+    static MultiHeap h;
+    EXPECT_TRUE(h.create(150000, 10, true, 10000));
+    MultiHeapPool pool{h};
+
+    const uint32_t max_allocs = 1000;
+    struct alloc {
+        uint8_t *ptr;
+        uint32_t size;
+        uint8_t owner;
+    };
+    auto *allocs = new alloc[max_allocs] {};
+    uint32_t usage[4] {};
+
+    for (uint32_t i=0; i<20000; i++) {
+        auto &a = allocs[get_random16() % max_allocs];
+        // mostly small allocations, some larger than the biggest class
+        const uint16_t size = (get_random16() % 8 == 0) ? get_random16() % 400 : get_random16() % 130;
+        if (a.ptr == nullptr) {
+            a.owner = get_random16() % ARRAY_SIZE(usage);
+        } else {
+            // contents must survive until resized
+            for (uint32_t j=0; j<a.size; j++) {
+                EXPECT_EQ(a.ptr[j], uint8_t(a.size + j));
+            }
+            usage[a.owner] -= a.size;
+        }
+        a.ptr = (uint8_t *)pool.change_size(a.ptr, a.size, size, a.owner);
+        EXPECT_TRUE(size==0?a.ptr == nullptr : a.ptr != nullptr);
+        a.size = size;
+        for (uint32_t j=0; j<a.size; j++) {
+            a.ptr[j] = a.size + j;
+        }
+        if (a.ptr != nullptr) {
+            EXPECT_EQ(pool.get_owner(a.ptr, a.size), a.owner);
+        }
+        usage[a.owner] += a.size;
+    }
+    for (uint8_t owner=0; owner<ARRAY_SIZE(usage); owner++) {
+        EXPECT_EQ(pool.get_owner_usage(owner), usage[owner]);
+    }
+
+    for (uint32_t i=0; i<max_allocs; i++) {
+        auto &a = allocs[i];
+        pool.change_size(a.ptr, a.size, 0, 0);
+    }
+    for (uint8_t owner=0; owner<ARRAY_SIZE(usage); owner++) {
+        EXPECT_EQ(pool.get_owner_usage(owner), 0U);
+    }
+    pool.trim();
+    MultiHeapPool::Stats stats;
+    pool.get_stats(stats);
+    EXPECT_EQ(stats.chunk_bytes, 0U);
+    EXPECT_EQ(stats.large_bytes, 0U);
+
+    // destroy checks that everything was returned to the heap
+    h.destroy();
+    delete[] allocs;
+}
+
 AP_GTEST_MAIN()
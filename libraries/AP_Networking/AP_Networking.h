@@ -11,6 +11,7 @@
 #include "AP_Networking_CAN.h"
 #include <AP_SerialManager/AP_SerialManager.h>
 #include <AP_HAL/utility/RingBuffer.h>
+#include <AP_HAL/utility/packetise.h>
 
 /*
   Note! all uint32_t IPv4 addresses are in host byte order
@@ -164,6 +165,7 @@ public:
         CAN2_MCAST_BRIDGED=(1U<<4),
 #endif
 #endif
+        MAVLINK_COALESCE=(1U<<5),
     };
     bool option_is_set(OPTION option) const {
         return (param.options.get() & int32_t(option)) != 0;
@@ -246,6 +248,7 @@ private:
 
         void udp_client_init(void);
         void udp_server_init(void);
+        void coalesce_init(void);
         void tcp_server_init(void);
         void tcp_client_init(void);
 
@@ -281,6 +284,11 @@ private:
         uint32_t last_size_tx;
         uint32_t last_size_rx;
         bool packetise;
+#if AP_MAVLINK_PACKETISE_ENABLED
+        // several MAVLink packets are sent in each UDP packet when set
+        uint8_t *coalesce_buf;
+        MAVLinkCoalesce coalescer;
+#endif
         bool connected;
         uint32_t last_udp_connect_address;
         uint16_t last_udp_connect_port;
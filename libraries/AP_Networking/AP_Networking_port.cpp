@@ -111,6 +111,20 @@ void AP_Networking::Port::thread_create(AP_HAL::MemberProc proc)
     }
 }
 
+/*
+  setup packing several MAVLink packets into each UDP packet if
+  enabled. The packet is too big to build on the stack of the port
+  thread so it gets its own buffer
+ */
+void AP_Networking::Port::coalesce_init(void)
+{
+#if AP_MAVLINK_PACKETISE_ENABLED
+    if (packetise && AP::network().option_is_set(OPTION::MAVLINK_COALESCE)) {
+        coalesce_buf = NEW_NOTHROW uint8_t[AP_MAVLINK_COALESCE_MAX_LEN];
+    }
+#endif
+}
+
 /*
   initialise a UDP client
  */
@@ -125,6 +139,7 @@ void AP_Networking::Port::udp_client_init(void)
     // setup for packet boundaries if this is mavlink
     packetise = (state.protocol == AP_SerialManager::SerialProtocol_MAVLink ||
                  state.protocol == AP_SerialManager::SerialProtocol_MAVLink2);
+    coalesce_init();
 
     thread_create(FUNCTOR_BIND_MEMBER(&AP_Networking::Port::udp_client_loop, void));
 }
@@ -143,6 +158,7 @@ void AP_Networking::Port::udp_server_init(void)
     // setup for packet boundaries if this is mavlink
     packetise = (state.protocol == AP_SerialManager::SerialProtocol_MAVLink ||
                  state.protocol == AP_SerialManager::SerialProtocol_MAVLink2);
+    coalesce_init();
 
     thread_create(FUNCTOR_BIND_MEMBER(&AP_Networking::Port::udp_server_loop, void));
 }
@@ -374,20 +390,28 @@ bool AP_Networking::Port::send_receive(void)
         // handle outgoing packets
         uint32_t available;
 
+        uint8_t small_buf[300];
+        uint8_t *buf = small_buf;
         {
             WITH_SEMAPHORE(sem);
             available = writebuffer->available();
-            available = MIN(300U, available);
 #if AP_MAVLINK_PACKETISE_ENABLED
-            if (packetise) {
-                available = mavlink_packetise(*writebuffer, available);
+            if (coalesce_buf != nullptr) {
+                buf = coalesce_buf;
+                available = coalescer.bytes_to_send(*writebuffer, MIN(available, uint32_t(UINT16_MAX)), AP_HAL::millis());
+            } else {
+                available = MIN(sizeof(small_buf), available);
+                if (packetise) {
+                    available = mavlink_packetise(*writebuffer, available);
+                }
             }
+#else
+            available = MIN(sizeof(small_buf), available);
 #endif
             if (available == 0) {
                 return active;
             }
         }
-        uint8_t buf[available];
         uint32_t n;
         {
             WITH_SEMAPHORE(sem);
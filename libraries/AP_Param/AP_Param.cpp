@@ -24,6 +24,7 @@
 #include "AP_Param.h"
 
 #include <cmath>
+#include <ctype.h>
 #include <string.h>
 
 #include <AP_Common/AP_Common.h>
@@ -120,6 +121,12 @@ bool AP_Param::registered_save_handler;
 
 bool AP_Param::done_all_default_params;
 
+struct AP_Param::name_index_entry *AP_Param::name_index;
+uint16_t AP_Param::name_index_len;
+
+uint32_t AP_Param::_conversion_id;
+bool AP_Param::_conversions_done;
+
 AP_Param::defaults_list *AP_Param::default_list;
 
 // we need a dummy object for the parameter save callback
@@ -958,6 +965,149 @@ AP_Param::find(const char *name, enum ap_var_type *ptype, uint16_t *flags)
     return nullptr;
 }
 
+// FNV-1a hash of an upper case parameter name
+uint64_t AP_Param::name_hash(const char *name)
+{
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (; *name; name++) {
+        hash ^= (uint8_t)toupper(*name);
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+// add an entry to the name index, or count it if the index is not
+// allocated yet
+void AP_Param::index_add(const char *name, AP_Param *ptr, uint8_t type)
+{
+    if (name_index == nullptr) {
+        name_index_len++;
+        return;
+    }
+    name_index[name_index_len].hash = name_hash(name);
+    name_index[name_index_len].ptr = ptr;
+    name_index[name_index_len].type = type;
+    name_index_len++;
+}
+
+// add the members of a group to the name index, following the same
+// rules as find_group(). name holds the len characters of the group
+// prefix and has room for a full name
+void AP_Param::index_group(char *name, uint8_t len, uint16_t vindex,
+                           ptrdiff_t group_offset, const struct GroupInfo *group_info)
+{
+    uint8_t type;
+    for (uint8_t i=0;
+         (type=group_info[i].type) != AP_PARAM_NONE;
+         i++) {
+        const uint8_t n = strnlen(group_info[i].name, AP_MAX_NAME_SIZE);
+        if (len + n > AP_MAX_NAME_SIZE) {
+            continue;
+        }
+        memcpy(&name[len], group_info[i].name, n);
+        name[len+n] = 0;
+        if (type == AP_PARAM_GROUP) {
+            const struct GroupInfo *ginfo = get_group_info(group_info[i]);
+            ptrdiff_t new_offset = group_offset;
+            if (ginfo == nullptr ||
+                !adjust_group_offset(vindex, group_info[i], new_offset)) {
+                continue;
+            }
+            index_group(name, len+n, vindex, new_offset, ginfo);
+            continue;
+        }
+        ptrdiff_t base;
+        if (!get_base(var_info(vindex), base)) {
+            continue;
+        }
+        AP_Param *ap = (AP_Param *)(base + group_info[i].offset + group_offset);
+        index_add(name, ap, type);
+        if (type == AP_PARAM_VECTOR3F && len + n + 2 <= AP_MAX_NAME_SIZE) {
+            for (uint8_t e=0; e<3; e++) {
+                name[len+n] = '_';
+                name[len+n+1] = 'X' + e;
+                name[len+n+2] = 0;
+                index_add(name, (AP_Param *)&((AP_Float *)ap)[e], AP_PARAM_FLOAT);
+            }
+        }
+    }
+}
+
+void AP_Param::build_name_index(void)
+{
+    free_name_index();
+
+    // the tree is walked twice, first to count the names
+    char name[AP_MAX_NAME_SIZE+3];
+    for (uint8_t pass=0; pass<2; pass++) {
+        if (pass == 1) {
+            name_index = NEW_NOTHROW name_index_entry[name_index_len];
+            if (name_index == nullptr) {
+                // find() still works without the index
+                name_index_len = 0;
+                return;
+            }
+            name_index_len = 0;
+        }
+        for (uint16_t i=0; i<_num_vars; i++) {
+            const auto &info = var_info(i);
+            const uint8_t len = strnlen(info.name, AP_MAX_NAME_SIZE);
+            memcpy(name, info.name, len);
+            name[len] = 0;
+            if (info.type == AP_PARAM_GROUP) {
+                const struct GroupInfo *group_info = get_group_info(info);
+                if (group_info != nullptr) {
+                    index_group(name, len, i, 0, group_info);
+                }
+                continue;
+            }
+            ptrdiff_t base;
+            if (get_base(info, base)) {
+                index_add(name, (AP_Param *)base, info.type);
+            }
+        }
+    }
+
+    qsort(name_index, name_index_len, sizeof(name_index[0]),
+          [](const void *a, const void *b) {
+              const uint64_t ha = ((const name_index_entry *)a)->hash;
+              const uint64_t hb = ((const name_index_entry *)b)->hash;
+              return ha < hb ? -1 : (ha > hb ? 1 : 0);
+          });
+}
+
+void AP_Param::free_name_index(void)
+{
+    delete[] name_index;
+    name_index = nullptr;
+    name_index_len = 0;
+}
+
+AP_Param *AP_Param::find_indexed(const char *name, enum ap_var_type *ptype)
+{
+    if (name_index == nullptr) {
+        return find(name, ptype);
+    }
+    const uint64_t hash = name_hash(name);
+    uint16_t lo = 0, hi = name_index_len;
+    while (lo < hi) {
+        const uint16_t mid = (lo + hi) / 2;
+        if (name_index[mid].hash < hash) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    if (lo < name_index_len && name_index[lo].hash == hash &&
+        (lo+1 == name_index_len || name_index[lo+1].hash != hash)) {
+        *ptype = (enum ap_var_type)name_index[lo].type;
+        return name_index[lo].ptr;
+    }
+    // not in the index, or a name used more than once in the tree,
+    // where find() decides which one is meant
+    return find(name, ptype);
+}
+
 // Find a variable by index. Note that this is quite slow.
 //
 AP_Param *
@@ -1572,6 +1722,92 @@ bool AP_Param::load_all()
     return false;
 }
 
+/*
+  the conversion watermark is a storage record with a key no parameter
+  uses, holding the id passed to load_conversion_watermark() on the
+  boot that last ran the conversions
+ */
+void AP_Param::load_conversion_watermark(uint32_t id)
+{
+    _conversion_id = id;
+    _conversions_done = false;
+
+    struct Param_header phdr;
+    phdr.type = AP_PARAM_INT32;
+    set_key(phdr, _watermark_key);
+    phdr.group_element = 0;
+
+    uint16_t ofs;
+    if (scan(&phdr, &ofs)) {
+        uint32_t stored_id;
+        _storage.read_block(&stored_id, ofs+sizeof(phdr), sizeof(stored_id));
+        _conversions_done = stored_id == id;
+    }
+}
+
+void AP_Param::set_conversion_watermark(void)
+{
+    if (_conversions_done) {
+        return;
+    }
+
+    struct Param_header phdr;
+    phdr.type = AP_PARAM_INT32;
+    set_key(phdr, _watermark_key);
+    phdr.group_element = 0;
+
+    uint16_t ofs;
+    if (scan(&phdr, &ofs)) {
+        eeprom_write_check(&_conversion_id, ofs+sizeof(phdr), sizeof(_conversion_id));
+        _conversions_done = true;
+        return;
+    }
+    if (ofs == (uint16_t) ~0 ||
+        ofs+sizeof(_conversion_id)+2*sizeof(phdr) >= _storage.size()) {
+        // no room, conversions will run again next boot
+        return;
+    }
+
+    // write a new sentinal, then the data, then the header
+    write_sentinal(ofs + sizeof(phdr) + sizeof(_conversion_id));
+    eeprom_write_check(&_conversion_id, ofs+sizeof(phdr), sizeof(_conversion_id));
+    eeprom_write_check(&phdr, ofs, sizeof(phdr));
+    _conversions_done = true;
+}
+
+uint32_t AP_Param::var_info_crc_group(uint32_t crc, const struct GroupInfo *group_info, uint8_t depth)
+{
+    for (uint8_t i=0; group_info[i].type != AP_PARAM_NONE; i++) {
+        const auto &ginfo = group_info[i];
+        crc = crc_crc32(crc, (const uint8_t *)ginfo.name, strnlen(ginfo.name, AP_MAX_NAME_SIZE));
+        crc = crc_crc32(crc, &ginfo.idx, sizeof(ginfo.idx));
+        crc = crc_crc32(crc, &ginfo.type, sizeof(ginfo.type));
+        // groups from pointers may not be allocated yet, so only
+        // the layout fixed at build time is included
+        if (ginfo.type == AP_PARAM_GROUP && depth < 3 &&
+            (ginfo.flags & AP_PARAM_FLAG_INFO_POINTER) == 0) {
+            crc = var_info_crc_group(crc, ginfo.group_info, depth+1);
+        }
+    }
+    return crc;
+}
+
+uint32_t AP_Param::var_info_crc(void)
+{
+    uint32_t crc = 0;
+    for (uint16_t i=0; i<_num_vars; i++) {
+        const auto &info = var_info(i);
+        crc = crc_crc32(crc, (const uint8_t *)info.name, strnlen(info.name, AP_MAX_NAME_SIZE));
+        crc = crc_crc32(crc, (const uint8_t *)&info.key, sizeof(info.key));
+        crc = crc_crc32(crc, &info.type, sizeof(info.type));
+        if (info.type == AP_PARAM_GROUP &&
+            (info.flags & AP_PARAM_FLAG_INFO_POINTER) == 0) {
+            crc = var_info_crc_group(crc, info.group_info, 0);
+        }
+    }
+    return crc;
+}
+
 /*
  * reload from hal.util defaults file or embedded param region
  * @last_pass: if this is the last pass on defaults - unknown parameters are
@@ -2307,7 +2543,7 @@ bool AP_Param::count_defaults_in_file(const char *filename, uint16_t &num_defaul
             continue;
         }
         enum ap_var_type var_type;
-        if (!find(pname, &var_type)) {
+        if (!find_indexed(pname, &var_type)) {
             continue;
         }
         num_defaults++;
@@ -2336,7 +2572,7 @@ bool AP_Param::read_param_defaults_file(const char *filename, bool last_pass, ui
             continue;
         }
         enum ap_var_type var_type;
-        AP_Param *vp = find(pname, &var_type);
+        AP_Param *vp = find_indexed(pname, &var_type);
         if (!vp) {
             if (last_pass) {
 #if ENABLE_DEBUG
@@ -2381,6 +2617,16 @@ bool AP_Param::load_defaults_file(const char *filename, bool last_pass)
         return false;
     }
 
+    build_name_index();
+    const bool ret = _load_defaults_file(filename, last_pass);
+    free_name_index();
+
+    return ret;
+}
+
+bool AP_Param::_load_defaults_file(const char *filename, bool last_pass)
+{
+
     char *mutable_filename = strdup(filename);
     if (mutable_filename == nullptr) {
         AP_HAL::panic("AP_Param: Failed to allocate mutable string");
@@ -2473,7 +2719,7 @@ bool AP_Param::count_param_defaults(const volatile char *ptr, int32_t length, ui
         }
 
         enum ap_var_type var_type;
-        if (!find(pname, &var_type)) {
+        if (!find_indexed(pname, &var_type)) {
             continue;
         }
 
@@ -2486,6 +2732,13 @@ bool AP_Param::count_param_defaults(const volatile char *ptr, int32_t length, ui
  *  load parameter defaults from supplied string
  */
 void AP_Param::load_param_defaults(const volatile char *ptr, int32_t length, bool last_pass)
+{
+    build_name_index();
+    _load_param_defaults(ptr, length, last_pass);
+    free_name_index();
+}
+
+void AP_Param::_load_param_defaults(const volatile char *ptr, int32_t length, bool last_pass)
 {
     delete[] param_overrides;
     param_overrides = nullptr;
@@ -2536,7 +2789,7 @@ void AP_Param::load_param_defaults(const volatile char *ptr, int32_t length, boo
             continue;
         }
         enum ap_var_type var_type;
-        AP_Param *vp = find(pname, &var_type);
+        AP_Param *vp = find_indexed(pname, &var_type);
         if (!vp) {
             if (last_pass) {
 #if ENABLE_DEBUG && (AP_PARAM_MAX_EMBEDDED_PARAM > 0)
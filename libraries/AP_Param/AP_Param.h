@@ -430,6 +430,25 @@ public:
     ///
     static bool load_all();
 
+    /*
+      parameter conversions only need to run on the first boot of a
+      new firmware. The vehicle passes an id for its firmware and
+      parameter layout to load_conversion_watermark() after
+      load_all(). conversions_done() is then true if the same id was
+      stored by set_conversion_watermark() on an earlier boot, and the
+      vehicle can skip its conversions. Only conversions of stored
+      values can be skipped; defaults are not stored, so must still
+      be set on every boot
+     */
+    static void load_conversion_watermark(uint32_t id);
+    static bool conversions_done(void) { return _conversions_done; }
+    static void set_conversion_watermark(void);
+
+    // checksum of the names, keys and types in the parameter tree,
+    // for building a conversion watermark id. Groups allocated
+    // through pointers are not included
+    static uint32_t var_info_crc(void);
+
     // return true if eeprom is full, used for arming check
     static bool get_eeprom_full(void) {
         return eeprom_full;
@@ -665,6 +684,12 @@ private:
     static const uint8_t        _sentinal_type  = 0x1F;
     static const uint8_t        _sentinal_group = 0xFF;
 
+    // storage record holding the conversion watermark. No parameter
+    // has this key, so load_all() skips the record
+    static const uint16_t       _watermark_key  = 0x1FE;
+    static uint32_t             _conversion_id;
+    static bool                 _conversions_done;
+
     static uint16_t             _frame_type_flags;
 
     /*
@@ -769,6 +794,29 @@ private:
 
     static bool parse_param_line(char *line, char **vname, float &value, bool &read_only);
 
+    /*
+      index of full parameter names, used while loading defaults so
+      that each line doesn't need a find(), which walks the var_info
+      tree. It is built with one walk of the tree, sorted by name
+      hash, and freed once the defaults are loaded
+     */
+    struct name_index_entry {
+        uint64_t hash;
+        AP_Param *ptr;
+        uint8_t type;
+    };
+    static struct name_index_entry *name_index;
+    static uint16_t name_index_len;
+    static uint64_t name_hash(const char *name);
+    static void build_name_index(void);
+    static void free_name_index(void);
+    static void index_group(char *name, uint8_t len, uint16_t vindex,
+                            ptrdiff_t group_offset, const struct GroupInfo *group_info);
+    static void index_add(const char *name, AP_Param *ptr, uint8_t type);
+    // find() using the index when there is one
+    static AP_Param *find_indexed(const char *name, enum ap_var_type *ptype);
+    static uint32_t var_info_crc_group(uint32_t crc, const struct GroupInfo *group_info, uint8_t depth);
+
     /*
       load a parameter defaults file. This happens as part of load_all()
      */
@@ -783,6 +831,8 @@ private:
 
     // load defaults from supplied string:
     static void load_param_defaults(const volatile char *ptr, int32_t length, bool last_pass);
+    static void _load_param_defaults(const volatile char *ptr, int32_t length, bool last_pass);
+    static bool _load_defaults_file(const char *filename, bool last_pass);
 
     /*
       load defaults from embedded parameters
@@ -237,6 +237,51 @@ void AP_RCProtocol::process_pulse_list(const uint32_t *widths, uint16_t n, bool
 }
 
 bool AP_RCProtocol::process_byte(uint8_t byte, uint32_t baudrate)
+{
+    return process_byte(byte, baudrate, UINT32_MAX);
+}
+
+/*
+  process a burst of bytes from a uart. While searching, each backend
+  is asked once per burst whether the burst could hold one of its
+  frames, and only backends that have matched in this burst or in the
+  last AP_RCPROTOCOL_CANDIDATE_BYTES bytes after a match are fed the
+  bytes. This replaces a call to every enabled backend for every byte
+ */
+void AP_RCProtocol::process_bytes(const uint8_t *bytes, uint16_t len, uint32_t baudrate)
+{
+    if (len == 0) {
+        return;
+    }
+    uint32_t scan_mask = 0;
+    if (_detected_protocol == AP_RCProtocol::NONE || should_search(AP_HAL::millis())) {
+#if AP_RC_CHANNEL_ENABLED
+        rc_protocols_mask = rc().enabled_protocols();
+#endif
+        for (uint8_t i = 0; i < ARRAY_SIZE(backend); i++) {
+            if (backend[i] == nullptr || !protocol_enabled(rcprotocol_t(i))) {
+                continue;
+            }
+            uint8_t &remaining = _candidate_bytes[i];
+            if (backend[i]->may_contain_frame(bytes, len, baudrate)) {
+                // the frame may start at the end of this burst, so
+                // the count starts with the next one
+                scan_mask |= (1U<<i);
+                remaining = AP_RCPROTOCOL_CANDIDATE_BYTES;
+            } else if (remaining > 0) {
+                // keep feeding the backend until any frame started in
+                // an earlier burst must have finished
+                scan_mask |= (1U<<i);
+                remaining = len >= remaining ? 0 : remaining - len;
+            }
+        }
+    }
+    for (uint16_t i = 0; i < len; i++) {
+        process_byte(bytes[i], baudrate, scan_mask);
+    }
+}
+
+bool AP_RCProtocol::process_byte(uint8_t byte, uint32_t baudrate, uint32_t scan_mask)
 {
     uint32_t now = AP_HAL::millis();
     bool searching = should_search(now);
@@ -268,7 +313,7 @@ bool AP_RCProtocol::process_byte(uint8_t byte, uint32_t baudrate)
     // otherwise scan all protocols
     for (uint8_t i = 0; i < ARRAY_SIZE(backend); i++) {
         if (backend[i] != nullptr) {
-            if (!protocol_enabled(rcprotocol_t(i))) {
+            if ((scan_mask & (1U<<i)) == 0 || !protocol_enabled(rcprotocol_t(i))) {
                 continue;
             }
             const uint32_t frame_count = backend[i]->get_rc_frame_count();
@@ -374,11 +419,14 @@ void AP_RCProtocol::check_added_uart(void)
 
     uint32_t n = added.uart->available();
     n = MIN(n, 255U);
-    for (uint8_t i=0; i<n; i++) {
-        int16_t b = added.uart->read();
-        if (b >= 0) {
-            process_byte(uint8_t(b), current_baud);
+    while (n > 0) {
+        uint8_t b[64];
+        const ssize_t nread = added.uart->read(b, MIN(n, sizeof(b)));
+        if (nread <= 0) {
+            break;
         }
+        process_bytes(b, nread, current_baud);
+        n -= nread;
     }
     if (searching) {
         if (now - added.last_config_change_ms > 1000) {
@@ -107,6 +107,7 @@ public:
     AP_RCProtocol() {}
     ~AP_RCProtocol();
     friend class AP_RCProtocol_Backend;
+    friend class AP_RCProtocol_Test;
 
     void init();
     bool valid_serial_prot() const
@@ -117,6 +118,7 @@ public:
     void process_pulse(uint32_t width_s0, uint32_t width_s1);
     void process_pulse_list(const uint32_t *widths, uint16_t n, bool need_swap);
     bool process_byte(uint8_t byte, uint32_t baudrate);
+    void process_bytes(const uint8_t *bytes, uint16_t len, uint32_t baudrate);
     void process_handshake(uint32_t baudrate);
     void update(void);
 
@@ -263,6 +265,10 @@ public:
 private:
     void check_added_uart(void);
 
+    // process a byte, only offering it to the backends in scan_mask
+    // while searching
+    bool process_byte(uint8_t byte, uint32_t baudrate, uint32_t scan_mask);
+
     // return true if a specific protocol is enabled
     bool protocol_enabled(enum rcprotocol_t protocol) const;
 
@@ -291,6 +297,11 @@ private:
     // allowed RC protocols mask (first bit means "all")
     uint32_t rc_protocols_mask;
 
+    // number of bytes each backend will be fed by process_bytes()
+    // while searching, refreshed whenever its frame signature is seen
+    uint8_t _candidate_bytes[NONE];
+    static_assert(NONE <= 32, "too many protocols for scan mask");
+
 #endif  // AP_RCPROTCOL_ENABLED
 
 };
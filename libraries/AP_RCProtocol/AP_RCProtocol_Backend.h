@@ -33,6 +33,13 @@ public:
     virtual void process_pulse(uint32_t width_s0, uint32_t width_s1) {}
     virtual void process_byte(uint8_t byte, uint32_t baudrate) {}
     virtual void process_handshake(uint32_t baudrate) {}
+
+    // return true if a burst of bytes received at baudrate could hold
+    // a frame of this protocol. While searching for a protocol only
+    // backends that have matched are fed bytes, so this should be a
+    // cheap check of the baudrate and header bytes. Backends that
+    // decode bytes must override this
+    virtual bool may_contain_frame(const uint8_t *bytes, uint16_t len, uint32_t baudrate) const { return false; }
     uint16_t read(uint8_t chan);
     void read(uint16_t *pwm, uint8_t n);
     bool new_input();
@@ -222,6 +222,14 @@ void AP_RCProtocol_CRSF::process_byte(uint8_t byte, uint32_t baudrate)
     _process_byte(byte);
 }
 
+bool AP_RCProtocol_CRSF::may_contain_frame(const uint8_t *bytes, uint16_t len, uint32_t baudrate) const
+{
+    if ((baudrate != CRSF_BAUDRATE && baudrate != CRSF_BAUDRATE_1MBIT && baudrate != CRSF_BAUDRATE_2MBIT) || _uart) {
+        return false;
+    }
+    return memchr(bytes, DeviceAddress::CRSF_ADDRESS_FLIGHT_CONTROLLER, len) != nullptr;
+}
+
 // process a byte provided by a uart
 void AP_RCProtocol_CRSF::_process_byte(uint8_t byte)
 {
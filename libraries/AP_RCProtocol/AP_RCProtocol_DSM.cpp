@@ -539,4 +539,10 @@ void AP_RCProtocol_DSM::process_byte(uint8_t b, uint32_t baudrate)
     _process_byte(AP_HAL::millis(), b);
 }
 
+bool AP_RCProtocol_DSM::may_contain_frame(const uint8_t *bytes, uint16_t len, uint32_t baudrate) const
+{
+    // DSM frames have no header byte
+    return baudrate == 115200;
+}
+
 #endif  // AP_RCPROTOCOL_DSM_ENABLED
@@ -32,6 +32,7 @@ public:
     AP_RCProtocol_DSM(AP_RCProtocol &_frontend) : AP_RCProtocol_Backend(_frontend) {}
     void process_pulse(uint32_t width_s0, uint32_t width_s1) override;
     void process_byte(uint8_t byte, uint32_t baudrate) override;
+    bool may_contain_frame(const uint8_t *bytes, uint16_t len, uint32_t baudrate) const override;
     void start_bind(void) override;
     void update(void) override;
 
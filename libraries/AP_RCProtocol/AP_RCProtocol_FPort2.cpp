@@ -298,4 +298,10 @@ void AP_RCProtocol_FPort2::process_byte(uint8_t b, uint32_t baudrate)
     _process_byte(AP_HAL::micros(), b);
 }
 
+bool AP_RCProtocol_FPort2::may_contain_frame(const uint8_t *bytes, uint16_t len, uint32_t baudrate) const
+{
+    // the first byte is one of several frame lengths
+    return baudrate == 115200;
+}
+
 #endif  // AP_RCPROTOCOL_FPORT2_ENABLED
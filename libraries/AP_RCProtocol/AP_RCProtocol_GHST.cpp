@@ -434,6 +434,14 @@ void AP_RCProtocol_GHST::process_byte(uint8_t byte, uint32_t baudrate)
     _process_byte(AP_HAL::micros(), byte);
 }
 
+bool AP_RCProtocol_GHST::may_contain_frame(const uint8_t *bytes, uint16_t len, uint32_t baudrate) const
+{
+    if (baudrate != CRSF_BAUDRATE && baudrate != GHST_BAUDRATE) {
+        return false;
+    }
+    return memchr(bytes, DeviceAddress::GHST_ADDRESS_FLIGHT_CONTROLLER, len) != nullptr;
+}
+
 // change the bootstrap baud rate to Ghost standard if configured
 void AP_RCProtocol_GHST::process_handshake(uint32_t baudrate)
 {
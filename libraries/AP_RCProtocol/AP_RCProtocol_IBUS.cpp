@@ -105,4 +105,9 @@ void AP_RCProtocol_IBUS::process_byte(uint8_t b, uint32_t baudrate)
     _process_byte(AP_HAL::micros(), b);
 }
 
+bool AP_RCProtocol_IBUS::may_contain_frame(const uint8_t *bytes, uint16_t len, uint32_t baudrate) const
+{
+    return baudrate == 115200 && memchr(bytes, 0x20, len) != nullptr;
+}
+
 #endif  // AP_RCPROTOCOL_IBUS_ENABLED
@@ -213,4 +213,9 @@ void AP_RCProtocol_SBUS::process_byte(uint8_t b, uint32_t baudrate)
     _process_byte(AP_HAL::micros(), b);
 }
 
+bool AP_RCProtocol_SBUS::may_contain_frame(const uint8_t *bytes, uint16_t len, uint32_t baudrate) const
+{
+    return baudrate == ss.baud() && memchr(bytes, 0x0F, len) != nullptr;
+}
+
 #endif  // AP_RCPROTOCOL_SBUS_ENABLED
@@ -286,4 +286,14 @@ void AP_RCProtocol_SRXL::process_byte(uint8_t byte, uint32_t baudrate)
     _process_byte(AP_HAL::micros(), byte);
 }
 
+bool AP_RCProtocol_SRXL::may_contain_frame(const uint8_t *bytes, uint16_t len, uint32_t baudrate) const
+{
+    if (baudrate != 115200) {
+        return false;
+    }
+    return memchr(bytes, SRXL_HEADER_V1, len) != nullptr ||
+           memchr(bytes, SRXL_HEADER_V2, len) != nullptr ||
+           memchr(bytes, SRXL_HEADER_V5, len) != nullptr;
+}
+
 #endif  // AP_RCPROTOCOL_SRXL_ENABLED
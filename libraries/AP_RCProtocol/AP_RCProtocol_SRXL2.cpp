@@ -249,6 +249,11 @@ void AP_RCProtocol_SRXL2::process_byte(uint8_t byte, uint32_t baudrate)
     _process_byte(AP_HAL::micros(), byte);
 }
 
+bool AP_RCProtocol_SRXL2::may_contain_frame(const uint8_t *bytes, uint16_t len, uint32_t baudrate) const
+{
+    return baudrate == 115200 && memchr(bytes, SPEKTRUM_SRXL_ID, len) != nullptr;
+}
+
 // handshake
 void AP_RCProtocol_SRXL2::process_handshake(uint32_t baudrate)
 {
@@ -31,6 +31,7 @@ public:
     AP_RCProtocol_SRXL2(AP_RCProtocol &_frontend);
     virtual ~AP_RCProtocol_SRXL2();
     void process_byte(uint8_t byte, uint32_t baudrate) override;
+    bool may_contain_frame(const uint8_t *bytes, uint16_t len, uint32_t baudrate) const override;
     void process_handshake(uint32_t baudrate) override;
     void start_bind(void) override;
     void update(void) override;
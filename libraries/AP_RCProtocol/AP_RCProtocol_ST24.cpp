@@ -240,4 +240,9 @@ void AP_RCProtocol_ST24::process_byte(uint8_t byte, uint32_t baudrate)
     _process_byte(byte);
 }
 
+bool AP_RCProtocol_ST24::may_contain_frame(const uint8_t *bytes, uint16_t len, uint32_t baudrate) const
+{
+    return baudrate == 115200 && memchr(bytes, ST24_STX1, len) != nullptr;
+}
+
 #endif  // AP_RCPROTOCOL_ST24_ENABLED
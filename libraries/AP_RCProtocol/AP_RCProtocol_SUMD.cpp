@@ -207,4 +207,9 @@ void AP_RCProtocol_SUMD::process_byte(uint8_t byte, uint32_t baudrate)
     _process_byte(AP_HAL::micros(), byte);
 }
 
+bool AP_RCProtocol_SUMD::may_contain_frame(const uint8_t *bytes, uint16_t len, uint32_t baudrate) const
+{
+    return baudrate == 115200 && memchr(bytes, SUMD_HEADER_ID, len) != nullptr;
+}
+
 #endif  // AP_RCPROTOCOL_SUMD_ENABLED
@@ -95,3 +95,10 @@
 #ifndef AP_RCPROTOCOL_FDM_ENABLED
 #define AP_RCPROTOCOL_FDM_ENABLED AP_RCPROTOCOL_BACKEND_DEFAULT_ENABLED && (CONFIG_HAL_BOARD == HAL_BOARD_SITL)
 #endif
+
+// while searching, bytes a backend keeps being fed after the burst its
+// frame signature was last seen in. Must cover the longest frame of any
+// protocol
+#ifndef AP_RCPROTOCOL_CANDIDATE_BYTES
+#define AP_RCPROTOCOL_CANDIDATE_BYTES 128
+#endif
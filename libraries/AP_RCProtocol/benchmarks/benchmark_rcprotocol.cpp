@@ -0,0 +1,102 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_RCProtocol/AP_RCProtocol.h>
+#include <AP_RCProtocol/AP_RCProtocol_CRSF.h>
+#include <AP_RCProtocol/AP_RCProtocol_FPort.h>
+#include <AP_RCProtocol/AP_RCProtocol_GHST.h>
+#include <AP_RCProtocol/AP_RCProtocol_IBUS.h>
+#include <AP_RCProtocol/AP_RCProtocol_SBUS.h>
+#include <AP_RCProtocol/AP_RCProtocol_SRXL.h>
+#include <AP_RCProtocol/AP_RCProtocol_ST24.h>
+#include <AP_RCProtocol/AP_RCProtocol_SUMD.h>
+#include <AP_SBusOut/AP_SBusOut.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+/*
+  cost of searching for a protocol on a uart, comparing feeding every
+  byte to every backend with feeding bursts only to the backends whose
+  frame signature has been seen, as AP_RCProtocol::process_bytes()
+  does.
+
+  The stream is SBUS frames received while the search is trying
+  115200 baud, which is what an SBUS receiver looks like for most of
+  the search. None of the backends can decode it, so the backends are
+  used directly rather than through the AP_RCProtocol frontend.
+ */
+
+static AP_RCProtocol frontend;
+static AP_RCProtocol_Backend *backends[] {
+    NEW_NOTHROW AP_RCProtocol_IBUS(frontend),
+    NEW_NOTHROW AP_RCProtocol_SBUS(frontend, true, 100000),
+    NEW_NOTHROW AP_RCProtocol_SUMD(frontend),
+    NEW_NOTHROW AP_RCProtocol_SRXL(frontend),
+    NEW_NOTHROW AP_RCProtocol_CRSF(frontend),
+    NEW_NOTHROW AP_RCProtocol_ST24(frontend),
+    NEW_NOTHROW AP_RCProtocol_FPort(frontend, true),
+    NEW_NOTHROW AP_RCProtocol_SBUS(frontend, false, 100000),
+    NEW_NOTHROW AP_RCProtocol_GHST(frontend),
+};
+
+static const uint32_t baudrate = 115200;
+
+static uint32_t make_stream(uint8_t *buf, uint32_t size)
+{
+    uint16_t channels[16];
+    uint32_t len = 0;
+    uint16_t v = 1000;
+    while (len + 25 <= size) {
+        for (uint8_t i = 0; i < ARRAY_SIZE(channels); i++) {
+            channels[i] = 1000 + (v + i * 37) % 1000;
+        }
+        v += 13;
+        AP_SBusOut::sbus_format_frame(channels, ARRAY_SIZE(channels), &buf[len]);
+        len += 25;
+    }
+    return len;
+}
+
+static uint8_t stream[25*400];
+static const uint32_t stream_len = make_stream(stream, sizeof(stream));
+
+static void BM_RCSearchPerByte(benchmark::State& state)
+{
+    while (state.KeepRunning()) {
+        for (uint32_t i = 0; i < stream_len; i++) {
+            for (auto *b : backends) {
+                b->process_byte(stream[i], baudrate);
+            }
+        }
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * stream_len);
+}
+
+static void BM_RCSearchBursts(benchmark::State& state)
+{
+    const uint16_t burst = state.range(0);
+    uint8_t candidate_bytes[ARRAY_SIZE(backends)] {};
+    while (state.KeepRunning()) {
+        for (uint32_t ofs = 0; ofs < stream_len; ofs += burst) {
+            const uint8_t *bytes = &stream[ofs];
+            const uint16_t len = MIN(uint32_t(burst), stream_len - ofs);
+            for (uint8_t i = 0; i < ARRAY_SIZE(backends); i++) {
+                if (backends[i]->may_contain_frame(bytes, len, baudrate)) {
+                    candidate_bytes[i] = AP_RCPROTOCOL_CANDIDATE_BYTES;
+                }
+                if (candidate_bytes[i] == 0) {
+                    continue;
+                }
+                candidate_bytes[i] = len >= candidate_bytes[i] ? 0 : candidate_bytes[i] - len;
+                for (uint16_t j = 0; j < len; j++) {
+                    backends[i]->process_byte(bytes[j], baudrate);
+                }
+            }
+        }
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * stream_len);
+}
+
+BENCHMARK(BM_RCSearchPerByte);
+BENCHMARK(BM_RCSearchBursts)->Arg(16)->Arg(64);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,85 @@
+/*
+  test that process_bytes() feeds a backend a frame split across bursts
+ */
+#include <AP_gtest.h>
+#include <AP_RCProtocol/AP_RCProtocol.h>
+#include <AP_RCProtocol/AP_RCProtocol_Backend.h>
+#include <string.h>
+
+const AP_HAL::HAL &hal = AP_HAL::get_HAL();
+
+#if AP_RCPROTOCOL_ENABLED
+
+#define FRAME_HEADER 0xA5
+#define FRAME_LEN 16
+
+/*
+  a backend that counts the bytes it is fed and the frames, a header
+  followed by FRAME_LEN-1 bytes, it sees in them
+ */
+class FakeBackend : public AP_RCProtocol_Backend {
+public:
+    using AP_RCProtocol_Backend::AP_RCProtocol_Backend;
+
+    bool may_contain_frame(const uint8_t *bytes, uint16_t len, uint32_t baudrate) const override {
+        return memchr(bytes, FRAME_HEADER, len) != nullptr;
+    }
+    void process_byte(uint8_t byte, uint32_t baudrate) override {
+        bytes_fed++;
+        if (ofs == 0 && byte != FRAME_HEADER) {
+            return;
+        }
+        if (++ofs == FRAME_LEN) {
+            frames++;
+            ofs = 0;
+        }
+    }
+
+    uint32_t bytes_fed {};
+    uint32_t frames {};
+
+private:
+    uint8_t ofs {};
+};
+
+class AP_RCProtocol_Test {
+public:
+    static void set_backend(AP_RCProtocol &rcprot, AP_RCProtocol_Backend *b) {
+        rcprot.backend[0] = b;
+        rcprot.rc_protocols_mask = 1U;
+    }
+};
+
+TEST(RCProtocol, frame_split_across_long_bursts)
+{
+    // zero initialised, as the constructor leaves the backends alone
+    static AP_RCProtocol rcprot;
+    FakeBackend *b = NEW_NOTHROW FakeBackend(rcprot);
+    ASSERT_NE(nullptr, b);
+    AP_RCProtocol_Test::set_backend(rcprot, b);
+
+    // a burst longer than AP_RCPROTOCOL_CANDIDATE_BYTES with the
+    // start of a frame at its end
+    uint8_t burst[AP_RCPROTOCOL_CANDIDATE_BYTES + 72] {};
+    const uint16_t start = sizeof(burst) - 5;
+    burst[start] = FRAME_HEADER;
+    rcprot.process_bytes(burst, sizeof(burst), 115200);
+    EXPECT_EQ(sizeof(burst), b->bytes_fed);
+    EXPECT_EQ(0U, b->frames);
+
+    // the rest of the frame comes in a burst without a header
+    uint8_t rest[100] {};
+    rcprot.process_bytes(rest, sizeof(rest), 115200);
+    EXPECT_EQ(1U, b->frames);
+
+    // the backend is fed for AP_RCPROTOCOL_CANDIDATE_BYTES after the
+    // burst with the header, and then no more
+    rcprot.process_bytes(rest, sizeof(rest), 115200);
+    EXPECT_EQ(sizeof(burst) + 2 * sizeof(rest), b->bytes_fed);
+    rcprot.process_bytes(rest, sizeof(rest), 115200);
+    EXPECT_EQ(sizeof(burst) + 2 * sizeof(rest), b->bytes_fed);
+}
+
+#endif  // AP_RCPROTOCOL_ENABLED
+
+AP_GTEST_MAIN()
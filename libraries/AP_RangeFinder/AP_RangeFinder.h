@@ -25,6 +25,9 @@
 #include <GCS_MAVLink/GCS_MAVLink.h>
 #include <AP_MSP/msp.h>
 #include "AP_RangeFinder_Params.h"
+#if AP_SCRIPTING_ENABLED
+#include <AP_Scripting/AP_Scripting_ArrayView.h>
+#endif
 
 // Maximum number of range finder instances available on this platform
 #ifndef RANGEFINDER_MAX_INSTANCES 
@@ -286,6 +289,14 @@ public:
     int32_t ground_clearance_cm_orient(enum Rotation orientation) const {
         return ground_clearance_orient(orientation) * 100;
     }
+
+    // views of the latest reading of every sensor, by instance
+    AP_Scripting_ArrayView get_distance_view(void) const {
+        return AP_Scripting_ArrayView(&state[0].distance_m, num_instances, sizeof(state[0]));
+    }
+    AP_Scripting_ArrayView get_signal_quality_view(void) const {
+        return AP_Scripting_ArrayView(&state[0].signal_quality_pct, num_instances, sizeof(state[0]));
+    }
 #endif
     // metre accessors - use these in preference to the cm accessors
     float distance_orient(enum Rotation orientation) const;
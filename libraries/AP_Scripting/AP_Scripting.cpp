@@ -95,6 +95,7 @@ const AP_Param::GroupInfo AP_Scripting::var_info[] = {
     // @Bitmask: 4: Disable pre-arm check
     // @Bitmask: 5: Save CRC of current scripts to loaded and running checksum parameters enabling pre-arm
     // @Bitmask: 6: Disable heap expansion on allocation failure
+    // @Bitmask: 7: Cache compiled scripts to speed up loading
     // @User: Advanced
     AP_GROUPINFO("DEBUG_OPTS", 4, AP_Scripting, _debug_options, 0),
 
@@ -162,6 +163,14 @@ const AP_Param::GroupInfo AP_Scripting::var_info[] = {
     // @User: Advanced
     AP_GROUPINFO("THD_PRIORITY", 14, AP_Scripting, _thd_priority, uint8_t(ThreadPriority::NORMAL)),
 
+    // @Param: MEM_LIMIT
+    // @DisplayName: Scripting per-script memory limit
+    // @Description: Maximum amount of memory each script may allocate. A script that exceeds the limit is stopped with an error, protecting the other scripts from running out of memory. 0 disables the limit
+    // @Range: 0 1048576
+    // @Increment: 1024
+    // @User: Advanced
+    AP_GROUPINFO("MEM_LIMIT", 19, AP_Scripting, _script_mem_limit, 0),
+
 #if AP_SCRIPTING_SERIALDEVICE_ENABLED
     // @Param: SDEV_EN
     // @DisplayName: Scripting serial device enable
@@ -307,7 +316,7 @@ void AP_Scripting::thread(void) {
         _restart = false;
         _init_failed = false;
 
-        lua_scripts *lua = NEW_NOTHROW lua_scripts(_script_vm_exec_count, _script_heap_size, _debug_options);
+        lua_scripts *lua = NEW_NOTHROW lua_scripts(_script_vm_exec_count, _script_heap_size, _script_mem_limit, _debug_options);
         if (lua == nullptr || !lua->heap_allocated()) {
             GCS_SEND_TEXT(MAV_SEVERITY_CRITICAL, "Scripting: %s", "Unable to allocate memory");
             _init_failed = true;
@@ -160,6 +160,7 @@ public:
         DISABLE_PRE_ARM = 1U << 4,
         SAVE_CHECKSUM = 1U << 5,
         DISABLE_HEAP_EXPANSION = 1U << 6,
+        BYTECODE_CACHE = 1U << 7,
     };
 
 private:
@@ -188,6 +189,7 @@ private:
     AP_Int8 _enable;
     AP_Int32 _script_vm_exec_count;
     AP_Int32 _script_heap_size;
+    AP_Int32 _script_mem_limit;
     AP_Int8 _debug_options;
     AP_Int16 _dir_disable;
     AP_Int32 _required_loaded_checksum;
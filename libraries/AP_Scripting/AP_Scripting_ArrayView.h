@@ -0,0 +1,73 @@
+#pragma once
+
+#include <stdint.h>
+
+/*
+  read-only view over an array of scalars owned by C++, exposed to
+  scripts as an ArrayView. Elements are read when they are indexed, so
+  a single binding call gives a script a whole sensor array without a
+  copy or a userdata per element:
+
+    local rpm = esc_telem:get_rpm_view()
+    for i = 1, #rpm do
+      total = total + rpm[i]
+    end
+
+  The viewed memory must outlive the view. Views are normally taken of
+  singleton members; the binding generator keeps the parent userdata
+  alive for views returned by userdata methods. Elements are read
+  without taking any semaphore, so a script may see a mix of old and
+  new elements, but never a torn element.
+
+  Header only with no scripting dependencies so that libraries can
+  return views from their scripting accessors.
+ */
+class AP_Scripting_ArrayView {
+public:
+    enum class Type : uint8_t {
+        NONE = 0,
+        BOOLEAN,
+        FLOAT,
+        INT8,
+        INT16,
+        INT32,
+        UINT8,
+        UINT16,
+    };
+
+    AP_Scripting_ArrayView() {}
+
+    // view count elements starting at data. The default stride is a
+    // plain array, use the size of a structure to view one member of
+    // an array of structures
+    template <typename T>
+    AP_Scripting_ArrayView(const volatile T *_data, uint16_t _count, uint16_t _stride = sizeof(T)) :
+        data(_data),
+        count(_count),
+        stride(_stride),
+        type(type_of(_data))
+    {}
+
+    uint16_t size() const { return count; }
+    Type get_type() const { return type; }
+
+    // return a pointer to element idx, which must be less than size()
+    const volatile void *element(uint16_t idx) const {
+        return (const volatile uint8_t *)data + idx * stride;
+    }
+
+private:
+    const volatile void *data = nullptr;
+    uint16_t count = 0;
+    uint16_t stride = 0;
+    Type type = Type::NONE;
+
+    // only types that map to a Lua number without boxing are supported
+    static constexpr Type type_of(const volatile bool *) { return Type::BOOLEAN; }
+    static constexpr Type type_of(const volatile float *) { return Type::FLOAT; }
+    static constexpr Type type_of(const volatile int8_t *) { return Type::INT8; }
+    static constexpr Type type_of(const volatile int16_t *) { return Type::INT16; }
+    static constexpr Type type_of(const volatile int32_t *) { return Type::INT32; }
+    static constexpr Type type_of(const volatile uint8_t *) { return Type::UINT8; }
+    static constexpr Type type_of(const volatile uint16_t *) { return Type::UINT16; }
+};
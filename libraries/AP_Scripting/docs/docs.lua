@@ -19,6 +19,13 @@ local enum_integer
 
 -- manual bindings
 
+-- read-only view of an array held by the firmware, index from 1 and use # for the length
+-- elements are read when indexed, nil is returned outside the view
+---@class (exact) ArrayView_ud
+---@field [integer] number|integer|boolean
+---@operator len: integer
+local ArrayView_ud = {}
+
 ---@class (exact) uint32_t_ud
 ---@operator add(uint32_t_ud|integer|number): uint32_t_ud
 ---@operator sub(uint32_t_ud|integer|number): uint32_t_ud
@@ -2393,6 +2400,14 @@ function esc_telem:set_rpm_scale(esc_index, scale_factor) end
 ---@return uint32_t_ud
 function esc_telem:get_last_telem_data_ms(esc_index) end
 
+-- get a view of the last reported RPM of every ESC, not cleared when data goes stale
+---@return ArrayView_ud
+function esc_telem:get_rpm_view() end
+
+-- get a view of the last reported temperature of every ESC in centi-degrees C
+---@return ArrayView_ud
+function esc_telem:get_temperature_view() end
+
 -- desc
 optical_flow = {}
 
@@ -3139,6 +3154,14 @@ rangefinder = {}
 ---@return AP_RangeFinder_Backend_ud|nil
 function rangefinder:get_backend(rangefinder_instance) end
 
+-- get a view of the distance in metres of every rangefinder instance
+---@return ArrayView_ud
+function rangefinder:get_distance_view() end
+
+-- get a view of the signal quality percentage of every rangefinder instance, -1 if unknown
+---@return ArrayView_ud
+function rangefinder:get_signal_quality_view() end
+
 -- desc
 ---@param orientation integer
 ---@return Vector3f_ud
@@ -0,0 +1,24 @@
+--[[
+   report the spread of ESC RPMs using an ArrayView, which reads the
+   RPM of every ESC from a single binding call
+--]]
+
+local rpm = esc_telem:get_rpm_view()
+
+function update()
+   local min_rpm = nil
+   local max_rpm = nil
+   for i = 1, #rpm do
+      local r = rpm[i]
+      if r > 0 then
+         min_rpm = math.min(min_rpm or r, r)
+         max_rpm = math.max(max_rpm or r, r)
+      end
+   end
+   if min_rpm then
+      gcs:send_text(6, string.format("ESC RPM min %.0f max %.0f", min_rpm, max_rpm))
+   end
+   return update, 1000
+end
+
+return update()
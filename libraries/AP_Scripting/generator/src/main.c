@@ -55,6 +55,10 @@ char keyword_uint16_t[] = "uint16_t";
 char keyword_uint32_t[] = "uint32_t";
 char keyword_void[]     = "void";
 
+// userdata type of read-only views over C++ arrays, a view returned by
+// a userdata method keeps the userdata it was taken from alive
+char array_view_type[]  = "AP_Scripting_ArrayView";
+
 enum error_codes {
   ERROR_OUT_OF_MEMORY   = 1, // ran out of memory
   ERROR_HEADER          = 2, // header keyword not followed by a header to include
@@ -2213,6 +2217,11 @@ void emit_userdata_method(const struct userdata *data, const struct method *meth
       break;
     case TYPE_USERDATA:
       fprintf(source, "    *new_%s(L) = data;\n", method->return_type.data.ud.sanatized_name);
+      if ((data->ud_type == UD_USERDATA) && (strcmp(method->return_type.data.ud.name, array_view_type) == 0)) {
+        // the view points into ud, hold a reference so it isn't collected first
+        fprintf(source, "    lua_pushvalue(L, 1);\n");
+        fprintf(source, "    lua_setuservalue(L, -2);\n");
+      }
       break;
     case TYPE_AP_OBJECT:
       fprintf(source, "    if (data == NULL) {\n");
@@ -2456,35 +2465,47 @@ void emit_index(struct userdata *head) {
   while(node) {
     start_dependency(source, node->dependency);
 
-    fprintf(source, "const luaL_Reg %s_meta[] = {\n", node->sanatized_name);
-
-    struct method *method = node->methods;
-    while (method) {
-      start_dependency(source, method->dependency);
-      fprintf(source, "    {\"%s\", %s_%s},\n", method->rename ? method->rename :  method->name, node->sanatized_name, method->name);
-      end_dependency(source, method->dependency);
-      method = method->next;
+    // userdata with only operators (such as ArrayView) have nothing to look up by name
+    int has_meta = (node->methods != NULL) || (node->fields != NULL);
+    struct method_alias *meta_alias = node->method_aliases;
+    while (meta_alias) {
+      if (meta_alias->type != ALIAS_TYPE_MANUAL_OPERATOR) {
+        has_meta = TRUE;
+      }
+      meta_alias = meta_alias->next;
     }
 
-    struct userdata_field *field = node->fields;
-    while(field) {
-      fprintf(source, "    {\"%s\", %s_%s},\n", field->rename ? field->rename : field->name, node->sanatized_name, field->name);
-      field = field->next;
-    }
+    if (has_meta) {
+      fprintf(source, "const luaL_Reg %s_meta[] = {\n", node->sanatized_name);
 
-    struct method_alias *alias = node->method_aliases;
-    while(alias) {
-      start_dependency(source, alias->dependency);
-      if (alias->type == ALIAS_TYPE_MANUAL) {
-        fprintf(source, "    {\"%s\", %s},\n", alias->alias, alias->name);
-      } else if (alias->type == ALIAS_TYPE_NONE) {
-        fprintf(source, "    {\"%s\", %s_%s},\n", alias->alias, node->sanatized_name, alias->name);
+      struct method *method = node->methods;
+      while (method) {
+        start_dependency(source, method->dependency);
+        fprintf(source, "    {\"%s\", %s_%s},\n", method->rename ? method->rename :  method->name, node->sanatized_name, method->name);
+        end_dependency(source, method->dependency);
+        method = method->next;
       }
-      end_dependency(source, alias->dependency);
-      alias = alias->next;
-    }
 
-    fprintf(source, "};\n\n");
+      struct userdata_field *field = node->fields;
+      while(field) {
+        fprintf(source, "    {\"%s\", %s_%s},\n", field->rename ? field->rename : field->name, node->sanatized_name, field->name);
+        field = field->next;
+      }
+
+      struct method_alias *alias = node->method_aliases;
+      while(alias) {
+        start_dependency(source, alias->dependency);
+        if (alias->type == ALIAS_TYPE_MANUAL) {
+          fprintf(source, "    {\"%s\", %s},\n", alias->alias, alias->name);
+        } else if (alias->type == ALIAS_TYPE_NONE) {
+          fprintf(source, "    {\"%s\", %s_%s},\n", alias->alias, node->sanatized_name, alias->name);
+        }
+        end_dependency(source, alias->dependency);
+        alias = alias->next;
+      }
+
+      fprintf(source, "};\n\n");
+    }
 
     if (node->operations) {
       fprintf(source, "const luaL_Reg %s_operators[] = {\n", node->sanatized_name);
@@ -2511,9 +2532,15 @@ void emit_index(struct userdata *head) {
     }
 
     fprintf(source, "static int %s_index(lua_State *L) {\n", node->sanatized_name);
-    fprintf(source, "    return load_function(L,%s_meta,ARRAY_SIZE(%s_meta))",node->sanatized_name,node->sanatized_name);
-    if (node->enums != NULL) {
-      fprintf(source, " || load_enum(L,%s_enums,ARRAY_SIZE(%s_enums))",node->sanatized_name,node->sanatized_name);
+    if (has_meta) {
+      fprintf(source, "    return load_function(L,%s_meta,ARRAY_SIZE(%s_meta))",node->sanatized_name,node->sanatized_name);
+      if (node->enums != NULL) {
+        fprintf(source, " || load_enum(L,%s_enums,ARRAY_SIZE(%s_enums))",node->sanatized_name,node->sanatized_name);
+      }
+    } else if (node->enums != NULL) {
+      fprintf(source, "    return load_enum(L,%s_enums,ARRAY_SIZE(%s_enums))",node->sanatized_name,node->sanatized_name);
+    } else {
+      fprintf(source, "    return 0");
     }
     fprintf(source, ";\n");
     fprintf(source, "}\n");
@@ -1013,6 +1013,16 @@ LUA_API int lua_load (lua_State *L, lua_Reader reader, void *data,
 }
 
 
+/*
+** load a binary chunk produced by lua_dump, regardless of
+** LUA_SUPPORT_LOAD_BINARY. Only for use by trusted C code
+*/
+LUA_API int lua_loadtrusted (lua_State *L, lua_Reader reader, void *data,
+                             const char *chunkname) {
+  return lua_load(L, reader, data, chunkname, luaD_trustedbinarymode);
+}
+
+
 LUA_API int lua_dump (lua_State *L, lua_Writer writer, void *data, int strip) {
   int status;
   TValue *o;
@@ -772,18 +772,24 @@ static void checkmode (lua_State *L, const char *mode, const char *x) {
 }
 
 
+/*
+  binary chunks are always accepted when loaded through
+  lua_loadtrusted(), which is only available to C code, so scripts
+  cannot use load() to run arbitrary bytecode
+ */
+LUAI_DDEF const char luaD_trustedbinarymode[] = "b";
+
 static void f_parser (lua_State *L, void *ud) {
   LClosure *cl;
   struct SParser *p = cast(struct SParser *, ud);
   int c = zgetc(p->z);  /* read first character */
-#if LUA_SUPPORT_LOAD_BINARY
-  // support loading pre-compiled luac
-  if (c == LUA_SIGNATURE[0]) {
+  if (c == LUA_SIGNATURE[0] &&
+      (LUA_SUPPORT_LOAD_BINARY || p->mode == luaD_trustedbinarymode)) {
+    // support loading pre-compiled luac
     checkmode(L, p->mode, "binary");
     cl = luaU_undump(L, p->z, p->name);
   }
   else
-#endif
   {
     checkmode(L, p->mode, "text");
     cl = luaY_parser(L, p->z, &p->buff, &p->dyd, p->name, c);
@@ -249,6 +249,8 @@ static LStream *newfile (lua_State *L) {
 
 static void opencheck (lua_State *L, const char *fname, const char *mode) {
   LStream *p = newfile(L);
+  if (lua_path_is_protected(fname))
+    luaL_error(L, "cannot open file '%s' (%s)", fname, strerror(EACCES));
   p->f = fopen(fname, mode);
   if (p->f == NULL)
     luaL_error(L, "cannot open file '%s' (%s)", fname, strerror(errno));
@@ -261,6 +263,10 @@ static int io_open (lua_State *L) {
   LStream *p = newfile(L);
   const char *md = mode;  /* to traverse/check mode */
   luaL_argcheck(L, l_checkmode(md), 2, "invalid mode");
+  if (lua_path_is_protected(filename)) {
+    errno = EACCES;
+    return luaL_fileresult(L, 0, filename);
+  }
   p->f = fopen(filename, mode);
   return (p->f == NULL) ? luaL_fileresult(L, 0, filename) : 1;
 }
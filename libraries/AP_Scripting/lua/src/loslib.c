@@ -165,6 +165,10 @@ static int os_execute (lua_State *L) {
 
 static int os_remove (lua_State *L) {
   const char *filename = luaL_checkstring(L, 1);
+  if (lua_path_is_protected(filename)) {
+    errno = EACCES;
+    return luaL_fileresult(L, 0, filename);
+  }
   return luaL_fileresult(L, remove(filename) == 0, filename);
 }
 
@@ -172,6 +176,10 @@ static int os_remove (lua_State *L) {
 static int os_rename (lua_State *L) {
   const char *fromname = luaL_checkstring(L, 1);
   const char *toname = luaL_checkstring(L, 2);
+  if (lua_path_is_protected(fromname) || lua_path_is_protected(toname)) {
+    errno = EACCES;
+    return luaL_fileresult(L, 0, NULL);
+  }
   return luaL_fileresult(L, rename(fromname, toname) == 0, NULL);
 }
 
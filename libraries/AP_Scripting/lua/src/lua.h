@@ -280,6 +280,9 @@ LUA_API int   (lua_pcallk) (lua_State *L, int nargs, int nresults, int errfunc,
 LUA_API int   (lua_load) (lua_State *L, lua_Reader reader, void *dt,
                           const char *chunkname, const char *mode);
 
+LUA_API int (lua_loadtrusted) (lua_State *L, lua_Reader reader, void *dt,
+                               const char *chunkname);
+
 LUA_API int (lua_dump) (lua_State *L, lua_Writer writer, void *data, int strip);
 
 
@@ -883,6 +883,10 @@ int lua_dirlist(lua_State *L) {
 int lua_removefile(lua_State *L) {
     binding_argcheck(L, 1);
     const char *filename = luaL_checkstring(L, 1);
+    if (lua_path_is_protected(filename)) {
+        errno = EACCES;
+        return luaL_fileresult(L, 0, filename);
+    }
     return luaL_fileresult(L, AP::FS().unlink(filename) == 0, filename);
 }
 
@@ -1086,6 +1090,34 @@ int lua_get_current_env_ref()
     return scripting->get_current_env_ref();
 }
 
+/*
+  scripts may not touch the bytecode cache, which is loaded without
+  the checks applied to script source. Any path with a component
+  naming the cache directory is refused, whatever directory it is
+  in, including the forms FAT resolves to the same directory
+ */
+int lua_path_is_protected(const char *path)
+{
+    const size_t name_len = strlen(SCRIPTING_CACHE_DIRNAME);
+    while (*path != '\0') {
+        const size_t len = strcspn(path, "/\\");
+        // FAT ignores trailing dots and spaces
+        size_t name_end = len;
+        while (name_end > 0 && (path[name_end-1] == '.' || path[name_end-1] == ' ')) {
+            name_end--;
+        }
+        if ((name_end == name_len && strncasecmp(path, SCRIPTING_CACHE_DIRNAME, name_len) == 0) ||
+            (len >= 6 && strncasecmp(path, "CACHE~", 6) == 0)) {
+            return 1;
+        }
+        path += len;
+        if (*path != '\0') {
+            path++;
+        }
+    }
+    return 0;
+}
+
 // This is used when loading modules with require, lua must only look in enabled directory's
 const char* lua_get_modules_path()
 {
@@ -1270,4 +1302,59 @@ int lua_DroneCAN_get_FlexDebug(lua_State *L)
 }
 #endif // HAL_ENABLE_DRONECAN_DRIVERS
 
+/*
+  index an ArrayView. Indexes are 1 based to match Lua tables, nil is
+  returned outside the view so ipairs() can be used to iterate
+ */
+int lua_array_view_index(lua_State *L)
+{
+    binding_argcheck(L, 2);
+
+    const AP_Scripting_ArrayView *view = check_AP_Scripting_ArrayView(L, 1);
+    int isnum;
+    const lua_Integer idx = lua_tointegerx(L, 2, &isnum);
+    if (!isnum || idx < 1 || idx > view->size()) {
+        return 0;
+    }
+    const volatile void *e = view->element(idx - 1);
+
+    switch (view->get_type()) {
+    case AP_Scripting_ArrayView::Type::BOOLEAN:
+        lua_pushboolean(L, *(const volatile bool *)e);
+        break;
+    case AP_Scripting_ArrayView::Type::FLOAT:
+        lua_pushnumber(L, *(const volatile float *)e);
+        break;
+    case AP_Scripting_ArrayView::Type::INT8:
+        lua_pushinteger(L, *(const volatile int8_t *)e);
+        break;
+    case AP_Scripting_ArrayView::Type::INT16:
+        lua_pushinteger(L, *(const volatile int16_t *)e);
+        break;
+    case AP_Scripting_ArrayView::Type::INT32:
+        lua_pushinteger(L, *(const volatile int32_t *)e);
+        break;
+    case AP_Scripting_ArrayView::Type::UINT8:
+        lua_pushinteger(L, *(const volatile uint8_t *)e);
+        break;
+    case AP_Scripting_ArrayView::Type::UINT16:
+        lua_pushinteger(L, *(const volatile uint16_t *)e);
+        break;
+    case AP_Scripting_ArrayView::Type::NONE:
+    default:
+        return 0;
+    }
+    return 1;
+}
+
+int lua_array_view_len(lua_State *L)
+{
+    // Lua passes the view twice for the length operator
+    binding_argcheck(L, 2);
+
+    const AP_Scripting_ArrayView *view = check_AP_Scripting_ArrayView(L, 1);
+    lua_pushinteger(L, view->size());
+    return 1;
+}
+
 #endif  // AP_SCRIPTING_ENABLED
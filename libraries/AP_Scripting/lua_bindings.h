@@ -35,3 +35,5 @@ int lua_print(lua_State *L);
 int lua_range_finder_handle_script_msg(lua_State *L);
 int lua_GCS_command_int(lua_State *L);
 int lua_DroneCAN_get_FlexDebug(lua_State *L);
+int lua_array_view_index(lua_State *L);
+int lua_array_view_len(lua_State *L);
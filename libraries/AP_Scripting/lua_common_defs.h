@@ -11,7 +11,17 @@
   #endif // HAL_OS_FATFS_IO || HAL_OS_LITTLEFS_IO
 #endif // SCRIPTING_DIRECTORY
 
+#ifndef SCRIPTING_CACHE_DIRNAME
+  // hidden so it is skipped when scanning for scripts
+  #define SCRIPTING_CACHE_DIRNAME ".cache"
+#endif
+#ifndef SCRIPTING_CACHE_DIRECTORY
+  #define SCRIPTING_CACHE_DIRECTORY SCRIPTING_DIRECTORY "/" SCRIPTING_CACHE_DIRNAME
+#endif
+
 int lua_get_current_env_ref();
 const char* lua_get_modules_path();
+// true if scripts may not open, remove or rename path
+int lua_path_is_protected(const char *path);
 void lua_abort(void) __attribute__((noreturn));
 
@@ -21,6 +21,8 @@
 #include <AP_HAL/AP_HAL.h>
 #include "AP_Scripting.h"
 #include <AP_Logger/AP_Logger.h>
+#include <AP_Math/crc.h>
+#include <AP_Common/AP_FWVersion.h>
 
 #include <AP_Scripting/lua_generated_bindings.h>
 
@@ -40,8 +42,9 @@ uint32_t lua_scripts::loaded_checksum;
 uint32_t lua_scripts::running_checksum;
 HAL_Semaphore lua_scripts::crc_sem;
 
-lua_scripts::lua_scripts(const AP_Int32 &vm_steps, const AP_Int32 &heap_size, AP_Int8 &debug_options)
+lua_scripts::lua_scripts(const AP_Int32 &vm_steps, const AP_Int32 &heap_size, const AP_Int32 &mem_limit, AP_Int8 &debug_options)
     : _vm_steps(vm_steps),
+      _mem_limit(mem_limit),
       _debug_options(debug_options)
 {
     const bool allow_heap_expansion = !option_is_set(AP_Scripting::DebugOption::DISABLE_HEAP_EXPANSION);
@@ -49,6 +52,7 @@ lua_scripts::lua_scripts(const AP_Int32 &vm_steps, const AP_Int32 &heap_size, AP
 }
 
 lua_scripts::~lua_scripts() {
+    _pool.trim();
     _heap.destroy();
 }
 
@@ -128,13 +132,14 @@ int lua_scripts::atpanic(lua_State *L) {
 }
 
 // helper for print and log of runtime stats
-void lua_scripts::update_stats(const char *name, uint32_t run_time, int total_mem, int run_mem)
+void lua_scripts::update_stats(const char *name, uint32_t run_time, int total_mem, int run_mem, uint32_t script_mem)
 {
     if (option_is_set(AP_Scripting::DebugOption::RUNTIME_MSG)) {
-        GCS_SEND_TEXT(MAV_SEVERITY_DEBUG, "Lua: Time: %u Mem: %d + %d",
+        GCS_SEND_TEXT(MAV_SEVERITY_DEBUG, "Lua: Time: %u Mem: %d + %d Script: %u",
                                             (unsigned int)run_time,
                                             (int)total_mem,
-                                            (int)run_mem);
+                                            (int)run_mem,
+                                            (unsigned int)script_mem);
     }
 #if HAL_LOGGING_ENABLED
     if (option_is_set(AP_Scripting::DebugOption::LOG_RUNTIME)) {
@@ -144,7 +149,8 @@ void lua_scripts::update_stats(const char *name, uint32_t run_time, int total_me
             name         : {},
             run_time     : run_time,
             total_mem    : total_mem,
-            run_mem      : run_mem
+            run_mem      : run_mem,
+            script_mem   : script_mem
         };
         const char * name_short = strrchr(name, '/');
         if ((strlen(name) > sizeof(pkt.name)) && (name_short != nullptr)) {
@@ -157,8 +163,242 @@ void lua_scripts::update_stats(const char *name, uint32_t run_time, int total_me
 #endif // HAL_LOGGING_ENABLED
 }
 
+#if AP_SCRIPTING_BYTECODE_CACHE_ENABLED
+void lua_scripts::cache_filename(char *buf, size_t len, uint32_t key)
+{
+    hal.util->snprintf(buf, len, SCRIPTING_CACHE_DIRECTORY "/%08lx.luac", (unsigned long)key);
+}
+
+/*
+  header at the start of each cache file. The bytecode is only handed
+  to the undumper, which does not check it, once the header matches
+  this firmware and script and the CRC of the bytecode is correct
+ */
+namespace {
+struct PACKED CacheHeader {
+    uint32_t magic;
+    uint32_t fw_hash;       // git hash of the firmware that compiled it
+    uint32_t lua_build;     // Lua version and type sizes
+    uint32_t key;           // cache key of the script source
+    uint32_t length;        // bytes of bytecode after the header
+    uint32_t crc;           // crc32 of the bytecode
+};
+
+struct CacheReader {
+    int fd;
+    uint32_t remaining;
+    char buf[128];
+};
+
+struct CacheWriter {
+    int fd;
+    uint32_t length;
+    uint32_t crc;
+};
+}
+
+static const uint32_t cache_magic = 0x4341554C; // "LUAC"
+
+static uint32_t cache_lua_build(void)
+{
+    return (LUA_VERSION_NUM << 16) |
+        (sizeof(lua_Integer) << 12) |
+        (sizeof(lua_Number) << 8) |
+        (sizeof(size_t) << 4) |
+        sizeof(void *);
+}
+
+static const char *cache_reader(lua_State *L, void *data, size_t *size)
+{
+    CacheReader *r = (CacheReader *)data;
+    const int32_t n = AP::FS().read(r->fd, r->buf, MIN(sizeof(r->buf), r->remaining));
+    if (n <= 0) {
+        *size = 0;
+        return nullptr;
+    }
+    r->remaining -= n;
+    *size = n;
+    return r->buf;
+}
+
+static int cache_writer(lua_State *L, const void *p, size_t sz, void *ud)
+{
+    CacheWriter *w = (CacheWriter *)ud;
+    if (AP::FS().write(w->fd, p, sz) != int32_t(sz)) {
+        return 1;
+    }
+    w->crc = crc_crc32(w->crc, (const uint8_t *)p, sz);
+    w->length += sz;
+    return 0;
+}
+
+/*
+  check the header and bytecode of an open cache file, leaving the
+  file positioned at the start of the bytecode
+ */
+static bool cache_file_valid(int fd, uint32_t key, CacheHeader &hdr)
+{
+    if (AP::FS().read(fd, &hdr, sizeof(hdr)) != sizeof(hdr) ||
+        hdr.magic != cache_magic ||
+        hdr.fw_hash != AP::fwversion().fw_hash ||
+        hdr.lua_build != cache_lua_build() ||
+        hdr.key != key) {
+        return false;
+    }
+    uint8_t buf[128];
+    uint32_t crc = 0;
+    uint32_t remaining = hdr.length;
+    while (remaining > 0) {
+        const int32_t n = AP::FS().read(fd, buf, MIN(sizeof(buf), remaining));
+        if (n <= 0) {
+            return false;
+        }
+        crc = crc_crc32(crc, buf, n);
+        remaining -= n;
+    }
+    if (crc != hdr.crc) {
+        return false;
+    }
+    return AP::FS().lseek(fd, sizeof(hdr), SEEK_SET) == int32_t(sizeof(hdr));
+}
+
+/*
+  load the compiled script for key, leaving the function on the stack.
+  Returns false if there is no usable cache entry, with the stack
+  unchanged, and the script is compiled from source
+ */
+bool lua_scripts::load_from_cache(lua_State *L, const char *filename, uint32_t key)
+{
+    char cache_name[sizeof(SCRIPTING_CACHE_DIRECTORY) + 16];
+    cache_filename(cache_name, sizeof(cache_name), key);
+
+    CacheReader reader;
+    reader.fd = AP::FS().open(cache_name, O_RDONLY);
+    if (reader.fd == -1) {
+        return false;
+    }
+
+    CacheHeader hdr;
+    if (!cache_file_valid(reader.fd, key, hdr)) {
+        // corrupt, or from another firmware; it will be replaced when
+        // the script is compiled
+        AP::FS().close(reader.fd);
+        AP::FS().unlink(cache_name);
+        return false;
+    }
+    reader.remaining = hdr.length;
+
+    // use the same chunk name as luaL_loadfile so error messages are unchanged
+    lua_pushfstring(L, "@%s", filename);
+    const int error = lua_loadtrusted(L, cache_reader, &reader, lua_tostring(L, -1));
+    AP::FS().close(reader.fd);
+    lua_remove(L, -2);
+    if (error != LUA_OK) {
+        lua_pop(L, 1);
+        AP::FS().unlink(cache_name);
+        return false;
+    }
+    return true;
+}
+
+/*
+  save the compiled script on top of the stack. Failure to save is
+  not an error, the script is just compiled again next boot
+ */
+void lua_scripts::save_to_cache(lua_State *L, uint32_t key)
+{
+    char cache_name[sizeof(SCRIPTING_CACHE_DIRECTORY) + 16];
+    char tmp_name[sizeof(cache_name) + 4];
+    cache_filename(cache_name, sizeof(cache_name), key);
+    hal.util->snprintf(tmp_name, sizeof(tmp_name), "%s.tmp", cache_name);
+
+    AP::FS().mkdir(SCRIPTING_CACHE_DIRECTORY);
+    CacheWriter writer {};
+    writer.fd = AP::FS().open(tmp_name, O_WRONLY|O_CREAT|O_TRUNC);
+    if (writer.fd == -1) {
+        return;
+    }
+    // the header is written again once the length and crc of the
+    // bytecode are known. The file is written under a temporary name
+    // and renamed so a partially written file is never loaded
+    CacheHeader hdr {};
+    bool ok = AP::FS().write(writer.fd, &hdr, sizeof(hdr)) == sizeof(hdr) &&
+        lua_dump(L, cache_writer, &writer, 0) == 0;
+    if (ok) {
+        hdr.magic = cache_magic;
+        hdr.fw_hash = AP::fwversion().fw_hash;
+        hdr.lua_build = cache_lua_build();
+        hdr.key = key;
+        hdr.length = writer.length;
+        hdr.crc = writer.crc;
+        ok = AP::FS().lseek(writer.fd, 0, SEEK_SET) == 0 &&
+            AP::FS().write(writer.fd, &hdr, sizeof(hdr)) == sizeof(hdr);
+    }
+    AP::FS().close(writer.fd);
+    if (!ok || AP::FS().rename(tmp_name, cache_name) != 0) {
+        AP::FS().unlink(tmp_name);
+    }
+}
+
+/*
+  remove cache entries that were not used by any loaded script, so
+  edited or deleted scripts don't leave files behind
+ */
+void lua_scripts::prune_cache(void)
+{
+    auto *d = AP::FS().opendir(SCRIPTING_CACHE_DIRECTORY);
+    if (d == nullptr) {
+        return;
+    }
+    for (struct dirent *de=AP::FS().readdir(d); de; de=AP::FS().readdir(d)) {
+        char *end = nullptr;
+        const uint32_t key = strtoul(de->d_name, &end, 16);
+        bool in_use = false;
+        if (end != nullptr && strcmp(end, ".luac") == 0) {
+            for (script_info *s = scripts; s != nullptr; s = s->next) {
+                if (s->cache_key == key) {
+                    in_use = true;
+                    break;
+                }
+            }
+        }
+        if (!in_use && de->d_name[0] != '.') {
+            char name[sizeof(SCRIPTING_CACHE_DIRECTORY) + sizeof(de->d_name) + 1];
+            hal.util->snprintf(name, sizeof(name), SCRIPTING_CACHE_DIRECTORY "/%s", de->d_name);
+            AP::FS().unlink(name);
+        }
+    }
+    AP::FS().closedir(d);
+}
+#endif  // AP_SCRIPTING_BYTECODE_CACHE_ENABLED
+
 lua_scripts::script_info *lua_scripts::load_script(lua_State *L, char *filename) {
-    if (int error = luaL_loadfile(L, filename)) {
+    // Get checksum of file, used for the loaded/running checksums and
+    // as the key for the bytecode cache
+    uint32_t crc = 0;
+    const bool have_crc = AP::FS().crc32(filename, crc);
+
+    // everything the script allocates from here on, including its
+    // compiled code, is accounted to it
+    const uint8_t mem_owner = allocate_mem_owner();
+    set_mem_owner(mem_owner);
+
+    const uint32_t loadStart = AP_HAL::micros();
+    const uint32_t start_mem_in_use = _mem_in_use;
+    _mem_peak = _mem_in_use;
+
+    bool loaded = false;
+#if AP_SCRIPTING_BYTECODE_CACHE_ENABLED
+    const bool use_cache = have_crc && option_is_set(AP_Scripting::DebugOption::BYTECODE_CACHE);
+    const uint32_t cache_key = crc_crc32(crc, (const uint8_t *)filename, strlen(filename));
+    if (use_cache) {
+        loaded = load_from_cache(L, filename, cache_key);
+    }
+#endif
+
+    if (loaded) {
+        // nothing to do
+    } else if (int error = luaL_loadfile(L, filename)) {
         switch (error) {
             case LUA_ERRSYNTAX:
                 set_and_print_new_error_message(MAV_SEVERITY_CRITICAL, "Error: %s", lua_tostring(L, -1));
@@ -178,9 +418,11 @@ lua_scripts::script_info *lua_scripts::load_script(lua_State *L, char *filename)
                 return nullptr;
         }
     }
-
-    const int loadMem = lua_gc(L, LUA_GCCOUNT, 0) * 1024 + lua_gc(L, LUA_GCCOUNTB, 0);
-    const uint32_t loadStart = AP_HAL::micros();
+#if AP_SCRIPTING_BYTECODE_CACHE_ENABLED
+    else if (use_cache) {
+        save_to_cache(L, cache_key);
+    }
+#endif
 
     script_info *new_script = (script_info *)_heap.allocate(sizeof(script_info));
     if (new_script == nullptr) {
@@ -198,16 +440,20 @@ lua_scripts::script_info *lua_scripts::load_script(lua_State *L, char *filename)
     const uint32_t loadEnd = AP_HAL::micros();
     const int endMem = lua_gc(L, LUA_GCCOUNT, 0) * 1024 + lua_gc(L, LUA_GCCOUNTB, 0);
 
-    update_stats(filename, loadEnd-loadStart, endMem, loadMem);
+    // report the peak memory used while loading, which is dominated
+    // by the compiler when the script is loaded from source
+    update_stats(filename, loadEnd-loadStart, endMem, _mem_peak - start_mem_in_use, _pool.get_owner_usage(mem_owner));
 
     new_script->name = filename;
     new_script->env_ref = luaL_ref(L, LUA_REGISTRYINDEX); // store reference to script's environment
     new_script->run_ref = luaL_ref(L, LUA_REGISTRYINDEX); // store reference to function to run
     new_script->next_run_ms = AP_HAL::millis64() - 1; // force the script to be stale
+    new_script->mem_owner = mem_owner;
+#if AP_SCRIPTING_BYTECODE_CACHE_ENABLED
+    new_script->cache_key = use_cache ? cache_key : 0;
+#endif
 
-    // Get checksum of file
-    uint32_t crc = 0;
-    if (AP::FS().crc32(filename, crc)) {
+    if (have_crc) {
         // Record crc of this script
         new_script->crc = crc;
         {
@@ -289,6 +535,7 @@ void lua_scripts::load_all_scripts_in_dir(lua_State *L, const char *dirname) {
 
         // we have something that looks like a lua file, attempt to load it
         script_info * script = load_script(L, filename);
+        set_mem_owner(0);
         if (script == nullptr) {
             _heap.deallocate(filename);
             continue;
@@ -335,10 +582,17 @@ void lua_scripts::run_next_script(lua_State *L) {
     // set current environment for other users
     AP::scripting()->set_current_env_ref(script->env_ref);
 
-    if(lua_pcall(L, 0, LUA_MULTRET, 0)) {
+    set_mem_owner(script->mem_owner);
+    _mem_limit_hit = false;
+    const int error = lua_pcall(L, 0, LUA_MULTRET, 0);
+    set_mem_owner(0);
+
+    if (error) {
         if (overtime) {
             // script has consumed an excessive amount of CPU time
             set_and_print_new_error_message(MAV_SEVERITY_CRITICAL, "%s exceeded time limit", script->name);
+        } else if (error == LUA_ERRMEM && _mem_limit_hit) {
+            set_and_print_new_error_message(MAV_SEVERITY_CRITICAL, "%s exceeded SCR_MEM_LIMIT", script->name);
         } else {
             set_and_print_new_error_message(MAV_SEVERITY_CRITICAL, "%s", lua_tostring(L, -1));
         }
@@ -459,10 +713,70 @@ void lua_scripts::reschedule_script(script_info *script) {
 }
 
 MultiHeap lua_scripts::_heap;
+MultiHeapPool lua_scripts::_pool{_heap};
+uint8_t lua_scripts::_current_owner;
+int32_t lua_scripts::_owner_limit;
+bool lua_scripts::_mem_limit_hit;
+uint32_t lua_scripts::_mem_in_use;
+uint32_t lua_scripts::_mem_peak;
 
 void *lua_scripts::alloc(void *ud, void *ptr, size_t osize, size_t nsize) {
     (void)ud; /* not used */
-    return _heap.change_size(ptr, osize, nsize);
+
+    // when ptr is null osize is the type of object being
+    // allocated, not a size
+    const size_t old_size = (ptr != nullptr) ? osize : 0;
+
+    if (_owner_limit > 0 && nsize > old_size) {
+        // growing an allocation owned by the running script must
+        // respect its limit. Returning nullptr makes Lua run a full
+        // garbage collection and retry before raising a memory error
+        const uint8_t owner = (ptr != nullptr) ? _pool.get_owner(ptr, osize) : _current_owner;
+        if (owner == _current_owner &&
+            _pool.get_owner_usage(owner) + (nsize - old_size) > uint32_t(_owner_limit)) {
+            _mem_limit_hit = true;
+            return nullptr;
+        }
+    }
+
+    void *ret = _pool.change_size(ptr, old_size, nsize, _current_owner);
+    if (ret != nullptr || nsize == 0) {
+        _mem_in_use += nsize - old_size;
+        _mem_peak = MAX(_mem_peak, _mem_in_use);
+    }
+    return ret;
+}
+
+/*
+  find an owner id that is not used by any loaded script and has no
+  allocations left from a script that has been removed. Falls back to
+  the shared owner if there are more scripts than ids
+ */
+uint8_t lua_scripts::allocate_mem_owner(void) const
+{
+    for (uint8_t owner=1; owner<MultiHeapPool::MAX_OWNERS; owner++) {
+        if (_pool.get_owner_usage(owner) != 0) {
+            continue;
+        }
+        bool in_use = false;
+        for (const script_info *s = scripts; s != nullptr; s = s->next) {
+            if (s->mem_owner == owner) {
+                in_use = true;
+                break;
+            }
+        }
+        if (!in_use) {
+            return owner;
+        }
+    }
+    return 0;
+}
+
+void lua_scripts::set_mem_owner(uint8_t owner)
+{
+    _current_owner = owner;
+    // the shared owner is never limited
+    _owner_limit = (owner != 0) ? _mem_limit.get() : 0;
 }
 
 void lua_scripts::run(void) {
@@ -480,7 +794,9 @@ void lua_scripts::run(void) {
         }
         if (lua_state != nullptr) {
             lua_close(lua_state); // shutdown the old state
+            _pool.trim();
         }
+        set_mem_owner(0);
         // remove all the old scheduled scripts
         for (script_info *script = scripts; script != nullptr; script = scripts) {
             remove_script(nullptr, script);
@@ -535,6 +851,11 @@ void lua_scripts::run(void) {
     if (!loaded) {
         GCS_SEND_TEXT(MAV_SEVERITY_CRITICAL, "Lua: All directory's disabled see SCR_DIR_DISABLE");
     }
+#if AP_SCRIPTING_BYTECODE_CACHE_ENABLED
+    if (option_is_set(AP_Scripting::DebugOption::BYTECODE_CACHE)) {
+        prune_cache();
+    }
+#endif
 
 #ifndef __clang_analyzer__
     succeeded_initial_load = true;
@@ -581,6 +902,7 @@ void lua_scripts::run(void) {
 #endif
 
             const int startMem = lua_gc(L, LUA_GCCOUNT, 0) * 1024 + lua_gc(L, LUA_GCCOUNTB, 0);
+            const uint8_t mem_owner = scripts->mem_owner;
             const uint32_t loadEnd = AP_HAL::micros();
 
             // NOTE!  the base pointer of our scripts linked list,
@@ -596,7 +918,7 @@ void lua_scripts::run(void) {
             hal.scheduler->restore_interrupts(istate);
 #endif
 
-            update_stats(script_name, runEnd - loadEnd, endMem, endMem - startMem);
+            update_stats(script_name, runEnd - loadEnd, endMem, endMem - startMem, _pool.get_owner_usage(mem_owner));
 
 
             // garbage collect after each script, this shouldn't matter, but seems to resolve a memory leak
@@ -638,6 +960,7 @@ void lua_scripts::run(void) {
         lua_close(lua_state); // shutdown the old state
         lua_state = nullptr;
     }
+    _pool.trim();
 
     error_msg_buf_sem.take_blocking();
     if (error_msg_buf != nullptr) {
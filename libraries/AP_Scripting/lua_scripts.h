@@ -27,6 +27,7 @@
 #include <GCS_MAVLink/GCS_MAVLink.h>
 #include <AP_HAL/Semaphores.h>
 #include <AP_MultiHeap/AP_MultiHeap.h>
+#include <AP_MultiHeap/MultiHeapPool.h>
 #include "lua_common_defs.h"
 
 #include "lua/src/lua.hpp"
@@ -34,7 +35,7 @@
 class lua_scripts
 {
 public:
-    lua_scripts(const AP_Int32 &vm_steps, const AP_Int32 &heap_size, AP_Int8 &debug_options);
+    lua_scripts(const AP_Int32 &vm_steps, const AP_Int32 &heap_size, const AP_Int32 &mem_limit, AP_Int8 &debug_options);
 
     ~lua_scripts();
 
@@ -57,6 +58,10 @@ private:
        int run_ref;          // reference to the function to run
        uint64_t next_run_ms; // time (in milliseconds) the script should next be run at
        uint32_t crc;         // crc32 checksum
+       uint8_t mem_owner;    // owner of memory allocated by this script, 0 if shared
+#if AP_SCRIPTING_BYTECODE_CACHE_ENABLED
+       uint32_t cache_key;   // key of the bytecode cache entry for this script
+#endif
        char *name;           // filename for the script // FIXME: This information should be available from Lua
        script_info *next;
     } script_info;
@@ -67,6 +72,15 @@ private:
 
     void load_all_scripts_in_dir(lua_State *L, const char *dirname);
 
+#if AP_SCRIPTING_BYTECODE_CACHE_ENABLED
+    // support for caching compiled scripts, keyed on a checksum of the
+    // script name and source
+    static void cache_filename(char *buf, size_t len, uint32_t key);
+    bool load_from_cache(lua_State *L, const char *filename, uint32_t key);
+    void save_to_cache(lua_State *L, uint32_t key);
+    void prune_cache(void);
+#endif
+
     void run_next_script(lua_State *L);
 
     void remove_script(lua_State *L, script_info *script);
@@ -87,6 +101,7 @@ private:
     lua_State *lua_state;
 
     const AP_Int32 & _vm_steps;
+    const AP_Int32 & _mem_limit;
     AP_Int8 & _debug_options;
 
     bool option_is_set(AP_Scripting::DebugOption option) const {
@@ -97,8 +112,24 @@ private:
 
     static MultiHeap _heap;
 
+    // small allocations are pooled, and all allocations are tagged
+    // with the script that made them for per-script accounting
+    static MultiHeapPool _pool;
+    static uint8_t _current_owner;
+    static int32_t _owner_limit;
+    static bool _mem_limit_hit;
+
+    // pick a memory owner for a newly loaded script
+    uint8_t allocate_mem_owner(void) const;
+    void set_mem_owner(uint8_t owner);
+
+    // memory in use by Lua and its high water mark, used to report
+    // peak memory use while loading a script
+    static uint32_t _mem_in_use;
+    static uint32_t _mem_peak;
+
     // helper for print and log of runtime stats
-    void update_stats(const char *name, uint32_t run_time, int total_mem, int run_mem);
+    void update_stats(const char *name, uint32_t run_time, int total_mem, int run_mem, uint32_t script_mem);
 
     // must be static for use in atpanic
     static void print_error(MAV_SEVERITY severity);
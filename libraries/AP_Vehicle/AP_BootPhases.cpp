@@ -0,0 +1,186 @@
+#include "AP_BootPhases.h"
+
+#if AP_VEHICLE_BOOT_PHASES_ENABLED
+
+#include <AP_Common/ExpandingString.h>
+
+extern const AP_HAL::HAL& hal;
+
+AP_BootPhases *AP_BootPhases::_singleton;
+
+AP_BootPhases::AP_BootPhases()
+{
+    if (_singleton != nullptr) {
+        AP_HAL::panic("AP_BootPhases must be singleton");
+    }
+    _singleton = this;
+}
+
+AP_BootPhases::Phase *AP_BootPhases::_add(const char *name)
+{
+    WITH_SEMAPHORE(_sem);
+
+    if (_num_phases >= ARRAY_SIZE(_phases)) {
+        return nullptr;
+    }
+    Phase &p = _phases[_num_phases++];
+    p.name = name;
+    p.start_ms = AP_HAL::millis();
+    return &p;
+}
+
+void AP_BootPhases::begin(const char *name)
+{
+    end();
+
+    if (_add(name) != nullptr) {
+        _current = _num_phases - 1;
+    }
+}
+
+void AP_BootPhases::end()
+{
+    if (_current < 0) {
+        return;
+    }
+    Phase &p = _phases[_current];
+    p.time_ms = AP_HAL::millis() - p.start_ms;
+    p.done = true;
+    _current = -1;
+}
+
+void AP_BootPhases::_run(Phase &p, AP_HAL::MemberProc fn)
+{
+    p.start_ms = AP_HAL::millis();
+    fn();
+    p.time_ms = AP_HAL::millis() - p.start_ms;
+
+    WITH_SEMAPHORE(_sem);
+    p.done = true;
+    _async_pending--;
+}
+
+#if AP_VEHICLE_PARALLEL_PROBE_ENABLED
+/*
+  take p, or the first async phase not yet taken if p is null. Threads
+  take phases in order of creation rather than by identity, so a phase
+  run without a thread must also be taken
+ */
+AP_BootPhases::Phase *AP_BootPhases::_take(Phase *p)
+{
+    WITH_SEMAPHORE(_sem);
+
+    if (p != nullptr) {
+        p->taken = true;
+        return p;
+    }
+    for (uint8_t i=0; i<_num_phases; i++) {
+        Phase &q = _phases[i];
+        if (q.async && !q.taken) {
+            q.taken = true;
+            return &q;
+        }
+    }
+    return nullptr;
+}
+
+void AP_BootPhases::_async_thread()
+{
+    Phase *p = _take(nullptr);
+    if (p != nullptr) {
+        _run(*p, p->fn);
+    }
+}
+#endif  // AP_VEHICLE_PARALLEL_PROBE_ENABLED
+
+void AP_BootPhases::run_async(const char *name, AP_HAL::MemberProc fn)
+{
+    Phase *p = _add(name);
+    if (p == nullptr) {
+        fn();
+        return;
+    }
+    {
+        WITH_SEMAPHORE(_sem);
+        p->async = true;
+#if AP_VEHICLE_PARALLEL_PROBE_ENABLED
+        p->fn = fn;
+#endif
+        _async_pending++;
+    }
+
+#if AP_VEHICLE_PARALLEL_PROBE_ENABLED
+    char thread_name[16];
+    hal.util->snprintf(thread_name, sizeof(thread_name), "boot-%s", name);
+    if (hal.scheduler->thread_create(FUNCTOR_BIND_MEMBER(&AP_BootPhases::_async_thread, void),
+                                     thread_name, 8192, AP_HAL::Scheduler::PRIORITY_IO, 0)) {
+        return;
+    }
+    _take(p);
+#endif
+
+    _run(*p, fn);
+}
+
+void AP_BootPhases::wait_async()
+{
+    while (true) {
+        {
+            WITH_SEMAPHORE(_sem);
+            if (_async_pending == 0) {
+                return;
+            }
+        }
+        // runs the delay callbacks, which keep the GCS alive once it is set up
+        hal.scheduler->delay(1);
+    }
+}
+
+void AP_BootPhases::finish()
+{
+    end();
+    wait_async();
+    _finish_ms = AP_HAL::millis();
+
+#if CONFIG_HAL_BOARD == HAL_BOARD_SITL || CONFIG_HAL_BOARD == HAL_BOARD_LINUX
+    for (uint8_t i=0; i<_num_phases; i++) {
+        const Phase &p = _phases[i];
+        DEV_PRINTF("Boot %-12s %6u %6ums%s\n", p.name,
+                   unsigned(p.start_ms), unsigned(p.time_ms),
+                   p.async ? " async" : "");
+    }
+    DEV_PRINTF("Boot took %ums\n", unsigned(_finish_ms));
+#endif
+}
+
+void AP_BootPhases::info(ExpandingString &str)
+{
+    WITH_SEMAPHORE(_sem);
+
+    str.printf("%-12s %8s %8s\n", "PHASE", "START", "TIME");
+    for (uint8_t i=0; i<_num_phases; i++) {
+        const Phase &p = _phases[i];
+        if (!p.done) {
+            str.printf("%-12s %6ums %8s%s\n", p.name, unsigned(p.start_ms), "-",
+                       p.async ? " async" : "");
+            continue;
+        }
+        str.printf("%-12s %6ums %6ums%s\n", p.name,
+                   unsigned(p.start_ms), unsigned(p.time_ms),
+                   p.async ? " async" : "");
+    }
+    if (_finish_ms != 0) {
+        str.printf("ready at %ums\n", unsigned(_finish_ms));
+    }
+}
+
+namespace AP {
+
+AP_BootPhases *boot_phases()
+{
+    return AP_BootPhases::get_singleton();
+}
+
+};
+
+#endif // AP_VEHICLE_BOOT_PHASES_ENABLED
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "AP_Vehicle_config.h"
+
+#if AP_VEHICLE_BOOT_PHASES_ENABLED
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_HAL/Semaphores.h>
+
+class ExpandingString;
+
+/*
+  timing of the phases of vehicle startup
+
+  Phases run one after another on the main thread with begin(), each
+  ending the one before it. Phases that do not depend on the main
+  thread, such as probing one class of sensor, can be started with
+  run_async() and run in a thread of their own while the main thread
+  carries on, until wait_async(). The timings can be read from
+  @SYS/boot.txt, and on SITL and Linux are printed once boot has
+  finished
+ */
+class AP_BootPhases {
+public:
+    AP_BootPhases();
+
+    CLASS_NO_COPY(AP_BootPhases);
+
+    static AP_BootPhases *get_singleton() { return _singleton; }
+
+    // start a phase on the main thread, ending the current one
+    void begin(const char *name);
+
+    // end the current phase on the main thread
+    void end();
+
+    /*
+      run fn as a phase in its own thread. If parallel probing is
+      disabled or the thread can't be created then fn is run before
+      returning
+     */
+    void run_async(const char *name, AP_HAL::MemberProc fn);
+
+    // wait for all phases started with run_async() to finish. The
+    // delay callbacks run while waiting, so a vehicle should wait
+    // before setting up the GCS if the phases touch what MAVLink can
+    // reach
+    void wait_async();
+
+    // end the current phase, mark boot as finished and print the timings
+    void finish();
+
+    // boot time in milliseconds, zero until finish()
+    uint32_t boot_time_ms() const { return _finish_ms; }
+
+    // text report of the phase timings
+    void info(ExpandingString &str);
+
+private:
+    static AP_BootPhases *_singleton;
+
+    struct Phase {
+        const char *name;
+        uint32_t start_ms;
+        uint32_t time_ms;
+#if AP_VEHICLE_PARALLEL_PROBE_ENABLED
+        AP_HAL::MemberProc fn;
+        // picked up by a thread
+        bool taken;
+#endif
+        bool async;
+        bool done;
+    } _phases[AP_VEHICLE_BOOT_PHASES_MAX];
+    uint8_t _num_phases;
+
+    // main thread phase in progress, -1 for none
+    int8_t _current = -1;
+    // async phases not yet done
+    uint8_t _async_pending;
+    uint32_t _finish_ms;
+
+    HAL_Semaphore _sem;
+
+    Phase *_add(const char *name);
+    void _run(Phase &p, AP_HAL::MemberProc fn);
+#if AP_VEHICLE_PARALLEL_PROBE_ENABLED
+    void _async_thread();
+    Phase *_take(Phase *p);
+#endif
+};
+
+namespace AP {
+    AP_BootPhases *boot_phases();
+};
+
+#endif // AP_VEHICLE_BOOT_PHASES_ENABLED
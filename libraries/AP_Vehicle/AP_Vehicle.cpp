@@ -316,11 +316,15 @@ void AP_Vehicle::setup()
     check_firmware_print();
 #endif
 
+    boot_phase("params");
+
     // validate the static parameter table, then load persistent
     // values from storage:
     AP_Param::check_var_info();
     load_parameters();
 
+    boot_phase("serial");
+
 #if CONFIG_HAL_BOARD == HAL_BOARD_CHIBIOS
     if (AP_BoardConfig::get_sdcard_slowdown() != 0) {
         // user wants the SDcard slower, we need to remount
@@ -400,13 +404,16 @@ void AP_Vehicle::setup()
     stats.init();
 #endif
 
+    boot_phase("board");
     BoardConfig.init();
 
 #if HAL_CANMANAGER_ENABLED
+    boot_phase("can");
     can_mgr.init();
 #endif
 
 #if HAL_LOGGING_ENABLED
+    boot_phase("logger");
     logger.init(get_log_bitmask(), get_log_structures(), get_num_log_structures());
 #endif
 
@@ -415,13 +422,24 @@ void AP_Vehicle::setup()
     AP::gripper().init();
 #endif
 
-    // init_ardupilot is where the vehicle does most of its initialisation.
+    boot_phase("vehicle");
+
+    // init_ardupilot is where the vehicle does most of its
+    // initialisation. It may start phases of its own
     init_ardupilot();
 
+    // anything init_ardupilot() started in the background must be
+    // finished before the late initialisation below
+    boot_wait_async();
+
 #if AP_SCRIPTING_ENABLED
+    boot_phase("scripting");
+    // scripts are loaded and run in the scripting thread
     scripting.init();
 #endif // AP_SCRIPTING_ENABLED
 
+    boot_phase("late");
+
 #if AP_AIRSPEED_ENABLED
     airspeed.init();
     if (airspeed.enabled()) {
@@ -520,7 +538,15 @@ void AP_Vehicle::setup()
     // initialisation
     AP_Param::invalidate_count();
 
+    // the vehicle has converted its parameters for this firmware
+    AP_Param::set_conversion_watermark();
+
+#if AP_VEHICLE_BOOT_PHASES_ENABLED
+    boot_phases.finish();
+    GCS_SEND_TEXT(MAV_SEVERITY_INFO, "ArduPilot Ready in %ums", unsigned(boot_phases.boot_time_ms()));
+#else
     GCS_SEND_TEXT(MAV_SEVERITY_INFO, "ArduPilot Ready");
+#endif
 
 #if AP_DDS_ENABLED
     if (!init_dds_client()) {
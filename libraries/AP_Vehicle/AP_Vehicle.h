@@ -82,6 +82,8 @@
 
 #include <AP_IBus_Telem/AP_IBus_Telem.h>
 
+#include "AP_BootPhases.h"
+
 class AP_DDS_Client;
 
 class AP_Vehicle : public AP_HAL::HAL::Callbacks {
@@ -312,7 +314,10 @@ protected:
 
     virtual void init_ardupilot() = 0;
     virtual void load_parameters() = 0;
-    void load_parameters(AP_Int16 &format_version, const uint16_t expected_format_version);
+    // conversion_version is bumped by the vehicle whenever it adds a
+    // parameter conversion, see AP_Param::conversions_done()
+    void load_parameters(AP_Int16 &format_version, const uint16_t expected_format_version,
+                         const uint16_t conversion_version = 0);
 
     virtual void set_control_channels() {}
 
@@ -333,6 +338,30 @@ protected:
     // Integration time; time last loop took to run
     float G_Dt;
 
+#if AP_VEHICLE_BOOT_PHASES_ENABLED
+    AP_BootPhases boot_phases;
+#endif
+
+    // start a timed phase of startup, see AP_BootPhases
+    void boot_phase(const char *name) {
+#if AP_VEHICLE_BOOT_PHASES_ENABLED
+        boot_phases.begin(name);
+#endif
+    }
+    // run fn in the background during startup where possible
+    void boot_run_async(const char *name, AP_HAL::MemberProc fn) {
+#if AP_VEHICLE_BOOT_PHASES_ENABLED
+        boot_phases.run_async(name, fn);
+#else
+        fn();
+#endif
+    }
+    void boot_wait_async() {
+#if AP_VEHICLE_BOOT_PHASES_ENABLED
+        boot_phases.wait_async();
+#endif
+    }
+
     // sensor drivers
 #if AP_GPS_ENABLED
     AP_GPS gps;
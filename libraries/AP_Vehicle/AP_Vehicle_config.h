@@ -5,3 +5,18 @@
 #ifndef AP_VEHICLE_ENABLED
 #define AP_VEHICLE_ENABLED 1
 #endif
+
+#ifndef AP_VEHICLE_BOOT_PHASES_ENABLED
+#define AP_VEHICLE_BOOT_PHASES_ENABLED AP_VEHICLE_ENABLED
+#endif
+
+// most phases of startup that are timed. Copter uses 17
+#ifndef AP_VEHICLE_BOOT_PHASES_MAX
+#define AP_VEHICLE_BOOT_PHASES_MAX 20
+#endif
+
+// probe independent sensors in their own threads during boot. Needs
+// a HAL whose device managers can be used from several threads
+#ifndef AP_VEHICLE_PARALLEL_PROBE_ENABLED
+#define AP_VEHICLE_PARALLEL_PROBE_ENABLED (AP_VEHICLE_BOOT_PHASES_ENABLED && CONFIG_HAL_BOARD == HAL_BOARD_LINUX)
+#endif
@@ -3,9 +3,12 @@
 #if AP_VEHICLE_ENABLED
 
 #include <AP_Param/AP_Param.h>
+#include <AP_Common/AP_FWVersion.h>
+#include <AP_Math/crc.h>
 #include <StorageManager/StorageManager.h>
 
-void AP_Vehicle::load_parameters(AP_Int16 &format_version, const uint16_t expected_format_version)
+void AP_Vehicle::load_parameters(AP_Int16 &format_version, const uint16_t expected_format_version,
+                                 const uint16_t conversion_version)
 {
     if (!format_version.load() ||
         format_version != expected_format_version) {
@@ -23,6 +26,23 @@ void AP_Vehicle::load_parameters(AP_Int16 &format_version, const uint16_t expect
 
     // Load all auto-loaded EEPROM variables
     AP_Param::load_all();
+
+    /*
+      parameter conversions are needed once for each firmware, which
+      is identified by its git hash, its parameter layout and the
+      vehicle's conversion version. The git hash doesn't change with
+      uncommitted work and the layout crc doesn't cover groups
+      allocated through pointers, so a development build that adds a
+      conversion must bump the conversion version for it to run on a
+      board that has already booted that build. Erasing the
+      parameters also runs the conversions again
+     */
+    const AP_FWVersion &fwver = AP::fwversion();
+    uint32_t id = AP_Param::var_info_crc();
+    id = crc_crc32(id, (const uint8_t *)&fwver.fw_hash, sizeof(fwver.fw_hash));
+    id = crc_crc32(id, (const uint8_t *)&expected_format_version, sizeof(expected_format_version));
+    id = crc_crc32(id, (const uint8_t *)&conversion_version, sizeof(conversion_version));
+    AP_Param::load_conversion_watermark(id);
 }
 
 #endif  // AP_VEHICLE_ENABLED
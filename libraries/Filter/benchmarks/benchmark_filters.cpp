@@ -0,0 +1,128 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_Math/AP_Math.h>
+#include <Filter/DerivativeFilter.h>
+#include <Filter/LowPassFilter2p.h>
+#include <Filter/ModeFilter.h>
+#include <Filter/NotchFilter.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+/*
+  filters applied to sensor data at loop rate. The input is a 1kHz
+  sample stream of a 20Hz signal with an 80Hz vibration on top
+ */
+
+#define NUM_SAMPLES 1024U
+static const float sample_rate_hz = 1000.0f;
+
+static float samples[NUM_SAMPLES];
+
+static void setup_samples()
+{
+    for (uint16_t i = 0; i < NUM_SAMPLES; i++) {
+        const float t = i / sample_rate_hz;
+        samples[i] = sinf(M_2PI * 20.0f * t) + 0.3f * sinf(M_2PI * 80.0f * t);
+    }
+}
+
+static void BM_LowPassFilter2pFloat(benchmark::State& state)
+{
+    setup_samples();
+    LowPassFilter2pFloat filter(sample_rate_hz, 40.0f);
+    uint16_t i = 0;
+
+    while (state.KeepRunning()) {
+        float out = filter.apply(samples[i++ % NUM_SAMPLES]);
+        gbenchmark_escape(&out);
+    }
+}
+
+static void BM_LowPassFilter2pVector3f(benchmark::State& state)
+{
+    setup_samples();
+    LowPassFilter2pVector3f filter(sample_rate_hz, 40.0f);
+    uint16_t i = 0;
+
+    while (state.KeepRunning()) {
+        const float s = samples[i++ % NUM_SAMPLES];
+        Vector3f out = filter.apply(Vector3f(s, -s, 0.5f * s));
+        gbenchmark_escape(&out);
+    }
+}
+
+static void BM_NotchFilterFloat(benchmark::State& state)
+{
+    setup_samples();
+    NotchFilterFloat filter;
+    filter.init(sample_rate_hz, 80.0f, 20.0f, 40.0f);
+    uint16_t i = 0;
+
+    while (state.KeepRunning()) {
+        float out = filter.apply(samples[i++ % NUM_SAMPLES]);
+        gbenchmark_escape(&out);
+    }
+}
+
+static void BM_NotchFilterVector3f(benchmark::State& state)
+{
+    setup_samples();
+    NotchFilterVector3f filter;
+    filter.init(sample_rate_hz, 80.0f, 20.0f, 40.0f);
+    uint16_t i = 0;
+
+    while (state.KeepRunning()) {
+        const float s = samples[i++ % NUM_SAMPLES];
+        Vector3f out = filter.apply(Vector3f(s, -s, 0.5f * s));
+        gbenchmark_escape(&out);
+    }
+}
+
+static void BM_NotchFilterInit(benchmark::State& state)
+{
+    NotchFilterFloat filter;
+    float center_freq_hz = 80.0f;
+
+    while (state.KeepRunning()) {
+        gbenchmark_escape(&center_freq_hz);
+        filter.init(sample_rate_hz, center_freq_hz, 20.0f, 40.0f);
+        gbenchmark_escape(&filter);
+    }
+}
+
+static void BM_DerivativeFilter(benchmark::State& state)
+{
+    setup_samples();
+    DerivativeFilterFloat_Size7 filter;
+    uint32_t timestamp_us = 0;
+    uint16_t i = 0;
+
+    while (state.KeepRunning()) {
+        filter.update(samples[i++ % NUM_SAMPLES], timestamp_us);
+        timestamp_us += 1000;
+        float slope = filter.slope();
+        gbenchmark_escape(&slope);
+    }
+}
+
+static void BM_ModeFilter(benchmark::State& state)
+{
+    setup_samples();
+    ModeFilterFloat_Size5 filter(2);
+    uint16_t i = 0;
+
+    while (state.KeepRunning()) {
+        float out = filter.apply(samples[i++ % NUM_SAMPLES]);
+        gbenchmark_escape(&out);
+    }
+}
+
+BENCHMARK(BM_LowPassFilter2pFloat);
+BENCHMARK(BM_LowPassFilter2pVector3f);
+BENCHMARK(BM_NotchFilterFloat);
+BENCHMARK(BM_NotchFilterVector3f);
+BENCHMARK(BM_NotchFilterInit);
+BENCHMARK(BM_DerivativeFilter);
+BENCHMARK(BM_ModeFilter);
+
+BENCHMARK_MAIN();
@@ -458,6 +458,9 @@ public:
       allow forwarding of packets / heartbeats to be blocked as required by some components to reduce traffic
     */
     static void disable_channel_routing(mavlink_channel_t chan) { routing.no_route_mask |= (1U<<(chan-MAVLINK_COMM_0)); }
+
+    // report the routing table and forwarding counters
+    static void routing_info(ExpandingString &str) { routing.info(str); }
     
     /*
       search for a component in the routing table with given mav_type and retrieve it's sysid, compid and channel
@@ -865,6 +868,33 @@ private:
     uint8_t sending_bucket_id = no_bucket_to_send;
     Bitmask<MSG_LAST> bucket_message_ids_to_send;
 
+#if AP_MAVLINK_STREAM_BUDGET_ENABLED
+    /*
+      token bucket limiting streamed messages to the estimated
+      capacity of the link, so that when the link is short of
+      capacity the priority messages in a bucket go first rather than
+      whichever fit. Tokens are bytes. Each update_send() adds the
+      capacity times the elapsed time, never banking more than the
+      space in the transmit buffer, and every byte written to the
+      link takes one. The capacity starts at the bandwidth of the
+      port and follows the transmit buffer from RADIO_STATUS received
+      on this link
+     */
+    struct {
+        int32_t tokens;
+        uint32_t capacity_bps;
+        uint32_t last_update_ms;
+        uint32_t last_tx_bytes;
+        // last RADIO_STATUS on this link
+        uint32_t radio_status_ms;
+    } send_budget;
+    void update_send_budget(uint32_t now_ms);
+    // adjust the capacity for the radio's transmit buffer free percentage
+    void update_send_budget_capacity(uint8_t txbuf);
+    // tokens left after the bytes sent since update_send_budget()
+    int32_t send_budget_remaining() const;
+#endif
+
     ap_message next_deferred_bucket_message_to_send(uint16_t now16_ms);
     void find_next_bucket_to_send(uint16_t now16_ms);
     void remove_message_from_bucket(int8_t bucket, ap_message id);
@@ -904,6 +904,10 @@ void GCS_MAVLINK::handle_radio_status(const mavlink_message_t &msg)
     }
 #endif
 
+#if AP_MAVLINK_STREAM_BUDGET_ENABLED
+    update_send_budget_capacity(packet.txbuf);
+#endif
+
 #if HAL_LOGGING_ENABLED
     //log rssi, noise, etc if logging Performance monitoring data
     if (AP::logger().should_log(log_radio_bit())) {
@@ -1196,7 +1200,11 @@ uint16_t GCS_MAVLINK::get_reschedule_interval_ms(const deferred_message_bucket_t
 {
     uint32_t interval_ms = deferred.interval_ms;
 
+#if !AP_MAVLINK_STREAM_BUDGET_ENABLED
+    // with the send budget the radio's transmit buffer sets the link
+    // capacity instead, and stream_slowdown_ms only stretches timeouts
     interval_ms += stream_slowdown_ms;
+#endif
 
     // slow most messages down if we're transfering parameters or
     // waypoints:
@@ -1222,6 +1230,79 @@ uint16_t GCS_MAVLINK::get_reschedule_interval_ms(const deferred_message_bucket_t
     return interval_ms;
 }
 
+#if AP_MAVLINK_STREAM_BUDGET_ENABLED
+/*
+  streamed messages sent first out of a bucket, and buckets holding
+  them sent first when several are due, so that the state a GCS needs
+  to fly by keeps its rate when the link is short of capacity
+ */
+static const uint16_t priority_message_ids[] {
+    MSG_ATTITUDE,
+    MSG_ATTITUDE_QUATERNION,
+    MSG_LOCATION,
+    MSG_SYS_STATUS,
+    MSG_VFR_HUD,
+};
+static const Bitmask<MSG_LAST> priority_messages{priority_message_ids};
+
+void GCS_MAVLINK::update_send_budget(uint32_t now_ms)
+{
+    const uint32_t max_bps = MAX(_port->bw_in_bytes_per_second(), 10U);
+    if (send_budget.capacity_bps == 0 || send_budget.capacity_bps > max_bps) {
+        send_budget.capacity_bps = max_bps;
+        send_budget.tokens = txspace();
+        send_budget.last_update_ms = now_ms;
+        send_budget.last_tx_bytes = mavlink_comm_tx_bytes[chan];
+    }
+
+    // without RADIO_STATUS there is nothing to say the link is short
+    // of capacity
+    if (send_budget.capacity_bps != max_bps &&
+        now_ms - send_budget.radio_status_ms > 5000) {
+        send_budget.capacity_bps = max_bps;
+    }
+
+    const uint32_t tx_bytes = mavlink_comm_tx_bytes[chan];
+    const uint32_t dt_ms = MIN(now_ms - send_budget.last_update_ms, 1000U);
+    int32_t tokens = send_budget.tokens;
+    tokens += send_budget.capacity_bps * dt_ms / 1000;
+    tokens -= int32_t(tx_bytes - send_budget.last_tx_bytes);
+    // there is no point banking more than the port can hold, and a
+    // burst of unbudgeted messages is paid back over at most a second
+    send_budget.tokens = constrain_int32(tokens, -int32_t(send_budget.capacity_bps), txspace());
+    send_budget.last_update_ms = now_ms;
+    send_budget.last_tx_bytes = tx_bytes;
+}
+
+int32_t GCS_MAVLINK::send_budget_remaining() const
+{
+    return send_budget.tokens - int32_t(mavlink_comm_tx_bytes[chan] - send_budget.last_tx_bytes);
+}
+
+/*
+  follow the transmit buffer of the radio on this link. RADIO_STATUS
+  comes at about 1Hz, so back off quickly and recover slowly
+ */
+void GCS_MAVLINK::update_send_budget_capacity(uint8_t txbuf)
+{
+    if (send_budget.capacity_bps == 0) {
+        // not sending streams yet
+        return;
+    }
+    send_budget.radio_status_ms = AP_HAL::millis();
+    const uint32_t max_bps = MAX(_port->bw_in_bytes_per_second(), 10U);
+    uint32_t capacity = send_budget.capacity_bps;
+    if (txbuf < 20) {
+        capacity = capacity * 3 / 4;
+    } else if (txbuf < 50) {
+        capacity = capacity * 7 / 8;
+    } else if (txbuf > 90) {
+        capacity += max_bps / 20;
+    }
+    send_budget.capacity_bps = constrain_uint32(capacity, max_bps / 20, max_bps);
+}
+#endif  // AP_MAVLINK_STREAM_BUDGET_ENABLED
+
 // typical runtime on fmuv3: 5 microseconds for 3 buckets
 void GCS_MAVLINK::find_next_bucket_to_send(uint16_t now16_ms)
 {
@@ -1233,6 +1314,12 @@ void GCS_MAVLINK::find_next_bucket_to_send(uint16_t now16_ms)
     // all done sending this bucket... find another bucket...
     sending_bucket_id = no_bucket_to_send;
     uint16_t ms_before_send_next_bucket_to_send = UINT16_MAX;
+#if AP_MAVLINK_STREAM_BUDGET_ENABLED
+    // of the buckets already due, prefer one holding a priority
+    // message, then the one furthest behind
+    bool next_bucket_has_priority = false;
+    uint16_t next_bucket_late_ms = 0;
+#endif
     for (uint8_t i=0; i<ARRAY_SIZE(deferred_message_bucket); i++) {
         if (deferred_message_bucket[i].ap_message_ids.count() == 0) {
             // no entries
@@ -1247,6 +1334,25 @@ void GCS_MAVLINK::find_next_bucket_to_send(uint16_t now16_ms)
         } else {
             ms_before_send_this_bucket = interval - ms_since_last_sent;
         }
+#if AP_MAVLINK_STREAM_BUDGET_ENABLED
+        if (ms_before_send_this_bucket == 0) {
+            const bool has_priority = deferred_message_bucket[i].ap_message_ids.first_set_in(priority_messages) != -1;
+            const uint16_t late_ms = ms_since_last_sent - interval;
+            if (ms_before_send_next_bucket_to_send == 0) {
+                if (has_priority < next_bucket_has_priority) {
+                    continue;
+                }
+                if (has_priority == next_bucket_has_priority && late_ms <= next_bucket_late_ms) {
+                    continue;
+                }
+            }
+            sending_bucket_id = i;
+            ms_before_send_next_bucket_to_send = 0;
+            next_bucket_has_priority = has_priority;
+            next_bucket_late_ms = late_ms;
+            continue;
+        }
+#endif
         if (ms_before_send_this_bucket < ms_before_send_next_bucket_to_send) {
             sending_bucket_id = i;
             ms_before_send_next_bucket_to_send = ms_before_send_this_bucket;
@@ -1280,7 +1386,14 @@ ap_message GCS_MAVLINK::next_deferred_bucket_message_to_send(uint16_t now16_ms)
         return no_message_to_send;
     }
 
+#if AP_MAVLINK_STREAM_BUDGET_ENABLED
+    int16_t next = bucket_message_ids_to_send.first_set_in(priority_messages);
+    if (next == -1) {
+        next = bucket_message_ids_to_send.first_set();
+    }
+#else
     const int16_t next = bucket_message_ids_to_send.first_set();
+#endif
     if (next == -1) {
         // should not happen
 #if CONFIG_HAL_BOARD == HAL_BOARD_SITL
@@ -1527,6 +1640,9 @@ void GCS_MAVLINK::update_send()
 
     const uint32_t start = AP_HAL::millis();
     const uint16_t start16 = start & 0xFFFF;
+#if AP_MAVLINK_STREAM_BUDGET_ENABLED
+    update_send_budget(start);
+#endif
     while (AP_HAL::millis() - start < 5) { // spend a max of 5ms sending messages.  This should never trigger - out_of_time() should become true
         if (gcs().out_of_time()) {
 #if GCS_DEBUG_SEND_MESSAGE_TIMINGS
@@ -1587,6 +1703,13 @@ void GCS_MAVLINK::update_send()
             continue;
         }
 
+#if AP_MAVLINK_STREAM_BUDGET_ENABLED
+        // specially handled and pushed messages are always tried, but
+        // the bytes they take come out of the budget for streams
+        if (send_budget_remaining() <= 0) {
+            break;
+        }
+#endif
         ap_message next = next_deferred_bucket_message_to_send(start16);
         if (next != no_message_to_send) {
             if (!do_try_send_message(next)) {
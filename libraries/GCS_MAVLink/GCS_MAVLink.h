@@ -46,6 +46,8 @@
 /// MAVLink streams used for each telemetry port
 extern AP_HAL::UARTDriver	*mavlink_comm_port[MAVLINK_COMM_NUM_BUFFERS];
 extern bool gcs_alternative_active[MAVLINK_COMM_NUM_BUFFERS];
+/// bytes written to each telemetry port
+extern uint32_t mavlink_comm_tx_bytes[MAVLINK_COMM_NUM_BUFFERS];
 
 /// MAVLink system definition
 extern mavlink_system_t mavlink_system;
@@ -61,7 +63,7 @@ static inline bool valid_channel(mavlink_channel_t chan)
 mavlink_message_t* mavlink_get_channel_buffer(uint8_t chan);
 mavlink_status_t* mavlink_get_channel_status(uint8_t chan);
 
-void comm_send_buffer(mavlink_channel_t chan, const uint8_t *buf, uint8_t len);
+void comm_send_buffer(mavlink_channel_t chan, const uint8_t *buf, uint16_t len);
 
 /// Check for available transmit space on the nominated MAVLink channel
 ///
@@ -13,6 +13,12 @@
 #define HAL_MAVLINK_BINDINGS_ENABLED HAL_GCS_ENABLED
 #endif
 
+// limit streamed messages to an estimate of the link capacity,
+// sending the most important ones first
+#ifndef AP_MAVLINK_STREAM_BUDGET_ENABLED
+#define AP_MAVLINK_STREAM_BUDGET_ENABLED 1
+#endif
+
 #ifndef HAL_HIGH_LATENCY2_ENABLED
 #define HAL_HIGH_LATENCY2_ENABLED 1
 #endif
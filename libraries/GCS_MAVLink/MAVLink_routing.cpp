@@ -23,6 +23,7 @@
 #include <stdio.h>
 #include <AP_HAL/AP_HAL.h>
 #include <AP_Common/AP_Common.h>
+#include <AP_Common/ExpandingString.h>
 #include "GCS.h"
 #include "MAVLink_routing.h"
 
@@ -32,9 +33,24 @@ extern const AP_HAL::HAL& hal;
 
 #define ROUTING_DEBUG 0
 
+static_assert((1U<<MAVLINK_ROUTE_HASH_BITS) > MAVLINK_MAX_ROUTES, "route hash tables need an empty slot");
+static_assert(MAVLINK_COMM_NUM_BUFFERS <= 8, "channel masks are 8 bits");
+
 // constructor
 MAVLink_routing::MAVLink_routing(void) : num_routes(0) {}
 
+// Fibonacci hash of a 16 bit key to a slot in the hash tables
+static inline uint8_t route_hash(uint16_t key)
+{
+    return uint16_t(key * 40503U) >> (16 - MAVLINK_ROUTE_HASH_BITS);
+}
+
+// lowest numbered channel in a channel mask
+static inline mavlink_channel_t first_channel(uint8_t chan_mask)
+{
+    return (mavlink_channel_t)(MAVLINK_COMM_0 + __builtin_ffs(chan_mask) - 1);
+}
+
 /*
   forward a MAVLink message to the right port. This also
   automatically learns the route for the sender if it is not
@@ -119,6 +135,7 @@ bool MAVLink_routing::check_and_forward(GCS_MAVLINK &in_link, const mavlink_mess
     if (msg.msgid == MAVLINK_MSG_ID_RADIO ||
         msg.msgid == MAVLINK_MSG_ID_RADIO_STATUS) {
         // don't forward RADIO packets
+        stats.filtered++;
         return true;
     }
 
@@ -137,6 +154,7 @@ bool MAVLink_routing::check_and_forward(GCS_MAVLINK &in_link, const mavlink_mess
         // if enabled ADSB packets are not forwarded, they have their own stream rate
         const AP_ADSB *adsb = AP::ADSB();
         if ((adsb != nullptr) && (adsb->enabled())) {
+            stats.filtered++;
             return true;
         }
     }
@@ -163,6 +181,7 @@ bool MAVLink_routing::check_and_forward(GCS_MAVLINK &in_link, const mavlink_mess
     }
 #endif
     if (should_process_locally) {
+        stats.filtered++;
         return process_locally;
     }
 
@@ -172,44 +191,12 @@ bool MAVLink_routing::check_and_forward(GCS_MAVLINK &in_link, const mavlink_mess
     }
 
     // forward on any channels matching the targets
-    bool forwarded = false;
-    bool sent_to_chan[MAVLINK_COMM_NUM_BUFFERS];
-    memset(sent_to_chan, 0, sizeof(sent_to_chan));
-    for (uint8_t i=0; i<num_routes; i++) {
-
-        // Skip if channel is private and the target system or component IDs do not match
-        GCS_MAVLINK *out_link = gcs().chan(routes[i].channel);
-        if (out_link == nullptr) {
-            // this is bad
-            continue;
-        }
-        if (out_link->is_private() &&
-            (target_system != routes[i].sysid ||
-             target_component != routes[i].compid)) {
-            continue;
-        }
-
-        if (broadcast_system || (target_system == routes[i].sysid &&
-                                 (broadcast_component || 
-                                  target_component == routes[i].compid ||
-                                  !match_system))) {
-
-            if (&in_link != out_link && !sent_to_chan[routes[i].channel]) {
-                if (out_link->check_payload_size(msg.len)) {
-#if ROUTING_DEBUG
-                    ::printf("fwd msg %u from chan %u on chan %u sysid=%d compid=%d\n",
-                             msg.msgid,
-                             (unsigned)in_link.get_chan(),
-                             (unsigned)routes[i].channel,
-                             (int)target_system,
-                             (int)target_component);
-#endif
-                    _mavlink_resend_uart(routes[i].channel, &msg);
-                }
-                sent_to_chan[routes[i].channel] = true;
-                forwarded = true;
-            }
-        }
+    const uint8_t chan_mask = forward_mask(target_system, target_component, match_system,
+                                           GCS_MAVLINK::private_channel_mask(),
+                                           in_link.get_chan());
+    const bool forwarded = chan_mask != 0;
+    if (forwarded) {
+        forward(msg, chan_mask);
     }
 
     if ((!forwarded && match_system) ||
@@ -220,6 +207,46 @@ bool MAVLink_routing::check_and_forward(GCS_MAVLINK &in_link, const mavlink_mess
     return process_locally;
 }
 
+/*
+  the channels a message for target_system/target_component is
+  forwarded on. That is every channel the target has been seen on,
+  except for private channels, which only get messages addressed to a
+  sysid/compid seen on them
+*/
+uint8_t MAVLink_routing::forward_mask(int16_t target_system, int16_t target_component, bool match_system,
+                                      uint8_t private_mask, mavlink_channel_t in_chan)
+{
+    const bool broadcast_system = (target_system == 0 || target_system == -1);
+    const bool broadcast_component = (target_component == 0 || target_component == -1);
+
+    int8_t target_route = -1;
+    if (target_system > 0 && target_component >= 0) {
+        target_route = find_route(target_system, target_component);
+    }
+    uint8_t chan_mask = 0;
+    if (broadcast_system) {
+        chan_mask = routed_channels;
+    } else if (broadcast_component || !match_system) {
+        // to any component of another system, or to all components
+        // of this one
+        const int8_t s = find_system(target_system);
+        if (s != -1) {
+            chan_mask = systems[s].channels;
+        }
+    } else if (target_route != -1) {
+        chan_mask = routes[target_route].channels;
+    }
+    if (target_route != -1) {
+        private_mask &= ~routes[target_route].channels;
+    }
+    if (chan_mask & private_mask) {
+        chan_mask &= ~private_mask;
+        stats.filtered++;
+    }
+    chan_mask &= ~(1U<<(in_chan-MAVLINK_COMM_0));
+    return chan_mask;
+}
+
 /*
   send a MAVLink message to all components with this vehicle's system id
 
@@ -236,29 +263,27 @@ void MAVLink_routing::send_to_components(uint32_t msgid, const char *pkt, uint8_
 
 void MAVLink_routing::send_to_components(const char *pkt, const mavlink_msg_entry_t *entry, const uint8_t pkt_len)
 {
-    bool sent_to_chan[MAVLINK_COMM_NUM_BUFFERS] {};
-
-    // check learned routes
-    for (uint8_t i=0; i<num_routes; i++) {
-        if (routes[i].sysid != mavlink_system.sysid) {
-            // our system ID hasn't been seen on this link
-            continue;
-        }
-        if (sent_to_chan[routes[i].channel]) {
-            // we've already send it on this link
+    // send on each channel our system ID has been seen on
+    const int8_t s = find_system(mavlink_system.sysid);
+    if (s == -1) {
+        return;
+    }
+    const uint8_t chan_mask = systems[s].channels;
+    for (uint8_t i=0; i<MAVLINK_COMM_NUM_BUFFERS; i++) {
+        if ((chan_mask & (1U<<i)) == 0) {
             continue;
         }
-        if (comm_get_txspace(routes[i].channel) <
-            ((uint16_t)entry->max_msg_len) + GCS_MAVLINK::packet_overhead_chan(routes[i].channel)) {
+        const mavlink_channel_t channel = (mavlink_channel_t)(MAVLINK_COMM_0 + i);
+        if (comm_get_txspace(channel) <
+            ((uint16_t)entry->max_msg_len) + GCS_MAVLINK::packet_overhead_chan(channel)) {
             // it doesn't fit on this channel
             continue;
         }
 #if ROUTING_DEBUG
-        ::printf("send msg %u on chan %u sysid=%u compid=%u\n",
+        ::printf("send msg %u on chan %u sysid=%u\n",
                  entry->msgid,
-                 (unsigned)routes[i].channel,
-                 (unsigned)routes[i].sysid,
-                 (unsigned)routes[i].compid);
+                 (unsigned)channel,
+                 (unsigned)mavlink_system.sysid);
 #endif
 #if CONFIG_HAL_BOARD == HAL_BOARD_SITL
         if (entry->max_msg_len > pkt_len) {
@@ -266,13 +291,12 @@ void MAVLink_routing::send_to_components(const char *pkt, const mavlink_msg_entr
                           entry->max_msg_len, pkt_len);
         }
 #endif
-        _mav_finalize_message_chan_send(routes[i].channel,
+        _mav_finalize_message_chan_send(channel,
                                         entry->msgid,
                                         pkt,
                                         entry->min_msg_len,
                                         MIN(entry->max_msg_len, pkt_len),
                                         entry->crc_extra);
-        sent_to_chan[routes[i].channel] = true;
     }
 }
 
@@ -287,7 +311,7 @@ bool MAVLink_routing::find_by_mavtype(uint8_t mavtype, uint8_t &sysid, uint8_t &
         if (routes[i].mavtype == mavtype) {
             sysid = routes[i].sysid;
             compid = routes[i].compid;
-            channel = routes[i].channel;
+            channel = first_channel(routes[i].channels);
             return true;
         }
     }
@@ -305,7 +329,7 @@ bool MAVLink_routing::find_by_mavtype_and_compid(uint8_t mavtype, uint8_t compid
     for (uint8_t i=0; i<num_routes; i++) {
         if ((routes[i].mavtype == mavtype) && (routes[i].compid == compid)) {
             sysid = routes[i].sysid;
-            channel = routes[i].channel;
+            channel = first_channel(routes[i].channels);
             return true;
         }
     }
@@ -317,7 +341,6 @@ bool MAVLink_routing::find_by_mavtype_and_compid(uint8_t mavtype, uint8_t compid
 */
 void MAVLink_routing::learn_route(GCS_MAVLINK &in_link, const mavlink_message_t &msg)
 {
-    uint8_t i;
     if (msg.sysid == 0) {
         // don't learn routes to the broadcast system
         return;
@@ -334,35 +357,166 @@ void MAVLink_routing::learn_route(GCS_MAVLINK &in_link, const mavlink_message_t
         // should also process them locally.
         return;
     }
-    const mavlink_channel_t in_channel = in_link.get_chan();
-    for (i=0; i<num_routes; i++) {
-        if (routes[i].sysid == msg.sysid &&
-            routes[i].compid == msg.compid &&
-            routes[i].channel == in_channel) {
-            if (routes[i].mavtype == 0 && msg.msgid == MAVLINK_MSG_ID_HEARTBEAT) {
-                routes[i].mavtype = mavlink_msg_heartbeat_get_type(&msg);
-            }
-            break;
+    const int8_t r = add_route(msg.sysid, msg.compid, in_link.get_chan());
+    if (r != -1 && routes[r].mavtype == 0 && msg.msgid == MAVLINK_MSG_ID_HEARTBEAT) {
+        routes[r].mavtype = mavlink_msg_heartbeat_get_type(&msg);
+    }
+}
+
+int8_t MAVLink_routing::add_route(uint8_t sysid, uint8_t compid, mavlink_channel_t chan)
+{
+    const uint8_t chan_bit = 1U<<(chan-MAVLINK_COMM_0);
+
+    int8_t r = find_route(sysid, compid);
+    if (r == -1) {
+        if (num_routes >= MAVLINK_MAX_ROUTES) {
+            return -1;
+        }
+        r = num_routes++;
+        routes[r].sysid = sysid;
+        routes[r].compid = compid;
+        routes[r].channels = 0;
+        routes[r].mavtype = 0;
+        uint8_t h = route_hash((sysid<<8) | compid);
+        while (route_index[h] != 0) {
+            h = (h + 1) % ARRAY_SIZE(route_index);
         }
+        route_index[h] = r + 1;
     }
-    if (i == num_routes && i<MAVLINK_MAX_ROUTES) {
-        routes[i].sysid = msg.sysid;
-        routes[i].compid = msg.compid;
-        routes[i].channel = in_channel;
-        if (msg.msgid == MAVLINK_MSG_ID_HEARTBEAT) {
-            routes[i].mavtype = mavlink_msg_heartbeat_get_type(&msg);
+    if (routes[r].channels & chan_bit) {
+        // already known
+        return r;
+    }
+    routes[r].channels |= chan_bit;
+
+    int8_t s = find_system(sysid);
+    if (s == -1) {
+        // there can't be more systems than routes
+        s = num_systems++;
+        systems[s].sysid = sysid;
+        systems[s].channels = 0;
+        uint8_t h = route_hash(sysid);
+        while (system_index[h] != 0) {
+            h = (h + 1) % ARRAY_SIZE(system_index);
         }
-        num_routes++;
+        system_index[h] = s + 1;
+    }
+    systems[s].channels |= chan_bit;
+    routed_channels |= chan_bit;
+
 #if ROUTING_DEBUG
-        ::printf("learned route %u %u via %u\n",
+    ::printf("learned route %u %u via %u\n",
+             (unsigned)sysid,
+             (unsigned)compid,
+             (unsigned)chan);
+#endif
+    return r;
+}
+
+int8_t MAVLink_routing::find_route(uint8_t sysid, uint8_t compid) const
+{
+    for (uint8_t h = route_hash((sysid<<8) | compid);
+         route_index[h] != 0;
+         h = (h + 1) % ARRAY_SIZE(route_index)) {
+        const uint8_t r = route_index[h] - 1;
+        if (routes[r].sysid == sysid && routes[r].compid == compid) {
+            return r;
+        }
+    }
+    return -1;
+}
+
+int8_t MAVLink_routing::find_system(uint8_t sysid) const
+{
+    for (uint8_t h = route_hash(sysid);
+         system_index[h] != 0;
+         h = (h + 1) % ARRAY_SIZE(system_index)) {
+        const uint8_t s = system_index[h] - 1;
+        if (systems[s].sysid == sysid) {
+            return s;
+        }
+    }
+    return -1;
+}
+
+/*
+  pack a message into a frame as _mavlink_resend_uart() sends it, with
+  the payload length, checksum and signature as received. This can't
+  use mavlink_msg_to_send_buffer(), which trims trailing zeros from a
+  MAVLink2 payload that the sender may not have trimmed, leaving a
+  frame that doesn't match its checksum or signature
+*/
+uint16_t MAVLink_routing::pack_frame(uint8_t *buf, const mavlink_message_t &msg)
+{
+    uint16_t n = 0;
+    buf[n++] = msg.magic;
+    buf[n++] = msg.len;
+    if (msg.magic == MAVLINK_STX_MAVLINK1) {
+        buf[n++] = msg.seq;
+        buf[n++] = msg.sysid;
+        buf[n++] = msg.compid;
+        buf[n++] = msg.msgid & 0xFF;
+    } else {
+        buf[n++] = msg.incompat_flags;
+        buf[n++] = msg.compat_flags;
+        buf[n++] = msg.seq;
+        buf[n++] = msg.sysid;
+        buf[n++] = msg.compid;
+        buf[n++] = msg.msgid & 0xFF;
+        buf[n++] = (msg.msgid >> 8) & 0xFF;
+        buf[n++] = (msg.msgid >> 16) & 0xFF;
+    }
+    memcpy(&buf[n], _MAV_PAYLOAD(&msg), msg.len);
+    n += msg.len;
+    buf[n++] = msg.checksum & 0xFF;
+    buf[n++] = msg.checksum >> 8;
+    if (msg.magic != MAVLINK_STX_MAVLINK1 && (msg.incompat_flags & MAVLINK_IFLAG_SIGNED)) {
+        memcpy(&buf[n], msg.signature, MAVLINK_SIGNATURE_BLOCK_LEN);
+        n += MAVLINK_SIGNATURE_BLOCK_LEN;
+    }
+    return n;
+}
+
+/*
+  send a message unchanged on each channel in chan_mask. The frame is
+  packed once and the same bytes written to every channel, rather than
+  being packed again for each one
+*/
+void MAVLink_routing::forward(const mavlink_message_t &msg, uint8_t chan_mask)
+{
+    uint8_t frame[MAVLINK_MAX_PACKET_LEN];
+    uint16_t frame_len = 0;
+    for (uint8_t i=0; i<MAVLINK_COMM_NUM_BUFFERS; i++) {
+        if ((chan_mask & (1U<<i)) == 0) {
+            continue;
+        }
+        const mavlink_channel_t channel = (mavlink_channel_t)(MAVLINK_COMM_0 + i);
+        GCS_MAVLINK *out_link = gcs().chan(channel);
+        if (out_link == nullptr) {
+            // this is bad
+            continue;
+        }
+        if (!out_link->check_payload_size(msg.len)) {
+            stats.dropped++;
+            continue;
+        }
+        if (frame_len == 0) {
+            frame_len = pack_frame(frame, msg);
+        }
+#if ROUTING_DEBUG
+        ::printf("fwd msg %u from sysid=%u compid=%u on chan %u\n",
+                 (unsigned)msg.msgid,
                  (unsigned)msg.sysid,
                  (unsigned)msg.compid,
-                 (unsigned)in_channel);
+                 (unsigned)channel);
 #endif
+        comm_send_lock(channel, frame_len);
+        comm_send_buffer(channel, frame, frame_len);
+        comm_send_unlock(channel);
+        stats.forwarded++;
     }
 }
 
-
 /*
   special handling for heartbeat messages. To ensure routing
   propagation heartbeat messages need to be forwarded on all channels
@@ -370,49 +524,38 @@ void MAVLink_routing::learn_route(GCS_MAVLINK &in_link, const mavlink_message_t
 */
 void MAVLink_routing::handle_heartbeat(GCS_MAVLINK &link, const mavlink_message_t &msg)
 {
-    uint16_t mask = GCS_MAVLINK::active_channel_mask() & ~GCS_MAVLINK::private_channel_mask();
+    const uint8_t mask = heartbeat_mask(msg.sysid, msg.compid, link.get_chan(),
+                                        GCS_MAVLINK::active_channel_mask(),
+                                        GCS_MAVLINK::private_channel_mask());
+    if (mask == 0) {
+        // nothing to send to
+        return;
+    }
 
-    const mavlink_channel_t in_channel = link.get_chan();
+    // send on the remaining channels
+    forward(msg, mask);
+}
+
+uint8_t MAVLink_routing::heartbeat_mask(uint8_t sysid, uint8_t compid, mavlink_channel_t in_chan,
+                                        uint8_t active_mask, uint8_t private_mask) const
+{
+    uint8_t mask = active_mask & ~private_mask;
 
     // don't send on the incoming channel. This should only matter if
     // the routing table is full
-    mask &= ~(1U<<(in_channel-MAVLINK_COMM_0));
+    mask &= ~(1U<<(in_chan-MAVLINK_COMM_0));
     
     // mask out channels that do not want the heartbeat to be forwarded
     mask &= ~no_route_mask;
     
     // mask out channels that are known sources for this sysid/compid
-    for (uint8_t i=0; i<num_routes; i++) {
-        if (routes[i].sysid == msg.sysid && routes[i].compid == msg.compid) {
-            mask &= ~(1U<<((unsigned)(routes[i].channel-MAVLINK_COMM_0)));
-        }
-    }
-
-    if (mask == 0) {
-        // nothing to send to
-        return;
-    }
-
-    // send on the remaining channels
-    for (uint8_t i=0; i<MAVLINK_COMM_NUM_BUFFERS; i++) {
-        if (mask & (1U<<i)) {
-            mavlink_channel_t channel = (mavlink_channel_t)(MAVLINK_COMM_0 + i);
-            if (comm_get_txspace(channel) >= ((uint16_t)msg.len) +
-                GCS_MAVLINK::packet_overhead_chan(channel)) {
-#if ROUTING_DEBUG
-                ::printf("fwd HB from chan %u on chan %u from sysid=%u compid=%u\n",
-                         (unsigned)in_channel,
-                         (unsigned)channel,
-                         (unsigned)msg.sysid,
-                         (unsigned)msg.compid);
-#endif
-                _mavlink_resend_uart(channel, &msg);
-            }
-        }
+    const int8_t r = find_route(sysid, compid);
+    if (r != -1) {
+        mask &= ~routes[r].channels;
     }
+    return mask;
 }
 
-
 /*
   extract target sysid and compid from a message. int16_t is used so
   that the caller can set them to -1 and know when a sysid or compid
@@ -432,4 +575,22 @@ void MAVLink_routing::get_targets(const mavlink_message_t &msg, int16_t &sysid,
     }
 }
 
+/*
+  report the routing table and counters
+*/
+void MAVLink_routing::info(ExpandingString &str) const
+{
+    str.printf("forwarded=%u dropped=%u filtered=%u\n",
+               (unsigned)stats.forwarded,
+               (unsigned)stats.dropped,
+               (unsigned)stats.filtered);
+    for (uint8_t i=0; i<num_routes; i++) {
+        str.printf("sysid=%-3u compid=%-3u type=%-3u chans=0x%02x\n",
+                   (unsigned)routes[i].sysid,
+                   (unsigned)routes[i].compid,
+                   (unsigned)routes[i].mavtype,
+                   (unsigned)routes[i].channels);
+    }
+}
+
 #endif  // HAL_GCS_ENABLED
@@ -5,16 +5,23 @@
 #include <AP_Common/AP_Common.h>
 #include "GCS_MAVLink.h"
 
-// 20 routes should be enough for now. This may need to increase as
-// we make more extensive use of MAVLink forwarding
+class ExpandingString;
+
+// maximum number of sysid/compid pairs we can route to. Each may be
+// reachable on any number of channels
 #define MAVLINK_MAX_ROUTES 20
 
+// log2 of the number of slots in the route and system hash tables,
+// which must be more than MAVLINK_MAX_ROUTES
+#define MAVLINK_ROUTE_HASH_BITS 5
+
 /*
   object to handle MAVLink packet routing
  */
 class MAVLink_routing
 {
     friend class GCS_MAVLINK;
+    friend class MAVLink_routing_Test;
     
 public:
     MAVLink_routing(void);
@@ -49,23 +56,79 @@ public:
      */
     bool find_by_mavtype_and_compid(uint8_t mavtype, uint8_t compid, uint8_t &sysid, mavlink_channel_t &channel) const;
 
+    struct Stats {
+        uint32_t forwarded;     // messages sent on another channel
+        uint32_t dropped;       // forwards lost to a full channel
+        uint32_t filtered;      // messages routing policy kept from other channels
+    };
+    const Stats &get_stats() const { return stats; }
+
+    // report the routing table and counters
+    void info(ExpandingString &str) const;
+
 private:
-    // a simple linear routing table. We don't expect to have a lot of
-    // routes, so a scalable structure isn't worthwhile yet.
+    /*
+      the routes are kept in the order they are learned, with a
+      channel bitmask for each sysid/compid pair and for each sysid
+      so that a message is routed with one or two lookups whatever
+      the number of routes and channels. The lookups are through
+      open addressed hash tables of route number plus one, zero being
+      an empty slot. Routes are never removed, so no tombstones are
+      needed
+     */
     uint8_t num_routes;
     struct route {
         uint8_t sysid;
         uint8_t compid;
-        mavlink_channel_t channel;
+        uint8_t channels;   // bitmask of channels the pair has been seen on
         uint8_t mavtype;
     } routes[MAVLINK_MAX_ROUTES];
-    
+    uint8_t route_index[1U<<MAVLINK_ROUTE_HASH_BITS] {};
+
+    uint8_t num_systems {};
+    struct system {
+        uint8_t sysid;
+        uint8_t channels;   // bitmask of channels any component of sysid has been seen on
+    } systems[MAVLINK_MAX_ROUTES];
+    uint8_t system_index[1U<<MAVLINK_ROUTE_HASH_BITS] {};
+
+    // channels any route has been seen on
+    uint8_t routed_channels {};
+
+    Stats stats {};
+
     // a channel mask to block routing as required
-    uint8_t no_route_mask;
-    
+    uint8_t no_route_mask {};
+
+    // lookups in the hash tables, returning the index in routes or
+    // systems, or -1 if not known
+    int8_t find_route(uint8_t sysid, uint8_t compid) const;
+    int8_t find_system(uint8_t sysid) const;
+
     // learn new routes
     void learn_route(GCS_MAVLINK &link, const mavlink_message_t &msg);
 
+    // note that sysid/compid has been seen on chan, returning the
+    // route or -1 if the table is full
+    int8_t add_route(uint8_t sysid, uint8_t compid, mavlink_channel_t chan);
+
+    // channels other than in_chan to forward a message for
+    // target_system/target_component on
+    uint8_t forward_mask(int16_t target_system, int16_t target_component, bool match_system,
+                         uint8_t private_mask, mavlink_channel_t in_chan);
+
+    // channels other than in_chan to forward a heartbeat from
+    // sysid/compid on
+    uint8_t heartbeat_mask(uint8_t sysid, uint8_t compid, mavlink_channel_t in_chan,
+                           uint8_t active_mask, uint8_t private_mask) const;
+
+    // send msg unchanged on each channel in chan_mask
+    void forward(const mavlink_message_t &msg, uint8_t chan_mask);
+
+    // pack msg into buf byte for byte as it was received, returning
+    // the frame length. buf must hold MAVLINK_MAX_PACKET_LEN bytes
+    static uint16_t pack_frame(uint8_t *buf, const mavlink_message_t &msg);
+
     // extract target sysid and compid from a message
     void get_targets(const mavlink_message_t &msg, int16_t &sysid, int16_t &compid);
 
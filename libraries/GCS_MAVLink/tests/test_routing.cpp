@@ -0,0 +1,333 @@
+#include <AP_gtest.h>
+
+#include <GCS_MAVLink/GCS_config.h>
+#include <string.h>
+#include <stdlib.h>
+
+const AP_HAL::HAL &hal = AP_HAL::get_HAL();
+
+#if HAL_GCS_ENABLED
+
+#include <GCS_MAVLink/GCS.h>
+#include <GCS_MAVLink/MAVLink_routing.h>
+
+// the number of channels the tests route between
+#define NUM_CHANS MIN(MAVLINK_COMM_NUM_BUFFERS, 6)
+
+/*
+  the routing table as it was kept before the hash tables, one entry
+  per sysid/compid/channel, with the masks worked out route by route
+ */
+class OldRouting {
+public:
+    void add(uint8_t sysid, uint8_t compid, uint8_t chan) {
+        for (uint8_t i=0; i<num_routes; i++) {
+            if (routes[i].sysid == sysid && routes[i].compid == compid && routes[i].chan == chan) {
+                return;
+            }
+        }
+        routes[num_routes++] = { sysid, compid, chan };
+    }
+
+    uint8_t forward_mask(int16_t target_system, int16_t target_component, bool match_system,
+                         uint8_t private_mask, uint8_t in_chan) const {
+        const bool broadcast_system = (target_system == 0 || target_system == -1);
+        const bool broadcast_component = (target_component == 0 || target_component == -1);
+        uint8_t mask = 0;
+        for (uint8_t i=0; i<num_routes; i++) {
+            if ((private_mask & (1U<<routes[i].chan)) &&
+                (target_system != routes[i].sysid ||
+                 target_component != routes[i].compid)) {
+                continue;
+            }
+            if (broadcast_system || (target_system == routes[i].sysid &&
+                                     (broadcast_component ||
+                                      target_component == routes[i].compid ||
+                                      !match_system))) {
+                if (routes[i].chan != in_chan) {
+                    mask |= 1U<<routes[i].chan;
+                }
+            }
+        }
+        return mask;
+    }
+
+    uint8_t heartbeat_mask(uint8_t sysid, uint8_t compid, uint8_t in_chan,
+                           uint8_t active_mask, uint8_t private_mask, uint8_t no_route_mask) const {
+        uint8_t mask = active_mask & ~private_mask & ~(1U<<in_chan) & ~no_route_mask;
+        for (uint8_t i=0; i<num_routes; i++) {
+            if (routes[i].sysid == sysid && routes[i].compid == compid) {
+                mask &= ~(1U<<routes[i].chan);
+            }
+        }
+        return mask;
+    }
+
+private:
+    struct {
+        uint8_t sysid;
+        uint8_t compid;
+        uint8_t chan;
+    } routes[MAVLINK_MAX_ROUTES * NUM_CHANS];
+    uint8_t num_routes;
+};
+
+class MAVLink_routing_Test {
+public:
+    void add(uint8_t sysid, uint8_t compid, uint8_t chan) {
+        ASSERT_NE(-1, routing.add_route(sysid, compid, mavlink_channel_t(MAVLINK_COMM_0 + chan)));
+        old.add(sysid, compid, chan);
+    }
+
+    void set_no_route_mask(uint8_t mask) { routing.no_route_mask = mask; }
+
+    // check a message for the targets goes where it used to
+    void check_forward(int16_t target_system, int16_t target_component,
+                       uint8_t private_mask, uint8_t in_chan) {
+        const bool broadcast_system = (target_system == 0 || target_system == -1);
+        const bool match_system = broadcast_system || (target_system == mavlink_system.sysid);
+        EXPECT_EQ(old.forward_mask(target_system, target_component, match_system, private_mask, in_chan),
+                  routing.forward_mask(target_system, target_component, match_system, private_mask,
+                                       mavlink_channel_t(MAVLINK_COMM_0 + in_chan)))
+            << "target " << target_system << "/" << target_component
+            << " private 0x" << std::hex << unsigned(private_mask)
+            << " in_chan " << unsigned(in_chan);
+    }
+
+    void check_heartbeat(uint8_t sysid, uint8_t compid, uint8_t in_chan,
+                         uint8_t active_mask, uint8_t private_mask, uint8_t no_route_mask) {
+        set_no_route_mask(no_route_mask);
+        EXPECT_EQ(old.heartbeat_mask(sysid, compid, in_chan, active_mask, private_mask, no_route_mask),
+                  routing.heartbeat_mask(sysid, compid, mavlink_channel_t(MAVLINK_COMM_0 + in_chan),
+                                         active_mask, private_mask))
+            << "from " << unsigned(sysid) << "/" << unsigned(compid)
+            << " in_chan " << unsigned(in_chan);
+    }
+
+    uint8_t forward_mask(int16_t target_system, int16_t target_component,
+                         uint8_t private_mask, uint8_t in_chan) {
+        const bool match_system = target_system <= 0 || target_system == mavlink_system.sysid;
+        return routing.forward_mask(target_system, target_component, match_system, private_mask,
+                                    mavlink_channel_t(MAVLINK_COMM_0 + in_chan));
+    }
+
+    static uint16_t pack_frame(uint8_t *buf, const mavlink_message_t &msg) {
+        return MAVLink_routing::pack_frame(buf, msg);
+    }
+
+private:
+    MAVLink_routing routing;
+    OldRouting old {};
+};
+
+static const uint8_t our_sysid = 1;
+static const uint8_t our_compid = MAV_COMP_ID_AUTOPILOT1;
+
+static void set_our_ids()
+{
+    mavlink_system.sysid = our_sysid;
+    mavlink_system.compid = our_compid;
+}
+
+TEST(MAVLinkRouting, broadcast)
+{
+    set_our_ids();
+    MAVLink_routing_Test r;
+    r.add(255, 190, 0);
+    r.add(2, 1, 1);
+    r.add(our_sysid, MAV_COMP_ID_CAMERA, 2);
+    r.add(3, 1, 3);
+
+    // to all channels a route has been seen on but the incoming one,
+    // with or without a target component
+    EXPECT_EQ(0x0e, r.forward_mask(-1, -1, 0, 0));
+    EXPECT_EQ(0x0e, r.forward_mask(0, 0, 0, 0));
+    EXPECT_EQ(0x0d, r.forward_mask(0, 1, 0, 1));
+    // but never on a private channel
+    EXPECT_EQ(0x06, r.forward_mask(0, -1, 0x08, 0));
+
+    r.check_forward(-1, -1, 0, 0);
+    r.check_forward(0, 1, 0x08, 1);
+}
+
+TEST(MAVLinkRouting, targeted)
+{
+    set_our_ids();
+    MAVLink_routing_Test r;
+    r.add(255, 190, 0);
+    r.add(2, 1, 1);
+    r.add(2, MAV_COMP_ID_GIMBAL, 2);
+    r.add(our_sysid, MAV_COMP_ID_CAMERA, 3);
+    r.add(our_sysid, MAV_COMP_ID_GIMBAL, 4);
+
+    // another system goes to every channel it has been seen on,
+    // whatever the component
+    EXPECT_EQ(0x06, r.forward_mask(2, 1, 0, 0));
+    EXPECT_EQ(0x06, r.forward_mask(2, 77, 0, 0));
+    // this system only to the channel the component has been seen on
+    EXPECT_EQ(0x08, r.forward_mask(our_sysid, MAV_COMP_ID_CAMERA, 0, 0));
+    EXPECT_EQ(0x00, r.forward_mask(our_sysid, 77, 0, 0));
+    // unless it is to all components
+    EXPECT_EQ(0x18, r.forward_mask(our_sysid, 0, 0, 0));
+    // an unknown system goes nowhere
+    EXPECT_EQ(0x00, r.forward_mask(9, 1, 0, 0));
+    // nor back where it came from
+    EXPECT_EQ(0x04, r.forward_mask(2, 1, 0, 1));
+
+    r.check_forward(2, 1, 0, 0);
+    r.check_forward(our_sysid, MAV_COMP_ID_CAMERA, 0, 0);
+    r.check_forward(our_sysid, 0, 0, 0);
+}
+
+TEST(MAVLinkRouting, private_channel)
+{
+    set_our_ids();
+    MAVLink_routing_Test r;
+    r.add(255, 190, 0);
+    r.add(our_sysid, MAV_COMP_ID_GIMBAL, 1);
+    r.add(our_sysid, MAV_COMP_ID_CAMERA, 1);
+    r.add(our_sysid, MAV_COMP_ID_CAMERA, 2);
+
+    const uint8_t private_mask = 0x02;
+    // a private channel only gets messages for a component seen on it
+    EXPECT_EQ(0x06, r.forward_mask(our_sysid, MAV_COMP_ID_CAMERA, private_mask, 0));
+    EXPECT_EQ(0x02, r.forward_mask(our_sysid, MAV_COMP_ID_GIMBAL, private_mask, 0));
+    // and not broadcasts to the system or to everyone
+    EXPECT_EQ(0x04, r.forward_mask(our_sysid, 0, private_mask, 0));
+    EXPECT_EQ(0x05, r.forward_mask(0, 0, private_mask, 1));
+
+    r.check_forward(our_sysid, MAV_COMP_ID_CAMERA, private_mask, 0);
+    r.check_forward(our_sysid, MAV_COMP_ID_GIMBAL, private_mask, 0);
+    r.check_forward(our_sysid, 0, private_mask, 0);
+    r.check_forward(0, 0, private_mask, 1);
+}
+
+TEST(MAVLinkRouting, heartbeat)
+{
+    set_our_ids();
+    MAVLink_routing_Test r;
+    r.add(255, 190, 0);
+    r.add(2, 1, 1);
+    r.add(2, 1, 2);
+    r.add(our_sysid, MAV_COMP_ID_CAMERA, 3);
+
+    // everywhere active except where the sender has been seen, private
+    // channels and channels that don't want heartbeats
+    r.check_heartbeat(2, 1, 1, 0x3f, 0, 0);
+    r.check_heartbeat(2, 1, 1, 0x3f, 0x08, 0x10);
+    r.check_heartbeat(255, 190, 0, 0x0f, 0, 0);
+    // an unknown sender still doesn't go back where it came from
+    r.check_heartbeat(7, 1, 4, 0x3f, 0, 0);
+}
+
+/*
+  random routing tables and messages give the same channels as the
+  old linear table
+ */
+TEST(MAVLinkRouting, matches_old_routing)
+{
+    set_our_ids();
+    const uint8_t sysids[] { our_sysid, 2, 3, 255 };
+    const uint8_t compids[] { 0, our_compid, 2, MAV_COMP_ID_CAMERA, 190 };
+    const int16_t target_systems[] { -1, 0, our_sysid, 2, 3, 9, 255 };
+    const int16_t target_components[] { -1, 0, our_compid, 2, MAV_COMP_ID_CAMERA, 190, 77 };
+
+    srand(42);
+    for (uint16_t n=0; n<200; n++) {
+        MAVLink_routing_Test r;
+        const uint8_t num_routes = rand() % (MAVLINK_MAX_ROUTES + 1);
+        for (uint8_t i=0; i<num_routes; i++) {
+            const uint8_t sysid = sysids[rand() % ARRAY_SIZE(sysids)];
+            const uint8_t compid = compids[rand() % ARRAY_SIZE(compids)];
+            if (sysid == our_sysid && (compid == our_compid || compid == MAV_COMP_ID_ALL)) {
+                // never learned
+                continue;
+            }
+            r.add(sysid, compid, rand() % NUM_CHANS);
+        }
+        const uint8_t private_mask = rand() & ((1U<<NUM_CHANS)-1);
+        for (const int16_t ts : target_systems) {
+            for (const int16_t tc : target_components) {
+                r.check_forward(ts, tc, private_mask, rand() % NUM_CHANS);
+            }
+        }
+        for (const uint8_t sysid : sysids) {
+            for (const uint8_t compid : compids) {
+                r.check_heartbeat(sysid, compid, rand() % NUM_CHANS,
+                                  rand() & 0xff, private_mask, rand() & 0xff);
+            }
+        }
+    }
+}
+
+static void fill_message(mavlink_message_t &msg, uint8_t magic, uint8_t len)
+{
+    memset(&msg, 0, sizeof(msg));
+    msg.magic = magic;
+    msg.len = len;
+    msg.seq = 17;
+    msg.sysid = 2;
+    msg.compid = 1;
+    msg.msgid = 0x0102a3;
+    msg.checksum = 0xbeef;
+    uint8_t *payload = (uint8_t *)_MAV_PAYLOAD_NON_CONST(&msg);
+    for (uint8_t i=0; i<len; i++) {
+        payload[i] = i + 1;
+    }
+}
+
+/*
+  a MAVLink2 payload that the sender didn't trim must be sent as it
+  came, as the checksum covers the trailing zeros
+ */
+TEST(MAVLinkRouting, pack_untrimmed_frame)
+{
+    mavlink_message_t msg;
+    fill_message(msg, MAVLINK_STX, 10);
+    uint8_t *payload = (uint8_t *)_MAV_PAYLOAD_NON_CONST(&msg);
+    payload[7] = payload[8] = payload[9] = 0;
+
+    uint8_t buf[MAVLINK_MAX_PACKET_LEN];
+    ASSERT_EQ(MAVLINK_CORE_HEADER_LEN + 1 + 10 + 2, MAVLink_routing_Test::pack_frame(buf, msg));
+    const uint8_t header[] { MAVLINK_STX, 10, 0, 0, 17, 2, 1, 0xa3, 0x02, 0x01 };
+    EXPECT_EQ(0, memcmp(header, buf, sizeof(header)));
+    EXPECT_EQ(0, memcmp(payload, &buf[sizeof(header)], 10));
+    EXPECT_EQ(0xef, buf[sizeof(header) + 10]);
+    EXPECT_EQ(0xbe, buf[sizeof(header) + 11]);
+}
+
+TEST(MAVLinkRouting, pack_signed_frame)
+{
+    mavlink_message_t msg;
+    fill_message(msg, MAVLINK_STX, 5);
+    msg.incompat_flags = MAVLINK_IFLAG_SIGNED;
+    for (uint8_t i=0; i<MAVLINK_SIGNATURE_BLOCK_LEN; i++) {
+        msg.signature[i] = 0x80 + i;
+    }
+
+    uint8_t buf[MAVLINK_MAX_PACKET_LEN];
+    const uint16_t sig_ofs = MAVLINK_CORE_HEADER_LEN + 1 + 5 + 2;
+    ASSERT_EQ(sig_ofs + MAVLINK_SIGNATURE_BLOCK_LEN, MAVLink_routing_Test::pack_frame(buf, msg));
+    EXPECT_EQ(MAVLINK_IFLAG_SIGNED, buf[2]);
+    EXPECT_EQ(0xef, buf[sig_ofs - 2]);
+    EXPECT_EQ(0xbe, buf[sig_ofs - 1]);
+    EXPECT_EQ(0, memcmp(msg.signature, &buf[sig_ofs], MAVLINK_SIGNATURE_BLOCK_LEN));
+}
+
+TEST(MAVLinkRouting, pack_mavlink1_frame)
+{
+    mavlink_message_t msg;
+    fill_message(msg, MAVLINK_STX_MAVLINK1, 4);
+    msg.msgid = 0xa3;
+    // MAVLink1 frames are never signed
+    msg.incompat_flags = MAVLINK_IFLAG_SIGNED;
+
+    uint8_t buf[MAVLINK_MAX_PACKET_LEN];
+    ASSERT_EQ(MAVLINK_CORE_HEADER_MAVLINK1_LEN + 1 + 4 + 2, MAVLink_routing_Test::pack_frame(buf, msg));
+    const uint8_t frame[] { MAVLINK_STX_MAVLINK1, 4, 17, 2, 1, 0xa3, 1, 2, 3, 4, 0xef, 0xbe };
+    EXPECT_EQ(0, memcmp(frame, buf, sizeof(frame)));
+}
+
+#endif  // HAL_GCS_ENABLED
+
+AP_GTEST_MAIN()